@@ -183,6 +183,8 @@
       size_t changed_files;
      /* количество новых файлов */
       size_t new_files;
+     /* количество файлов, не обрабатывавшихся повторно в инкрементальном режиме */
+      size_t unchanged_files;
    } statistical_data;
   /* при установленном флаге программа не проверяет сегменты, загружаемые в память */
    bool_t ignore_segments;
@@ -213,6 +215,14 @@
    bool_t search_deleted;
   /* флаг использования производных ключей */
    bool_t key_derive;
+#ifdef AK_HAVE_PTHREAD_H
+  /* количество потоков, используемых для вычисления и проверки контрольных сумм */
+   size_t threads;
+#endif
+  /* флаг инкрементальной обработки: файлы с неизменными атрибутами повторно не обрабатываются */
+   bool_t incremental;
+  /* таблица с атрибутами файлов и вычисленными ранее контрольными суммами */
+   struct htable attributes;
   /* таблица со значениями контрольных сумм */
    struct htable icodes;
   /* количество узлов первого уровня в хэш-таблице */
@@ -325,6 +335,16 @@
  int aktool_icode_export_checksum( aktool_ki_t * );
 /* чтение файла с вычисленными ранее контрольными суммами */
  int aktool_icode_import_checksum( aktool_ki_t * );
+/* количество атрибутов файла, сохраняемых в инкрементальном режиме */
+ #define aktool_icode_attributes_count  (6)
+/* чтение таблицы с атрибутами файлов */
+ int aktool_icode_import_attributes( aktool_ki_t * );
+/* сохранение таблицы с атрибутами файлов */
+ int aktool_icode_export_attributes( aktool_ki_t * , bool_t );
+/* поиск сохраненной контрольной суммы файла с неизменными атрибутами */
+ ak_uint8 *aktool_icode_get_unchanged( const char * , aktool_ki_t * , ak_uint64 * );
+/* сохранение атрибутов файла и его контрольной суммы */
+ int aktool_icode_set_attributes( const char * , aktool_ki_t * , ak_uint64 * , ak_uint8 * );
 /* проверка контрольных сумм по заданой базе данных */
  int aktool_icode_check_from_database( aktool_ki_t * );
 /* проверка контрольных сумм для заданных каталогов и файлов */
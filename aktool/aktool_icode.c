@@ -65,6 +65,10 @@
      { "no-database",         0, NULL,  'n' },
      { "offset",              1, NULL,  173 },
      { "size",                1, NULL,  174 },
+#ifdef AK_HAVE_PTHREAD_H
+     { "threads",             1, NULL,  175 },
+#endif
+     { "incremental",         0, NULL,  176 },
 
     /* аналоги из aktool_key */
      { "key",                 1, NULL,  203 },
@@ -117,6 +121,9 @@
   ki.dont_save_database = ak_false;
   ki.offset = 0;
   ki.data_size = -1;
+#ifdef AK_HAVE_PTHREAD_H
+  ki.threads = 1;
+#endif
 
  /* разбираем опции командной строки */
   do {
@@ -374,6 +381,20 @@
                    }
                    break;
 
+        case 176: /* --incremental */
+                   ki.incremental = ak_true;
+                   break;
+
+      #ifdef AK_HAVE_PTHREAD_H
+        case 175: /* --threads */
+                   if( atoi( optarg ) < 1 ) {
+                     aktool_error(_("the number of threads must be positive"));
+                     goto exitlab;
+                   }
+                   ki.threads = (size_t) atoi( optarg );
+                   break;
+      #endif
+
         default:  /* обрабатываем ошибочные параметры */
                    if( next_option != -1 ) goto exitlab;
                    break;
@@ -427,6 +448,9 @@
          aktool_icode_export_checksum( &ki );
         else
          exit_status = aktool_icode_export_checksum( &ki );
+      /* сохраняем атрибуты файлов для последующих запусков в инкрементальном режиме */
+       if( aktool_icode_export_attributes( &ki, ak_true ) != ak_error_ok )
+         exit_status = EXIT_FAILURE;
       break;
 
     case do_add:
@@ -439,6 +463,8 @@
        if(( exit_status = aktool_icode_evaluate( &ki )) != EXIT_SUCCESS ) goto exitlab;
       /* сохраняем результат */
        exit_status = aktool_icode_export_checksum( &ki );
+       if( aktool_icode_export_attributes( &ki, ak_true ) != ak_error_ok )
+         exit_status = EXIT_FAILURE;
       break;
 
     case do_check:
@@ -499,6 +525,7 @@
     ak_htable_destroy( &ki.fragments_lens );
    #endif
     ak_htable_destroy( &ki.icodes );
+    ak_htable_destroy( &ki.attributes );
     aktool_destroy_libakrypt();
 
  return exit_status;
@@ -704,6 +731,8 @@
   printf(_("     --format            set the format of output hash table [ enabled values: binary linux bsd, default: binary ]\n"));
   printf(_("     --hash-table-nodes  number of high-level nodes in the generated hash table [ default: %llu ]\n"),
                                                                   (unsigned long long int) ki.icode_lists_count );
+  printf(_("     --incremental       do not process files whose size, modification and change times and inode have not changed\n"));
+  printf(_("                         since the previous database creation; verification always processes all files\n"));
   printf(_("     --inpass            set the password for the secret key to be read directly in command line\n"));
   printf(_("     --inpass-hex        set the password for the secret key to be read directly in command line as hexademal string\n"));
   printf(_(" -i, --input             set the name of file with previously created authentication or integrity codes\n"));
@@ -733,6 +762,9 @@
   printf(_("     --size              set the size of the file fragment being processed\n"));
   printf(_("                         the value -1 determines the size of the data to the end of the file\n"));
   printf(_("     --tag               create a BSD-style hash table format\n"));
+#ifdef AK_HAVE_PTHREAD_H
+  printf(_("     --threads           set the number of threads used to create or verify codes [ default: 1 ]\n"));
+#endif
   printf(_(" -v, --verify            verify previously created authentication or integrity codes\n"));
 #ifdef AK_HAVE_GELF_H
   printf(_("     --with-segments     create or verify authentication or integrity codes for downloadable segments\n"));
@@ -98,6 +98,14 @@
       return 1;
     }
 
+   /* --incremental */
+    if( memcmp( name, "incremental", 11 ) == 0 ) {
+      if(( memcmp( value, "true", 4 ) == 0 ) || ( memcmp( value, "TRUE", 4 ) == 0 )) {
+        ki->incremental = ak_true;
+      }
+      return 1;
+    }
+
 #ifdef AK_HAVE_GELF_H
    /* --with-segments */
     if( memcmp( name, "with-segments", 13 ) == 0 ) {
@@ -21,6 +21,9 @@
 #ifdef AK_HAVE_DIRENT_H
  #include <dirent.h>
 #endif
+#ifdef AK_HAVE_PTHREAD_H
+ #include <pthread.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
 /*                 Функция для создания и удаления ключевой информации                             */
@@ -122,7 +125,10 @@
 /* ----------------------------------------------------------------------------------------------- */
 /*                      функция выработки производного ключа                                       */
 /* ----------------------------------------------------------------------------------------------- */
- ak_pointer aktool_icode_get_derived_key( const char *value, aktool_ki_t *ki, ak_uint64 fp_size )
+/* при audit == ak_false функция не выводит сообщений и может вызываться из рабочих потоков;
+   об ошибке в этом случае сообщает вызывающая сторона */
+ static ak_pointer aktool_icode_new_derived_key( const char *value, aktool_ki_t *ki,
+                                                                ak_uint64 fp_size, bool_t audit )
 {
     struct file infp;
     ak_pointer dkey = NULL;
@@ -143,7 +149,7 @@
                        (ak_uint8*) value, /* метка, в качестве которой выступает имя файла */
                        strlen( value ),                                     /* длина метки */
                        NULL, 0 )) != ak_error_ok ) {
-          aktool_error(_("incorrect creation of derivative key (file %s)"), value );
+          if( audit ) aktool_error(_("incorrect creation of derivative key (file %s)"), value );
           if( dkey != NULL ) ak_oid_delete_object( koid, dkey );
           return NULL;
         }
@@ -164,7 +170,7 @@
       иначе придется вырабатывать следующий производный ключ и т.д. */
     if(( blocks = ( total_size / ki->size )) > ((ak_skey)dkey)->resource.value.counter ) {
       ((ak_skey)dkey)->resource.value.counter = blocks;
-      if( ak_log_get_level() > ak_log_standard ) {
+      if(( audit ) && ( ak_log_get_level() > ak_log_standard )) {
          ak_error_message_fmt( ak_error_ok, __func__,
                 _("the resource of the derived key was increased up to %llu blocks (file %s)"),
                                        (ak_uint64)((ak_skey)dkey)->resource.value.counter, value );
@@ -174,6 +180,12 @@
   return dkey;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+ ak_pointer aktool_icode_get_derived_key( const char *value, aktool_ki_t *ki, ak_uint64 fp_size )
+{
+  return aktool_icode_new_derived_key( value, ki, fp_size, ak_true );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                     функции вычисления контрольных сумм                                         */
 /* ----------------------------------------------------------------------------------------------- */
@@ -266,10 +278,22 @@
 }
 #endif
 
+/* ----------------------------------------------------------------------------------------------- */
+/* вычисление контрольной суммы всего файла или его фрагмента */
+ static int aktool_icode_evaluate_value( aktool_ki_t *ki, ak_pointer dkey,
+                                                                const char *value, ak_uint8 *icode )
+{
+    if(( ki->offset == 0 ) && ( ki->data_size == -1 ))
+      return ki->icode_file( dkey, value, icode, ki->size );
+ return ki->icode_file_offset( dkey, value, ki->offset, ki->data_size, icode, ki->size );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  static int aktool_icode_evaluate_function( const char *value, ak_pointer ptr )
 {
     ak_uint8 icode[256];
+    ak_uint8 *iptr = NULL;
+    ak_uint64 attr[aktool_icode_attributes_count];
     aktool_ki_t *ki = ptr;
     ak_pointer dkey = NULL;
     int error = ak_error_ok;
@@ -281,23 +305,28 @@
 
    /* проверяем, что надо контролировать целостность всего файла */
     if( !ki->only_segments ) {
-     /* вычисляем производный ключ */
-      if(( dkey = aktool_icode_get_derived_key( value, ki, 0 )) == NULL ) {
-        ki->statistical_data.skiped_files++;
-        return ak_error_null_pointer;
+     /* в инкрементальном режиме используем сохраненное значение для неизмененного файла */
+      if(( ki->incremental ) && (( iptr = aktool_icode_get_unchanged( value, ki, attr )) != NULL )) {
+        memcpy( icode, iptr, ki->size );
+        ki->statistical_data.unchanged_files++;
       }
-     /* вычисляем контрольную сумму от заданного файла и помещаем ее в таблицу */
-      if(( ki->offset == 0 ) && ( ki->data_size = -1 ))
-        error = ki->icode_file( dkey, value, icode, ki->size );
-       else
-        error = ki->icode_file_offset( dkey, value, ki->offset, ki->data_size, icode, ki->size );
-      if( dkey != ki->handle ) ak_skey_delete( dkey );
+       else {
+        /* вычисляем производный ключ */
+         if(( dkey = aktool_icode_get_derived_key( value, ki, 0 )) == NULL ) {
+           ki->statistical_data.skiped_files++;
+           return ak_error_null_pointer;
+         }
+        /* вычисляем контрольную сумму от заданного файла и помещаем ее в таблицу */
+         error = aktool_icode_evaluate_value( ki, dkey, value, icode );
+         if( dkey != ki->handle ) ak_skey_delete( dkey );
+       }
      /* проверка результата и его сохнение в хеш-таблице */
       if( error == ak_error_ok ) {
         ki->statistical_data.hashed_files++;
         if(( !ki->quiet ) && ( !ki->dont_show_icode))
           aktool_icode_out( stdout, value, ki, icode, ki->size );
         ak_htable_add_str_value( &ki->icodes, value, icode, ki->size );
+        if( ki->incremental ) aktool_icode_set_attributes( value, ki, attr, icode );
       }
        else {
          ki->statistical_data.skiped_files++;
@@ -314,6 +343,330 @@
  return error;
 }
 
+#ifdef AK_HAVE_PTHREAD_H
+/* ----------------------------------------------------------------------------------------------- */
+/*                   параллельное вычисление и проверка контрольных сумм                           */
+/* ----------------------------------------------------------------------------------------------- */
+/* количество файлов, приходящихся на один поток в ограниченной очереди заданий */
+ #define aktool_icode_jobs_per_thread (256)
+
+/* ----------------------------------------------------------------------------------------------- */
+/* задание на вычисление контрольной суммы одного файла */
+ typedef struct {
+  /* имя файла */
+   char *value;
+  /* запись, исключенная из базы данных (используется только при проверке) */
+   ak_keypair kp;
+  /* флаг того, что имя файла и запись kp принадлежат базе данных и не удаляются */
+   bool_t borrowed;
+  /* флаг успешной выработки производного ключа */
+   bool_t dkey_ok;
+  /* код ошибки, возникшей при вычислении контрольной суммы */
+   int error;
+  /* вычисленное значение контрольной суммы */
+   ak_uint8 icode[256];
+  /* атрибуты файла (используются в инкрементальном режиме) */
+   ak_uint64 attr[aktool_icode_attributes_count];
+  /* флаг использования сохраненной ранее контрольной суммы */
+   bool_t unchanged;
+ } aktool_icode_job_t;
+
+/* ----------------------------------------------------------------------------------------------- */
+/* ограниченная очередь заданий и обрабатывающие ее потоки */
+ typedef struct aktool_icode_pool aktool_icode_pool_t;
+
+/* контекст одного потока */
+ typedef struct {
+  /* очередь, из которой поток извлекает задания */
+   aktool_icode_pool_t *pool;
+  /* собственный контекст алгоритма хеширования потока */
+   ak_pointer handle;
+ } aktool_icode_worker_t;
+
+ struct aktool_icode_pool {
+  /* параметры программы */
+   aktool_ki_t *ki;
+  /* массив заданий */
+   aktool_icode_job_t *jobs;
+  /* количество заданий в очереди */
+   size_t count;
+  /* максимальное количество заданий в очереди */
+   size_t capacity;
+  /* номер следующего необработанного задания */
+   size_t next;
+  /* количество потоков */
+   size_t threads_count;
+  /* контексты потоков */
+   aktool_icode_worker_t *workers;
+  /* флаг проверки контрольных сумм (иначе - вычисление) */
+   bool_t check;
+  /* код первой ошибки, возникшей при постановке или выполнении заданий текущей очереди;
+     обнуляется при каждом запуске обработки очереди */
+   int error;
+  /* код первой ошибки, возникшей с момента создания очереди */
+   int status;
+  /* блокировка доступа к номеру следующего задания */
+   pthread_mutex_t mutex;
+  /* блокировка доступа к секретному ключу ki->handle при выработке производных ключей */
+   pthread_mutex_t key_mutex;
+ };
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_icode_check_result( const char * , ak_uint8 * , ak_uint8 * , int );
+ static int aktool_icode_check_new_file( aktool_ki_t * , const char * );
+
+/* ----------------------------------------------------------------------------------------------- */
+/* параллельная обработка допустима, если потоки не используют один и тот же ключ */
+ static bool_t aktool_icode_pool_enabled( aktool_ki_t *ki )
+{
+    if( ki->threads < 2 ) return ak_false;
+    if(( ki->method->engine != hash_function ) && ( ki->key_derive == ak_false )) {
+      if( ak_log_get_level() > ak_log_standard )
+        ak_error_message( ak_error_ok, __func__,
+                    _("derived keys are not used, so integrity codes are evaluated in one thread"));
+      return ak_false;
+    }
+ return ak_true;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_icode_pool_create( aktool_icode_pool_t *pool, aktool_ki_t *ki, bool_t check )
+{
+    size_t i = 0;
+
+    memset( pool, 0, sizeof( aktool_icode_pool_t ));
+    pool->ki = ki;
+    pool->check = check;
+    pool->threads_count = ki->threads;
+    pool->capacity = ki->threads*aktool_icode_jobs_per_thread;
+
+    if((( pool->jobs = calloc( pool->capacity, sizeof( aktool_icode_job_t ))) == NULL ) ||
+       (( pool->workers = calloc( pool->threads_count, sizeof( aktool_icode_worker_t ))) == NULL )) {
+      if( pool->jobs != NULL ) free( pool->jobs );
+      aktool_error(_("incorrect memory allocation for %u threads"), (unsigned int) ki->threads );
+      return ak_error_out_of_memory;
+    }
+
+   /* бесключевые алгоритмы хеширования требуют собственного контекста для каждого потока */
+    for( i = 0; i < pool->threads_count; i++ ) {
+       pool->workers[i].pool = pool;
+       if( ki->method->engine != hash_function ) continue;
+       if(( pool->workers[i].handle = ak_oid_new_object( ki->method )) == NULL ) {
+         aktool_error(_("wrong creation of internal context of %s algorithm"), ki->method->name[0]);
+         while( i-- > 0 ) ak_oid_delete_object( ki->method, pool->workers[i].handle );
+         free( pool->workers );
+         free( pool->jobs );
+         return ak_error_get_value();
+       }
+    }
+
+    pthread_mutex_init( &pool->mutex, NULL );
+    pthread_mutex_init( &pool->key_mutex, NULL );
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static void aktool_icode_pool_destroy( aktool_icode_pool_t *pool )
+{
+    size_t i = 0;
+
+    for( i = 0; i < pool->threads_count; i++ )
+       if( pool->workers[i].handle != NULL )
+         ak_oid_delete_object( pool->ki->method, pool->workers[i].handle );
+    pthread_mutex_destroy( &pool->mutex );
+    pthread_mutex_destroy( &pool->key_mutex );
+    free( pool->workers );
+    free( pool->jobs );
+    memset( pool, 0, sizeof( aktool_icode_pool_t ));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* функция потока: выработка производного ключа и вычисление контрольной суммы */
+ static void *aktool_icode_pool_thread( void *arg )
+{
+    aktool_icode_worker_t *worker = arg;
+    aktool_icode_pool_t *pool = worker->pool;
+    aktool_ki_t *ki = pool->ki;
+
+    for( ;; ) {
+       size_t idx = 0;
+       ak_pointer dkey = NULL;
+       aktool_icode_job_t *job = NULL;
+
+       pthread_mutex_lock( &pool->mutex );
+       idx = pool->next++;
+       pthread_mutex_unlock( &pool->mutex );
+       if( idx >= pool->count ) break;
+
+       job = pool->jobs +idx;
+       if( pool->check ) {
+         if(( job->kp == NULL ) || ( job->kp->data == NULL )) continue;
+       }
+        else if( ki->only_segments ) continue;
+       if( job->unchanged ) continue;
+
+      /* ключ ki->handle маскируется при каждом обращении, поэтому доступ к нему упорядочивается;
+         сообщения об ошибках потоки не выводят, код ошибки сохраняется в задании
+         и обрабатывается в основном потоке */
+       if( worker->handle != NULL ) dkey = worker->handle;
+        else {
+          pthread_mutex_lock( &pool->key_mutex );
+          dkey = aktool_icode_new_derived_key( job->value, ki, 0, ak_false );
+          pthread_mutex_unlock( &pool->key_mutex );
+          if( dkey == NULL ) {
+            job->error = ak_error_null_pointer;
+            continue;
+          }
+        }
+       job->dkey_ok = ak_true;
+
+       if( pool->check ) job->error = ki->icode_file( dkey, job->value, job->icode, ki->size );
+        else job->error = aktool_icode_evaluate_value( ki, dkey, job->value, job->icode );
+       if( dkey != worker->handle ) ak_skey_delete( dkey );
+    }
+
+ return NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* перенос результата вычисления в таблицу ki->icodes (выполняется в основном потоке) */
+ static void aktool_icode_pool_merge_evaluated( aktool_ki_t *ki, aktool_icode_job_t *job )
+{
+    ki->statistical_data.total_files++;
+
+    if( !ki->only_segments ) {
+      if( !job->dkey_ok ) {
+        aktool_error(_("incorrect creation of derivative key (file %s)"), job->value );
+        ki->statistical_data.skiped_files++;
+        return;
+      }
+      if( job->error != ak_error_ok ) {
+        ak_error_message_fmt( job->error, __func__,
+                                    _("incorrect evaluation of integrity code for %s"), job->value );
+        ki->statistical_data.skiped_files++;
+        return;
+      }
+      ki->statistical_data.hashed_files++;
+      if( job->unchanged ) ki->statistical_data.unchanged_files++;
+      if(( !ki->quiet ) && ( !ki->dont_show_icode ))
+        aktool_icode_out( stdout, job->value, ki, job->icode, ki->size );
+      ak_htable_add_str_value( &ki->icodes, job->value, job->icode, ki->size );
+      if( ki->incremental ) aktool_icode_set_attributes( job->value, ki, job->attr, job->icode );
+    }
+
+  #ifdef AK_HAVE_GELF_H
+   if( !ki->ignore_segments ) aktool_icode_evaluate_gelf( job->value, ki );
+  #endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* сравнение результата вычисления со значением из базы данных (выполняется в основном потоке) */
+ static void aktool_icode_pool_merge_checked( aktool_ki_t *ki, aktool_icode_job_t *job )
+{
+    if( job->kp == NULL ) {
+      aktool_icode_check_new_file( ki, job->value );
+      return;
+    }
+    if( job->kp->data == NULL )
+      ak_error_message( ak_error_null_pointer, __func__, _("using null pointer to keypair"));
+     else {
+       ki->statistical_data.total_files++;
+       if( !job->dkey_ok ) {
+         aktool_error(_("incorrect creation of derivative key (file %s)"), job->value );
+         ki->statistical_data.skiped_files++;
+       }
+        else aktool_icode_check_result( job->value,
+                                 job->kp->data +job->kp->key_length, job->icode, job->error );
+     }
+    if( !job->borrowed ) ak_keypair_delete( job->kp );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* обработка всех заданий очереди: задания распределяются между потоками,
+   а результаты переносятся в основном потоке в порядке постановки заданий в очередь;
+   функция возвращает код первой ошибки, возникшей при обработке текущей очереди,
+   код первой ошибки с момента создания очереди сохраняется в поле status */
+ static int aktool_icode_pool_run( aktool_icode_pool_t *pool )
+{
+    size_t i = 0, started = 0;
+    pthread_t *threads = NULL;
+
+    pool->error = ak_error_ok;
+    if( pool->count == 0 ) return pool->error;
+    if(( threads = calloc( pool->threads_count, sizeof( pthread_t ))) != NULL ) {
+      for( started = 0; started < pool->threads_count; started++ )
+         if( pthread_create( threads +started, NULL,
+                                        aktool_icode_pool_thread, pool->workers +started ) != 0 )
+           break;
+    }
+   /* если ни один поток не был создан, задания выполняются в основном потоке */
+    if( started == 0 ) aktool_icode_pool_thread( pool->workers );
+    for( i = 0; i < started; i++ ) pthread_join( threads[i], NULL );
+    if( threads != NULL ) free( threads );
+
+    for( i = 0; i < pool->count; i++ ) {
+       if(( pool->error == ak_error_ok ) && ( pool->jobs[i].error != ak_error_ok ))
+         pool->error = pool->jobs[i].error;
+       if( pool->check ) aktool_icode_pool_merge_checked( pool->ki, pool->jobs +i );
+        else aktool_icode_pool_merge_evaluated( pool->ki, pool->jobs +i );
+       if( !pool->jobs[i].borrowed ) free( pool->jobs[i].value );
+    }
+    memset( pool->jobs, 0, pool->count*sizeof( aktool_icode_job_t ));
+    pool->count = pool->next = 0;
+    if( pool->status == ak_error_ok ) pool->status = pool->error;
+
+ return pool->error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* функция, вызываемая при обходе каталогов: постановка файла в очередь заданий */
+ static int aktool_icode_pool_add_function( const char *value, ak_pointer ptr )
+{
+    aktool_icode_pool_t *pool = ptr;
+    aktool_icode_job_t *job = pool->jobs +pool->count;
+
+   /* проверяем черный список */
+    if( ak_htable_get_str( &pool->ki->exclude_file, value, NULL ) != NULL ) return ak_error_ok;
+
+    if(( job->value = strdup( value )) == NULL ) {
+      if( pool->status == ak_error_ok ) pool->status = ak_error_out_of_memory;
+      return ak_error_message( ak_error_out_of_memory, __func__, _("incorrect memory allocation"));
+    }
+    if( pool->check ) job->kp = ak_htable_exclude_keypair_str( &pool->ki->icodes, value );
+
+   /* поиск сохраненных атрибутов выполняется в основном потоке,
+      поскольку обращение к хеш-таблице изменяет ее состояние;
+      при проверке контрольные суммы вычисляются всегда */
+    if(( pool->ki->incremental ) && ( !pool->check ) && ( !pool->ki->only_segments )) {
+      ak_uint8 *iptr = aktool_icode_get_unchanged( value, pool->ki, job->attr );
+      if( iptr != NULL ) {
+        memcpy( job->icode, iptr, pool->ki->size );
+        job->unchanged = job->dkey_ok = ak_true;
+      }
+    }
+
+   /* очередь заполнена: обрабатываем накопленные задания */
+    if( ++pool->count == pool->capacity ) return aktool_icode_pool_run( pool );
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* постановка в очередь записи из базы данных (при проверке по базе данных);
+   запись остается в хеш-таблице, поэтому ни имя файла, ни сама запись не удаляются */
+ static int aktool_icode_pool_add_keypair( aktool_icode_pool_t *pool, ak_keypair kp )
+{
+    aktool_icode_job_t *job = pool->jobs +pool->count;
+
+    job->value = ( char * )kp->data;
+    job->kp = kp;
+    job->borrowed = ak_true;
+
+   /* очередь заполнена: обрабатываем накопленные задания */
+    if( ++pool->count == pool->capacity ) return aktool_icode_pool_run( pool );
+ return ak_error_ok;
+}
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция вычисляет контрольные суммы по заданным спискам каталогов и файлов */
  int aktool_icode_evaluate( aktool_ki_t *ki )
@@ -332,6 +685,40 @@
 
    /* создаем контекст алгоритма хеширования или имитозащиты */
     if( aktool_icode_create_handle( ki ) != ak_error_ok ) return EXIT_FAILURE;
+   /* считываем атрибуты файлов, сохраненные при предыдущем запуске */
+    if( aktool_icode_import_attributes( ki ) != ak_error_ok ) {
+      aktool_icode_destroy_handle( ki );
+      return EXIT_FAILURE;
+    }
+
+  #ifdef AK_HAVE_PTHREAD_H
+   /* при необходимости, вычисления выполняются в нескольких потоках */
+    if( aktool_icode_pool_enabled( ki )) {
+      aktool_icode_pool_t pool;
+      if( aktool_icode_pool_create( &pool, ki, ak_false ) != ak_error_ok ) {
+        aktool_icode_destroy_handle( ki );
+        return EXIT_FAILURE;
+      }
+      if( ki->include_file.count ) {
+        ak_list_first( &ki->include_file );
+        do{
+            aktool_icode_pool_add_function(( char * )ki->include_file.current->data, &pool );
+        } while( ak_list_next( &ki->include_file ));
+      }
+      if( ki->include_path.count ) {
+        ak_list_first( &ki->include_path );
+        do{
+            value = ( char * )ki->include_path.current->data;
+            if( ak_htable_get_str( &ki->exclude_path, value, NULL ) != NULL ) continue;
+            ak_file_find( value, ki->pattern, aktool_icode_pool_add_function, &pool, ki->tree );
+        } while( ak_list_next( &ki->include_path ));
+      }
+      aktool_icode_pool_run( &pool );
+      if( pool.status != ak_error_ok ) exit_status = EXIT_FAILURE;
+      aktool_icode_pool_destroy( &pool );
+      goto labstat;
+    }
+  #endif
 
    /* начинаем с обхода файлов */
     if( ki->include_file.count ) {
@@ -353,6 +740,9 @@
       } while( ak_list_next( &ki->include_path ));
     }
 
+  #ifdef AK_HAVE_PTHREAD_H
+   labstat:
+  #endif
    /* финальное сообщение об ошибках */
     if( ki->statistical_data.skiped_files ) {
       exit_status = EXIT_FAILURE;
@@ -370,6 +760,9 @@
                                       (long long unsigned int) ki->statistical_data.skiped_files );
         printf(_(" %6llu have been proceed\n"),
                                       (long long unsigned int) ki->statistical_data.hashed_files );
+        if( ki->statistical_data.unchanged_files )
+          printf(_(" %6llu of them have not been changed since the previous run\n"),
+                                   (long long unsigned int) ki->statistical_data.unchanged_files );
        #ifdef AK_HAVE_GELF_H
         if( !ki->ignore_segments ) {
           printf(_(" %6llu contain downloadable segments\n"),
@@ -390,26 +783,10 @@
 /* ----------------------------------------------------------------------------------------------- */
 /*                           функции проверки контрольных сумм                                     */
 /* ----------------------------------------------------------------------------------------------- */
- static int aktool_icode_check_function( const char *value, ak_pointer ptr )
+/* сравнение вычисленной контрольной суммы icode с сохраненным в базе значением iptr */
+ static int aktool_icode_check_result( const char *value, ak_uint8 *iptr,
+                                                                    ak_uint8 *icode, int error )
 {
-    ak_uint8 icode[256];
-    ak_pointer dkey = NULL;
-    ak_uint8 *iptr = (ak_uint8 *)ptr;
-    int error = ak_error_ok;
-
-   /* статистика */
-    ki.statistical_data.total_files++;
-
-   /* вычисляем производный ключ */
-    if(( dkey = aktool_icode_get_derived_key( value, &ki, 0 )) == NULL ) {
-      ki.statistical_data.skiped_files++;
-      return ak_error_get_value();
-    }
-
-   /* вычисляем контрольную сумму от заданного файла и помещаем ее в таблицу */
-    error = ki.icode_file( dkey, value, icode, ki.size );
-    if( dkey != ki.handle ) ak_skey_delete( dkey );
-
     if( error != ak_error_ok ) {
       ak_error_message_fmt( error, __func__, _("%s is lost"), value );
       if( !ki.quiet ) aktool_error(_("%s is lost"), value );
@@ -436,16 +813,48 @@
  return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+ static int aktool_icode_check_function( const char *value, ak_pointer ptr )
+{
+    ak_uint8 icode[256];
+    ak_pointer dkey = NULL;
+    int error = ak_error_ok;
+
+   /* статистика */
+    ki.statistical_data.total_files++;
+
+   /* вычисляем производный ключ */
+    if(( dkey = aktool_icode_get_derived_key( value, &ki, 0 )) == NULL ) {
+      ki.statistical_data.skiped_files++;
+      return ak_error_get_value();
+    }
+
+   /* вычисляем контрольную сумму от заданного файла и сравниваем ее с сохраненной */
+    error = ki.icode_file( dkey, value, icode, ki.size );
+    if( dkey != ki.handle ) ak_skey_delete( dkey );
+
+ return aktool_icode_check_result( value, (ak_uint8 *)ptr, icode, error );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  int aktool_icode_check_from_database( aktool_ki_t *ki )
 {
     size_t i = 0;
     int exit_status = EXIT_FAILURE;
+  #ifdef AK_HAVE_PTHREAD_H
+    aktool_icode_pool_t pool;
+    bool_t use_pool = aktool_icode_pool_enabled( ki );
+  #endif
 
    /* аудит */
     if( ak_log_get_level() > ak_log_standard )
       ak_error_message_fmt( ak_error_ok, __func__,
                                 _("checking all files from given database: %s"), ki->pubkey_file );
+  #ifdef AK_HAVE_PTHREAD_H
+   /* при необходимости, проверка выполняется в нескольких потоках */
+    if(( use_pool ) && ( aktool_icode_pool_create( &pool, ki, ak_true ) != ak_error_ok ))
+      return EXIT_FAILURE;
+  #endif
    /* основной цикл */
     for( i = 0; i < ki->icodes.count; i++ ) {
       ak_list list = &ki->icodes.list[i];
@@ -457,6 +866,9 @@
         /* проверки  */
          if( kp->data == NULL ) {
            ak_error_message( ak_error_null_pointer, __func__, _("using null pointer to keypair"));
+          #ifdef AK_HAVE_PTHREAD_H
+           if( use_pool ) aktool_icode_pool_destroy( &pool );
+          #endif
            return EXIT_FAILURE;
          }
 
@@ -474,11 +886,25 @@
          }
 
         /* выполняем проверку конкретного файла */
+        #ifdef AK_HAVE_PTHREAD_H
+         if( use_pool ) {
+           aktool_icode_pool_add_keypair( &pool, kp );
+           continue;
+         }
+        #endif
          aktool_icode_check_function( (const char *)kp->data, kp->data +kp->key_length );
       }
        while( ak_list_next( list ));
     }
 
+  #ifdef AK_HAVE_PTHREAD_H
+   /* обрабатываем задания, оставшиеся в очереди */
+    if( use_pool ) {
+      aktool_icode_pool_run( &pool );
+      aktool_icode_pool_destroy( &pool );
+    }
+  #endif
+
    /* финальное предупреждение */
     if( ki->statistical_data.skiped_files ) {
       aktool_error(_("aktool found %d error(s), try aktool with \"--audit-file stderr --audit 2\""
@@ -509,6 +935,17 @@
  return exit_status;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/* файл отсутствует в базе данных контрольных сумм */
+ static int aktool_icode_check_new_file( aktool_ki_t *ki, const char *value )
+{
+    ki->statistical_data.total_files++;
+    ki->statistical_data.new_files++;
+    if( !ki->quiet ) aktool_error( _("%s is a new file"), value );
+ return ak_error_message_fmt( ak_error_htable_key_not_found, __func__,
+                                                                    _("%s is a new file"), value );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  static int aktool_icode_check_file_function( const char *value, ak_pointer ptr )
 {
@@ -520,13 +957,8 @@
     if( ak_htable_get_str( &ki->exclude_file, value, NULL ) != NULL ) return ak_error_ok;
 
    /* ищем файл в базе */
-    if(( kp = ak_htable_exclude_keypair_str( &ki->icodes, value )) == NULL ) {
-      ki->statistical_data.total_files++;
-      ki->statistical_data.new_files++;
-      if( !ki->quiet ) aktool_error( _("%s is a new file"), value );
-      return ak_error_message_fmt( ak_error_htable_key_not_found, __func__,
-                                                                    _("%s is a new file"), value );
-    }
+    if(( kp = ak_htable_exclude_keypair_str( &ki->icodes, value )) == NULL )
+      return aktool_icode_check_new_file( ki, value );
 
    /* проверяем, что база корректна */
     if( kp->data == NULL ) {
@@ -546,7 +978,12 @@
  int aktool_icode_check_from_directory( aktool_ki_t *ki )
 {
     size_t total_errors = 0;
-    int exit_status = EXIT_FAILURE;
+    int exit_status = EXIT_FAILURE, error = ak_error_ok;
+    ak_pointer find_ptr = ki;
+    ak_function_find *find_function = aktool_icode_check_file_function;
+  #ifdef AK_HAVE_PTHREAD_H
+    aktool_icode_pool_t pool;
+  #endif
 
    /* аудит */
     if( ak_log_get_level() > ak_log_standard )
@@ -555,11 +992,20 @@
    /* обнуляем счетчики */
     memset( &ki->statistical_data, 0, sizeof( struct icode_stat ));
 
+  #ifdef AK_HAVE_PTHREAD_H
+   /* при необходимости, проверка выполняется в нескольких потоках */
+    if( aktool_icode_pool_enabled( ki )) {
+      if( aktool_icode_pool_create( &pool, ki, ak_true ) != ak_error_ok ) return EXIT_FAILURE;
+      find_function = aktool_icode_pool_add_function;
+      find_ptr = &pool;
+    }
+  #endif
+
    /* начинаем с обхода файлов */
     if( ki->include_file.count ) {
       ak_list_first( &ki->include_file );
       do{
-          aktool_icode_check_file_function( ( char * )ki->include_file.current->data, ki );
+          find_function( ( char * )ki->include_file.current->data, find_ptr );
       } while( ak_list_next( &ki->include_file ));
     }
 
@@ -576,10 +1022,21 @@
          /* проверяем черный список */
           if( ak_htable_get_str( &ki->exclude_path, value, NULL ) != NULL ) continue;
          /* запускаем вычисление контрольной суммы */
-          ak_file_find( value, ki->pattern, aktool_icode_check_file_function, ki, ki->tree );
+          ak_file_find( value, ki->pattern, find_function, find_ptr, ki->tree );
       } while( ak_list_next( &ki->include_path ));
+    }
 
-     /* осталось найти то, что осталось непроверенным */
+  #ifdef AK_HAVE_PTHREAD_H
+   /* обрабатываем задания, оставшиеся в очереди */
+    if( find_ptr == &pool ) {
+      aktool_icode_pool_run( &pool );
+      error = pool.status;
+      aktool_icode_pool_destroy( &pool );
+    }
+  #endif
+
+   /* осталось найти то, что осталось непроверенным */
+    if( ki->include_path.count ) {
       if( ki->search_deleted ) {
         for( size_t i = 0; i < ki->icodes.count; i++ ) {
            ak_list list = &ki->icodes.list[i];
@@ -609,7 +1066,7 @@
       aktool_error(_("aktool found %d error(s), try aktool with \"--audit-file stderr --audit 2\""
                                                 " options or see syslog messages"), total_errors );
     }
-     else exit_status = EXIT_SUCCESS;
+     else exit_status = ( error == ak_error_ok ) ? EXIT_SUCCESS : EXIT_FAILURE;
 
    /* вывод статистики о проделанной работе */
     if( !ki->quiet ) {
@@ -10,6 +10,9 @@
 #ifdef AK_HAVE_ERRNO_H
  #include <errno.h>
 #endif
+#ifdef AK_HAVE_SYSSTAT_H
+ #include <sys/stat.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция выводит контрольную сумму в консоль */
@@ -250,6 +253,208 @@
   return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                  Функции для работы с атрибутами файлов (инкрементальный режим)                 */
+/* ----------------------------------------------------------------------------------------------- */
+/* имя файла, в котором хранится таблица атрибутов, образуется добавлением суффикса
+   к имени базы данных с контрольными суммами */
+ static void aktool_icode_attributes_file( aktool_ki_t *ki, char *filename, const size_t size )
+{
+    ak_snprintf( filename, size, "%s.attr", ki->pubkey_file );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* строка, описывающая параметры вычисления контрольных сумм;
+   сохраненные ранее значения могут использоваться только при совпадении этих параметров */
+ static void aktool_icode_attributes_header( aktool_ki_t *ki, char *header, const size_t size )
+{
+    ak_snprintf( header, size, "%s %s %d %lld %lld", ki->method->id[0],
+                 ki->method->engine == hash_function ? "-" :
+                                  ak_ptr_to_hexstr( ((ak_skey)ki->handle)->number, 32, ak_false ),
+                                  ki->key_derive, (long long int) ki->offset, (long long int) ki->data_size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция считывает таблицу атрибутов файлов, сохраненную при предыдущем запуске.
+
+    Таблица сопоставляет имени файла его размер, время модификации, время изменения
+    метаданных (с точностью до наносекунд, если система ее предоставляет), номер индексного
+    дескриптора и вычисленную ранее контрольную сумму. Таблица не защищена от изменения,
+    поэтому используется только при создании базы данных; при проверке контрольные суммы всех
+    файлов вычисляются заново. Если таблица отсутствует или была создана с другими параметрами
+    (алгоритм, ключ, фрагмент файла), то создается пустая таблица и все файлы обрабатываются
+    заново. Пустая таблица создается и в том случае, когда база данных не сохраняется
+    (опция `--no-database`): в этом режиме таблица атрибутов не считывается и не записывается. */
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_icode_import_attributes( aktool_ki_t *ki )
+{
+    int error = ak_error_ok;
+    const char *value = NULL;
+    char filename[1040], header[256];
+
+    if( !ki->incremental ) return ak_error_ok;
+    if( ki->attributes.count ) return ak_error_ok; /* таблица уже считана */
+
+    aktool_icode_attributes_file( ki, filename, sizeof( filename ));
+    aktool_icode_attributes_header( ki, header, sizeof( header ));
+
+    if(( !ki->dont_save_database ) && ( ak_file_or_directory( filename ) == DT_REG )) {
+      if(( error = ak_htable_create_from_file( &ki->attributes, filename )) == ak_error_ok ) {
+        if((( value = ak_htable_get_str( &ki->attributes, "", NULL )) != NULL ) &&
+                                                            ( strcmp( value, header ) == 0 )) {
+          if( ak_log_get_level() > ak_log_standard )
+            ak_error_message_fmt( ak_error_ok, __func__,
+                                           _("file attributes loaded from %s"), filename );
+          return ak_error_ok;
+        }
+        ak_htable_destroy( &ki->attributes );
+      }
+      ak_error_set_value( ak_error_ok );
+      if( ak_log_get_level() > ak_log_standard )
+        ak_error_message_fmt( ak_error_ok, __func__,
+             _("file attributes from %s cannot be used, all files will be processed"), filename );
+    }
+
+   /* создаем новую таблицу */
+    if(( error = ak_htable_create( &ki->attributes, ki->icode_lists_count )) != ak_error_ok )
+      return ak_error_message( error, __func__, _("incorrect hash table creation"));
+ return ak_htable_add_str_str( &ki->attributes, "", header );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция сохраняет таблицу атрибутов файлов.
+
+    Если флаг `prune` установлен, то из таблицы удаляются файлы, отсутствующие
+    в базе данных контрольных сумм.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_icode_export_attributes( aktool_ki_t *ki, bool_t prune )
+{
+    size_t i = 0;
+    char filename[1040];
+    struct htable attributes;
+
+    if(( !ki->incremental ) || ( ki->dont_save_database )) return ak_error_ok;
+    if( ki->attributes.count == 0 ) return ak_error_ok;
+
+   /* оставляем только те файлы, которые присутствуют в базе данных */
+    if( prune ) {
+      if( ak_htable_create( &attributes, ki->attributes.count ) != ak_error_ok )
+        return ak_error_get_value();
+      for( i = 0; i < ki->attributes.count; i++ ) {
+         ak_list list = &ki->attributes.list[i];
+         if( list->count == 0 ) continue;
+         ak_list_first( list );
+         do{
+             ak_keypair kp = (ak_keypair)list->current->data;
+             if(( kp->key_length > 1 ) &&
+                ( ak_htable_get( &ki->icodes, kp->data, kp->key_length, NULL ) == NULL )) continue;
+             ak_htable_add_key_value( &attributes,
+                            kp->data, kp->key_length, kp->data +kp->key_length, kp->value_length );
+         } while( ak_list_next( list ));
+      }
+      ak_htable_destroy( &ki->attributes );
+      ki->attributes = attributes;
+    }
+
+    aktool_icode_attributes_file( ki, filename, sizeof( filename ));
+    if( ak_htable_export_to_file( &ki->attributes, filename ) != ak_error_ok ) {
+      aktool_error(_("incorrectly writing file attributes to %s (%s)"),
+                                                                      filename, strerror( errno ));
+      return ak_error_write_data;
+    }
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция определяет атрибуты файла и, если они совпадают с сохраненными ранее,
+    возвращает указатель на сохраненную контрольную сумму.
+
+    Атрибуты файла, метаданные которого изменялись в текущую секунду, не определяются:
+    на файловых системах с грубым разрешением временных меток повторное изменение файла
+    в ту же секунду может не изменить его атрибутов.
+
+    @param value имя файла
+    @param ki контекст утилиты
+    @param attr массив из `aktool_icode_attributes_count` элементов, в который помещаются
+    текущие атрибуты файла; используется в дальнейшем функцией aktool_icode_set_attributes()
+    @return Указатель на сохраненную контрольную сумму. Если файл изменился, отсутствует
+    в таблице или его атрибуты не могут быть получены, возвращается NULL.                         */
+/* ----------------------------------------------------------------------------------------------- */
+ ak_uint8 *aktool_icode_get_unchanged( const char *value, aktool_ki_t *ki, ak_uint64 *attr )
+{
+    ak_keypair kp = NULL;
+   #ifdef AK_HAVE_SYSSTAT_H
+    struct stat st;
+   #endif
+
+    memset( attr, 0, aktool_icode_attributes_count*sizeof( ak_uint64 ));
+   #ifdef AK_HAVE_SYSSTAT_H
+    if( stat( value, &st ) != 0 ) return NULL;
+    if( st.st_ctime >= time( NULL )) return NULL;
+    attr[0] = (ak_uint64) st.st_size;
+    attr[1] = (ak_uint64) st.st_mtime;
+    attr[3] = (ak_uint64) st.st_ctime;
+   /* наносекундные составляющие времени (если система их предоставляет) */
+   #if defined( AK_HAVE_STAT_ST_MTIM )
+    attr[2] = (ak_uint64) st.st_mtim.tv_nsec;
+    attr[4] = (ak_uint64) st.st_ctim.tv_nsec;
+   #elif defined( AK_HAVE_STAT_ST_MTIMESPEC )
+    attr[2] = (ak_uint64) st.st_mtimespec.tv_nsec;
+    attr[4] = (ak_uint64) st.st_ctimespec.tv_nsec;
+   #endif
+    attr[5] = (ak_uint64) st.st_ino;
+   #else
+    return NULL;
+   #endif
+
+    if(( kp = ak_htable_get_keypair_str( &ki->attributes, value )) == NULL ) return NULL;
+    if( kp->value_length != aktool_icode_attributes_count*sizeof( ak_uint64 ) +ki->size )
+      return NULL;
+    if( memcmp( kp->data +kp->key_length,
+                                 attr, aktool_icode_attributes_count*sizeof( ak_uint64 )) != 0 )
+      return NULL;
+
+ return kp->data +kp->key_length +aktool_icode_attributes_count*sizeof( ak_uint64 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция сохраняет атрибуты файла и его контрольную сумму в таблице атрибутов.
+
+    @param value имя файла
+    @param ki контекст утилиты
+    @param attr атрибуты файла, полученные функцией aktool_icode_get_unchanged()
+    до вычисления контрольной суммы
+    @param icode контрольная сумма файла
+    @return В случае успеха возвращается ноль. В противном случае возвращается код ошибки.      */
+/* ----------------------------------------------------------------------------------------------- */
+ int aktool_icode_set_attributes( const char *value,
+                                              aktool_ki_t *ki, ak_uint64 *attr, ak_uint8 *icode )
+{
+    size_t i = 0;
+    ak_uint64 mask = 0;
+    ak_keypair kp = NULL;
+    ak_uint8 buffer[aktool_icode_attributes_count*sizeof( ak_uint64 ) +256];
+    const size_t asize = aktool_icode_attributes_count*sizeof( ak_uint64 );
+
+   /* атрибуты файла не были получены */
+    for( i = 0; i < aktool_icode_attributes_count; i++ ) mask |= attr[i];
+    if( mask == 0 ) return ak_error_ok;
+
+    memcpy( buffer, attr, asize );
+    memcpy( buffer +asize, icode, ki->size );
+
+   /* файл уже содержится в таблице: заменяем значение */
+    if((( kp = ak_htable_get_keypair_str( &ki->attributes, value )) != NULL ) &&
+                                                         ( kp->value_length == asize +ki->size )) {
+      memcpy( kp->data +kp->key_length, buffer, asize +ki->size );
+      return ak_error_ok;
+    }
+    if( kp != NULL ) ak_keypair_delete( ak_htable_exclude_keypair_str( &ki->attributes, value ));
+
+ return ak_htable_add_str_value( &ki->attributes, value, buffer, asize +ki->size );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                                                                   aktool_icode_export_import.c  */
 /* ----------------------------------------------------------------------------------------------- */
@@ -19,6 +19,37 @@ if( AK_HAVE_BUILTIN_MULQ_GCC )
     set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_BUILTIN_MULQ_GCC" )
 endif()
 
+# -------------------------------------------------------------------------------------------------- #
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  __extension__ typedef unsigned __int128 uint128;
+  int main( void ) {
+   uint128 a = 0x8000000000000000ULL, b = 3;
+   a *= b;
+   return ( int )( a >> 64 ) - 1;
+  }" AK_HAVE_BUILTIN_UINT128 )
+
+if( AK_HAVE_BUILTIN_UINT128 )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_BUILTIN_UINT128" )
+endif()
+
+# -------------------------------------------------------------------------------------------------- #
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  #include <emmintrin.h>
+  int main( void ) {
+
+   __m128i a = _mm_setzero_si128(), b = _mm_set1_epi32( 1 );
+   a = _mm_xor_si128( a, _mm_loadu_si128( &b ));
+   _mm_storeu_si128( &b, a );
+
+  return 0;
+ }" AK_HAVE_BUILTIN_XOR_SI128 )
+
+if( AK_HAVE_BUILTIN_XOR_SI128 )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_BUILTIN_XOR_SI128" )
+endif()
+
 # -------------------------------------------------------------------------------------------------- #
 # -------------------------------------------------------------------------------------------------- #
 check_c_source_compiles("
@@ -53,3 +84,35 @@ check_c_source_compiles("
 if( AK_HAVE_BUILTIN_MM256_SLL )
     set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_BUILTIN_MM256_SLL" )
 endif()
+
+# -------------------------------------------------------------------------------------------------- #
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  int main( void ) {
+   unsigned int flag = 0, expected = 0;
+   long counter = 2;
+
+   if( !__atomic_compare_exchange_n( &flag, &expected, 1, 0,
+                                              __ATOMIC_ACQUIRE, __ATOMIC_RELAXED )) return 1;
+   __atomic_store_n( &flag, 0, __ATOMIC_RELEASE );
+   counter = __atomic_sub_fetch( &counter, 1, __ATOMIC_RELAXED );
+   __atomic_add_fetch( &counter, 1, __ATOMIC_RELAXED );
+  return ( int )flag;
+ }" AK_HAVE_BUILTIN_ATOMIC )
+
+if( AK_HAVE_BUILTIN_ATOMIC )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_BUILTIN_ATOMIC" )
+endif()
+
+# -------------------------------------------------------------------------------------------------- #
+# -------------------------------------------------------------------------------------------------- #
+check_c_source_compiles("
+  static _Thread_local int value = 0;
+  int main( void ) {
+   value = 1;
+  return value - 1;
+ }" AK_HAVE_THREAD_LOCAL )
+
+if( AK_HAVE_THREAD_LOCAL )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_THREAD_LOCAL" )
+endif()
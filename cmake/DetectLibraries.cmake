@@ -94,7 +94,10 @@ else()
     endif()
 
   else()
+    find_library( LIBAKRYPT_PTHREAD pthread )
     if( LIBAKRYPT_PTHREAD )
+      message( STATUS "Searching pthread - done ")
+      set( LIBAKRYPT_LIBS ${LIBAKRYPT_LIBS} pthread )
       set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_PTHREAD_H" )
     endif()
   endif()
@@ -81,6 +81,34 @@ if( LIBAKRYPT_LIBS )
   message( STATUS "Additional libraries for aktool is ${LIBAKRYPT_LIBS}")
 endif()
 
+# -------------------------------------------------------------------------------------------------- #
+# наносекундные составляющие времени в struct stat (инкрементальный режим aktool icode):
+# st_mtim/st_ctim (POSIX.1-2008, Linux) или st_mtimespec/st_ctimespec (macOS, BSD);
+# если ни одно из полей не найдено, используются только st_mtime и st_ctime
+check_c_source_compiles("
+  #include <sys/stat.h>
+  int main( void ) {
+   struct stat st;
+   st.st_mtim.tv_nsec = st.st_ctim.tv_nsec = 0;
+  return ( int )st.st_mtim.tv_nsec;
+ }" AK_HAVE_STAT_ST_MTIM )
+
+if( AK_HAVE_STAT_ST_MTIM )
+  set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_STAT_ST_MTIM" )
+else()
+  check_c_source_compiles("
+    #include <sys/stat.h>
+    int main( void ) {
+     struct stat st;
+     st.st_mtimespec.tv_nsec = st.st_ctimespec.tv_nsec = 0;
+    return ( int )st.st_mtimespec.tv_nsec;
+   }" AK_HAVE_STAT_ST_MTIMESPEC )
+
+  if( AK_HAVE_STAT_ST_MTIMESPEC )
+    set( CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DAK_HAVE_STAT_ST_MTIMESPEC" )
+  endif()
+endif()
+
 add_executable( aktool ${AKTOOL_SOURCES} )
 target_include_directories( aktool PUBLIC "${CMAKE_CURRENT_SOURCE_DIR}/aktool" )
 
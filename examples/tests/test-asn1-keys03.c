@@ -0,0 +1,112 @@
+ #include <stdio.h>
+ #include <stdlib.h>
+ #include <string.h>
+ #include <libakrypt.h>
+
+/* --------------------------------------------------------------------------------------------- */
+/* пакетный импорт ключевых контейнеров, часть из которых зашифрована на разных паролях,
+   а один контейнер не зашифрован */
+ #define keys_count (5)
+
+/* --------------------------------------------------------------------------------------------- */
+/* определяем функцию, которая будет имитировать чтение пароля пользователя;
+   пароли запрашиваются в том же порядке, в котором перечислены зашифрованные контейнеры */
+ static int password_index = 0;
+ static const char *passwords[keys_count -1] = { "hello", "world", "libakrypt", "password" };
+
+ ssize_t get_user_password( const char *prompt, char *password, size_t psize, password_t flag )
+{
+   (void)prompt;
+   (void)flag;
+
+   memset( password, 0, psize );
+   ak_snprintf( password, psize, "%s", passwords[ password_index++ %( keys_count -1 )] );
+ return strlen( password );
+}
+
+/* --------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+   size_t i = 0;
+   struct random generator;
+   int exitstatus = EXIT_FAILURE;
+   struct bckey keys[keys_count], lkeys[keys_count];
+   ak_pointer ctx[keys_count];
+   char names[keys_count][32];
+   const char *filenames[keys_count];
+   ak_uint8 seed[8] = { 0xc6, 0x53, 0x24, 0xa2, 0x53, 0xa2, 0xc5, 0x21 };
+   ak_uint8 in[17] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+                 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11 };
+   ak_uint8 out[17], dec[17];
+
+  /* инициализируем библиотеку */
+   if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true ) return ak_libakrypt_destroy();
+   ak_libakrypt_set_password_read_function( get_user_password );
+
+  /* вырабатываем секретные ключи и сохраняем их в файлы */
+   ak_random_create_lcg( &generator );
+   ak_random_randomize( &generator, seed, 8 );
+   for( i = 0; i < keys_count; i++ ) {
+      ak_bckey_create_kuznechik( keys+i );
+      ak_bckey_set_key_random( keys+i, &generator );
+      ak_snprintf( names[i], sizeof( names[i] ), "delme03-%u.key", (unsigned int)i );
+      filenames[i] = names[i];
+      ctx[i] = lkeys+i;
+   }
+   ak_random_destroy( &generator );
+
+   for( i = 0; i < keys_count; i++ ) {
+      if( i < keys_count -1 ) {
+        if( ak_skey_export_to_file_with_password( keys+i, passwords[i],
+                        strlen( passwords[i] ), names[i], 0, asn1_der_format ) != ak_error_ok ) {
+          printf("file export: %s wrong\n", names[i] );
+          goto endl;
+        }
+      } else {
+          if( ak_skey_export_to_file_unencrypted( keys+i,
+                                                  names[i], 0, asn1_der_format ) != ak_error_ok ) {
+            printf("file export: %s wrong\n", names[i] );
+            goto endl;
+          }
+        }
+   }
+
+  /* импортируем все ключи одновременно */
+   if( ak_skey_import_from_files( ctx, block_cipher, filenames, keys_count, 4 ) != ak_error_ok ) {
+     printf("bulk import: wrong\n");
+     goto endl;
+   }
+   printf("bulk import: Ok (%u keys, %d passwords)\n", (unsigned int)keys_count, password_index );
+
+  /* сравниваем результаты зашифрования на исходных и импортированных ключах */
+   exitstatus = EXIT_SUCCESS;
+   for( i = 0; i < keys_count; i++ ) {
+      ak_bckey_ctr( keys+i, in, out, 17, seed, 8 );
+      ak_bckey_ctr( lkeys+i, out, dec, 17, seed, 8 );
+      if( ak_ptr_is_equal( in, dec, 17 )) printf("%s: decrypt Ok\n", names[i] );
+       else {
+         printf("%s: decrypt wrong\n", names[i] );
+         exitstatus = EXIT_FAILURE;
+       }
+      ak_bckey_destroy( lkeys+i );
+   }
+   if( password_index != keys_count -1 ) exitstatus = EXIT_FAILURE;
+
+  /* ошибка в одном из файлов приводит к ошибке импорта всех ключей */
+   filenames[1] = "delme03-missing.key";
+   if( ak_skey_import_from_files( ctx, block_cipher, filenames, keys_count, 4 ) == ak_error_ok ) {
+     printf("bulk import with missing file: wrong\n");
+     for( i = 0; i < keys_count; i++ ) ak_bckey_destroy( lkeys+i );
+     exitstatus = EXIT_FAILURE;
+   }
+    else printf("bulk import with missing file: Ok (rejected)\n");
+
+  endl:
+   for( i = 0; i < keys_count; i++ ) {
+      ak_bckey_destroy( keys+i );
+      remove( names[i] );
+   }
+   ak_error_set_value( ak_error_ok );
+   ak_libakrypt_destroy();
+  return exitstatus;
+}
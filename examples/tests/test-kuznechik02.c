@@ -0,0 +1,105 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  тест многоблочной реализации алгоритма Кузнечик:
+    результаты режимов простой замены и гаммирования сравниваются
+    с результатами последовательного зашифрования отдельных блоков                                 */
+ #include <stdio.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define blocks_count (67)
+
+/* ----------------------------------------------------------------------------------------------- */
+ int ecb_test( ak_bckey kc, ak_uint8 *in )
+{
+    size_t i, j;
+    ak_uint8 out[16*blocks_count], ref[16*blocks_count];
+
+   /* последовательно зашифровываем отдельные блоки */
+    for( i = 0; i < blocks_count; i++ ) kc->encrypt( &kc->key, in +16*i, ref +16*i );
+
+    for( j = 1; j <= blocks_count; j++ ) {
+       memset( out, 0, sizeof( out ));
+       ak_bckey_encrypt_ecb( kc, in, out, 16*j );
+       if( !ak_ptr_is_equal_with_log( out, ref, 16*j )) {
+         printf("ecb mode: wrong encryption of %u blocks\n", (unsigned int) j );
+         return EXIT_FAILURE;
+       }
+    }
+    printf("ecb mode: Ok\n");
+ return EXIT_SUCCESS;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int ctr_test( ak_bckey kc, ak_uint8 *in, size_t size )
+{
+    size_t i, j, tail = size%16;
+    ak_uint64 ctr[2];
+    ak_uint8 out[16*blocks_count], ref[16*blocks_count], yaout[16];
+    ak_uint8 iv[8] = { 0xf0, 0xce, 0xab, 0x90, 0x78, 0x56, 0x34, 0x12 };
+
+   /* вычисляем эталонное значение: счетчик занимает младшую половину блока */
+    ctr[0] = 0;
+    memcpy( ctr+1, iv, 8 );
+    for( i = 0; i < size/16; i++ ) {
+       kc->encrypt( &kc->key, ctr, yaout );
+       for( j = 0; j < 16; j++ ) ref[16*i+j] = in[16*i+j]^yaout[j];
+       ctr[0]++;
+    }
+    if( tail ) {
+      kc->encrypt( &kc->key, ctr, yaout );
+      for( i = 0; i < tail; i++ )
+         ref[size-tail+i] = in[size-tail+i]^yaout[16-tail+i];
+    }
+
+   /* зашифровываем данные за один вызов */
+    memset( out, 0, sizeof( out ));
+    ak_bckey_ctr( kc, in, out, size, iv, sizeof( iv ));
+    if( !ak_ptr_is_equal_with_log( out, ref, size )) {
+      printf("ctr mode: wrong encryption of %u octets\n", (unsigned int) size );
+      return EXIT_FAILURE;
+    }
+
+   /* зашифровываем данные фрагментами, длина которых кратна длине блока */
+    memset( out, 0, sizeof( out ));
+    ak_bckey_ctr( kc, in, out, 48, iv, sizeof( iv ));
+    ak_bckey_ctr( kc, in +48, out +48, 16*17, NULL, 0 );
+    ak_bckey_ctr( kc, in +16*20, out +16*20, size -16*20, NULL, 0 );
+    if( !ak_ptr_is_equal_with_log( out, ref, size )) {
+      printf("ctr mode: wrong fragmented encryption of %u octets\n", (unsigned int) size );
+      return EXIT_FAILURE;
+    }
+    printf("ctr mode (%u octets): Ok\n", (unsigned int) size );
+ return EXIT_SUCCESS;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+    size_t i;
+    struct bckey kc;
+    int result = EXIT_SUCCESS;
+    ak_uint8 in[16*blocks_count];
+
+   /* тестовый ключ из ГОСТ Р 34.13-2015, приложение А.1 */
+    ak_uint8 key[32] = {
+     0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0x10, 0x32, 0x54, 0x76, 0x98, 0xba, 0xdc, 0xfe,
+     0x77, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88
+    };
+
+   /* инициализируем библиотеку */
+    if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true ) return ak_libakrypt_destroy();
+
+    for( i = 0; i < sizeof( in ); i++ ) in[i] = (ak_uint8)( 7*i+1 );
+
+    ak_bckey_create_kuznechik( &kc );
+    ak_bckey_set_key( &kc, key, 32 );
+
+    if( ecb_test( &kc, in ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    if( ctr_test( &kc, in, sizeof( in )) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    if( ctr_test( &kc, in, sizeof( in ) -5 ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+
+    ak_bckey_destroy( &kc );
+    ak_libakrypt_destroy();
+
+ return result;
+}
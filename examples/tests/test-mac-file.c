@@ -0,0 +1,126 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  тест вычисления кодов целостности файлов:
+    результаты функций ak_hash_file_offset(), ak_hmac_file_offset() и ak_bckey_cmac_file_offset()
+    сравниваются с результатами обработки памяти при чтении файла буфферами различной длины,
+    а также при отображении файла в память                                                        */
+ #include <stdio.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define data_length (3*4096 +100)
+
+ static ak_uint8 data[data_length];
+ static const size_t lengths[] = { 0, 1, 63, 64, 65, 4095, 4096, 4097, 8192, 8193, 12288, 12289 };
+ static const size_t offsets[] = { 0, 5, 4099 };
+
+/* ----------------------------------------------------------------------------------------------- */
+ int file_test( const char *mode, struct hash *hctx, struct hmac *hmac, struct bckey *key )
+{
+    size_t i, j, len;
+    int result = EXIT_SUCCESS;
+    ak_uint8 out[32], outf[32];
+
+    for( i = 0; i < sizeof( offsets )/sizeof( size_t ); i++ ) {
+       for( j = 0; j < sizeof( lengths )/sizeof( size_t ); j++ ) {
+          len = ak_min( lengths[j], data_length - offsets[i] );
+
+          ak_hash_ptr( hctx, data +offsets[i], len, out, 32 );
+          ak_hash_file_offset( hctx, "hello.file", offsets[i], lengths[j], outf, 32 );
+          if( !ak_ptr_is_equal_with_log( out, outf, 32 )) {
+            printf("%s: hash (offset %u, length %u) Wrong\n",
+                                     mode, (unsigned int) offsets[i], (unsigned int) lengths[j] );
+            result = EXIT_FAILURE;
+          }
+
+          ak_hmac_ptr( hmac, data +offsets[i], len, out, 32 );
+          ak_hmac_file_offset( hmac, "hello.file", offsets[i], lengths[j], outf, 32 );
+          if( !ak_ptr_is_equal_with_log( out, outf, 32 )) {
+            printf("%s: hmac (offset %u, length %u) Wrong\n",
+                                     mode, (unsigned int) offsets[i], (unsigned int) lengths[j] );
+            result = EXIT_FAILURE;
+          }
+
+          ak_bckey_cmac( key, data +offsets[i], len, out, key->bsize );
+          ak_bckey_cmac_file_offset( key, "hello.file", offsets[i], lengths[j], outf, key->bsize );
+          if( !ak_ptr_is_equal_with_log( out, outf, key->bsize )) {
+            printf("%s: cmac (offset %u, length %u) Wrong\n",
+                                     mode, (unsigned int) offsets[i], (unsigned int) lengths[j] );
+            result = EXIT_FAILURE;
+          }
+       }
+    }
+
+   /* весь файл целиком */
+    ak_hash_ptr( hctx, data, data_length, out, 32 );
+    ak_hash_file( hctx, "hello.file", outf, 32 );
+    if( !ak_ptr_is_equal_with_log( out, outf, 32 )) {
+      printf("%s: hash of file Wrong\n", mode );
+      result = EXIT_FAILURE;
+    }
+    ak_bckey_cmac( key, data, data_length, out, key->bsize );
+    ak_bckey_cmac_file( key, "hello.file", outf, key->bsize );
+    if( !ak_ptr_is_equal_with_log( out, outf, key->bsize )) {
+      printf("%s: cmac of file Wrong\n", mode );
+      result = EXIT_FAILURE;
+    }
+
+    if( result == EXIT_SUCCESS ) printf("%s: Ok\n", mode );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+    size_t i;
+    struct file fs;
+    struct hash hctx;
+    struct hmac hmac;
+    struct bckey key;
+    ak_uint8 out[32];
+    int result = EXIT_SUCCESS;
+
+   /* инициализируем библиотеку */
+    if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true ) return ak_libakrypt_destroy();
+
+   /* создаем файл для экспериментов */
+    for( i = 0; i < sizeof( data ); i++ ) data[i] = (ak_uint8)( 7*i +1 );
+    ak_file_create_to_write( &fs, "hello.file" );
+    ak_file_write( &fs, data, sizeof( data ));
+    ak_file_close( &fs );
+
+    ak_hash_create_streebog256( &hctx );
+    ak_hmac_create_streebog256( &hmac );
+    ak_hmac_set_key_from_password( &hmac, "password", 8, "salt", 4 );
+    ak_bckey_create_kuznechik( &key );
+    ak_bckey_set_key_from_password( &key, "password", 8, "salt", 4 );
+
+   /* чтение буфферами минимальной длины */
+    ak_libakrypt_set_option( "file_mmap_threshold", 0 );
+    ak_libakrypt_set_option( "file_read_buffer_size", 4096 );
+    if( file_test( "read (4096 octets)", &hctx, &hmac, &key ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+
+   /* чтение буфферами большой длины */
+    ak_libakrypt_set_option( "file_read_buffer_size", 1048576 );
+    if( file_test( "read (1 MB)", &hctx, &hmac, &key ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+
+   /* отображение файла в память */
+    ak_libakrypt_set_option( "file_mmap_threshold", 1 );
+    if( file_test( "mmap", &hctx, &hmac, &key ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    ak_libakrypt_set_option( "file_mmap_threshold", 0 );
+
+   /* отрицательное смещение является ошибкой */
+    if(( ak_hash_file_offset( &hctx, "hello.file", -1, 10, out, 32 ) != ak_error_lseek_file ) ||
+       ( ak_bckey_cmac_file_offset( &key, "hello.file", -1, 10, out, key.bsize )
+                                                                      != ak_error_lseek_file )) {
+      printf("negative offset: Wrong\n");
+      result = EXIT_FAILURE;
+    }
+     else printf("negative offset: Ok\n");
+
+    ak_bckey_destroy( &key );
+    ak_hmac_destroy( &hmac );
+    ak_hash_destroy( &hctx );
+    ak_libakrypt_destroy();
+
+ return result;
+}
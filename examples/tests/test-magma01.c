@@ -0,0 +1,147 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  тест многоблочной реализации алгоритма Магма:
+    результаты режимов простой замены, гаммирования и ACPKM сравниваются
+    с результатами последовательного зашифрования отдельных блоков                                 */
+ #include <stdio.h>
+ #include <libakrypt.h>
+ #include <libakrypt-internal.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define blocks_count (133)
+
+/* ----------------------------------------------------------------------------------------------- */
+ int ecb_test( ak_bckey kc, ak_uint8 *in )
+{
+    size_t i, j;
+    ak_uint8 out[8*blocks_count], ref[8*blocks_count];
+
+   /* последовательно зашифровываем отдельные блоки */
+    for( i = 0; i < blocks_count; i++ ) kc->encrypt( &kc->key, in +8*i, ref +8*i );
+
+    for( j = 1; j <= blocks_count; j++ ) {
+       memset( out, 0, sizeof( out ));
+       ak_bckey_encrypt_ecb( kc, in, out, 8*j );
+       if( !ak_ptr_is_equal_with_log( out, ref, 8*j )) {
+         printf("ecb mode: wrong encryption of %u blocks\n", (unsigned int) j );
+         return EXIT_FAILURE;
+       }
+    }
+    printf("ecb mode: Ok\n");
+ return EXIT_SUCCESS;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int ctr_test( ak_bckey kc, ak_uint8 *in, size_t size )
+{
+    size_t i, j, tail = size%8;
+    ak_uint64 ctr;
+    ak_uint8 out[8*blocks_count], ref[8*blocks_count], yaout[8];
+    ak_uint8 iv[4] = { 0x78, 0x56, 0x34, 0x12 };
+
+   /* вычисляем эталонное значение: синхропосылка занимает старшую половину блока */
+    ctr = ((ak_uint64) 0x12345678 ) << 32;
+    for( i = 0; i < size/8; i++ ) {
+       kc->encrypt( &kc->key, &ctr, yaout );
+       for( j = 0; j < 8; j++ ) ref[8*i+j] = in[8*i+j]^yaout[j];
+       ctr++;
+    }
+    if( tail ) {
+      kc->encrypt( &kc->key, &ctr, yaout );
+      for( i = 0; i < tail; i++ )
+         ref[size-tail+i] = in[size-tail+i]^yaout[8-tail+i];
+    }
+
+   /* зашифровываем данные за один вызов */
+    memset( out, 0, sizeof( out ));
+    ak_bckey_ctr( kc, in, out, size, iv, sizeof( iv ));
+    if( !ak_ptr_is_equal_with_log( out, ref, size )) {
+      printf("ctr mode: wrong encryption of %u octets\n", (unsigned int) size );
+      return EXIT_FAILURE;
+    }
+
+   /* зашифровываем данные фрагментами, длина которых кратна длине блока */
+    memset( out, 0, sizeof( out ));
+    ak_bckey_ctr( kc, in, out, 24, iv, sizeof( iv ));
+    ak_bckey_ctr( kc, in +24, out +24, 8*37, NULL, 0 );
+    ak_bckey_ctr( kc, in +8*40, out +8*40, size -8*40, NULL, 0 );
+    if( !ak_ptr_is_equal_with_log( out, ref, size )) {
+      printf("ctr mode: wrong fragmented encryption of %u octets\n", (unsigned int) size );
+      return EXIT_FAILURE;
+    }
+    printf("ctr mode (%u octets): Ok\n", (unsigned int) size );
+ return EXIT_SUCCESS;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int acpkm_test( ak_uint8 *key, ak_uint8 *in, size_t size )
+{
+    struct bckey kc;
+    size_t i, j, tail = size%8;
+    ak_uint64 ctr = ((ak_uint64) 0x12345678 ) << 32;
+    ak_uint8 out[8*blocks_count], ref[8*blocks_count], yaout[8];
+    ak_uint8 iv[4] = { 0x78, 0x56, 0x34, 0x12 };
+    int result = EXIT_SUCCESS;
+
+   /* вычисляем эталонное значение: после каждой секции из 20 блоков ключ заменяется */
+    ak_bckey_create_magma( &kc );
+    ak_bckey_set_key( &kc, key, 32 );
+    for( i = 0; i < size/8; i++ ) {
+       kc.encrypt( &kc.key, &ctr, yaout );
+       for( j = 0; j < 8; j++ ) ref[8*i+j] = in[8*i+j]^yaout[j];
+       ctr++;
+       if(( i+1 )%20 == 0 ) ak_bckey_next_acpkm_key( &kc );
+    }
+    if( tail ) {
+      kc.encrypt( &kc.key, &ctr, yaout );
+      for( i = 0; i < tail; i++ )
+         ref[size-tail+i] = in[size-tail+i]^yaout[8-tail+i];
+    }
+    ak_bckey_destroy( &kc );
+
+    ak_bckey_create_magma( &kc );
+    ak_bckey_set_key( &kc, key, 32 );
+    memset( out, 0, sizeof( out ));
+    ak_bckey_ctr_acpkm( &kc, in, out, size, 8*20, iv, sizeof( iv ));
+    ak_bckey_destroy( &kc );
+
+    if( !ak_ptr_is_equal_with_log( out, ref, size )) {
+      printf("acpkm mode: wrong encryption of %u octets\n", (unsigned int) size );
+      result = EXIT_FAILURE;
+    } else printf("acpkm mode (%u octets): Ok\n", (unsigned int) size );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+    size_t i;
+    struct bckey kc;
+    int result = EXIT_SUCCESS;
+    ak_uint8 in[8*blocks_count];
+
+   /* тестовый ключ из ГОСТ Р 34.13-2015, приложение А.2 */
+    ak_uint8 key[32] = {
+     0xff, 0xfe, 0xfd, 0xfc, 0xfb, 0xfa, 0xf9, 0xf8, 0xf7, 0xf6, 0xf5, 0xf4, 0xf3, 0xf2, 0xf1, 0xf0,
+     0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+    };
+
+   /* инициализируем библиотеку */
+    if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true ) return ak_libakrypt_destroy();
+
+    for( i = 0; i < sizeof( in ); i++ ) in[i] = (ak_uint8)( 7*i+1 );
+
+    ak_bckey_create_magma( &kc );
+    ak_bckey_set_key( &kc, key, 32 );
+
+    if( ecb_test( &kc, in ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    if( ctr_test( &kc, in, sizeof( in )) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    if( ctr_test( &kc, in, sizeof( in ) -3 ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    ak_bckey_destroy( &kc );
+
+    if( acpkm_test( key, in, sizeof( in )) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    if( acpkm_test( key, in, sizeof( in ) -5 ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+
+    ak_libakrypt_destroy();
+
+ return result;
+}
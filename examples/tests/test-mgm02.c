@@ -0,0 +1,97 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  тест конвейерной реализации режима MGM для алгоритма Кузнечик:
+    результаты зашифрования с использованием многоблочной функции encrypt_blocks (для одного и
+    двух различных ключей) сравниваются с результатами поблочной обработки данных,
+    а также проверяется расшифрование с проверкой имитовставки                                    */
+ #include <time.h>
+ #include <stdio.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define data_length (1031)
+
+ static const size_t plain_lengths[] = { 0, 16, 100, 128, 129, 255, 256, 1031 };
+ static const size_t adata_lengths[] = { 0, 15, 16, 200 };
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+    size_t i, j;
+    clock_t tp, tb;
+    struct bckey key, akey, ref;
+    int result = EXIT_SUCCESS;
+    ak_uint8 data[data_length], out[data_length], outr[data_length], icode[16], icoder[16],
+             iv[16] = { 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x77, 0x66, 0x55 },
+             keyval[32] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0x10, 0x32, 0x54, 0x76 },
+             *buffer = NULL;
+
+   /* инициализируем библиотеку */
+    if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true ) return ak_libakrypt_destroy();
+    for( i = 0; i < sizeof( data ); i++ ) data[i] = (ak_uint8)( 3*i+1 );
+
+   /* ключ ref использует только поблочное зашифрование */
+    ak_bckey_create_kuznechik( &key );
+    ak_bckey_set_key( &key, keyval, sizeof( keyval ));
+    ak_bckey_create_kuznechik( &akey );
+    ak_bckey_set_key( &akey, keyval, sizeof( keyval ));
+    ak_bckey_create_kuznechik( &ref );
+    ak_bckey_set_key( &ref, keyval, sizeof( keyval ));
+    ref.encrypt_blocks = NULL;
+
+    for( i = 0; i < sizeof( adata_lengths )/sizeof( size_t ); i++ ) {
+       for( j = 0; j < sizeof( plain_lengths )/sizeof( size_t ); j++ ) {
+          ak_bckey_encrypt_mgm( &ref, &ref, data, adata_lengths[i], data, outr,
+                                              plain_lengths[j], iv, sizeof( iv ), icoder, 16 );
+         /* один ключ для шифрования и имитозащиты */
+          memset( out, 0, sizeof( out )); memset( icode, 0, 16 );
+          ak_bckey_encrypt_mgm( &key, &key, data, adata_lengths[i], data, out,
+                                              plain_lengths[j], iv, sizeof( iv ), icode, 16 );
+          if( !ak_ptr_is_equal_with_log( out, outr, plain_lengths[j] ) ||
+              !ak_ptr_is_equal_with_log( icode, icoder, 16 )) {
+            printf("mgm (one key): wrong encryption for adata %u and data %u octets\n",
+                                 (unsigned int) adata_lengths[i], (unsigned int) plain_lengths[j] );
+            result = EXIT_FAILURE;
+          }
+         /* два различных контекста ключей */
+          memset( out, 0, sizeof( out )); memset( icode, 0, 16 );
+          ak_bckey_encrypt_mgm( &key, &akey, data, adata_lengths[i], data, out,
+                                              plain_lengths[j], iv, sizeof( iv ), icode, 16 );
+          if( !ak_ptr_is_equal_with_log( out, outr, plain_lengths[j] ) ||
+              !ak_ptr_is_equal_with_log( icode, icoder, 16 )) {
+            printf("mgm (two keys): wrong encryption for adata %u and data %u octets\n",
+                                 (unsigned int) adata_lengths[i], (unsigned int) plain_lengths[j] );
+            result = EXIT_FAILURE;
+          }
+         /* расшифрование на месте */
+          if(( ak_bckey_decrypt_mgm( &key, &key, data, adata_lengths[i], out, out,
+                               plain_lengths[j], iv, sizeof( iv ), icoder, 16 ) != ak_error_ok ) ||
+             ( !ak_ptr_is_equal_with_log( out, data, plain_lengths[j] ))) {
+            printf("mgm: wrong decryption for adata %u and data %u octets\n",
+                                 (unsigned int) adata_lengths[i], (unsigned int) plain_lengths[j] );
+            result = EXIT_FAILURE;
+          }
+       }
+    }
+    if( result == EXIT_SUCCESS ) printf("mgm (kuznechik): Ok\n");
+
+   /* сравниваем скорость обработки одного мегабайта */
+    if(( buffer = malloc( 1048576 )) != NULL ) {
+      memset( buffer, 0x11, 1048576 );
+      tb = clock();
+      ak_bckey_encrypt_mgm( &ref, &ref, NULL, 0, buffer, buffer, 1048576, iv, 16, icoder, 16 );
+      tb = clock() - tb;
+      tp = clock();
+      ak_bckey_encrypt_mgm( &key, &key, NULL, 0, buffer, buffer, 1048576, iv, 16, icode, 16 );
+      tp = clock() - tp;
+      printf("mgm (1 MB): per block %.3f sec, pipelined %.3f sec\n",
+                                   (double)tb/CLOCKS_PER_SEC, (double)tp/CLOCKS_PER_SEC );
+      free( buffer );
+    }
+
+    ak_bckey_destroy( &ref );
+    ak_bckey_destroy( &akey );
+    ak_bckey_destroy( &key );
+    ak_libakrypt_destroy();
+
+ return result;
+}
@@ -0,0 +1,149 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  тест многоблочного расшифрования в режимах простой замены, простой замены с зацеплением
+    и гаммирования с обратной связью по шифртексту:
+    результаты функций, использующих многоблочные функции decrypt_blocks и encrypt_blocks
+    (в том числе в нескольких потоках и при расшифровании на месте), сравниваются с
+    результатами поблочной обработки данных для алгоритмов Магма и Кузнечик                       */
+ #include <time.h>
+ #include <stdio.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define data_length (4*4096*16 +1024)
+
+ static const size_t lengths[] = { 0, 16, 64, 96, 160, 1024, 4096, 65536, data_length };
+ static const size_t iv_lengths[] = { 16, 32, 48 };
+
+/* ----------------------------------------------------------------------------------------------- */
+ int modes_test( ak_bckey key, ak_bckey ref, ak_uint8 *data, ak_uint8 *ct, ak_uint8 *out )
+{
+    clock_t ts, tp;
+    size_t i, j, threads;
+    int result = EXIT_SUCCESS;
+    ak_uint8 iv[48] = { 0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xcd, 0xef, 0x23, 0x45, 0x67, 0x89,
+                        0x0a, 0xbc, 0xde, 0xf1, 0x34, 0x56, 0x78, 0x90, 0xab, 0xcd, 0xef, 0x12 };
+
+   /* режим простой замены */
+    ak_bckey_encrypt_ecb( ref, data, ct, 1024 );
+    ak_bckey_decrypt_ecb( key, ct, out, 1024 );
+    if( !ak_ptr_is_equal_with_log( out, data, 1024 )) {
+      printf("%s: wrong ecb decryption\n", key->key.oid->name[0] );
+      result = EXIT_FAILURE;
+    }
+
+    for( i = 0; i < sizeof( iv_lengths )/sizeof( size_t ); i++ ) {
+       for( j = 0; j < sizeof( lengths )/sizeof( size_t ); j++ ) {
+         /* шифртекст вырабатывается поблочной реализацией */
+          ak_bckey_encrypt_cbc( ref, data, ct, lengths[j], iv, iv_lengths[i] );
+          for( threads = 1; threads < 5; threads += 3 ) {
+             memcpy( out, ct, lengths[j] );
+             if(( ak_bckey_decrypt_cbc_threads( key, out, out, lengths[j],
+                                                 iv, iv_lengths[i], threads ) != ak_error_ok ) ||
+                ( !ak_ptr_is_equal_with_log( out, data, lengths[j] ))) {
+               printf("%s: wrong cbc decryption (iv %u, data %u octets, %u threads)\n",
+                           key->key.oid->name[0], (unsigned int) iv_lengths[i],
+                                            (unsigned int) lengths[j], (unsigned int) threads );
+               result = EXIT_FAILURE;
+             }
+          }
+
+         /* в режиме cfb длина данных не обязана быть кратной длине блока */
+          ak_bckey_encrypt_cfb( ref, data, ct, lengths[j] +j, iv, iv_lengths[i] );
+          for( threads = 1; threads < 5; threads += 3 ) {
+             memcpy( out, ct, lengths[j] +j );
+             if(( ak_bckey_decrypt_cfb_threads( key, out, out, lengths[j] +j,
+                                                 iv, iv_lengths[i], threads ) != ak_error_ok ) ||
+                ( !ak_ptr_is_equal_with_log( out, data, lengths[j] +j ))) {
+               printf("%s: wrong cfb decryption (iv %u, data %u octets, %u threads)\n",
+                           key->key.oid->name[0], (unsigned int) iv_lengths[i],
+                                         (unsigned int) ( lengths[j] +j ), (unsigned int) threads );
+               result = EXIT_FAILURE;
+             }
+          }
+       }
+    }
+
+   /* внутреннее состояние синхропосылки после обработки данных, кратных длине блока */
+    ak_bckey_encrypt_cfb( ref, data, ct, 19*key->bsize, iv, 32 );
+    ak_bckey_decrypt_cfb( ref, ct, out, 19*key->bsize, iv, 32 );
+    ak_bckey_decrypt_cfb( key, ct, out, 19*key->bsize, iv, 32 );
+    if( !ak_ptr_is_equal_with_log( ref->ivector, key->ivector, 32 )) {
+      printf("%s: wrong state of cfb initial vector\n", key->key.oid->name[0] );
+      result = EXIT_FAILURE;
+    }
+
+   /* сравниваем скорость расшифрования */
+    ak_bckey_encrypt_cbc( ref, data, ct, data_length, iv, 16 );
+    ts = clock();
+    ak_bckey_decrypt_cbc( ref, ct, out, data_length, iv, 16 );
+    ts = clock() - ts;
+    tp = clock();
+    ak_bckey_decrypt_cbc( key, ct, out, data_length, iv, 16 );
+    tp = clock() - tp;
+
+    if( result == EXIT_SUCCESS )
+      printf("%s: Ok (cbc decryption of %u octets: per block %.3f sec, multiblock %.3f sec)\n",
+                 key->key.oid->name[0], (unsigned int) data_length,
+                                            (double)ts/CLOCKS_PER_SEC, (double)tp/CLOCKS_PER_SEC );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+    size_t i;
+    struct bckey key, ref;
+    int result = EXIT_SUCCESS;
+    ak_uint8 *data = NULL, *ct = NULL, *out = NULL,
+             keyval[32] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0x10, 0x32, 0x54, 0x76 };
+
+   /* инициализируем библиотеку */
+    if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true ) return ak_libakrypt_destroy();
+    if((( data = malloc( data_length +64 )) == NULL ) ||
+       (( ct = malloc( data_length +64 )) == NULL ) ||
+       (( out = malloc( data_length +64 )) == NULL )) {
+      result = EXIT_FAILURE;
+      goto labex;
+    }
+    for( i = 0; i < data_length +64; i++ ) data[i] = (ak_uint8)( 5*i+7 );
+
+   /* ключ ref использует только поблочное шифрование */
+    ak_bckey_create_magma( &key );
+    ak_bckey_set_key( &key, keyval, sizeof( keyval ));
+    ak_bckey_create_magma( &ref );
+    ak_bckey_set_key( &ref, keyval, sizeof( keyval ));
+    ref.encrypt_blocks = ref.decrypt_blocks = NULL;
+    if( modes_test( &key, &ref, data, ct, out ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    ak_bckey_destroy( &ref );
+    ak_bckey_destroy( &key );
+
+   /* в режиме совместимости с openssl значение ключа Магма хранится в развернутом виде,
+      поэтому проверяем, что копии ключа, используемые потоками, совпадают с исходным ключом */
+    ak_libakrypt_set_openssl_compability( ak_true );
+    ak_bckey_create_magma( &key );
+    ak_bckey_set_key( &key, keyval, sizeof( keyval ));
+    ak_bckey_create_magma( &ref );
+    ak_bckey_set_key( &ref, keyval, sizeof( keyval ));
+    ref.encrypt_blocks = ref.decrypt_blocks = NULL;
+    if( modes_test( &key, &ref, data, ct, out ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    ak_bckey_destroy( &ref );
+    ak_bckey_destroy( &key );
+    ak_libakrypt_set_openssl_compability( ak_false );
+
+    ak_bckey_create_kuznechik( &key );
+    ak_bckey_set_key( &key, keyval, sizeof( keyval ));
+    ak_bckey_create_kuznechik( &ref );
+    ak_bckey_set_key( &ref, keyval, sizeof( keyval ));
+    ref.encrypt_blocks = ref.decrypt_blocks = NULL;
+    if( modes_test( &key, &ref, data, ct, out ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    ak_bckey_destroy( &ref );
+    ak_bckey_destroy( &key );
+
+  labex:
+    if( out ) free( out );
+    if( ct ) free( ct );
+    if( data ) free( data );
+    ak_libakrypt_destroy();
+
+ return result;
+}
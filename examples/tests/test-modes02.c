@@ -0,0 +1,130 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  тест многопоточного шифрования в режимах гаммирования и CTR-ACPKM:
+    результаты функций ak_bckey_ctr_threads() и ak_bckey_ctr_acpkm_threads() сравниваются
+    с результатами последовательной поблочной обработки данных для алгоритмов Магма и Кузнечик,
+    в том числе при продолжении шифрования с внутренним значением счетчика                         */
+ #include <time.h>
+ #include <stdio.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define data_length (4*4096*16 +1000)
+
+ static const size_t lengths[] = { 0, 15, 64, 1031, 65536, 4*4096*8 +13, data_length };
+
+/* ----------------------------------------------------------------------------------------------- */
+ int modes_test( ak_bckey key, ak_bckey ref, ak_uint8 *data, ak_uint8 *out, ak_uint8 *outr )
+{
+    clock_t ts, tp;
+    size_t i, threads, section;
+    int result = EXIT_SUCCESS;
+    ak_uint8 iv[8] = { 0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xcd, 0xef };
+
+    for( i = 0; i < sizeof( lengths )/sizeof( size_t ); i++ ) {
+      /* режим гаммирования: два последовательных вызова с продолжением счетчика */
+       ak_bckey_ctr( ref, data, outr, 4096*key->bsize, iv, sizeof( iv ));
+       ak_bckey_ctr( ref, data +4096*key->bsize, outr +4096*key->bsize, lengths[i], NULL, 0 );
+       for( threads = 1; threads < 5; threads += 3 ) {
+          memset( out, 0, 4096*key->bsize +lengths[i] );
+          if(( ak_bckey_ctr_threads( key, data, out, 4096*key->bsize,
+                                                  iv, sizeof( iv ), threads ) != ak_error_ok ) ||
+             ( ak_bckey_ctr_threads( key, data +4096*key->bsize, out +4096*key->bsize,
+                                                  lengths[i], NULL, 0, threads ) != ak_error_ok ) ||
+             ( !ak_ptr_is_equal_with_log( out, outr, 4096*key->bsize +lengths[i] ))) {
+            printf("%s: wrong ctr encryption (data %u octets, %u threads)\n",
+                     key->key.oid->name[0], (unsigned int) lengths[i], (unsigned int) threads );
+            result = EXIT_FAILURE;
+          }
+       }
+
+      /* режим ACPKM для различных длин секций */
+       for( section = 16*key->bsize; section <= 128*key->bsize; section *= 8 ) {
+          ak_bckey_ctr_acpkm( ref, data, outr, lengths[i], section, iv, sizeof( iv ));
+          for( threads = 1; threads < 5; threads += 3 ) {
+             memcpy( out, data, lengths[i] );
+             if(( ak_bckey_ctr_acpkm_threads( key, out, out, lengths[i], section,
+                                                   iv, sizeof( iv ), threads ) != ak_error_ok ) ||
+                ( !ak_ptr_is_equal_with_log( out, outr, lengths[i] ))) {
+               printf("%s: wrong acpkm encryption (section %u, data %u octets, %u threads)\n",
+                          key->key.oid->name[0], (unsigned int) section,
+                                            (unsigned int) lengths[i], (unsigned int) threads );
+               result = EXIT_FAILURE;
+             }
+          }
+       }
+    }
+
+   /* сравниваем скорость шифрования */
+    ts = clock();
+    ak_bckey_ctr_acpkm( key, data, out, data_length, 128*key->bsize, iv, sizeof( iv ));
+    ts = clock() - ts;
+    tp = clock();
+    ak_bckey_ctr_acpkm_threads( key, data, out, data_length, 128*key->bsize, iv, sizeof( iv ), 4 );
+    tp = clock() - tp;
+
+    if( result == EXIT_SUCCESS )
+      printf("%s: Ok (acpkm encryption of %u octets: serial %.3f sec, 4 threads %.3f sec cpu time)\n",
+                 key->key.oid->name[0], (unsigned int) data_length,
+                                            (double)ts/CLOCKS_PER_SEC, (double)tp/CLOCKS_PER_SEC );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+    size_t i;
+    struct bckey key, ref;
+    int result = EXIT_SUCCESS;
+    ak_uint8 *data = NULL, *out = NULL, *outr = NULL,
+             keyval[32] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0x10, 0x32, 0x54, 0x76 };
+
+   /* инициализируем библиотеку */
+    if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true ) return ak_libakrypt_destroy();
+    if((( data = malloc( 2*data_length )) == NULL ) ||
+       (( out = malloc( 2*data_length )) == NULL ) ||
+       (( outr = malloc( 2*data_length )) == NULL )) {
+      result = EXIT_FAILURE;
+      goto labex;
+    }
+    for( i = 0; i < 2*data_length; i++ ) data[i] = (ak_uint8)( 3*i+5 );
+
+   /* ключ ref использует только поблочное шифрование */
+    ak_bckey_create_magma( &key );
+    ak_bckey_set_key( &key, keyval, sizeof( keyval ));
+    ak_bckey_create_magma( &ref );
+    ak_bckey_set_key( &ref, keyval, sizeof( keyval ));
+    ref.encrypt_blocks = NULL;
+    if( modes_test( &key, &ref, data, out, outr ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    ak_bckey_destroy( &ref );
+    ak_bckey_destroy( &key );
+
+   /* в режиме совместимости с openssl значение ключа Магма хранится в развернутом виде;
+      копии ключа, используемые потоками, должны совпадать с исходным ключом */
+    ak_libakrypt_set_openssl_compability( ak_true );
+    ak_bckey_create_magma( &key );
+    ak_bckey_set_key( &key, keyval, sizeof( keyval ));
+    ak_bckey_create_magma( &ref );
+    ak_bckey_set_key( &ref, keyval, sizeof( keyval ));
+    ref.encrypt_blocks = NULL;
+    if( modes_test( &key, &ref, data, out, outr ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    ak_bckey_destroy( &ref );
+    ak_bckey_destroy( &key );
+    ak_libakrypt_set_openssl_compability( ak_false );
+
+    ak_bckey_create_kuznechik( &key );
+    ak_bckey_set_key( &key, keyval, sizeof( keyval ));
+    ak_bckey_create_kuznechik( &ref );
+    ak_bckey_set_key( &ref, keyval, sizeof( keyval ));
+    ref.encrypt_blocks = NULL;
+    if( modes_test( &key, &ref, data, out, outr ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    ak_bckey_destroy( &ref );
+    ak_bckey_destroy( &key );
+
+  labex:
+    if( outr ) free( outr );
+    if( out ) free( out );
+    if( data ) free( data );
+    ak_libakrypt_destroy();
+
+ return result;
+}
@@ -0,0 +1,90 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  тест обращения вычетов:
+    результаты функций ak_mpzn_inverse() и ak_mpzn_inverse_montgomery() сравниваются
+    с возведением в степень p-2 для модулей p и порядков q всех эллиптических кривых               */
+ #include <time.h>
+ #include <stdio.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define values_count (512)
+
+/* ----------------------------------------------------------------------------------------------- */
+ int inverse_test( const char *name, ak_uint64 *p, ak_uint64 n0, const size_t size,
+                                                                           ak_random generator )
+{
+    size_t i;
+    clock_t tp, ti;
+    ak_mpznmax x, z, w, t, e, one = ak_mpznmax_one;
+    int result = EXIT_SUCCESS;
+
+    tp = ti = 0;
+    ak_mpzn_mul_montgomery( e, one, one, p, n0, size );
+    ak_mpzn_set_ui( t, size, 2 );
+    ak_mpzn_sub( t, p, t, size );
+    for( i = 0; i < values_count; i++ ) {
+      /* граничные значения: 0, 1, 2, p-1 */
+       switch( i ) {
+         case 0:  ak_mpzn_set_ui( x, size, 0 ); break;
+         case 1:  ak_mpzn_set_ui( x, size, 1 ); break;
+         case 2:  ak_mpzn_set_ui( x, size, 2 ); break;
+         case 3:  ak_mpzn_set_ui( x, size, 1 ); ak_mpzn_sub( x, p, x, size ); break;
+         default: ak_mpzn_set_random_modulo( x, p, size, generator ); break;
+       }
+
+      /* обращение в представлении Монтгомери */
+       tp -= clock();
+       ak_mpzn_modpow_montgomery( w, x, t, p, n0, size );
+       tp += clock();
+       ti -= clock();
+       ak_mpzn_inverse_montgomery( z, x, p, n0, size );
+       ti += clock();
+       if( ak_mpzn_cmp( z, w, size ) != 0 ) {
+         printf("%s: wrong montgomery inverse for x = %s\n", name, ak_mpzn_to_hexstr( x, size ));
+         result = EXIT_FAILURE;
+       }
+
+      /* обращение в естественном представлении: x*z*r^{-1} = r^{-1} (mod p) */
+       ak_mpzn_inverse( z, x, p, size );
+       ak_mpzn_mul_montgomery( w, x, z, p, n0, size );
+       if( ak_mpzn_cmp( w, e, size ) != 0 ) {
+         if(( i > 0 ) || ( !ak_mpzn_cmp_ui( z, size, 0 ))) {
+           printf("%s: wrong inverse for x = %s\n", name, ak_mpzn_to_hexstr( x, size ));
+           result = EXIT_FAILURE;
+         }
+       }
+    }
+
+    printf("%s: %s (modpow: %.3f us, safegcd: %.3f us per inverse)\n",
+                                                  name, result == EXIT_SUCCESS ? "Ok" : "Wrong",
+                                      1000000.*(double)tp/( CLOCKS_PER_SEC*(double)values_count ),
+                                      1000000.*(double)ti/( CLOCKS_PER_SEC*(double)values_count ));
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+    ak_oid oid = NULL;
+    ak_wcurve wc = NULL;
+    struct random generator;
+    int result = EXIT_SUCCESS;
+
+   /* инициализируем библиотеку */
+    if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true ) return ak_libakrypt_destroy();
+    ak_random_create_lcg( &generator );
+
+    oid = ak_oid_find_by_mode( wcurve_params );
+    do {
+         wc = ( ak_wcurve ) oid->data;
+         if( inverse_test( oid->name[0], wc->p, wc->n, wc->size, &generator ) != EXIT_SUCCESS )
+           result = EXIT_FAILURE;
+         if( inverse_test( oid->name[0], wc->q, wc->nq, wc->size, &generator ) != EXIT_SUCCESS )
+           result = EXIT_FAILURE;
+    } while(( oid = ak_oid_findnext_by_mode( oid, wcurve_params )) != NULL );
+
+    ak_random_destroy( &generator );
+    ak_libakrypt_destroy();
+
+ return result;
+}
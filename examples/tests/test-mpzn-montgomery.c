@@ -79,7 +79,7 @@
 /* тест для операции умножения вычетов в представлении монтгомери */
  bool_t mul_montgomery_test( size_t size, const char *prime, ak_uint64 n0, size_t count )
 {
-  size_t i = 0, errors_gmp = 0, val = 0;
+  size_t i = 0, errors_gmp = 0, val = 0, sqr_val = 0;
   mpz_t xm, ym, zm, tm, pm, rm, gm, sm, um, nm;
   ak_mpznmax x, y, n, p, z;
   struct random generator;
@@ -136,6 +136,20 @@
   }
   printf(" correct montgomery multiplications %ld from %ld with %ld gmp errors\n", val, count, errors_gmp );
 
+  sqr_val=0;
+ // цикл проверок возведения в квадрат
+  for( i = 0; i < count; i++ ) {
+     ak_mpzn_set_random_modulo( x, p, size, &generator );
+     ak_mpzn_to_mpz( x, size, xm );
+
+     // тестовый пример для возведения в квадрат: результат x*x*r^{-1}
+     mpz_mul( zm, xm, xm ); mpz_mul( zm, zm, sm ); mpz_mod( zm, zm, pm );
+     ak_mpzn_sqr_montgomery( z, x, p, n0, size );
+     ak_mpzn_to_mpz( z, size, um );
+     if( mpz_cmp( um, zm ) == 0 ) sqr_val++;
+  }
+  printf(" correct montgomery squarings %ld from %ld\n", sqr_val, count );
+
   val=0;
  // дополнительный цикл проверок
   for( i = 0; i < count; i++ ) {
@@ -221,7 +235,7 @@
   mpz_clear(ym);
   mpz_clear(xm);
 
- return ( val == count );
+ return ( val == count ) && ( sqr_val == count );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -0,0 +1,61 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  тест доступа к опциям библиотеки по индексу:
+    значения, получаемые по имени и по индексу опции, должны совпадать, а ключ блочного шифра
+    должен сохранять значения опций, действовавшие в момент присвоения ему значения               */
+ #include <stdio.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+    size_t i;
+    struct bckey kc;
+    ak_uint8 keyval[32] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef };
+    int result = EXIT_SUCCESS;
+
+   /* инициализируем библиотеку */
+    if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true ) return ak_libakrypt_destroy();
+
+   /* проверяем согласованность перечисления и таблицы опций */
+    if( ak_libakrypt_options_count() != ak_option_count ) {
+      printf("wrong number of options: %u\n", (unsigned int) ak_libakrypt_options_count( ));
+      result = EXIT_FAILURE;
+    }
+    for( i = 0; i < ak_libakrypt_options_count(); i++ ) {
+       if( ak_libakrypt_get_option_by_name( ak_libakrypt_get_option_name( i )) !=
+                                                          ak_libakrypt_get_option_by_index( i )) {
+         printf("wrong value of option %s\n", ak_libakrypt_get_option_name( i ));
+         result = EXIT_FAILURE;
+       }
+    }
+    if( ak_libakrypt_get_option_by_index( ak_option_count ) != ak_error_wrong_option ) {
+      printf("access to undefined option\n");
+      result = EXIT_FAILURE;
+    }
+
+   /* ключ сохраняет значения опций, действовавшие в момент присвоения ему значения */
+    ak_bckey_create_kuznechik( &kc );
+    ak_libakrypt_set_option( "acpkm_section_kuznechik_block_count", 1024 );
+    ak_bckey_set_key( &kc, keyval, sizeof( keyval ));
+    ak_libakrypt_set_option( "acpkm_section_kuznechik_block_count", 512 );
+    if(( kc.options.acpkm_section_block_count != 1024 ) ||
+       ( kc.options.cipher_resource !=
+                        ak_libakrypt_get_option_by_index( ak_option_kuznechik_cipher_resource )) ||
+       ( kc.options.openssl_compability !=
+                             ak_libakrypt_get_option_by_index( ak_option_openssl_compability ))) {
+      printf("wrong values of options stored in block cipher key\n");
+      result = EXIT_FAILURE;
+    }
+   /* повторное присвоение значения обновляет опции */
+    ak_bckey_set_key( &kc, keyval, sizeof( keyval ));
+    if( kc.options.acpkm_section_block_count != 512 ) {
+      printf("options stored in block cipher key are not refreshed\n");
+      result = EXIT_FAILURE;
+    }
+    ak_bckey_destroy( &kc );
+
+    if( result == EXIT_SUCCESS ) printf("options access: Ok\n");
+    ak_libakrypt_destroy();
+
+ return result;
+}
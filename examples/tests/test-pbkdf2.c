@@ -0,0 +1,99 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  тест выработки ключевых векторов из паролей:
+    проверяется выработка вектора длины более 64-х октетов (Р 50.1.111-2016) и соглашение
+    о длинах векторов, а также совпадение результатов пакетной и последовательной обработки        */
+ #include <stdio.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define tasks_count (9)
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+    size_t i, j;
+    int result = EXIT_SUCCESS;
+    char passwords[tasks_count][16];
+    ak_uint8 out[100], ref[tasks_count][72], res[tasks_count][72];
+    struct pbkdf2_task tasks[tasks_count];
+    ak_uint8 salt[36] = "saltSALTsaltSALTsaltSALTsaltSALTsalt";
+
+   /* контрольное значение из Р 50.1.111-2016 (dkLen = 100) */
+    ak_uint8 R5[100] = {
+     0xb2, 0xd8, 0xf1, 0x24, 0x5f, 0xc4, 0xd2, 0x92, 0x74, 0x80, 0x20, 0x57, 0xe4, 0xb5, 0x4e, 0x0a,
+     0x07, 0x53, 0xaa, 0x22, 0xfc, 0x53, 0x76, 0x0b, 0x30, 0x1c, 0xf0, 0x08, 0x67, 0x9e, 0x58, 0xfe,
+     0x4b, 0xee, 0x9a, 0xdd, 0xca, 0xe9, 0x9b, 0xa2, 0xb0, 0xb2, 0x0f, 0x43, 0x1a, 0x9c, 0x5e, 0x50,
+     0xf3, 0x95, 0xc8, 0x93, 0x87, 0xd0, 0x94, 0x5a, 0xed, 0xec, 0xa6, 0xeb, 0x40, 0x15, 0xdf, 0xc2,
+     0xbd, 0x24, 0x21, 0xee, 0x9b, 0xb7, 0x11, 0x83, 0xba, 0x88, 0x2c, 0xee, 0xbf, 0xef, 0x25, 0x9f,
+     0x33, 0xf9, 0xe2, 0x7d, 0xc6, 0x17, 0x8c, 0xb8, 0x9d, 0xc3, 0x74, 0x28, 0xcf, 0x9c, 0xc5, 0x2a,
+     0x2b, 0xaa, 0x2d, 0x3a
+    };
+
+   /* инициализируем библиотеку */
+    if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true ) return ak_libakrypt_destroy();
+
+    ak_hmac_pbkdf2_streebog512( "passwordPASSWORDpassword", 24, salt, 36, 4096, 100, out );
+    if( !ak_ptr_is_equal_with_log( out, R5, 100 )) {
+      printf("pbkdf2: wrong value of 100 octets key vector\n");
+      result = EXIT_FAILURE;
+    } else printf("pbkdf2 (100 octets): Ok\n");
+
+   /* соглашение о длинах: 64-х октетный вектор T1 является началом более длинных векторов
+      и окончанием более коротких (младшие октеты T1, как в предыдущих версиях библиотеки) */
+    ak_hmac_pbkdf2_streebog512( "passwordPASSWORDpassword", 24, salt, 36, 4096, 64, res[0] );
+    ak_hmac_pbkdf2_streebog512( "passwordPASSWORDpassword", 24, salt, 36, 4096, 32, res[1] );
+    ak_hmac_pbkdf2_streebog512( "passwordPASSWORDpassword", 24, salt, 36, 4096, 48, res[2] );
+    if( !ak_ptr_is_equal_with_log( res[0], R5, 64 ) ||
+        !ak_ptr_is_equal_with_log( res[1], R5 +32, 32 ) ||
+        !ak_ptr_is_equal_with_log( res[2], R5 +16, 48 )) {
+      printf("pbkdf2: wrong convention for lengths of key vectors\n");
+      result = EXIT_FAILURE;
+    } else printf("pbkdf2 (32, 48 and 64 octets): Ok\n");
+
+   /* формируем задания с различными паролями и длинами ключевых векторов */
+    for( i = 0; i < tasks_count; i++ ) {
+       ak_snprintf( passwords[i], sizeof( passwords[i] ), "password%02u", (unsigned int) i );
+       tasks[i].pass = passwords[i];
+       tasks[i].pass_size = strlen( passwords[i] );
+       tasks[i].salt = salt;
+       tasks[i].salt_size = 4 + i;
+       tasks[i].cnt = 100 + i;
+       tasks[i].dklen = 32 + 5*i;
+       tasks[i].out = res[i];
+       tasks[i].error = ak_error_undefined_value;
+       ak_hmac_pbkdf2_streebog512( tasks[i].pass, tasks[i].pass_size,
+                            tasks[i].salt, tasks[i].salt_size, tasks[i].cnt, tasks[i].dklen, ref[i] );
+    }
+
+   /* выполняем задания последовательно и в нескольких потоках */
+    for( i = 1; i < 5; i += 3 ) {
+       memset( res, 0, sizeof( res ));
+       if( ak_hmac_pbkdf2_streebog512_tasks( tasks, tasks_count, i ) != ak_error_ok ) {
+         printf("pbkdf2 tasks: incorrect execution with %u threads\n", (unsigned int) i );
+         result = EXIT_FAILURE;
+         continue;
+       }
+       for( j = 0; j < tasks_count; j++ ) {
+          if( !ak_ptr_is_equal_with_log( res[j], ref[j], tasks[j].dklen )) {
+            printf("pbkdf2 tasks: wrong result of task %u with %u threads\n",
+                                                               (unsigned int) j, (unsigned int) i );
+            result = EXIT_FAILURE;
+          }
+       }
+       printf("pbkdf2 tasks (%u threads): done\n", (unsigned int) i );
+    }
+
+   /* задание с некорректными параметрами не влияет на выполнение остальных заданий */
+    tasks[2].dklen = 16;
+    memset( res, 0, sizeof( res ));
+    if(( ak_hmac_pbkdf2_streebog512_tasks( tasks, tasks_count, 4 ) != ak_error_invalid_value ) ||
+       ( tasks[2].error != ak_error_invalid_value ) || ( tasks[3].error != ak_error_ok ) ||
+       ( !ak_ptr_is_equal_with_log( res[3], ref[3], tasks[3].dklen ))) {
+      printf("pbkdf2 tasks: wrong processing of task with wrong parameters\n");
+      result = EXIT_FAILURE;
+    }
+
+    ak_libakrypt_destroy();
+
+ return result;
+}
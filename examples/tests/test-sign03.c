@@ -0,0 +1,106 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  тест пакетной проверки электронных подписей:
+    результаты функции ak_verifykey_verify_hash_tasks() для подписей, выработанных на различных
+    кривых (часть подписей искажена), сравниваются с результатами функции ak_verifykey_verify_hash()
+    при последовательном и многопоточном выполнении заданий                                        */
+ #include <time.h>
+ #include <stdio.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define keys_count  (3)
+ #define tasks_count (150)
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+    size_t i, j;
+    clock_t ts, tb;
+    struct random generator;
+    int result = EXIT_SUCCESS;
+    struct signkey sk[keys_count];
+    struct verifykey vk[keys_count];
+    struct verify_task tasks[tasks_count];
+    bool_t ref[tasks_count];
+    ak_uint8 hash[tasks_count][64], sign[tasks_count][128];
+    const struct wcurve *curves[keys_count] = {
+      &id_tc26_gost_3410_2012_256_paramSetA,
+      &id_rfc4357_gost_3410_2001_paramSetA,
+      &id_tc26_gost_3410_2012_512_paramSetA
+    };
+
+   /* инициализируем библиотеку */
+    if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true ) return ak_libakrypt_destroy();
+    ak_random_create_lcg( &generator );
+
+   /* вырабатываем ключи */
+    for( i = 0; i < keys_count; i++ ) {
+       if( curves[i]->size == ak_mpzn256_size ) ak_signkey_create_streebog256( sk+i );
+         else ak_signkey_create_streebog512( sk+i );
+       ak_signkey_set_curve( sk+i, (ak_wcurve) curves[i] );
+       ak_signkey_set_key_random( sk+i, &generator );
+       ak_verifykey_create_from_signkey( vk+i, sk+i );
+    }
+
+   /* вырабатываем подписи; каждая седьмая подпись искажается */
+    for( i = 0; i < tasks_count; i++ ) {
+       j = ( i/5 )%keys_count;
+       tasks[i].key = vk+j;
+       tasks[i].hash = hash[i];
+       tasks[i].hash_size = sizeof( ak_uint64 )*vk[j].wc->size;
+       tasks[i].sign = sign[i];
+       ak_random_ptr( &generator, hash[i], tasks[i].hash_size );
+       ak_signkey_sign_hash( sk+j, &generator, hash[i], tasks[i].hash_size, sign[i], sizeof( sign[i] ));
+       if( i%7 == 3 ) sign[i][i%( 2*tasks[i].hash_size )] ^= 0x01;
+    }
+
+    ts = clock();
+    for( i = 0; i < tasks_count; i++ )
+       ref[i] = ak_verifykey_verify_hash( tasks[i].key, tasks[i].hash, tasks[i].hash_size, tasks[i].sign );
+    ts = clock() - ts;
+
+   /* выполняем задания последовательно и в нескольких потоках */
+    for( i = 1; i < 5; i += 3 ) {
+       tb = clock();
+       if( ak_verifykey_verify_hash_tasks( tasks, tasks_count, i ) != ak_error_ok ) {
+         printf("verify tasks: incorrect execution with %u threads\n", (unsigned int) i );
+         result = EXIT_FAILURE;
+         continue;
+       }
+       tb = clock() - tb;
+       for( j = 0; j < tasks_count; j++ ) {
+          if(( tasks[j].result != ref[j] ) || ( tasks[j].result != ( j%7 != 3 ))) {
+            printf("verify tasks: wrong result of task %u with %u threads\n",
+                                                               (unsigned int) j, (unsigned int) i );
+            result = EXIT_FAILURE;
+          }
+       }
+       printf("verify tasks (%u threads): done (serial: %.3f sec, tasks: %.3f sec)\n",
+                  (unsigned int) i, (double)ts/CLOCKS_PER_SEC, (double)tb/CLOCKS_PER_SEC );
+    }
+
+   /* задание с некорректными параметрами (последовательно и в нескольких потоках) */
+    tasks[1].hash_size = 5;
+    for( i = 1; i < 5; i += 3 ) {
+       if( ak_verifykey_verify_hash_tasks( tasks, tasks_count, i ) != ak_error_wrong_length ) {
+         printf("verify tasks: wrong task parameters not detected with %u threads\n",
+                                                                             (unsigned int) i );
+         result = EXIT_FAILURE;
+       }
+       if(( tasks[1].result != ak_false ) || ( tasks[0].result != ak_true ) ||
+          ( tasks[1].error != ak_error_wrong_length ) || ( tasks[0].error != ak_error_ok )) {
+         printf("verify tasks: wrong result for task with wrong parameters with %u threads\n",
+                                                                             (unsigned int) i );
+         result = EXIT_FAILURE;
+       }
+    }
+
+    for( i = 0; i < keys_count; i++ ) {
+       ak_verifykey_destroy( vk+i );
+       ak_signkey_destroy( sk+i );
+    }
+    ak_random_destroy( &generator );
+    ak_libakrypt_destroy();
+
+ return result;
+}
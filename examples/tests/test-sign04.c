@@ -0,0 +1,128 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  тест многопоточной выработки электронных подписей с помощью пула реплик секретного ключа:
+    подписи, выработанные одновременно несколькими потоками, проверяются функцией
+    ak_verifykey_verify_hash(), а израсходованный ресурс ключа сравнивается с количеством подписей  */
+ #include <stdio.h>
+ #include <libakrypt.h>
+#ifdef AK_HAVE_PTHREAD_H
+ #include <pthread.h>
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define threads_count (4)
+ #define signs_count  (25)
+
+/* ----------------------------------------------------------------------------------------------- */
+ typedef struct sign_thread {
+   ak_signkey_pool pool;
+   ak_uint8 hash[signs_count][64];
+   ak_uint8 sign[signs_count][128];
+   int error;
+ } *ak_sign_thread;
+
+/* ----------------------------------------------------------------------------------------------- */
+ void *sign_thread_func( void *ptr )
+{
+    size_t i;
+    struct random generator;
+    ak_sign_thread st = ( ak_sign_thread ) ptr;
+
+    ak_random_create_lcg( &generator );
+    for( i = 0; i < signs_count; i++ ) {
+       ak_random_ptr( &generator, st->hash[i], 32 );
+       if(( st->error = ak_signkey_pool_sign_hash( st->pool, &generator,
+                                        st->hash[i], 32, st->sign[i], 128 )) != ak_error_ok ) break;
+    }
+    ak_random_destroy( &generator );
+ return NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+    size_t i, j;
+    ssize_t resource;
+    struct signkey sk;
+    struct verifykey vk;
+    struct random generator;
+    struct signkey_pool pool;
+    struct sign_thread st[threads_count];
+    int result = EXIT_SUCCESS;
+    ak_uint8 sign[128];
+#ifdef AK_HAVE_PTHREAD_H
+    pthread_t handles[threads_count];
+#endif
+
+   /* инициализируем библиотеку */
+    if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true ) return ak_libakrypt_destroy();
+    ak_random_create_lcg( &generator );
+
+    ak_signkey_create_streebog256( &sk );
+    ak_signkey_set_key_random( &sk, &generator );
+    ak_verifykey_create_from_signkey( &vk, &sk );
+    resource = sk.key.resource.value.counter;
+
+   /* вырабатываем подписи в нескольких потоках */
+    if( ak_signkey_pool_create( &pool, &sk, threads_count ) != ak_error_ok ) {
+      printf("signing pool: incorrect creation\n");
+      return ak_libakrypt_destroy();
+    }
+    for( i = 0; i < threads_count; i++ ) { st[i].pool = &pool; st[i].error = ak_error_ok; }
+#ifdef AK_HAVE_PTHREAD_H
+    for( i = 0; i < threads_count; i++ ) pthread_create( handles +i, NULL, sign_thread_func, st +i );
+    for( i = 0; i < threads_count; i++ ) pthread_join( handles[i], NULL );
+#else
+    for( i = 0; i < threads_count; i++ ) sign_thread_func( st +i );
+#endif
+    ak_signkey_pool_destroy( &pool );
+
+    for( i = 0; i < threads_count; i++ ) {
+       if( st[i].error != ak_error_ok ) {
+         printf("signing pool: thread %u finished with error %d\n", (unsigned int) i, st[i].error );
+         result = EXIT_FAILURE;
+         continue;
+       }
+       for( j = 0; j < signs_count; j++ )
+          if( !ak_verifykey_verify_hash( &vk, st[i].hash[j], 32, st[i].sign[j] )) {
+            printf("signing pool: wrong signature %u of thread %u\n",
+                                                                (unsigned int) j, (unsigned int) i );
+            result = EXIT_FAILURE;
+          }
+    }
+    if( sk.key.resource.value.counter != resource - threads_count*signs_count ) {
+      printf("signing pool: wrong resource of secret key\n");
+      result = EXIT_FAILURE;
+    }
+   /* исходный ключ остается пригодным для использования */
+    ak_signkey_sign_hash( &sk, &generator, st[0].hash[0], 32, sign, sizeof( sign ));
+    if( !ak_verifykey_verify_hash( &vk, st[0].hash[0], 32, sign )) {
+      printf("signing pool: source key is broken\n");
+      result = EXIT_FAILURE;
+    }
+
+   /* исчерпание ресурса */
+    sk.key.resource.value.counter = 3;
+    ak_signkey_pool_create( &pool, &sk, 2 );
+    for( i = 0; i < 3; i++ )
+       if( ak_signkey_pool_sign_ptr( &pool, &generator, sign, 16, sign +64, 64 ) != ak_error_ok ) {
+         printf("signing pool: unexpected error while resource is available\n");
+         result = EXIT_FAILURE;
+       }
+    if( ak_signkey_pool_sign_ptr( &pool, &generator, sign, 16, sign +64, 64 )
+                                                                   != ak_error_low_key_resource ) {
+      printf("signing pool: exhausted resource not detected\n");
+      result = EXIT_FAILURE;
+    }
+    ak_signkey_pool_destroy( &pool );
+    if( sk.key.resource.value.counter != 0 ) result = EXIT_FAILURE;
+
+    if( result == EXIT_SUCCESS )
+      printf("signing pool (%u threads, %u signatures): Ok\n",
+                          (unsigned int) threads_count, (unsigned int)( threads_count*signs_count ));
+    ak_verifykey_destroy( &vk );
+    ak_signkey_destroy( &sk );
+    ak_random_destroy( &generator );
+    ak_libakrypt_destroy();
+
+ return result;
+}
@@ -0,0 +1,131 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  тест выработки электронной подписи с использованием предварительно вычисленных пар (k, r):
+    подписи, выработанные с использованием пар, пополняемых явным вызовом функции
+    ak_signkey_refill_nonces() и фоновым потоком, проверяются функцией ak_verifykey_verify_hash();
+    также проверяется, что после смены эллиптической кривой ранее вычисленные пары не используются */
+ #include <time.h>
+ #include <stdio.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define nonces_count (16)
+ #define signs_count  (48)
+
+/* ----------------------------------------------------------------------------------------------- */
+ int nonces_test( ak_signkey sk, ak_verifykey vk, ak_random generator )
+{
+    size_t i;
+    clock_t tn, tf;
+    ak_uint8 hash[64], sign[128];
+    int result = EXIT_SUCCESS;
+    struct random tgenerator;
+    const size_t hsize = sizeof( ak_uint64 )*vk->wc->size;
+
+    ak_signkey_set_nonces( sk, nonces_count );
+    if( ak_signkey_refill_nonces( sk, generator ) != ak_error_ok ) {
+      printf("%s: incorrect refill of nonces\n", vk->wc->size == ak_mpzn256_size ? "256" : "512" );
+      return EXIT_FAILURE;
+    }
+    if( ak_signkey_get_nonces_count( sk ) != nonces_count ) result = EXIT_FAILURE;
+
+   /* подписи с использованием пар, затем без них */
+    tn = tf = 0;
+    for( i = 0; i < 2*nonces_count; i++ ) {
+       ak_random_ptr( generator, hash, hsize );
+       if( i < nonces_count ) tn -= clock(); else tf -= clock();
+       ak_signkey_sign_hash( sk, generator, hash, hsize, sign, sizeof( sign ));
+       if( i < nonces_count ) tn += clock(); else tf += clock();
+       if( !ak_verifykey_verify_hash( vk, hash, hsize, sign )) {
+         printf("wrong signature %u\n", (unsigned int) i );
+         result = EXIT_FAILURE;
+       }
+    }
+    if( ak_signkey_get_nonces_count( sk ) != 0 ) result = EXIT_FAILURE;
+
+   /* пары вырабатываются фоновым потоком */
+    ak_random_create_lcg( &tgenerator );
+    if( ak_signkey_start_nonces_thread( sk, &tgenerator ) == ak_error_ok ) {
+      for( i = 0; i < signs_count; i++ ) {
+         ak_random_ptr( generator, hash, hsize );
+         ak_signkey_sign_hash( sk, generator, hash, hsize, sign, sizeof( sign ));
+         if( !ak_verifykey_verify_hash( vk, hash, hsize, sign )) {
+           printf("wrong signature %u with background thread\n", (unsigned int) i );
+           result = EXIT_FAILURE;
+         }
+      }
+    }
+   /* уничтожение набора останавливает фоновый поток */
+    ak_signkey_set_nonces( sk, 0 );
+    ak_random_destroy( &tgenerator );
+
+    printf("%u bits: %s (precomputed: %.3f ms, full: %.3f ms per signature)\n",
+             (unsigned int)( 64*vk->wc->size ), result == EXIT_SUCCESS ? "Ok" : "Wrong",
+                                     1000.*(double)tn/( CLOCKS_PER_SEC*(double)nonces_count ),
+                                     1000.*(double)tf/( CLOCKS_PER_SEC*(double)nonces_count ));
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int curve_test( ak_signkey sk, ak_random generator )
+{
+    size_t i;
+    struct verifykey vk;
+    ak_uint8 hash[32], sign[64];
+    int result = EXIT_SUCCESS;
+
+    ak_signkey_set_nonces( sk, nonces_count );
+    ak_signkey_refill_nonces( sk, generator );
+    ak_signkey_set_curve_str( sk, "id-tc26-gost-3410-2012-256-paramSetB" );
+    if( ak_signkey_get_nonces_count( sk ) != 0 ) result = EXIT_FAILURE;
+    ak_signkey_set_key_random( sk, generator );
+    ak_verifykey_create_from_signkey( &vk, sk );
+
+   /* подпись без пар, затем с парами, вычисленными на новой кривой */
+    for( i = 0; i < 2; i++ ) {
+       ak_random_ptr( generator, hash, sizeof( hash ));
+       ak_signkey_sign_hash( sk, generator, hash, sizeof( hash ), sign, sizeof( sign ));
+       if( !ak_verifykey_verify_hash( &vk, hash, sizeof( hash ), sign )) {
+         printf("wrong signature %u after curve change\n", (unsigned int) i );
+         result = EXIT_FAILURE;
+       }
+       ak_signkey_refill_nonces( sk, generator );
+    }
+    ak_signkey_set_nonces( sk, 0 );
+    ak_verifykey_destroy( &vk );
+
+    printf("curve change: %s\n", result == EXIT_SUCCESS ? "Ok" : "Wrong" );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+    struct signkey sk;
+    struct verifykey vk;
+    struct random generator;
+    int result = EXIT_SUCCESS;
+
+   /* инициализируем библиотеку */
+    if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true ) return ak_libakrypt_destroy();
+    ak_random_create_lcg( &generator );
+
+    ak_signkey_create_streebog256( &sk );
+    ak_signkey_set_key_random( &sk, &generator );
+    ak_verifykey_create_from_signkey( &vk, &sk );
+    if( nonces_test( &sk, &vk, &generator ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    if( curve_test( &sk, &generator ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    ak_verifykey_destroy( &vk );
+    ak_signkey_destroy( &sk );
+
+    ak_signkey_create_streebog512( &sk );
+    ak_signkey_set_key_random( &sk, &generator );
+    ak_verifykey_create_from_signkey( &vk, &sk );
+    if( nonces_test( &sk, &vk, &generator ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    ak_verifykey_destroy( &vk );
+    ak_signkey_destroy( &sk );
+
+    ak_random_destroy( &generator );
+    ak_libakrypt_destroy();
+
+ return result;
+}
@@ -0,0 +1,229 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  тест вычисления кратных образующей точки эллиптической кривой:
+    результаты функций ak_wpoint_pow_generator() и ak_wpoint_pow_sum(), использующих таблицы
+    кратных точек, и функции ak_wpoint_pow_window(), использующей фиксированное окно,
+    сравниваются с результатами функции ak_wpoint_pow() для всех кривых,
+    а результаты функции ak_wpoint_pow(), выполняющей вычисления в системе координат кривой, -
+    с результатами вычислений в однородных проективных координатах                                */
+ #include <time.h>
+ #include <stdio.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define values_count (64)
+
+/* ----------------------------------------------------------------------------------------------- */
+ int coordinates_test( ak_wcurve wc, ak_random generator )
+{
+    long long int i, j;
+    ak_mpzn512 k;
+    struct wpoint wp, wt;
+    int result = EXIT_SUCCESS;
+
+    for( i = 0; i < 8; i++ ) {
+       ak_mpzn_set_random_modulo( k, wc->q, wc->size, generator );
+       if( i == 0 ) { ak_mpzn_set_ui( k, wc->size, 1 ); ak_mpzn_sub( k, wc->q, k, wc->size ); }
+       ak_wpoint_pow( &wp, &wc->point, k, wc->size, wc );
+       ak_wpoint_reduce( &wp, wc );
+
+      /* метод "удвоения и сложения" с использованием функций ak_wpoint_double() и ak_wpoint_add() */
+       ak_wpoint_set_as_unit( &wt, wc );
+       for( j = 64*wc->size -1; j >= 0; j-- ) {
+          ak_wpoint_double( &wt, wc );
+          if(( k[j >> 6] >> ( j&0x3f ))&1 ) ak_wpoint_add( &wt, &wc->point, wc );
+       }
+       ak_wpoint_reduce( &wt, wc );
+
+       if(( ak_mpzn_cmp( wp.x, wt.x, wc->size ) != 0 ) ||
+          ( ak_mpzn_cmp( wp.y, wt.y, wc->size ) != 0 ) ||
+          ( ak_mpzn_cmp( wp.z, wt.z, wc->size ) != 0 )) {
+         printf("%s: wrong point in curve coordinates for k = %s\n",
+                                 ak_oid_find_by_data( wc )->name[0], ak_mpzn_to_hexstr( k, wc->size ));
+         result = EXIT_FAILURE;
+       }
+    }
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int generator_test( ak_wcurve wc, ak_random generator )
+{
+    size_t i;
+    clock_t tp, tg;
+    ak_mpzn512 k;
+    struct wpoint wp, wg;
+    int result = EXIT_SUCCESS;
+
+    tp = tg = 0;
+    for( i = 0; i < values_count; i++ ) {
+      /* граничные значения степени кратности: 0, 1, 2, q-1, q-2 */
+       switch( i ) {
+         case 0:  ak_mpzn_set_ui( k, wc->size, 0 ); break;
+         case 1:  ak_mpzn_set_ui( k, wc->size, 1 ); break;
+         case 2:  ak_mpzn_set_ui( k, wc->size, 2 ); break;
+         case 3:  ak_mpzn_set_ui( k, wc->size, 1 ); ak_mpzn_sub( k, wc->q, k, wc->size ); break;
+         case 4:  ak_mpzn_set_ui( k, wc->size, 2 ); ak_mpzn_sub( k, wc->q, k, wc->size ); break;
+         default: ak_mpzn_set_random_modulo( k, wc->q, wc->size, generator ); break;
+       }
+
+       tp -= clock();
+       ak_wpoint_pow( &wp, &wc->point, k, wc->size, wc );
+       tp += clock();
+       ak_wpoint_reduce( &wp, wc );
+
+       tg -= clock();
+       ak_wpoint_pow_generator( &wg, k, wc->size, wc );
+       tg += clock();
+       ak_wpoint_reduce( &wg, wc );
+
+       if(( ak_mpzn_cmp( wp.x, wg.x, wc->size ) != 0 ) ||
+          ( ak_mpzn_cmp( wp.y, wg.y, wc->size ) != 0 ) ||
+          ( ak_mpzn_cmp( wp.z, wg.z, wc->size ) != 0 )) {
+         printf("%s: wrong point for k = %s\n", ak_oid_find_by_data( wc )->name[0],
+                                                                 ak_mpzn_to_hexstr( k, wc->size ));
+         result = EXIT_FAILURE;
+       }
+    }
+
+    printf("%s: %s (ladder: %.3f ms, table: %.3f ms per point)\n",
+                      ak_oid_find_by_data( wc )->name[0], result == EXIT_SUCCESS ? "Ok" : "Wrong",
+                                      1000.*(double)tp/( CLOCKS_PER_SEC*(double)values_count ),
+                                      1000.*(double)tg/( CLOCKS_PER_SEC*(double)values_count ));
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int sum_test( ak_wcurve wc, ak_random generator )
+{
+    size_t i;
+    clock_t tp, tg;
+    ak_mpzn512 k1, k2, t;
+    struct wpoint wq, wp, wt, wg;
+    int result = EXIT_SUCCESS;
+
+   /* вырабатываем случайную точку Q */
+    ak_mpzn_set_random_modulo( t, wc->q, wc->size, generator );
+    ak_wpoint_pow( &wq, &wc->point, t, wc->size, wc );
+    ak_wpoint_reduce( &wq, wc );
+
+    tp = tg = 0;
+    for( i = 0; i < values_count; i++ ) {
+       ak_mpzn_set_random_modulo( k1, wc->q, wc->size, generator );
+       ak_mpzn_set_random_modulo( k2, wc->q, wc->size, generator );
+      /* граничные значения: нулевые степени и сумма, равная бесконечно удаленной точке */
+       switch( i ) {
+         case 0:  ak_mpzn_set_ui( k1, wc->size, 0 ); break;
+         case 1:  ak_mpzn_set_ui( k2, wc->size, 0 ); break;
+         case 2:  ak_mpzn_set_ui( k1, wc->size, 0 ); ak_mpzn_set_ui( k2, wc->size, 0 ); break;
+         case 3:  ak_mpzn_set_ui( k2, wc->size, 1 ); /* k1 = q - t */
+                  ak_mpzn_sub( k1, wc->q, t, wc->size ); break;
+         default: break;
+       }
+
+       tp -= clock();
+       ak_wpoint_pow( &wp, &wc->point, k1, wc->size, wc );
+       ak_wpoint_pow( &wt, &wq, k2, wc->size, wc );
+       ak_wpoint_add( &wp, &wt, wc );
+       tp += clock();
+       ak_wpoint_reduce( &wp, wc );
+
+       tg -= clock();
+       ak_wpoint_pow_sum( &wg, k1, &wq, k2, wc->size, wc );
+       tg += clock();
+       ak_wpoint_reduce( &wg, wc );
+
+       if(( ak_mpzn_cmp( wp.x, wg.x, wc->size ) != 0 ) ||
+          ( ak_mpzn_cmp( wp.y, wg.y, wc->size ) != 0 ) ||
+          ( ak_mpzn_cmp( wp.z, wg.z, wc->size ) != 0 )) {
+         printf("%s: wrong sum of points for k1 = %s", ak_oid_find_by_data( wc )->name[0],
+                                                                ak_mpzn_to_hexstr( k1, wc->size ));
+         printf(", k2 = %s\n", ak_mpzn_to_hexstr( k2, wc->size ));
+         result = EXIT_FAILURE;
+       }
+    }
+
+    printf("%s: %s (two ladders: %.3f ms, wnaf: %.3f ms per sum)\n",
+                      ak_oid_find_by_data( wc )->name[0], result == EXIT_SUCCESS ? "Ok" : "Wrong",
+                                      1000.*(double)tp/( CLOCKS_PER_SEC*(double)values_count ),
+                                      1000.*(double)tg/( CLOCKS_PER_SEC*(double)values_count ));
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int window_test( ak_wcurve wc, ak_random generator )
+{
+    size_t i;
+    clock_t tp, tw;
+    ak_mpzn512 k, t;
+    struct wpoint wq, wp, ww;
+    int result = EXIT_SUCCESS;
+
+   /* вырабатываем случайную точку Q */
+    ak_mpzn_set_random_modulo( t, wc->q, wc->size, generator );
+    ak_wpoint_pow( &wq, &wc->point, t, wc->size, wc );
+    ak_wpoint_reduce( &wq, wc );
+
+    tp = tw = 0;
+    for( i = 0; i < values_count; i++ ) {
+      /* граничные значения степени кратности: 0, 1, 2, q-1, q-2, а также q (вычисления лесенкой) */
+       switch( i ) {
+         case 0:  ak_mpzn_set_ui( k, wc->size, 0 ); break;
+         case 1:  ak_mpzn_set_ui( k, wc->size, 1 ); break;
+         case 2:  ak_mpzn_set_ui( k, wc->size, 2 ); break;
+         case 3:  ak_mpzn_set_ui( k, wc->size, 1 ); ak_mpzn_sub( k, wc->q, k, wc->size ); break;
+         case 4:  ak_mpzn_set_ui( k, wc->size, 2 ); ak_mpzn_sub( k, wc->q, k, wc->size ); break;
+         case 5:  ak_mpzn_set( k, wc->q, wc->size ); break;
+         default: ak_mpzn_set_random_modulo( k, wc->q, wc->size, generator ); break;
+       }
+
+       tp -= clock();
+       ak_wpoint_pow( &wp, &wq, k, wc->size, wc );
+       tp += clock();
+       ak_wpoint_reduce( &wp, wc );
+
+       tw -= clock();
+       ak_wpoint_pow_window( &ww, &wq, k, wc->size, wc );
+       tw += clock();
+       ak_wpoint_reduce( &ww, wc );
+
+       if(( ak_mpzn_cmp( wp.x, ww.x, wc->size ) != 0 ) ||
+          ( ak_mpzn_cmp( wp.y, ww.y, wc->size ) != 0 ) ||
+          ( ak_mpzn_cmp( wp.z, ww.z, wc->size ) != 0 )) {
+         printf("%s: wrong window multiple for k = %s\n", ak_oid_find_by_data( wc )->name[0],
+                                                                 ak_mpzn_to_hexstr( k, wc->size ));
+         result = EXIT_FAILURE;
+       }
+    }
+
+    printf("%s: %s (ladder: %.3f ms, window: %.3f ms per point)\n",
+                      ak_oid_find_by_data( wc )->name[0], result == EXIT_SUCCESS ? "Ok" : "Wrong",
+                                      1000.*(double)tp/( CLOCKS_PER_SEC*(double)values_count ),
+                                      1000.*(double)tw/( CLOCKS_PER_SEC*(double)values_count ));
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+    ak_oid oid = NULL;
+    struct random generator;
+    int result = EXIT_SUCCESS;
+
+   /* инициализируем библиотеку */
+    if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true ) return ak_libakrypt_destroy();
+    ak_random_create_lcg( &generator );
+
+   /* первый вызов для каждой кривой вырабатывает таблицу */
+    oid = ak_oid_find_by_mode( wcurve_params );
+    do {
+         if( coordinates_test( oid->data, &generator ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+         if( generator_test( oid->data, &generator ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+         if( sum_test( oid->data, &generator ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+         if( window_test( oid->data, &generator ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    } while(( oid = ak_oid_findnext_by_mode( oid, wcurve_params )) != NULL );
+
+    ak_random_destroy( &generator );
+    ak_libakrypt_destroy();
+
+ return result;
+}
@@ -0,0 +1,131 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  тест шифрования последовательности секторов в режиме XTS:
+    результаты функций ak_bckey_encrypt_xts_sectors() и ak_bckey_decrypt_xts_sectors()
+    (последовательно и в нескольких потоках) сравниваются с результатами вызова функции
+    ak_bckey_encrypt_xts() для каждого сектора с синхропосылкой, равной номеру сектора              */
+ #include <time.h>
+ #include <stdio.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define data_length (128*4096)
+
+ static const size_t sector_sizes[] = { 16, 512, 4096 };
+ static const size_t sectors_count[] = { 1, 17, 128 };
+
+/* ----------------------------------------------------------------------------------------------- */
+ int xts_test( ak_bckey ekey, ak_bckey akey, ak_uint8 *data, ak_uint8 *out, ak_uint8 *outr )
+{
+    clock_t ts, tp;
+    ak_uint8 iv[8];
+    size_t i, j, k, threads;
+    int result = EXIT_SUCCESS;
+    const ak_uint64 first = 0xfffffffffffffff0LL;
+
+    for( i = 0; i < sizeof( sector_sizes )/sizeof( size_t ); i++ ) {
+       for( j = 0; j < sizeof( sectors_count )/sizeof( size_t ); j++ ) {
+          if( sector_sizes[i]*sectors_count[j] > data_length ) continue;
+         /* каждый сектор зашифровывается отдельно, номер сектора - синхропосылка */
+          for( k = 0; k < sectors_count[j]; k++ ) {
+             ak_uint64 sn = first +k;
+             size_t l;
+             for( l = 0; l < 8; l++ ) iv[l] = (ak_uint8)( sn >> 8*l );
+             ak_bckey_encrypt_xts( ekey, akey, data +k*sector_sizes[i],
+                                 outr +k*sector_sizes[i], sector_sizes[i], iv, sizeof( iv ));
+          }
+          for( threads = 1; threads < 5; threads += 3 ) {
+             memcpy( out, data, sector_sizes[i]*sectors_count[j] );
+             if(( ak_bckey_encrypt_xts_sectors( ekey, akey, out, out, sector_sizes[i],
+                                             sectors_count[j], first, threads ) != ak_error_ok ) ||
+                ( !ak_ptr_is_equal_with_log( out, outr, sector_sizes[i]*sectors_count[j] ))) {
+               printf("%s: wrong xts encryption (sector %u, %u sectors, %u threads)\n",
+                       ekey->key.oid->name[0], (unsigned int) sector_sizes[i],
+                                       (unsigned int) sectors_count[j], (unsigned int) threads );
+               result = EXIT_FAILURE;
+             }
+             if(( ak_bckey_decrypt_xts_sectors( ekey, akey, out, out, sector_sizes[i],
+                                             sectors_count[j], first, threads ) != ak_error_ok ) ||
+                ( !ak_ptr_is_equal_with_log( out, data, sector_sizes[i]*sectors_count[j] ))) {
+               printf("%s: wrong xts decryption (sector %u, %u sectors, %u threads)\n",
+                       ekey->key.oid->name[0], (unsigned int) sector_sizes[i],
+                                       (unsigned int) sectors_count[j], (unsigned int) threads );
+               result = EXIT_FAILURE;
+             }
+          }
+       }
+    }
+
+   /* сравниваем скорость зашифрования секторов длины 512 октетов */
+    ts = clock();
+    for( k = 0; k < data_length/512; k++ ) {
+       memcpy( iv, &k, sizeof( iv ));
+       ak_bckey_encrypt_xts( ekey, akey, data +512*k, outr +512*k, 512, iv, sizeof( iv ));
+    }
+    ts = clock() - ts;
+    tp = clock();
+    ak_bckey_encrypt_xts_sectors( ekey, akey, data, out, 512, data_length/512, 0, 1 );
+    tp = clock() - tp;
+
+    if( result == EXIT_SUCCESS )
+      printf("%s: Ok (%u sectors of 512 octets: per sector %.3f sec, sectors %.3f sec)\n",
+                 ekey->key.oid->name[0], (unsigned int)( data_length/512 ),
+                                            (double)ts/CLOCKS_PER_SEC, (double)tp/CLOCKS_PER_SEC );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+    size_t i;
+    struct bckey ekey, akey;
+    int result = EXIT_SUCCESS;
+    ak_uint8 *data = NULL, *out = NULL, *outr = NULL,
+             keyval[32] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0x10, 0x32, 0x54, 0x76 },
+             akeyval[32] = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc };
+
+   /* инициализируем библиотеку */
+    if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true ) return ak_libakrypt_destroy();
+    if((( data = malloc( data_length )) == NULL ) ||
+       (( out = malloc( data_length )) == NULL ) ||
+       (( outr = malloc( data_length )) == NULL )) {
+      result = EXIT_FAILURE;
+      goto labex;
+    }
+    for( i = 0; i < data_length; i++ ) data[i] = (ak_uint8)( 7*i+3 );
+
+    ak_bckey_create_magma( &ekey );
+    ak_bckey_set_key( &ekey, keyval, sizeof( keyval ));
+    ak_bckey_create_magma( &akey );
+    ak_bckey_set_key( &akey, akeyval, sizeof( akeyval ));
+    if( xts_test( &ekey, &akey, data, out, outr ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    ak_bckey_destroy( &akey );
+    ak_bckey_destroy( &ekey );
+
+   /* в режиме совместимости с openssl значения ключей Магма хранятся в развернутом виде;
+      копии ключей, используемые потоками, должны совпадать с исходными ключами */
+    ak_libakrypt_set_openssl_compability( ak_true );
+    ak_bckey_create_magma( &ekey );
+    ak_bckey_set_key( &ekey, keyval, sizeof( keyval ));
+    ak_bckey_create_magma( &akey );
+    ak_bckey_set_key( &akey, akeyval, sizeof( akeyval ));
+    if( xts_test( &ekey, &akey, data, out, outr ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    ak_bckey_destroy( &akey );
+    ak_bckey_destroy( &ekey );
+    ak_libakrypt_set_openssl_compability( ak_false );
+
+    ak_bckey_create_kuznechik( &ekey );
+    ak_bckey_set_key( &ekey, keyval, sizeof( keyval ));
+    ak_bckey_create_kuznechik( &akey );
+    ak_bckey_set_key( &akey, akeyval, sizeof( akeyval ));
+    if( xts_test( &ekey, &akey, data, out, outr ) != EXIT_SUCCESS ) result = EXIT_FAILURE;
+    ak_bckey_destroy( &akey );
+    ak_bckey_destroy( &ekey );
+
+  labex:
+    if( outr ) free( outr );
+    if( out ) free( out );
+    if( data ) free( data );
+    ak_libakrypt_destroy();
+
+ return result;
+}
@@ -0,0 +1,104 @@
+/* ----------------------------------------------------------------------------------------------- */
+/*  тест конвейерной реализации режима XTSMAC для алгоритма Магма:
+    результаты зашифрования и расшифрования с использованием многоблочных функций encrypt_blocks
+    и decrypt_blocks сравниваются с результатами поблочной обработки данных и с известным
+    значением имитовставки                                                                         */
+ #include <time.h>
+ #include <stdio.h>
+ #include <libakrypt.h>
+
+/* ----------------------------------------------------------------------------------------------- */
+ #define data_length (1000)
+
+ static const size_t plain_lengths[] = { 8, 16, 17, 100, 256, 263, 512, 520, 1000 };
+ static const size_t adata_lengths[] = { 0, 15, 16, 37, 600 };
+
+/* имитовставка для 37 октетов ассоциированных данных и 1000 октетов открытого текста */
+ static ak_uint8 icode_kat[16] = {
+     0x25, 0xf5, 0x64, 0xdd, 0x84, 0x2b, 0x9e, 0x6e, 0x18, 0xe7, 0x59, 0x9a, 0xc1, 0xa5, 0x8b, 0xdd };
+
+/* ----------------------------------------------------------------------------------------------- */
+ int main( void )
+{
+    size_t i, j;
+    clock_t tp, tb;
+    struct bckey key, akey, ref, aref;
+    int result = EXIT_SUCCESS;
+    ak_uint8 data[data_length], out[data_length], outr[data_length], icode[16], icoder[16],
+             iv[16] = { 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x77, 0x66, 0x55 },
+             keyval[32] = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef, 0x10, 0x32, 0x54, 0x76 },
+             authval[32] = { 0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10, 0xef, 0xcd, 0xab, 0x89 },
+             *buffer = NULL;
+
+   /* инициализируем библиотеку */
+    if( ak_libakrypt_create( ak_function_log_stderr ) != ak_true ) return ak_libakrypt_destroy();
+    for( i = 0; i < sizeof( data ); i++ ) data[i] = (ak_uint8)( 3*i+1 );
+
+   /* ключи ref и aref используют только поблочное шифрование */
+    ak_bckey_create_magma( &key );
+    ak_bckey_set_key( &key, keyval, sizeof( keyval ));
+    ak_bckey_create_magma( &akey );
+    ak_bckey_set_key( &akey, authval, sizeof( authval ));
+    ak_bckey_create_magma( &ref );
+    ak_bckey_set_key( &ref, keyval, sizeof( keyval ));
+    ak_bckey_create_magma( &aref );
+    ak_bckey_set_key( &aref, authval, sizeof( authval ));
+    ref.encrypt_blocks = ref.decrypt_blocks = NULL;
+    aref.encrypt_blocks = aref.decrypt_blocks = NULL;
+
+   /* известное значение имитовставки */
+    ak_bckey_encrypt_xtsmac( &key, &akey, data, 37, data, out, data_length,
+                                                                  iv, sizeof( iv ), icode, 16 );
+    if( !ak_ptr_is_equal_with_log( icode, icode_kat, 16 )) {
+      printf("xtsmac: wrong integrity code\n");
+      result = EXIT_FAILURE;
+    }
+
+    for( i = 0; i < sizeof( adata_lengths )/sizeof( size_t ); i++ ) {
+       for( j = 0; j < sizeof( plain_lengths )/sizeof( size_t ); j++ ) {
+          ak_bckey_encrypt_xtsmac( &ref, &aref, data, adata_lengths[i], data, outr,
+                                              plain_lengths[j], iv, sizeof( iv ), icoder, 16 );
+          memset( out, 0, sizeof( out )); memset( icode, 0, 16 );
+          ak_bckey_encrypt_xtsmac( &key, &akey, data, adata_lengths[i], data, out,
+                                              plain_lengths[j], iv, sizeof( iv ), icode, 16 );
+          if( !ak_ptr_is_equal_with_log( out, outr, plain_lengths[j] ) ||
+              !ak_ptr_is_equal_with_log( icode, icoder, 16 )) {
+            printf("xtsmac: wrong encryption for adata %u and data %u octets\n",
+                                 (unsigned int) adata_lengths[i], (unsigned int) plain_lengths[j] );
+            result = EXIT_FAILURE;
+          }
+          memset( out, 0, sizeof( out ));
+          if(( ak_bckey_decrypt_xtsmac( &key, &akey, data, adata_lengths[i], outr, out,
+                               plain_lengths[j], iv, sizeof( iv ), icoder, 16 ) != ak_error_ok ) ||
+             ( !ak_ptr_is_equal_with_log( out, data, plain_lengths[j] ))) {
+            printf("xtsmac: wrong decryption for adata %u and data %u octets\n",
+                                 (unsigned int) adata_lengths[i], (unsigned int) plain_lengths[j] );
+            result = EXIT_FAILURE;
+          }
+       }
+    }
+
+    if( result == EXIT_SUCCESS ) printf("xtsmac (magma): Ok\n");
+
+   /* сравниваем скорость обработки одного мегабайта */
+    if(( buffer = malloc( 1048576 )) != NULL ) {
+      memset( buffer, 0x11, 1048576 );
+      tb = clock();
+      ak_bckey_encrypt_xtsmac( &ref, &aref, NULL, 0, buffer, buffer, 1048576, iv, 16, icoder, 16 );
+      tb = clock() - tb;
+      tp = clock();
+      ak_bckey_encrypt_xtsmac( &key, &akey, NULL, 0, buffer, buffer, 1048576, iv, 16, icode, 16 );
+      tp = clock() - tp;
+      printf("xtsmac (1 MB): per block %.3f sec, multiblock %.3f sec\n",
+                                   (double)tb/CLOCKS_PER_SEC, (double)tp/CLOCKS_PER_SEC );
+      free( buffer );
+    }
+
+    ak_bckey_destroy( &aref );
+    ak_bckey_destroy( &ref );
+    ak_bckey_destroy( &akey );
+    ak_bckey_destroy( &key );
+    ak_libakrypt_destroy();
+
+ return result;
+}
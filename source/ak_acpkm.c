@@ -6,23 +6,24 @@
 /*  - содержит реализацию криптографических алгоритмов семейства ACPKM из Р 1323565.1.017—2018     */
 /* ----------------------------------------------------------------------------------------------- */
  #include <libakrypt-internal.h>
+#ifdef AK_HAVE_PTHREAD_H
+ #include <pthread.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! \details Функция вычисляет новое значение секретного ключа в соответствии с соотношениями
-    из раздела 4.1, см. Р 1323565.1.017—2018.
-    После выработки новое значение помещается вместо старого.
-    Одновременно, изменяется ресурс нового ключа: его тип принимает значение - \ref key_using_resource,
-    а счетчик принимает значение, определяемое одной из опций
+/*! \brief Функция вычисляет на ключе `bkey` новое значение секретного ключа в соответствии
+    с соотношениями из раздела 4.1 Р 1323565.1.017—2018 и присваивает его ключу `nkey`.
 
-     - `ackpm_section_magma_block_count`,
-     - `ackpm_section_kuznechik_block_count`.
+    Ключи `bkey` и `nkey` могут совпадать; в противном случае контекст `nkey` должен быть
+    создан для того же алгоритма блочного шифрования. Такое разделение позволяет вычислить
+    ключ секции, не изменяя ключ предыдущей секции.
 
-    @param bkey Контекст ключа алгоритма блочного шифрования, для которого вычисляется
-    новое значение. Контекст должен быть инициализирован и содержать ключевое значение.
+    @param bkey Контекст ключа, на котором вычисляется новое значение.
+    @param nkey Контекст ключа, которому присваивается новое значение.
     @return В случае возникновения ошибки функция возвращает ее код, в противном случае
     возвращается \ref ak_error_ok (ноль)                                                           */
 /* ----------------------------------------------------------------------------------------------- */
- int ak_bckey_next_acpkm_key( ak_bckey bkey )
+ static int ak_bckey_next_acpkm_key_common( ak_bckey bkey, ak_bckey nkey )
 {
   ssize_t counter = 0;
   int error = ak_error_ok;
@@ -46,108 +47,352 @@
          bkey->encrypt( &bkey->key, acpkm +8, new_key +8 );
          bkey->encrypt( &bkey->key, acpkm +16, new_key +16 );
          bkey->encrypt( &bkey->key, acpkm +24, new_key +24 );
-         counter = ak_libakrypt_get_option_by_name( "acpkm_section_magma_block_count" );
+         counter = bkey->options.acpkm_section_block_count;
          break;
       case 16: /* шифр с длиной блока 128 бит */
          bkey->encrypt( &bkey->key, acpkm, new_key );
          bkey->encrypt( &bkey->key, acpkm +16, new_key +16 );
-         counter = ak_libakrypt_get_option_by_name( "acpkm_section_kuznechik_block_count" );
+         counter = bkey->options.acpkm_section_block_count;
          break;
       default: return ak_error_message( ak_error_wrong_block_cipher,
                                            __func__ , "incorrect block size of block cipher key" );
    }
 
  /* присваиваем ключу значение */
-  if(( error = ak_bckey_set_key( bkey, new_key, bkey->key.key_size )) != ak_error_ok )
+  if(( error = ak_bckey_set_key( nkey, new_key, nkey->key.key_size )) != ak_error_ok )
     ak_error_message( error, __func__ , "can't replace key by new using acpkm" );
    else {
-           bkey->key.resource.value.type = key_using_resource;
-           bkey->key.resource.value.counter = counter;
+           nkey->key.resource.value.type = key_using_resource;
+           nkey->key.resource.value.counter = counter;
         }
   ak_ptr_wipe( new_key, sizeof( new_key ), &bkey->key.generator );
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \details Функция вычисляет новое значение секретного ключа в соответствии с соотношениями
+    из раздела 4.1, см. Р 1323565.1.017—2018.
+    После выработки новое значение помещается вместо старого.
+    Одновременно, изменяется ресурс нового ключа: его тип принимает значение - \ref key_using_resource,
+    а счетчик принимает значение, определяемое одной из опций
+
+     - `ackpm_section_magma_block_count`,
+     - `ackpm_section_kuznechik_block_count`.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования, для которого вычисляется
+    новое значение. Контекст должен быть инициализирован и содержать ключевое значение.
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_next_acpkm_key( ak_bckey bkey )
+{
+ return ak_bckey_next_acpkm_key_common( bkey, bkey );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 #ifdef AK_LITTLE_ENDIAN
-  #define acpkm_block64 {\
-              nkey.encrypt( &nkey.key, ctr, yaout );\
+  #define acpkm_increment64 {\
               ctr[0] += 1;\
-              ((ak_uint64 *) outptr)[0] = yaout[0] ^ ((ak_uint64 *) inptr)[0];\
-              outptr++; inptr++;\
            }
 
-  #define acpkm_block128 {\
-              nkey.encrypt( &nkey.key, ctr, yaout );\
+  #define acpkm_increment128 {\
               if(( ctr[0] += 1 ) == 0 ) ctr[1]++;\
-              ((ak_uint64 *) outptr)[0] = yaout[0] ^ ((ak_uint64 *) inptr)[0];\
-              ((ak_uint64 *) outptr)[1] = yaout[1] ^ ((ak_uint64 *) inptr)[1];\
-              outptr += 2; inptr += 2;\
            }
 
 #else
-  #define acpkm_block64 {\
-              nkey.encrypt( &nkey.key, ctr, yaout );\
+  #define acpkm_increment64 {\
               ctr[0] = bswap_64( ctr[0] ); ctr[0] += 1; ctr[0] = bswap_64( ctr[0] );\
-              ((ak_uint64 *) outptr)[0] = yaout[0] ^ ((ak_uint64 *) inptr)[0];\
-              outptr++; inptr++;\
            }
 
-  #define acpkm_block128 {\
-              nkey.encrypt( &nkey.key, ctr, yaout );\
+  #define acpkm_increment128 {\
               ctr[0] = bswap_64( ctr[0] ); ctr[0] += 1; ctr[0] = bswap_64( ctr[0] );\
               if( ctr[0] == 0 ) { \
                 ctr[1] = bswap_64( ctr[0] ); ctr[1] += 1; ctr[1] = bswap_64( ctr[0] );\
               }\
+           }
+#endif
+
+  #define acpkm_block64 {\
+              nkey->encrypt( &nkey->key, ctr, yaout );\
+              acpkm_increment64;\
+              ((ak_uint64 *) outptr)[0] = yaout[0] ^ ((ak_uint64 *) inptr)[0];\
+              outptr++; inptr++;\
+           }
+
+  #define acpkm_block128 {\
+              nkey->encrypt( &nkey->key, ctr, yaout );\
+              acpkm_increment128;\
               ((ak_uint64 *) outptr)[0] = yaout[0] ^ ((ak_uint64 *) inptr)[0];\
               ((ak_uint64 *) outptr)[1] = yaout[1] ^ ((ak_uint64 *) inptr)[1];\
               outptr += 2; inptr += 2;\
            }
+
+/*! \brief Количество 64-х битных слов гаммы, вырабатываемых за один вызов многоблочной функции. */
+ #define acpkm_batch_words  (32)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает `count` последовательных блоков одной секции, используя
+    многоблочную реализацию алгоритма шифрования.
+
+    Значение счетчика `ctr` изменяется так же, как и при последовательной обработке блоков.
+    Функция предполагает, что метод `encrypt_blocks` ключа определен.
+
+    @param nkey Контекст ключа текущей секции.
+    @param ctr Текущее значение счетчика.
+    @param inptr Указатель на входные данные.
+    @param outptr Указатель на выходные данные.
+    @param count Количество обрабатываемых блоков.                                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_acpkm_blocks( ak_bckey nkey, ak_uint64 *ctr,
+                                           ak_uint64 *inptr, ak_uint64 *outptr, ssize_t count )
+{
+  ssize_t j = 0, n = 0;
+  ak_uint64 counters[ acpkm_batch_words ], gamma[ acpkm_batch_words ];
+
+  if( nkey->bsize == 8 ) {
+    while( count > 0 ) {
+       n = ak_min( count, acpkm_batch_words );
+       for( j = 0; j < n; j++ ) {
+          counters[j] = ctr[0];
+          acpkm_increment64;
+       }
+       nkey->encrypt_blocks( &nkey->key, counters, gamma, ( size_t ) n );
+       for( j = 0; j < n; j++ ) outptr[j] = inptr[j] ^ gamma[j];
+       inptr += n; outptr += n; count -= n;
+    }
+  } else {
+    while( count > 0 ) {
+       n = ak_min( count, acpkm_batch_words >> 1 );
+       for( j = 0; j < n; j++ ) {
+          counters[2*j] = ctr[0]; counters[2*j+1] = ctr[1];
+          acpkm_increment128;
+       }
+       nkey->encrypt_blocks( &nkey->key, counters, gamma, ( size_t ) n );
+       for( j = 0; j < 2*n; j++ ) outptr[j] = inptr[j] ^ gamma[j];
+       inptr += 2*n; outptr += 2*n; count -= n;
+    }
+  }
+}
+
+#ifdef AK_HAVE_PTHREAD_H
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция прибавляет к значению счетчика режима `ACPKM` заданное количество блоков.
+
+    @param ctr Значение счетчика (два 64-х битных слова).
+    @param bsize Длина блока алгоритма блочного шифрования.
+    @param n Прибавляемое значение.                                                                */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_acpkm_counter_add( ak_uint64 *ctr, const size_t bsize, const ak_uint64 n )
+{
+#ifdef AK_LITTLE_ENDIAN
+  if(( ctr[0] += n ) < n ) {
+    if( bsize == 16 ) ctr[1]++;
+  }
+#else
+  ak_uint64 x = bswap_64( ctr[0] ) + n;
+  if(( x < n ) && ( bsize == 16 )) ctr[1] = bswap_64( bswap_64( ctr[1] ) + 1 );
+  ctr[0] = bswap_64( x );
+#endif
+}
 #endif
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! В режиме `ACPKM` для шифрования используется операция гаммирования - операция сложения
-    открытого (зашифровываемого) текста с гаммой, вырабатываемой шифром, по модулю два.
-    Поэтому, для зашифрования и расшифрования информациии используется одна и та же функция.
+/*! \brief Функция зашифровывает (расшифровывает) последовательность секций в режиме `ACPKM`.
 
-    В процессе шифрования исходные данные разбиваются на секции фиксированной длины, после чего
-    каждая секция шифруется на своем ключе. Длина секции является параметром алгоритма и
-    не должна превосходить величины, определяемой одной из следующих технических характеристик
-    (опций)
+    Данные разбиваются на секции длины `section_size`; после обработки каждой полной секции
+    ключ `nkey` заменяется ключом следующей секции. Последний фрагмент данных, длина которого
+    меньше длины секции, обрабатывается на ключе, полученном после обработки всех полных секций.
 
-     - `ackpm_section_magma_block_count`,
-     - `ackpm_section_kuznechik_block_count`.
+    @param nkey Контекст ключа первой секции; в ходе работы функции значение ключа изменяется.
+    @param ctr Значение счетчика для первого блока данных; в ходе работы функции изменяется.
+    @param inptr Указатель на входные данные.
+    @param outptr Указатель на выходные данные.
+    @param size Размер обрабатываемых данных (в байтах).
+    @param section_size Размер одной секции в байтах.
 
-    Значение синхропосылки `iv` копируется во временную область памяти и, в ходе выполнения
-    функции, не изменяется. Повторный вызов функции ak_bckey_ctr_acpkm() с нулевым
-    указатетем на синхропосылу, как в случае функции ak_bckey_ctr(), не допускается.
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_acpkm_sections( ak_bckey nkey, ak_uint64 *ctr,
+                    ak_uint64 *inptr, ak_uint64 *outptr, const size_t size, const size_t section_size )
+{
+  ak_uint64 yaout[2];
+  int error = ak_error_ok;
+  ssize_t j = 0, seclen = ( ssize_t )( section_size/nkey->bsize ),
+          sections = ( ssize_t )( size/section_size ),
+          tail = ( ssize_t )( size - ( size_t )( sections*seclen )*nkey->bsize );
 
-    @param bkey Контекст ключа алгоритма блочного шифрования,
-    используемый для шифрования и порождения цепочки производных ключей.
-    @param in Указатель на область памяти, где хранятся входные
-    (зашифровываемые/расшифровываемые) данные
-    @param out Указатель на область памяти, куда помещаются выходные
-    (расшифровываемые/зашифровываемые) данные; этот указатель может совпадать с in
-    @param size Размер зашировываемых данных (в байтах). Длина зашифровываемых данных может
-    принимать любое значение, не превосходящее \f$ 2^{\frac{8n}{2}-1}\f$, где \f$ n \f$
-    длина блока алгоритма шифрования (8 или 16 байт).
+  if( sections > 0 ) {
+    do{
+       if( nkey->encrypt_blocks != NULL ) { /* обрабатываем одну секцию группами блоков */
+         ak_bckey_acpkm_blocks( nkey, ctr, inptr, outptr, seclen );
+         inptr += seclen*(ssize_t)( nkey->bsize >> 3 );
+         outptr += seclen*(ssize_t)( nkey->bsize >> 3 );
+       }
+        else switch( nkey->bsize ) { /* обрабатываем одну секцию */
+         case 8: for( j = 0; j < seclen; j++ ) acpkm_block64; break;
+         case 16: for( j = 0; j < seclen; j++ ) acpkm_block128; break;
+         default: ak_error_message( ak_error_wrong_block_cipher,
+                                           __func__ , "incorrect block size of block cipher key" );
+       }
+      /* вычисляем следующий ключ */
+       if(( error = ak_bckey_next_acpkm_key( nkey )) != ak_error_ok )
+         return ak_error_message_fmt( error, __func__,
+                          "incorrect key generation after %u sections", (unsigned int) sections );
+    } while( --sections > 0 );
+  } /* конец обработки случая, когда sections > 0 */
 
-    @param section_size Размер одной секции в байтах. Данная величина должна быть кратна длине блока
-    используемого алгоритма шифрования.
+  if( tail ) { /* теперь обрабатываем фрагмент данных, не кратный длине секции */
+    if(( seclen = tail/(ssize_t)( nkey->bsize )) > 0 ) {
+       if( nkey->encrypt_blocks != NULL ) { /* обрабатываем данные, кратные длине блока */
+         ak_bckey_acpkm_blocks( nkey, ctr, inptr, outptr, seclen );
+         inptr += seclen*(ssize_t)( nkey->bsize >> 3 );
+         outptr += seclen*(ssize_t)( nkey->bsize >> 3 );
+       }
+        else switch( nkey->bsize ) { /* обрабатываем данные, кратные длине блока */
+         case 8: for( j = 0; j < seclen; j++ ) acpkm_block64; break;
+         case 16: for( j = 0; j < seclen; j++ ) acpkm_block128; break;
+         default: ak_error_message( ak_error_wrong_block_cipher,
+                                            __func__ , "incorrect block size of block cipher key" );
+       }
+    }
+  /* остался последний фрагмент, длина которого меньше длины блока
+                      в качестве гаммы мы используем старшие байты */
+    if(( tail -= seclen*(ssize_t)( nkey->bsize )) > 0 ) {
+      nkey->encrypt( &nkey->key, ctr, yaout );
+      for( j = 0; j < tail; j++ ) ((ak_uint8 *) outptr)[j] =
+                        ((ak_uint8 *)yaout)[(ssize_t)nkey->bsize-tail+j] ^ ((ak_uint8 *) inptr)[j];
+    }
+  }
+ return error;
+}
 
-    @param iv имитовставка
-    @param iv_size длина имитовставки (в байтах)
+#ifdef AK_HAVE_PTHREAD_H
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Последовательность секций, обрабатываемая отдельным потоком в режиме `ACPKM`. */
+ typedef struct bckey_acpkm_segment {
+  /*! \brief Ключ первой секции фрагмента (собственный для каждого потока). */
+   struct bckey key;
+  /*! \brief Значение счетчика для первого блока фрагмента. */
+   ak_uint64 ctr[2];
+  /*! \brief Указатель на входные данные. */
+   ak_uint64 *in;
+  /*! \brief Указатель на выходные данные. */
+   ak_uint64 *out;
+  /*! \brief Размер обрабатываемых данных (в байтах). */
+   size_t size;
+  /*! \brief Размер одной секции в байтах. */
+   size_t section_size;
+  /*! \brief Код ошибки, возникшей при обработке фрагмента. */
+   int error;
+  /*! \brief Флаг успешного создания потока. */
+   bool_t started;
+  /*! \brief Дескриптор потока. */
+   pthread_t handle;
+ } *ak_bckey_acpkm_segment;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция потока: обрабатывает одну последовательность секций. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void *ak_bckey_acpkm_thread( void *ptr )
+{
+  ak_bckey_acpkm_segment seg = ( ak_bckey_acpkm_segment ) ptr;
+  seg->error = ak_bckey_acpkm_sections( &seg->key, seg->ctr,
+                                                  seg->in, seg->out, seg->size, seg->section_size );
+ return NULL;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает данные в режиме `ACPKM`, распределяя секции между потоками.
+
+    Данные разбиваются на `tcount` фрагментов, состоящих из целого числа секций (последний
+    фрагмент содержит также неполную секцию). Значение счетчика для каждого фрагмента вычисляется
+    прибавлением номера его первого блока, а ключ первой секции фрагмента - последовательным
+    применением преобразования ACPKM к ключу `nkey` в вызывающем потоке. Поток, обрабатывающий
+    фрагмент, запускается сразу после вычисления его ключа, поэтому выработка ключей
+    для последующих фрагментов выполняется одновременно с шифрованием.
+
+    @param bkey Исходный ключ алгоритма блочного шифрования (используется для создания
+    ключа первого фрагмента).
+    @param nkey Ключ первой секции; в ходе работы функции значение ключа изменяется.
+    @param ctr Значение счетчика для первого блока данных.
+    @param in Указатель на входные данные.
+    @param out Указатель на выходные данные.
+    @param size Размер обрабатываемых данных (в байтах).
+    @param section_size Размер одной секции в байтах.
+    @param tcount Количество фрагментов (потоков).
 
     @return В случае возникновения ошибки функция возвращает ее код, в противном случае
     возвращается \ref ak_error_ok (ноль)                                                           */
 /* ----------------------------------------------------------------------------------------------- */
- int ak_bckey_ctr_acpkm( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
-                                                 size_t section_size, ak_pointer iv, size_t iv_size)
+ static int ak_bckey_acpkm_sections_threads( ak_bckey bkey, ak_bckey nkey, ak_uint64 *ctr,
+               ak_uint64 *in, ak_uint64 *out, size_t size, size_t section_size, size_t tcount )
+{
+  int error = ak_error_ok;
+  ak_bckey_acpkm_segment segs = NULL;
+  size_t idx = 0, jdx = 0, created = 0,
+         spw = ( size/section_size )/tcount; /* количество секций в одном фрагменте */
+
+  if(( segs = malloc( tcount*sizeof( struct bckey_acpkm_segment ))) == NULL )
+    return ak_bckey_acpkm_sections( nkey, ctr, in, out, size, section_size );
+
+  for( idx = 0; idx < tcount; idx++ ) {
+    /* ключ первой секции фрагмента */
+     if( idx == 0 ) {
+       if(( error = ak_bckey_create_and_set_bckey( &segs[0].key, bkey )) != ak_error_ok ) break;
+       segs[0].key.key.resource.value.counter = nkey->key.resource.value.counter;
+     } else {
+         for( jdx = 1; jdx < spw; jdx++ )
+            if(( error = ak_bckey_next_acpkm_key( nkey )) != ak_error_ok ) break;
+         if( error != ak_error_ok ) break;
+         if(( error = ak_bckey_create_oid( &segs[idx].key, nkey->key.oid )) != ak_error_ok ) break;
+         if(( error = ak_bckey_next_acpkm_key_common( nkey, &segs[idx].key )) != ak_error_ok ) {
+           ak_bckey_destroy( &segs[idx].key );
+           break;
+         }
+         if(( error = ak_bckey_next_acpkm_key( nkey )) != ak_error_ok ) {
+           ak_bckey_destroy( &segs[idx].key );
+           break;
+         }
+       }
+    /* остальные параметры фрагмента */
+     segs[idx].ctr[0] = ctr[0]; segs[idx].ctr[1] = ctr[1];
+     ak_bckey_acpkm_counter_add( segs[idx].ctr, nkey->bsize,
+                                         ( ak_uint64 )( idx*spw*( section_size/nkey->bsize )));
+     segs[idx].in = in + idx*spw*( section_size >> 3 );
+     segs[idx].out = out + idx*spw*( section_size >> 3 );
+     segs[idx].size = ( idx == tcount-1 ) ? size - idx*spw*section_size : spw*section_size;
+     segs[idx].section_size = section_size;
+     segs[idx].error = ak_error_ok;
+     segs[idx].started = ( pthread_create( &segs[idx].handle, NULL,
+                                        ak_bckey_acpkm_thread, segs +idx ) == 0 ) ? ak_true : ak_false;
+     created++;
+  }
+  if( error != ak_error_ok ) ak_error_message( error, __func__, "incorrect section key generation" );
+
+ /* фрагменты, для которых не удалось создать поток, обрабатываются в вызывающем потоке */
+  for( idx = 0; idx < created; idx++ ) {
+     if( segs[idx].started ) pthread_join( segs[idx].handle, NULL );
+      else if( error == ak_error_ok ) ak_bckey_acpkm_thread( segs +idx );
+     if(( error == ak_error_ok ) && ( segs[idx].error != ak_error_ok )) error = segs[idx].error;
+     ak_bckey_destroy( &segs[idx].key );
+  }
+  free( segs );
+ return error;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция шифрования в режиме `ACPKM`, использующая заданное количество потоков
+    (см. ak_bckey_ctr_acpkm_threads()).                                                            */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_ctr_acpkm_common( ak_bckey bkey, ak_pointer in, ak_pointer out,
+                   size_t size, size_t section_size, ak_pointer iv, size_t iv_size, size_t threads )
 {
   struct bckey nkey;
   int error = ak_error_ok;
-  ssize_t j = 0, sections = 0, tail = 0, seclen = 0, maxseclen = 0, mcount = 0;
-  ak_uint64 yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out, ctr[2] = { 0, 0 };
+  ssize_t seclen = 0, maxseclen = 0, mcount = 0;
+  ak_uint64 ctr[2] = { 0, 0 };
 
  /* выполняем проверку размера входных данных */
   if( section_size%bkey->bsize != 0 )
@@ -168,8 +413,8 @@
                                                              а также устанавливаем синхропосылку */
   switch( bkey->bsize ) {
     case 8:
-       maxseclen = ak_libakrypt_get_option_by_name( "acpkm_section_magma_block_count" );
-       mcount = ak_libakrypt_get_option_by_name( "magma_cipher_resource" )/maxseclen;
+       maxseclen = bkey->options.acpkm_section_block_count;
+       mcount = bkey->options.cipher_resource/maxseclen;
        #ifdef AK_LITTLE_ENDIAN
          ctr[0] = ((ak_uint64 *)iv)[0] << 32;
        #else
@@ -178,8 +423,8 @@
       break;
 
     case 16:
-       maxseclen = ak_libakrypt_get_option_by_name( "acpkm_section_kuznechik_block_count" );
-       mcount = ak_libakrypt_get_option_by_name( "kuznechik_cipher_resource" )/maxseclen;
+       maxseclen = bkey->options.acpkm_section_block_count;
+       mcount = bkey->options.cipher_resource/maxseclen;
        ctr[1] = ((ak_uint64 *) iv)[0];
       break;
     default: return ak_error_message( ak_error_wrong_block_cipher,
@@ -207,48 +452,93 @@
  /* и меняем ресурс для производного ключа */
   nkey.key.resource.value.counter = maxseclen;
 
- /* дальнейшие криптографические действия применяются к новому экземпляру ключа */
-  sections = ( ssize_t )( size/section_size );
-  tail = ( ssize_t )( size - ( size_t )( sections*seclen )*nkey.bsize );
-  if( sections > 0 ) {
-    do{
-       switch( nkey.bsize ) { /* обрабатываем одну секцию */
-         case 8: for( j = 0; j < seclen; j++ ) acpkm_block64; break;
-         case 16: for( j = 0; j < seclen; j++ ) acpkm_block128; break;
-         default: ak_error_message( ak_error_wrong_block_cipher,
-                                           __func__ , "incorrect block size of block cipher key" );
-       }
-      /* вычисляем следующий ключ */
-       if(( error = ak_bckey_next_acpkm_key( &nkey )) != ak_error_ok ) {
-         ak_error_message_fmt( error, __func__, "incorrect key generation after %u sections",
-                                                                         (unsigned int) sections );
-         goto labex;
-       }
-    } while( --sections > 0 );
-  } /* конец обработки случая, когда sections > 0 */
-
-  if( tail ) { /* теперь обрабатываем фрагмент данных, не кратный длине секции */
-    if(( seclen = tail/(ssize_t)( nkey.bsize )) > 0 ) {
-       switch( nkey.bsize ) { /* обрабатываем данные, кратные длине блока */
-         case 8: for( j = 0; j < seclen; j++ ) acpkm_block64; break;
-         case 16: for( j = 0; j < seclen; j++ ) acpkm_block128; break;
-         default: ak_error_message( ak_error_wrong_block_cipher,
-                                            __func__ , "incorrect block size of block cipher key" );
-       }
-    }
-  /* остался последний фрагмент, длина которого меньше длины блока
-                      в качестве гаммы мы используем старшие байты */
-    if(( tail -= seclen*(ssize_t)( nkey.bsize )) > 0 ) {
-      nkey.encrypt( &nkey.key, ctr, yaout );
-      for( j = 0; j < tail; j++ ) ((ak_uint8 *) outptr)[j] =
-                         ((ak_uint8 *)yaout)[(ssize_t)nkey.bsize-tail+j] ^ ((ak_uint8 *) inptr)[j];
-    }
-  }
+ /* дальнейшие криптографические действия применяются к новому экземпляру ключа;
+    каждый поток обрабатывает не менее одной секции */
+#ifdef AK_HAVE_PTHREAD_H
+  threads = ak_min( ak_min( threads, ( size/section_size )),
+                                                     ( size/nkey.bsize )/ak_bckey_thread_blocks );
+  if( threads > 1 ) error = ak_bckey_acpkm_sections_threads( bkey, &nkey, ctr,
+                                 (ak_uint64 *)in, (ak_uint64 *)out, size, section_size, threads );
+   else
+#else
+  (void)threads;
+#endif
+  error = ak_bckey_acpkm_sections( &nkey, ctr, (ak_uint64 *)in, (ak_uint64 *)out, size, section_size );
 
-  labex: ak_bckey_destroy( &nkey );
+  ak_bckey_destroy( &nkey );
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! В режиме `ACPKM` для шифрования используется операция гаммирования - операция сложения
+    открытого (зашифровываемого) текста с гаммой, вырабатываемой шифром, по модулю два.
+    Поэтому, для зашифрования и расшифрования информациии используется одна и та же функция.
+
+    В процессе шифрования исходные данные разбиваются на секции фиксированной длины, после чего
+    каждая секция шифруется на своем ключе. Длина секции является параметром алгоритма и
+    не должна превосходить величины, определяемой одной из следующих технических характеристик
+    (опций)
+
+     - `ackpm_section_magma_block_count`,
+     - `ackpm_section_kuznechik_block_count`.
+
+    Значение синхропосылки `iv` копируется во временную область памяти и, в ходе выполнения
+    функции, не изменяется. Повторный вызов функции ak_bckey_ctr_acpkm() с нулевым
+    указатетем на синхропосылу, как в случае функции ak_bckey_ctr(), не допускается.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования,
+    используемый для шифрования и порождения цепочки производных ключей.
+    @param in Указатель на область памяти, где хранятся входные
+    (зашифровываемые/расшифровываемые) данные
+    @param out Указатель на область памяти, куда помещаются выходные
+    (расшифровываемые/зашифровываемые) данные; этот указатель может совпадать с in
+    @param size Размер зашировываемых данных (в байтах). Длина зашифровываемых данных может
+    принимать любое значение, не превосходящее \f$ 2^{\frac{8n}{2}-1}\f$, где \f$ n \f$
+    длина блока алгоритма шифрования (8 или 16 байт).
+
+    @param section_size Размер одной секции в байтах. Данная величина должна быть кратна длине блока
+    используемого алгоритма шифрования.
+
+    @param iv имитовставка
+    @param iv_size длина имитовставки (в байтах)
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_ctr_acpkm( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                                 size_t section_size, ak_pointer iv, size_t iv_size)
+{
+ return ak_bckey_ctr_acpkm_common( bkey, in, out, size, section_size, iv, iv_size, 1 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция зашифровывает (расшифровывает) данные в режиме `ACPKM` так же, как функция
+    ak_bckey_ctr_acpkm(), и вырабатывает тот же самый результат. Данные большой длины
+    разбиваются на фрагменты, состоящие из целого числа секций; для каждого фрагмента
+    вычисляются начальное значение счетчика и ключ его первой секции, после чего фрагменты
+    обрабатываются одновременно в `threads` потоках. Каждый поток обрабатывает не менее
+    4096 блоков; если библиотека собрана без поддержки pthreads, то шифрование выполняется
+    в вызывающем потоке. Ресурс ключа `bkey` уменьшается один раз, до начала обработки данных.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param in Указатель на область памяти, где хранятся входные данные.
+    @param out Указатель на область памяти, куда помещаются выходные данные
+    (этот указатель может совпадать с `in`).
+    @param size Размер обрабатываемых данных (в байтах).
+    @param section_size Размер одной секции в байтах (кратен длине блока).
+    @param iv Указатель на синхропосылку.
+    @param iv_size Длина синхропосылки (в байтах).
+    @param threads Максимальное количество используемых потоков.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_ctr_acpkm_threads( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                          size_t section_size, ak_pointer iv, size_t iv_size, const size_t threads )
+{
+ return ak_bckey_ctr_acpkm_common( bkey, in, out, size, section_size, iv, iv_size, threads );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  bool_t ak_libakrypt_test_acpkm( void )
 {
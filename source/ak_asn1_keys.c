@@ -114,6 +114,39 @@
 
 /* ----------------------------------------------------------------------------------------------- */
                   /* Функции выработки и сохранения производных ключей */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Создание ключей `eKey` и `iKey` из выработанного ранее ключевого вектора.
+    \param ekey контекст создаваемого ключа шифрования
+    \param ikey контекст создаваемого ключа имитозащиты
+    \param oid идентификатор алгоритма блочного шифрования, для которого создается ключевая пара
+    \param derived_key ключевой вектор длины 64 октета, `eKey || iKey`
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+   возвращается код ошибки.                                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_create_key_pair_from_vector( ak_bckey ekey, ak_bckey ikey, ak_oid oid,
+                                                                     const ak_uint8 *derived_key )
+{
+  int error = ak_error_ok;
+
+   if(( error = ak_bckey_create_oid( ekey, oid )) != ak_error_ok )
+     return ak_error_message( error, __func__, "incorrect creation of encryption cipher key" );
+   if(( error = ak_bckey_set_key( ekey, (ak_pointer) derived_key, 32 )) != ak_error_ok ) {
+     ak_bckey_destroy( ekey );
+     return ak_error_message( error, __func__, "incorrect assigning a value to encryption key" );
+   }
+   if(( error = ak_bckey_create_oid( ikey, oid )) != ak_error_ok ) {
+     ak_bckey_destroy( ekey );
+     return ak_error_message( error, __func__, "incorrect creation of integrity key" );
+   }
+   if(( error = ak_bckey_set_key( ikey, (ak_pointer)( derived_key+32 ), 32 )) != ak_error_ok ) {
+     ak_bckey_destroy( ikey );
+     ak_bckey_destroy( ekey );
+     return ak_error_message( error, __func__, "incorrect assigning a value to integrity key" );
+   }
+
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Для выработки ключей `eKey` и `iKey` используется алгоритм PBKDF2, реализуемый при
     помощи функции хеширования Стрибог512 (см. Р 50.1.111-2016), т.е.
@@ -158,20 +191,10 @@
       return ak_error_message( error, __func__, "incorrect creation of derived key" );
 
  /* 2. инициализируем контексты ключа шифрования контента и ключа имитозащиты */
-   if(( error = ak_bckey_create_oid( ekey, oid )) != ak_error_ok )
-     return ak_error_message( error, __func__, "incorrect creation of encryption cipher key" );
-   if(( error = ak_bckey_set_key( ekey, derived_key, 32 )) != ak_error_ok ) {
-     ak_bckey_destroy( ekey );
-     return ak_error_message( error, __func__, "incorrect assigning a value to encryption key" );
-   }
-   if(( error = ak_bckey_create_oid( ikey, oid )) != ak_error_ok ) {
-     ak_bckey_destroy( ekey );
-     return ak_error_message( error, __func__, "incorrect creation of integrity key" );
-   }
-   if(( error = ak_bckey_set_key( ikey, derived_key+32, 32 )) != ak_error_ok ) {
-     ak_bckey_destroy( ikey );
-     ak_bckey_destroy( ekey );
-     return ak_error_message( error, __func__, "incorrect assigning a value to integrity key" );
+   if(( error = ak_bckey_create_key_pair_from_vector( ekey, ikey, oid,
+                                                                   derived_key )) != ak_error_ok ) {
+     memset( derived_key, 0, sizeof( derived_key ));
+     return ak_error_message( error, __func__, "incorrect creation of derived key pair" );
    }
   /* очищаем использованную память */
    ak_ptr_wipe( derived_key, sizeof( derived_key ), &ikey->key.generator );
@@ -365,36 +388,30 @@
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! Для ввода пароля используется функция, на которую указывает ak_function_defaut_password_read.
-    Если этот указатель не установлен (то есть равен NULL), то выполняется чтение пароля
-    из терминала, владеющего текущим процессом, с помощью функции ak_password_read().
-
-    Формат ASN.1 структуры, хранящей параметры восстановления производных ключей,
+/*! \brief Функция считывает из ASN.1 дерева параметры выработки производных ключей из пароля.
+    \details Формат ASN.1 структуры, хранящей параметры восстановления производных ключей,
     содержится в документации к функции ak_asn1_add_derived_keys_from_password().
+    Указатель `salt` указывает на память, принадлежащую ASN.1 дереву.
 
  \param akey контекст ASN.1 дерева, содержащий информацию о ключе (структура `BasicKeyMetaData`)
- \param ekey контекст ключа шифрования
- \param ikey контекст ключа имитозащиты
+ \param eoid указатель, куда помещается идентификатор алгоритма блочного шифрования
+ \param salt указатель, куда помещается указатель на инициализационный вектор
+ \param salt_size указатель, куда помещается длина инициализационного вектора
+ \param iter указатель, куда помещается количество итераций алгоритма pbkdf2
  \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
    возвращается код ошибки.                                                                        */
 /* ----------------------------------------------------------------------------------------------- */
- static int ak_asn1_get_derived_keys( ak_asn1 akey, ak_bckey ekey, ak_bckey ikey )
+ static int ak_asn1_get_derived_keys_parameters( ak_asn1 akey, ak_oid *eoid,
+                                          ak_pointer *salt, size_t *salt_size, ak_uint32 *iter )
 {
-  size_t size = 0;
-  ak_uint32 u32 = 0;
   ak_asn1 asn = NULL;
-  char password[256];
-  ssize_t passlen = 0;
   ak_pointer ptr = NULL;
-  int error = ak_error_ok;
-  ak_oid eoid = NULL, oid = NULL;
+  ak_oid oid = NULL;
 
- /* получаем структуру с параметрами, необходимыми для восстановления ключа */
-  ak_asn1_first( akey );
-  if( akey->count == 1 ) return ak_asn1_get_derived_keys_unencrypted( akey, ekey, ikey );
   if( akey->count != 2 ) return ak_error_invalid_asn1_count;
 
  /* проверяем параметры */
+  ak_asn1_first( akey );
   if(( DATA_STRUCTURE( akey->current->tag ) != PRIMITIVE ) ||
      ( TAG_NUMBER( akey->current->tag ) != TOBJECT_IDENTIFIER )) return ak_error_invalid_asn1_tag;
   ak_tlv_get_oid( akey->current, &ptr );
@@ -416,8 +433,8 @@
      ( TAG_NUMBER( asn->current->tag ) != TOBJECT_IDENTIFIER )) return ak_error_invalid_asn1_tag;
 
   ak_tlv_get_oid( asn->current, &ptr );
-  eoid = ak_oid_find_by_id( ptr ); /* идентификатор ключа блочного шифрования */
-  if(( eoid->engine != block_cipher ) || ( eoid->mode != algorithm ))
+  *eoid = ak_oid_find_by_id( ptr ); /* идентификатор ключа блочного шифрования */
+  if(( (*eoid)->engine != block_cipher ) || ( (*eoid)->mode != algorithm ))
     return ak_error_invalid_asn1_tag;
 
  /* получаем доступ к параметрам алгоритма генерации производных ключей */
@@ -438,12 +455,56 @@
   ak_asn1_next( asn );
   if(( DATA_STRUCTURE( asn->current->tag ) != PRIMITIVE ) ||
      ( TAG_NUMBER( asn->current->tag ) != TOCTET_STRING )) return ak_error_invalid_asn1_tag;
-  ak_tlv_get_octet_string( asn->current, &ptr, &size ); /* инициализационный вектор */
+  ak_tlv_get_octet_string( asn->current, salt, salt_size ); /* инициализационный вектор */
 
   ak_asn1_next( asn );
   if(( DATA_STRUCTURE( asn->current->tag ) != PRIMITIVE ) ||
      ( TAG_NUMBER( asn->current->tag ) != TINTEGER )) return ak_error_invalid_asn1_tag;
-  ak_tlv_get_uint32( asn->current, &u32 ); /* число циклов */
+  ak_tlv_get_uint32( asn->current, iter ); /* число циклов */
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Для ввода пароля используется функция, на которую указывает ak_function_defaut_password_read.
+    Если этот указатель не установлен (то есть равен NULL), то выполняется чтение пароля
+    из терминала, владеющего текущим процессом, с помощью функции ak_password_read().
+
+    Если указатель `derived_key` отличен от `NULL`, то пароль не запрашивается, а производные
+    ключи создаются из заданного ключевого вектора, выработанного ранее из пароля
+    (см. функцию ak_skey_import_from_files()).
+
+    Формат ASN.1 структуры, хранящей параметры восстановления производных ключей,
+    содержится в документации к функции ak_asn1_add_derived_keys_from_password().
+
+ \param akey контекст ASN.1 дерева, содержащий информацию о ключе (структура `BasicKeyMetaData`)
+ \param ekey контекст ключа шифрования
+ \param ikey контекст ключа имитозащиты
+ \param derived_key выработанный ранее ключевой вектор длины 64 октета или `NULL`
+ \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+   возвращается код ошибки.                                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_asn1_get_derived_keys( ak_asn1 akey, ak_bckey ekey, ak_bckey ikey,
+                                                                     const ak_uint8 *derived_key )
+{
+  size_t size = 0;
+  ak_uint32 u32 = 0;
+  char password[256];
+  ssize_t passlen = 0;
+  ak_pointer ptr = NULL;
+  int error = ak_error_ok;
+  ak_oid eoid = NULL;
+
+ /* получаем структуру с параметрами, необходимыми для восстановления ключа */
+  ak_asn1_first( akey );
+  if( akey->count == 1 ) return ak_asn1_get_derived_keys_unencrypted( akey, ekey, ikey );
+  if(( error = ak_asn1_get_derived_keys_parameters( akey,
+                                                  &eoid, &ptr, &size, &u32 )) != ak_error_ok )
+    return error;
+
+ /* ключевой вектор уже выработан */
+  if( derived_key != NULL )
+    return ak_bckey_create_key_pair_from_vector( ekey, ikey, eoid, derived_key );
 
  /* вырабатываем производную ключевую информацию */
   if(( passlen = ak_function_default_password_read( ak_default_password_prompt,
@@ -1210,8 +1271,12 @@
    if(( DATA_STRUCTURE( asn->current->tag ) != PRIMITIVE ) ||
             ( TAG_NUMBER( asn->current->tag ) != TINTEGER )) return ak_error_invalid_asn1_tag;
    ak_tlv_get_uint32( asn->current, &u32 );  /* теперь u32 содержит флаг совместимости с openssl */
-   if( u32 !=  (oc = ( ak_uint32 )ak_libakrypt_get_option_by_name( "openssl_compability" ))) /* текущее значение */
+   if( u32 !=  (oc = ( ak_uint32 )ak_libakrypt_get_option_by_name( "openssl_compability" ))) { /* текущее значение */
      ak_libakrypt_set_openssl_compability( u32 );
+    /* ключи расшифрования и имитозащиты должны использовать измененное значение опции */
+     ak_bckey_load_options( ekey );
+     ak_bckey_load_options( ikey );
+   }
 
   /* расшифровываем и проверяем имитовставку */
    ak_asn1_next( asn );
@@ -1268,7 +1333,13 @@
    }
 
   /* восстанавливаем изначальный режим совместимости и выходим */
-   labexit: if( u32 != oc ) ak_libakrypt_set_openssl_compability( oc );
+   labexit: if( u32 != oc ) {
+     ak_libakrypt_set_openssl_compability( oc );
+     ak_bckey_load_options( ekey );
+     ak_bckey_load_options( ikey );
+   }
+  /* импортированный ключ использует значения опций, действующие после его импорта */
+   if( skey->oid->engine == block_cipher ) ak_bckey_load_options(( ak_bckey )skey );
  return error;
 }
 
@@ -1299,11 +1370,13 @@
    \param basicKey Указатель на ASN.1 структуру с информацией для восстановления ключа
     шифрования контента
    \param content Указатель на ASN.1 структуру, соержащую данные
+   \param derived_key Выработанный ранее из пароля ключевой вектор длины 64 октета; если
+   указатель равен `NULL`, то пароль запрашивается у пользователя
    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
    возвращается код ошибки.                                                                        */
 /* ----------------------------------------------------------------------------------------------- */
  static int ak_skey_create_form_asn1_content( ak_pointer *key, oid_engines_t engine,
-                                                                ak_asn1 basicKey, ak_asn1 content )
+                             ak_asn1 basicKey, ak_asn1 content, const ak_uint8 *derived_key )
 {
   size_t len = 0;
   ak_oid oid = NULL;
@@ -1471,7 +1544,8 @@
   if( basicKey != NULL ) {
 
    /* получаем производные ключи шифрования и имитозащиты */
-    if(( error = ak_asn1_get_derived_keys( basicKey, &ekey, &ikey )) != ak_error_ok ) {
+    if(( error = ak_asn1_get_derived_keys( basicKey,
+                                                   &ekey, &ikey, derived_key )) != ak_error_ok ) {
       ak_error_message( error, __func__, "incorrect creation of derived keys" );            
       goto lab1;
     }
@@ -1536,7 +1610,8 @@
                              /* проверку ожидаемого типа механизма не проводим */
                    undefined_engine,  /* и создаем объект в оперативной памяти */
                    basicKey, /* после создания будем присваивать ключ */
-                   content   /* указатель на ключевые данные */
+                   content,  /* указатель на ключевые данные */
+                   NULL      /* пароль запрашивается у пользователя */
        )) != ak_error_ok ) {
         ak_error_message( error, __func__, "incorrect creation of a new secret key");
      goto lab1;
@@ -1586,7 +1661,8 @@
                              /* проверку ожидаемого типа механизма не проводим */
                    undefined_engine,  /* и создаем объект в оперативной памяти */
                    NULL,     /* после создания ключ присваивать не будем */
-                   content   /* указатель на ключевые данные */
+                   content,  /* указатель на ключевые данные */
+                   NULL
        )) != ak_error_ok ) {
         ak_error_message( error, __func__, "incorrect creation of a new secret key");
      goto lab1;
@@ -1637,7 +1713,7 @@
                    engine,   /* ожидаем объект заданного типа */
                    basicKey, /* после инициализации будем присваивать ключ */
                              /* указатель на ключевые данные */
-                   content )) != ak_error_ok ) {
+                   content, NULL )) != ak_error_ok ) {
      ak_error_message( error, __func__, "incorrect creation of a new secret key");
      goto lab1;
    }
@@ -1646,6 +1722,163 @@
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Данные ключевого контейнера, импортируемого функцией ak_skey_import_from_files(). */
+ typedef struct skey_import_item {
+  /*! \brief ASN.1 дерево, содержащее ключевой контейнер. */
+   ak_asn1 asn;
+  /*! \brief Информация о ключе доступа к контейнеру (структура `BasicKeyMetaData`). */
+   ak_asn1 basicKey;
+  /*! \brief Ключевые данные. */
+   ak_asn1 content;
+  /*! \brief Задание на выработку ключевого вектора; для незашифрованного контейнера `NULL`. */
+   ak_pbkdf2_task task;
+  /*! \brief Пароль пользователя. */
+   char password[256];
+  /*! \brief Ключевой вектор, выработанный из пароля. */
+   ak_uint8 derived_key[64];
+ } *ak_skey_import_item;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция выполняет те же действия, что и функция ak_skey_import_from_file(), для массива
+    ключевых контейнеров. Импорт выполняется в три этапа:
+     - в вызывающем потоке последовательно считываются все контейнеры и для каждого
+       зашифрованного контейнера запрашивается пароль пользователя;
+     - из всех паролей одновременно вырабатываются ключевые векторы с помощью функции
+       ak_hmac_pbkdf2_streebog512_tasks(); этот этап занимает основное время импорта
+       и выполняется не более, чем в `threads` потоках;
+     - в вызывающем потоке инициализируются контексты и им присваиваются значения ключей.
+
+    Если хотя бы один из ключей не может быть импортирован, то все созданные функцией
+    контексты уничтожаются.
+
+    \param ctx Массив указателей на контексты секретных ключей; контексты должны быть
+    не инициализированы до вызова функции
+    \param engine Тип криптографического алгоритма, для которого создаются контексты.
+    Если это значение отлично от типа, хранящегося в ключевом контейнере, то возбуждается ошибка
+    \param filenames Массив имен файлов, в которых хранятся данные
+    \param count Количество импортируемых ключей
+    \param threads Максимальное количество потоков, используемых для выработки ключевых векторов
+    \return Функция возвращает \ref ak_error_ok (ноль) в случае успеха, в случае неудачи
+   возвращается код ошибки.                                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_skey_import_from_files( ak_pointer *ctx, oid_engines_t engine,
+                                const char **filenames, const size_t count, const size_t threads )
+{
+  size_t size = 0;
+  ak_uint32 iter = 0;
+  ak_oid eoid = NULL;
+  ssize_t passlen = 0;
+  ak_pointer key = NULL;
+  struct random generator;
+  int error = ak_error_ok;
+  ak_pbkdf2_task tasks = NULL;
+  ak_skey_import_item item = NULL, items = NULL;
+  size_t idx = 0, created = 0, ntasks = 0;
+
+   if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                       "using null pointer to array of contexts" );
+   if( filenames == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                      "using null pointer to array of filenames" );
+   if( !count ) return ak_error_message( ak_error_zero_length, __func__,
+                                                                "using empty array of filenames" );
+   if( engine == undefined_engine ) return ak_error_message( ak_error_undefined_value, __func__,
+                                                        "using undefined type of secret keys" );
+   if(( error = ak_random_create_lcg( &generator )) != ak_error_ok )
+     return ak_error_message( error, __func__, "incorrect creation of random generator" );
+   if((( items = calloc( count, sizeof( struct skey_import_item ))) == NULL ) ||
+      (( tasks = calloc( count, sizeof( struct pbkdf2_task ))) == NULL )) {
+     ak_error_message( error = ak_error_out_of_memory, __func__,
+                                                                 "incorrect memory allocation" );
+     goto lab1;
+   }
+
+  /* 1. считываем контейнеры и пароли к зашифрованным контейнерам */
+   for( idx = 0; idx < count; idx++ ) {
+      item = items + idx;
+      if( filenames[idx] == NULL ) {
+        ak_error_message_fmt( error = ak_error_null_pointer, __func__,
+                                           "using null pointer to filename %u", (unsigned int)idx );
+        goto lab1;
+      }
+      if(( error = ak_asn1_import_from_file( item->asn = ak_asn1_new(),
+                                                         filenames[idx], NULL )) != ak_error_ok ) {
+        ak_error_message_fmt( error, __func__,
+                               "incorrect reading of ASN.1 context from %s file", filenames[idx] );
+        goto lab1;
+      }
+      ak_asn1_first( item->asn );
+      if( !ak_tlv_check_libakrypt_container( item->asn->current,
+                                                            &item->basicKey, &item->content )) {
+        ak_error_message_fmt( error = ak_error_invalid_asn1_content, __func__,
+                                   "incorrect format of secret key container %s", filenames[idx] );
+        goto lab1;
+      }
+      if( item->basicKey->count == 1 ) continue; /* контейнер не зашифрован */
+
+      item->task = tasks + ntasks;
+      if(( error = ak_asn1_get_derived_keys_parameters( item->basicKey,
+                                        &eoid, &item->task->salt, &size, &iter )) != ak_error_ok ) {
+        ak_error_message_fmt( error, __func__,
+                                   "incorrect reading of derived key parameters from %s file",
+                                                                                  filenames[idx] );
+        goto lab1;
+      }
+      if(( passlen = ak_function_default_password_read( ak_default_password_prompt,
+                        item->password, sizeof( item->password ),
+                                             ak_default_password_interpretation )) < ak_error_ok ) {
+        ak_error_message( error = ak_error_get_value(), __func__, "incorrect password reading" );
+        goto lab1;
+      }
+     /* длина инициализационного вектора выбирается так же,
+                                        как и в функции ak_bckey_create_key_pair_from_password() */
+      item->task->salt_size = sizeof( ak_uint8 * );
+      item->task->pass = item->password;
+      item->task->pass_size = (size_t) passlen;
+      item->task->cnt = iter;
+      item->task->dklen = sizeof( item->derived_key );
+      item->task->out = item->derived_key;
+      ntasks++;
+   }
+
+  /* 2. вырабатываем ключевые векторы из всех паролей */
+   if( ntasks > 0 ) {
+     if(( error = ak_hmac_pbkdf2_streebog512_tasks( tasks, ntasks, threads )) != ak_error_ok ) {
+       ak_error_message( error, __func__, "incorrect creation of derived keys" );
+       goto lab1;
+     }
+   }
+
+  /* 3. создаем ключи и присваиваем им значения */
+   for( created = 0; created < count; created++ ) {
+      item = items + created;
+      key = ctx[created];
+      if(( error = ak_skey_create_form_asn1_content( &key, engine, item->basicKey, item->content,
+                           item->task == NULL ? NULL : item->derived_key )) != ak_error_ok ) {
+        ak_error_message_fmt( error, __func__,
+                            "incorrect creation of a secret key from %s file", filenames[created] );
+        goto lab1;
+      }
+   }
+
+  /* удаляем созданные ключи в случае ошибки и очищаем память */
+   lab1:
+    if(( error != ak_error_ok ) && ( created > 0 )) {
+      for( idx = 0; idx < created; idx++ )
+         ((ak_skey)ctx[idx])->oid->func.first.destroy( ctx[idx] );
+    }
+    if( items != NULL ) {
+      for( idx = 0; idx < count; idx++ )
+         if( items[idx].asn != NULL ) ak_asn1_delete( items[idx].asn );
+      ak_ptr_wipe( items, count*sizeof( struct skey_import_item ), &generator );
+      free( items );
+    }
+    if( tasks != NULL ) free( tasks );
+    ak_random_destroy( &generator );
+
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  int ak_skey_delete( ak_pointer ctx )
 {
@@ -4,7 +4,10 @@
 /*  Файл ak_bckey.c                                                                                */
 /*  - содержит реализацию общих функций для алгоритмов блочного шифрования.                        */
 /* ----------------------------------------------------------------------------------------------- */
- #include <libakrypt.h>
+ #include <libakrypt-internal.h>
+#ifdef AK_HAVE_PTHREAD_H
+ #include <pthread.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция устанавливает параметры алгоритма блочного шифрования, передаваемые в качестве
@@ -13,6 +16,8 @@
 
     - bkey.encrypt -- алгоритм зашифрования одного блока
     - bkey.decrypt -- алгоритм расшифрования одного блока
+    - bkey.encrypt_blocks -- алгоритм зашифрования нескольких независимых блоков
+    - bkey.decrypt_blocks -- алгоритм расшифрования нескольких независимых блоков
     - bkey.shedule_keys -- алгоритм развертки ключа и генерации раундовых ключей
     - bkey.delete_keys -- функция удаления раундовых ключей
 
@@ -52,12 +57,46 @@
   bkey->ivector_size =  0;
   bkey->encrypt =       NULL;
   bkey->decrypt =       NULL;
+  bkey->encrypt_blocks = NULL;
+  bkey->decrypt_blocks = NULL;
   bkey->schedule_keys = NULL;
   bkey->delete_keys =   NULL;
 
+ /* фиксируем значения опций, используемых режимами шифрования */
+  ak_bckey_load_options( bkey );
+
  return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция сохраняет в контексте ключа текущие значения опций библиотеки, используемых
+    режимами шифрования. Функция вызывается при создании ключа и при каждом присвоении ключу
+    значения, поэтому ключ использует значения опций, действовавшие в момент присвоения
+    ему значения; изменение опций после этого момента не влияет на работу с ключом
+    до следующего присвоения значения.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_bckey_load_options( ak_bckey bkey )
+{
+  bkey->options.openssl_compability =
+                        (int) ak_libakrypt_get_option_by_index( ak_option_openssl_compability );
+  switch( bkey->bsize ) {
+    case  8: bkey->options.acpkm_section_block_count =
+                      ak_libakrypt_get_option_by_index( ak_option_acpkm_section_magma_block_count );
+             bkey->options.cipher_resource =
+                                ak_libakrypt_get_option_by_index( ak_option_magma_cipher_resource );
+             break;
+    case 16: bkey->options.acpkm_section_block_count =
+                  ak_libakrypt_get_option_by_index( ak_option_acpkm_section_kuznechik_block_count );
+             bkey->options.cipher_resource =
+                            ak_libakrypt_get_option_by_index( ak_option_kuznechik_cipher_resource );
+             break;
+    default: bkey->options.acpkm_section_block_count = 0;
+             bkey->options.cipher_resource = 0;
+  }
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param bkey контекст ключа алгоритма блочного шифрованния
     @return В случае успеха функция возввращает \ref ak_error_ok (ноль).
@@ -86,8 +125,11 @@
   bkey->bsize =            0;
   bkey->encrypt =       NULL;
   bkey->decrypt =       NULL;
+  bkey->encrypt_blocks = NULL;
+  bkey->decrypt_blocks = NULL;
   bkey->schedule_keys = NULL;
   bkey->delete_keys =   NULL;
+  memset( &bkey->options, 0, sizeof( bkey->options ));
 
  return error;
 }
@@ -153,8 +195,11 @@
   if( size != bkey->key.key_size ) return ak_error_message( ak_error_wrong_length, __func__,
                                        "using a constant value for secret key with wrong length" );
 
+ /* обновляем значения опций, используемых ключом */
+  ak_bckey_load_options( bkey );
+
  /* дополнительный переворот ключа для алгоритма Магма (в режиме совместимости с openssl) */
-  if(( ak_libakrypt_get_option_by_name( "openssl_compability" ) == 1 ) &&
+  if(( bkey->options.openssl_compability == 1 ) &&
                                          ( strncmp( bkey->key.oid->name[0], "magma", 5 ) == 0 )) {
     int i = 0;
     ak_uint8 revkey[32];
@@ -178,15 +223,11 @@
   }
  /* устанавливаем ресурс использования секретного ключа */
   switch( bkey->bsize ) {
-    case  8: if(( error = ak_skey_set_resource_values( &bkey->key,
-                      block_counter_resource, "magma_cipher_resource", 0, 0 )) != ak_error_ok )
-       ak_error_message( error, __func__, "incorrect assigning \"magma_cipher_resource\" option" );
-      break;
-
-    case 16: if(( error = ak_skey_set_resource_values( &bkey->key,
-                     block_counter_resource, "kuznechik_cipher_resource", 0, 0 )) != ak_error_ok )
-       ak_error_message( error, __func__,
-                                      "incorrect assigning \"kuznechik_cipher_resource\" option" );
+    case  8:
+    case 16: /* значение ресурса определено в момент присвоения ключа */
+      ak_skey_set_validity( &bkey->key, 0, 0 );
+      bkey->key.resource.value.type = block_counter_resource;
+      bkey->key.resource.value.counter = bkey->options.cipher_resource;
       break;
     default:  ak_error_message( error = ak_error_wrong_block_cipher_length, __func__,
                                                         "incorrect value of block cipher length" );
@@ -216,6 +257,8 @@
                                                         "using null pointer to secret key context" );
   if( generator == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                                           "using null pointer to random generator" );
+ /* обновляем значения опций, используемых ключом */
+  ak_bckey_load_options( bkey );
  /* присваиваем ключевой буффер */
   if(( error = ak_skey_set_key_random( &bkey->key, generator )) != ak_error_ok )
     return ak_error_message( error, __func__ , "incorrect assigning of random key data" );
@@ -227,15 +270,11 @@
 
  /* устанавливаем ресурс использования секретного ключа */
   switch( bkey->bsize ) {
-    case  8: if(( error = ak_skey_set_resource_values( &bkey->key,
-                      block_counter_resource, "magma_cipher_resource", 0, 0 )) != ak_error_ok )
-       ak_error_message( error, __func__, "incorrect assigning \"magma_cipher_resource\" option" );
-      break;
-
-    case 16: if(( error = ak_skey_set_resource_values( &bkey->key,
-                     block_counter_resource, "kuznechik_cipher_resource", 0, 0 )) != ak_error_ok )
-       ak_error_message( error, __func__,
-                                      "incorrect assigning \"kuznechik_cipher_resource\" option" );
+    case  8:
+    case 16: /* значение ресурса определено в момент присвоения ключа */
+      ak_skey_set_validity( &bkey->key, 0, 0 );
+      bkey->key.resource.value.type = block_counter_resource;
+      bkey->key.resource.value.counter = bkey->options.cipher_resource;
       break;
     default:  ak_error_message( error = ak_error_wrong_block_cipher_length, __func__,
                                                         "incorrect value of block cipher length" );
@@ -272,6 +311,8 @@
  /* проверяем входные данные */
   if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                         "using null pointer to secret key context" );
+ /* обновляем значения опций, используемых ключом */
+  ak_bckey_load_options( bkey );
  /* присваиваем ключевой буффер */
   if(( error = ak_skey_set_key_from_password( &bkey->key,
                                                 pass, pass_size, salt, salt_size )) != ak_error_ok )
@@ -284,15 +325,11 @@
 
  /* устанавливаем ресурс использования секретного ключа */
   switch( bkey->bsize ) {
-    case  8: if(( error = ak_skey_set_resource_values( &bkey->key,
-                      block_counter_resource, "magma_cipher_resource", 0, 0 )) != ak_error_ok )
-       ak_error_message( error, __func__, "incorrect assigning \"magma_cipher_resource\" option" );
-      break;
-
-    case 16: if(( error = ak_skey_set_resource_values( &bkey->key,
-                     block_counter_resource, "kuznechik_cipher_resource", 0, 0 )) != ak_error_ok )
-       ak_error_message( error, __func__,
-                                      "incorrect assigning \"kuznechik_cipher_resource\" option" );
+    case  8:
+    case 16: /* значение ресурса определено в момент присвоения ключа */
+      ak_skey_set_validity( &bkey->key, 0, 0 );
+      bkey->key.resource.value.type = block_counter_resource;
+      bkey->key.resource.value.counter = bkey->options.cipher_resource;
       break;
     default:  ak_error_message( error = ak_error_wrong_block_cipher_length, __func__,
                                                         "incorrect value of block cipher length" );
@@ -342,8 +379,363 @@
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! В отличие от функции ak_bckey_create_and_set_bckey() значение ключа копируется без
+    какого-либо преобразования, а опции создаваемого ключа совпадают с опциями ключа `rkey`.
+    Созданный ключ имеет собственный генератор масок, поэтому копия может использоваться
+    в отдельном потоке одновременно с исходным ключом.
+
+    @param bkey Контекст создаваемого ключа.
+    @param rkey Контекст ключа, значение которого копируется.
+
+    @return В случае успеха возвращается значение \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_create_copy( ak_bckey bkey, ak_bckey rkey )
+{
+  ak_oid oid = NULL;
+  int error = ak_error_ok;
+  if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                              "using null pointer to left block cipher context" );
+  if( rkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                             "using null pointer to right block cipher context" );
+  if(( oid = rkey->key.oid ) == NULL )
+    return ak_error_message( ak_error_wrong_oid, __func__,
+                             "using null pointer to internal oid in right block cipher context" );
+  if( oid->func.first.create == NULL )
+    return ak_error_message( ak_error_undefined_function, __func__,
+                          "using null pointer to create function in right block cipher context" );
+ /* создаем объект */
+  if(( error = ((ak_function_bckey_create *)oid->func.first.create)( bkey )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect creation of left block cipher context" );
+  bkey->options = rkey->options;
+
+ /* копируем ключ (значение уже развернуто, поэтому ak_bckey_set_key() не используется) */
+  if(( error = rkey->key.unmask( &rkey->key )) != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect unmasking block cipher context" );
+    goto  labex;
+  }
+  error = ak_skey_set_key( &bkey->key, rkey->key.key, rkey->key.key_size );
+  rkey->key.set_mask( &rkey->key );
+  if( error != ak_error_ok ) {
+    ak_error_message( error, __func__, "incorrect assigning a new key value" );
+    goto labex;
+  }
+  if(( bkey->schedule_keys != NULL ) &&
+                                  (( error = bkey->schedule_keys( &bkey->key )) != ak_error_ok )) {
+    ak_error_message( error, __func__, "incorrect execution of key scheduling procedure" );
+    goto labex;
+  }
+  bkey->key.resource = rkey->key.resource;
+
+ return error;
+
+  labex:
+   ak_bckey_destroy( bkey );
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                             теперь реализация режимов шифрования                                */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество значений счетчика, зашифровываемых за один вызов многоблочной функции
+    в режиме гаммирования. */
+ #define ak_bckey_ctr_blocks  (16)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обработки последовательности блоков в режимах с обратной связью по шифртексту.
+
+    Функция вычисляет `out[k] = func( in[k] ) ^ c[k-z]`, если флаг `cbc` истинен
+    (расшифрование в режиме простой замены с зацеплением), и `out[k] = in[k] ^ func( c[k-z] )`
+    в противном случае (расшифрование в режиме гаммирования с обратной связью по шифртексту).
+    Здесь `c[k]` есть k-й блок шифртекста `in`, а `z` блоков, предшествующих первому блоку
+    шифртекста, содержатся в массиве `feedback`. Поскольку все блоки шифртекста известны заранее,
+    функция `func` вызывается сразу для группы из нескольких независимых блоков.
+
+    Блоки шифртекста копируются во внутренний буффер до записи результата, поэтому указатели
+    `in` и `out` могут совпадать. После завершения работы массив `feedback` содержит
+    `z` последних блоков шифртекста.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param func Многоблочная функция зашифрования или расшифрования.
+    @param feedback Массив из `fwords` 64-х битных слов, предшествующих шифртексту.
+    @param fwords Длина массива `feedback` (не более восьми слов).
+    @param in Указатель на шифртекст.
+    @param out Указатель на область памяти, куда помещается открытый текст.
+    @param words Количество обрабатываемых 64-х битных слов (кратно длине блока).
+    @param cbc Флаг режима простой замены с зацеплением.                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_feedback_blocks( ak_bckey bkey, ak_function_bckey_blocks *func,
+                      ak_uint64 *feedback, const size_t fwords, ak_uint64 *in, ak_uint64 *out,
+                                                                 size_t words, const bool_t cbc )
+{
+  size_t j, n, bw = bkey->bsize >> 3;
+  ak_uint64 chain[ 8 + 2*ak_bckey_ctr_blocks ], gamma[ 2*ak_bckey_ctr_blocks ];
+
+  memcpy( chain, feedback, fwords*sizeof( ak_uint64 ));
+  while( words > 0 ) {
+    n = ak_min( words, 2*ak_bckey_ctr_blocks );
+    memcpy( chain +fwords, in, n*sizeof( ak_uint64 ));
+    if( cbc ) {
+      func( &bkey->key, chain +fwords, gamma, n/bw );
+      for( j = 0; j < n; j++ ) out[j] = gamma[j] ^ chain[j];
+    } else {
+        func( &bkey->key, chain, gamma, n/bw );
+        for( j = 0; j < n; j++ ) out[j] = gamma[j] ^ chain[fwords +j];
+      }
+    memmove( chain, chain +n, fwords*sizeof( ak_uint64 ));
+    in += n; out += n; words -= n;
+  }
+  memcpy( feedback, chain, fwords*sizeof( ak_uint64 ));
+}
+
+#ifdef AK_HAVE_PTHREAD_H
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Фрагмент шифртекста, расшифровываемый отдельным потоком. */
+ typedef struct bckey_feedback_segment {
+  /*! \brief Копия ключа, используемая потоком (многоблочные функции алгоритма Магма изменяют
+      состояние генератора масок, поэтому каждый поток работает с собственным ключом). */
+   struct bckey key;
+  /*! \brief Многоблочная функция зашифрования или расшифрования. */
+   ak_function_bckey_blocks *func;
+  /*! \brief Блоки шифртекста, предшествующие фрагменту. */
+   ak_uint64 feedback[8];
+  /*! \brief Количество слов в массиве feedback. */
+   size_t fwords;
+  /*! \brief Указатель на шифртекст. */
+   ak_uint64 *in;
+  /*! \brief Указатель на открытый текст. */
+   ak_uint64 *out;
+  /*! \brief Количество обрабатываемых 64-х битных слов. */
+   size_t words;
+  /*! \brief Флаг режима простой замены с зацеплением. */
+   bool_t cbc;
+  /*! \brief Дескриптор потока. */
+   pthread_t handle;
+ } *ak_bckey_feedback_segment;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция потока: расшифровывает один фрагмент шифртекста. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void *ak_bckey_feedback_thread( void *ptr )
+{
+  ak_bckey_feedback_segment seg = ( ak_bckey_feedback_segment ) ptr;
+  ak_bckey_feedback_blocks( &seg->key, seg->func,
+                                  seg->feedback, seg->fwords, seg->in, seg->out, seg->words, seg->cbc );
+ return NULL;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Многопоточный вариант функции ak_bckey_feedback_blocks().
+
+    Шифртекст разбивается на `threads` фрагментов, длина каждого из которых кратна длине блока.
+    Блоки шифртекста, предшествующие каждому фрагменту, копируются до запуска потоков,
+    поэтому указатели `in` и `out` могут совпадать. Каждый фрагмент обрабатывается с
+    использованием собственной копии ключа. Если библиотека собрана без поддержки pthreads,
+    количество блоков недостаточно велико, копии ключа или потоки не удалось создать, обработка
+    выполняется в вызывающем потоке.                                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_feedback_blocks_threads( ak_bckey bkey, ak_function_bckey_blocks *func,
+                      ak_uint64 *feedback, const size_t fwords, ak_uint64 *in, ak_uint64 *out,
+                                         size_t words, const bool_t cbc, const size_t threads )
+{
+#ifndef AK_HAVE_PTHREAD_H
+  (void)threads;
+#else
+  size_t idx = 0, seglen = 0, created = 0,
+         tcount = ak_min( threads, ( words/( bkey->bsize >> 3 ))/ak_bckey_thread_blocks );
+  ak_bckey_feedback_segment segs = NULL;
+
+  if(( tcount > 1 ) &&
+     (( segs = malloc( tcount*sizeof( struct bckey_feedback_segment ))) != NULL )) {
+   /* каждый фрагмент получает собственную копию ключа */
+    for( created = 0; created < tcount; created++ )
+       if( ak_bckey_create_copy( &segs[created].key, bkey ) != ak_error_ok ) break;
+    if( created < tcount ) {
+      for( idx = 0; idx < created; idx++ ) ak_bckey_destroy( &segs[idx].key );
+      free( segs );
+      ak_bckey_feedback_blocks( bkey, func, feedback, fwords, in, out, words, cbc );
+      return;
+    }
+   /* длина фрагмента кратна длине блока, последний фрагмент содержит остаток */
+    seglen = ( words/( tcount*( bkey->bsize >> 3 )))*( bkey->bsize >> 3 );
+    for( idx = 0; idx < tcount; idx++ ) {
+       segs[idx].func = func;
+       segs[idx].fwords = fwords;
+       segs[idx].in = in +idx*seglen;
+       segs[idx].out = out +idx*seglen;
+       segs[idx].words = ( idx == tcount-1 ) ? words -idx*seglen : seglen;
+       segs[idx].cbc = cbc;
+       memcpy( segs[idx].feedback, idx ? segs[idx].in -fwords : feedback,
+                                                                     fwords*sizeof( ak_uint64 ));
+    }
+   /* все фрагменты, кроме первого, обрабатываются в отдельных потоках;
+      фрагменты, для которых не удалось создать поток, обрабатываются в вызывающем потоке */
+    for( idx = 1; idx < tcount; idx++ )
+       if( pthread_create( &segs[idx].handle, NULL, ak_bckey_feedback_thread, segs +idx ) != 0 )
+         segs[idx].func = NULL;
+    ak_bckey_feedback_thread( segs );
+    for( idx = 1; idx < tcount; idx++ ) {
+       if( segs[idx].func == NULL ) {
+         segs[idx].func = func;
+         ak_bckey_feedback_thread( segs +idx );
+       } else pthread_join( segs[idx].handle, NULL );
+    }
+    memcpy( feedback, segs[tcount-1].feedback, fwords*sizeof( ak_uint64 ));
+    for( idx = 0; idx < tcount; idx++ ) ak_bckey_destroy( &segs[idx].key );
+    free( segs );
+    return;
+  }
+#endif
+  ak_bckey_feedback_blocks( bkey, func, feedback, fwords, in, out, words, cbc );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Представление числового значения счетчика в том виде, в котором оно хранится
+    в блоке синхропосылки режима гаммирования. */
+#ifdef AK_LITTLE_ENDIAN
+ #define ak_bckey_ctr_value( x, oc ) ( (oc) ? bswap_64( x ) : (x) )
+#else
+ #define ak_bckey_ctr_value( x, oc ) ( (oc) ? (x) : bswap_64( x ) )
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифрования (расшифрования) `blocks` последовательных блоков в режиме
+    гаммирования с использованием многоблочной функции encrypt_blocks.
+
+    Функция вырабатывает группу последовательных значений счетчика, а потом зашифровывает
+    их за один вызов многоблочной функции. Первым значением счетчика является блок `ivector`;
+    после обработки данных блок `ivector` содержит значение счетчика, следующее за последним
+    использованным значением.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param ivector Текущее значение блока счетчика.
+    @param x Числовое значение изменяемой части счетчика.
+    @param oc Флаг режима совместимости с библиотекой openssl.
+    @param inptr Указатель на входные данные.
+    @param outptr Указатель на выходные данные.
+    @param blocks Количество обрабатываемых блоков.                                                */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_ctr_blocks_segment( ak_bckey bkey, ak_uint64 *ivector, ak_uint64 x,
+                          const int oc, ak_uint64 *inptr, ak_uint64 *outptr, ak_int64 blocks )
+{
+  ak_int64 j, n, bw = ( ak_int64 )( bkey->bsize >> 3 );
+  size_t w = ( bkey->bsize == 8 ) ? 0 : ( size_t ) oc;
+  ak_uint64 ctr[ 2*ak_bckey_ctr_blocks ], gamma[ 2*ak_bckey_ctr_blocks ];
+
+  while( blocks > 0 ) {
+    n = ak_min( blocks, 2*ak_bckey_ctr_blocks/bw );
+    for( j = 0; j < n; j++ ) {
+       ctr[bw*j] = ivector[0];
+       if( bw == 2 ) ctr[bw*j+1] = ivector[1];
+       ivector[w] = ak_bckey_ctr_value( ++x, oc );   /* здесь мы не учитываем знак переноса */
+    }
+    bkey->encrypt_blocks( &bkey->key, ctr, gamma, (size_t) n );
+    for( j = 0; j < bw*n; j++ ) outptr[j] = inptr[j] ^ gamma[j];
+    outptr += bw*n; inptr += bw*n;
+    blocks -= n;
+  }
+}
+
+#ifdef AK_HAVE_PTHREAD_H
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Фрагмент данных, обрабатываемый отдельным потоком в режиме гаммирования. */
+ typedef struct bckey_ctr_segment {
+  /*! \brief Копия ключа, используемая потоком. */
+   struct bckey key;
+  /*! \brief Значение блока счетчика для первого блока фрагмента. */
+   ak_uint64 ivector[2];
+  /*! \brief Числовое значение изменяемой части счетчика. */
+   ak_uint64 x;
+  /*! \brief Флаг режима совместимости с библиотекой openssl. */
+   int oc;
+  /*! \brief Указатель на входные данные. */
+   ak_uint64 *in;
+  /*! \brief Указатель на выходные данные. */
+   ak_uint64 *out;
+  /*! \brief Количество обрабатываемых блоков. */
+   ak_int64 blocks;
+  /*! \brief Флаг успешного создания потока. */
+   bool_t started;
+  /*! \brief Дескриптор потока. */
+   pthread_t handle;
+ } *ak_bckey_ctr_segment;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция потока: зашифровывает один фрагмент данных в режиме гаммирования. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void *ak_bckey_ctr_thread( void *ptr )
+{
+  ak_bckey_ctr_segment seg = ( ak_bckey_ctr_segment ) ptr;
+  ak_bckey_ctr_blocks_segment( &seg->key, seg->ivector, seg->x, seg->oc,
+                                                                seg->in, seg->out, seg->blocks );
+ return NULL;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Многопоточный вариант функции ak_bckey_ctr_blocks_segment().
+
+    Данные разбиваются на `threads` фрагментов; значение счетчика для первого блока каждого
+    фрагмента вычисляется заранее прибавлением к значению `x` номера этого блока, поэтому
+    результат совпадает с результатом последовательной обработки. Каждый фрагмент
+    обрабатывается с использованием собственной копии ключа. Если библиотека собрана
+    без поддержки pthreads, количество блоков недостаточно велико или копии ключа
+    не удалось создать, обработка выполняется в вызывающем потоке.                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_bckey_ctr_blocks_threads( ak_bckey bkey, ak_uint64 *ivector, ak_uint64 x,
+     const int oc, ak_uint64 *inptr, ak_uint64 *outptr, ak_int64 blocks, const size_t threads )
+{
+#ifndef AK_HAVE_PTHREAD_H
+  (void)threads;
+#else
+  size_t idx = 0, created = 0, tcount = ak_min( threads, ( size_t )blocks/ak_bckey_thread_blocks );
+  ak_int64 seglen = 0, bw = ( ak_int64 )( bkey->bsize >> 3 );
+  size_t w = ( bkey->bsize == 8 ) ? 0 : ( size_t ) oc;
+  ak_bckey_ctr_segment segs = NULL;
+
+  if(( tcount > 1 ) &&
+     (( segs = malloc( tcount*sizeof( struct bckey_ctr_segment ))) != NULL )) {
+   /* каждый фрагмент получает собственную копию ключа */
+    for( created = 0; created < tcount; created++ )
+       if( ak_bckey_create_copy( &segs[created].key, bkey ) != ak_error_ok ) break;
+    if( created < tcount ) {
+      for( idx = 0; idx < created; idx++ ) ak_bckey_destroy( &segs[idx].key );
+      free( segs );
+      ak_bckey_ctr_blocks_segment( bkey, ivector, x, oc, inptr, outptr, blocks );
+      return;
+    }
+    seglen = blocks/( ak_int64 )tcount;
+    for( idx = 0; idx < tcount; idx++ ) {
+       segs[idx].x = x + ( ak_uint64 )( seglen*( ak_int64 )idx );
+       segs[idx].ivector[0] = ivector[0];
+       segs[idx].ivector[1] = ( bw == 2 ) ? ivector[1] : 0;
+       if( idx ) segs[idx].ivector[w] = ak_bckey_ctr_value( segs[idx].x, oc );
+       segs[idx].oc = oc;
+       segs[idx].in = inptr + seglen*bw*( ak_int64 )idx;
+       segs[idx].out = outptr + seglen*bw*( ak_int64 )idx;
+       segs[idx].blocks = ( idx == tcount-1 ) ? blocks - seglen*( ak_int64 )idx : seglen;
+    }
+   /* первый фрагмент обрабатывается в вызывающем потоке, как и фрагменты,
+      для которых не удалось создать поток */
+    for( idx = 1; idx < tcount; idx++ )
+       segs[idx].started = ( pthread_create( &segs[idx].handle, NULL,
+                                           ak_bckey_ctr_thread, segs +idx ) == 0 ) ? ak_true : ak_false;
+    ak_bckey_ctr_thread( segs );
+    for( idx = 1; idx < tcount; idx++ ) {
+       if( segs[idx].started ) pthread_join( segs[idx].handle, NULL );
+        else ak_bckey_ctr_thread( segs +idx );
+    }
+    for( idx = 0; idx < tcount; idx++ ) ak_bckey_destroy( &segs[idx].key );
+    free( segs );
+    ivector[w] = ak_bckey_ctr_value( x + ( ak_uint64 )blocks, oc );
+    return;
+  }
+#endif
+  ak_bckey_ctr_blocks_segment( bkey, ivector, x, oc, inptr, outptr, blocks );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param bkey Контекст ключа алгоритма блочного шифрования.
     @param in Указатель на область памяти, где хранятся входные (зашифровываемые) данные
@@ -378,7 +770,9 @@
    else bkey->key.resource.value.counter -= blocks;
 
  /* теперь приступаем к зашифрованию данных */
-  switch( bkey->bsize ) {
+ /* (при наличии многоблочной реализации все блоки обрабатываются за один вызов) */
+  if( bkey->encrypt_blocks != NULL ) bkey->encrypt_blocks( &bkey->key, inptr, outptr, blocks );
+   else switch( bkey->bsize ) {
     case  8: /* шифр с длиной блока 64 бита */
       do {
         bkey->encrypt( &bkey->key, inptr++, outptr++ );
@@ -435,7 +829,9 @@
    else bkey->key.resource.value.counter -= blocks;
 
  /* теперь приступаем к расшифрованию данных */
-  switch( bkey->bsize ) {
+ /* (при наличии многоблочной реализации все блоки обрабатываются за один вызов) */
+  if( bkey->decrypt_blocks != NULL ) bkey->decrypt_blocks( &bkey->key, inptr, outptr, blocks );
+   else switch( bkey->bsize ) {
     case  8: /* шифр с длиной блока 64 бита */
       do {
         bkey->decrypt( &bkey->key, inptr++, outptr++ );
@@ -459,62 +855,16 @@
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! Поскольку в режиме гаммирования операцией шифрования является сложение открытого текста по
-    модулю два с последовательностью, вырабатываемой блочным шифром из заданной синхропосылки,
-    то для зашифрования и расшифрования информациии используется одна и та же функция.
-
-    Значение синхропосылки `iv` копируется в контекст секретного ключа (область памяти, на которую
-    указывает `iv` не изменяется) и преобразуется в ходе реализации режима гаммирования.
-    Преобразованное значение сохраняется в контексте секретного ключа в буффере `skey.ivector`.
-    Данное значение может быть использовано при повторном вызове функции ak_bckey_ctr().
-    Следующий пример иллюстрирует сказанное.
-
-
-\code
- // bkey - ключ алгоритма "Магма"
- // шифрование буффера с данными одним фрагментом
-  ak_bckey_ctr( bkey, in, out, size, iv, 4 );
-
- // тот же результат может быть получен за три последовательных вызова
-  ak_bckey_ctr( bkey, in, out, 16, iv, 4 );
-  ak_bckey_ctr( bkey, in+16, out+16, 16, NULL, 0 );
-  ak_bckey_ctr( bkey, in+32, out+32, size-32, NULL, 0 );
- //   для того, чтобы использовать внутреннее значение синхропосылки,
- //                мы передаем нулевые значения последних параметров
- //        использовать данную возможность можно только в том случае,
- // когда длина переданных в функцию ранее данных кратна длине блока
-\endcode
-
-
- В приведенном выше фрагменте исходный буффер сначала зашифровывается за один вызов функции,
- а потом фрагментами, длина которых кратна длине блока используемого алгоритма блочного шифрования.
- Результаты зашифрования должны совпадать в обоих случаях. Указанное поведение функции позволяет
- зашифровывать данные в случае, когда они поступают фрагментами, например из сети, или когда хранение
- данных полностью в оперативной памяти нецелесообразно (например, шифрование больших файлов).
-
-    @param bkey Контекст ключа алгоритма блочного шифрования, на котором происходит
-    зашифрование или расшифрование информации.
-    @param in Указатель на область памяти, где хранятся входные (открытые) данные.
-    @param out Указатель на область памяти, куда помещаются зашифрованные данные
-    (этот указатель может совпадать с `in`).
-    @param size Размер зашировываемых данных (в байтах).
-    @param iv Указатель на произвольную область памяти - синхропосылку. Область памяти, на
-    которую указывает `iv` не изменяется.
-    @param iv_size Длина синхропосылки в байтах. Согласно  стандарту ГОСТ Р 34.13-2015 длина
-    синхропосылки должна быть ровно в два раза меньше, чем длина блока, то есть 4 байта для Магмы
-    и 8 байт для Кузнечика. Значение `iv_size`, отличное от указанных, может привести к
-    возникновению ошибки.
-
-    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
-    возвращается \ref ak_error_ok (ноль)                                                           */
+/*! \brief Функция шифрования в режиме гаммирования, использующая заданное количество
+    потоков (см. ak_bckey_ctr_threads()).                                                          */
 /* ----------------------------------------------------------------------------------------------- */
- int ak_bckey_ctr( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
-                                                                     ak_pointer iv, size_t iv_size )
+ static int ak_bckey_ctr_common( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                             ak_pointer iv, size_t iv_size, const size_t threads )
 {
   ak_int64 blocks = (ak_int64)( size/bkey->bsize ),
              tail = (ak_int64)( size%bkey->bsize );
   ak_uint64 x, yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
-  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+  int error = ak_error_ok, oc = bkey->options.openssl_compability;
 
   if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
                                                 "wrong value for \"openssl_compability\" option" );
@@ -563,6 +913,16 @@
  /* обработка основного массива данных (кратного длине блока) */
   switch( bkey->bsize ) {
     case  8: /* шифр с длиной блока 64 бита (Магма) */
+     /* при наличии многоблочной реализации сначала вырабатываем группу последовательных
+        значений счетчика, а потом зашифровываем их за один вызов */
+      if( bkey->encrypt_blocks != NULL ) {
+        ak_bckey_ctr_blocks_threads( bkey, (ak_uint64 *)bkey->ivector,
+                              ak_bckey_ctr_value( ((ak_uint64 *)bkey->ivector)[0], oc ),
+                                                            oc, inptr, outptr, blocks, threads );
+        outptr += blocks; inptr += blocks;
+        blocks = 0;
+      }
+
       while( blocks > 0 ) {
         #ifndef AK_LITTLE_ENDIAN
           x = oc ? ((ak_uint64 *)bkey->ivector)[0] : bswap_64( ((ak_uint64 *)bkey->ivector)[0] );
@@ -589,6 +949,15 @@
       x = ((ak_uint64 *)bkey->ivector)[oc];
      #endif
 
+     /* при наличии многоблочной реализации сначала вырабатываем группу последовательных
+        значений счетчика, а потом зашифровываем их за один вызов */
+      if( bkey->encrypt_blocks != NULL ) {
+        ak_bckey_ctr_blocks_threads( bkey, (ak_uint64 *)bkey->ivector, x,
+                                                            oc, inptr, outptr, blocks, threads );
+        outptr += 2*blocks; inptr += 2*blocks;
+        blocks = 0;
+      }
+
       while( blocks > 0 ) {
           bkey->encrypt( &bkey->key, bkey->ivector, yaout );
           *outptr = *inptr ^ yaout[0]; outptr++; inptr++;
@@ -639,6 +1008,89 @@
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Поскольку в режиме гаммирования операцией шифрования является сложение открытого текста по
+    модулю два с последовательностью, вырабатываемой блочным шифром из заданной синхропосылки,
+    то для зашифрования и расшифрования информациии используется одна и та же функция.
+
+    Значение синхропосылки `iv` копируется в контекст секретного ключа (область памяти, на которую
+    указывает `iv` не изменяется) и преобразуется в ходе реализации режима гаммирования.
+    Преобразованное значение сохраняется в контексте секретного ключа в буффере `skey.ivector`.
+    Данное значение может быть использовано при повторном вызове функции ak_bckey_ctr().
+    Следующий пример иллюстрирует сказанное.
+
+
+\code
+ // bkey - ключ алгоритма "Магма"
+ // шифрование буффера с данными одним фрагментом
+  ak_bckey_ctr( bkey, in, out, size, iv, 4 );
+
+ // тот же результат может быть получен за три последовательных вызова
+  ak_bckey_ctr( bkey, in, out, 16, iv, 4 );
+  ak_bckey_ctr( bkey, in+16, out+16, 16, NULL, 0 );
+  ak_bckey_ctr( bkey, in+32, out+32, size-32, NULL, 0 );
+ //   для того, чтобы использовать внутреннее значение синхропосылки,
+ //                мы передаем нулевые значения последних параметров
+ //        использовать данную возможность можно только в том случае,
+ // когда длина переданных в функцию ранее данных кратна длине блока
+\endcode
+
+
+ В приведенном выше фрагменте исходный буффер сначала зашифровывается за один вызов функции,
+ а потом фрагментами, длина которых кратна длине блока используемого алгоритма блочного шифрования.
+ Результаты зашифрования должны совпадать в обоих случаях. Указанное поведение функции позволяет
+ зашифровывать данные в случае, когда они поступают фрагментами, например из сети, или когда хранение
+ данных полностью в оперативной памяти нецелесообразно (например, шифрование больших файлов).
+
+    @param bkey Контекст ключа алгоритма блочного шифрования, на котором происходит
+    зашифрование или расшифрование информации.
+    @param in Указатель на область памяти, где хранятся входные (открытые) данные.
+    @param out Указатель на область памяти, куда помещаются зашифрованные данные
+    (этот указатель может совпадать с `in`).
+    @param size Размер зашировываемых данных (в байтах).
+    @param iv Указатель на произвольную область памяти - синхропосылку. Область памяти, на
+    которую указывает `iv` не изменяется.
+    @param iv_size Длина синхропосылки в байтах. Согласно  стандарту ГОСТ Р 34.13-2015 длина
+    синхропосылки должна быть ровно в два раза меньше, чем длина блока, то есть 4 байта для Магмы
+    и 8 байт для Кузнечика. Значение `iv_size`, отличное от указанных, может привести к
+    возникновению ошибки.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_ctr( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                                                     ak_pointer iv, size_t iv_size )
+{
+ return ak_bckey_ctr_common( bkey, in, out, size, iv, iv_size, 1 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция зашифровывает (расшифровывает) данные в режиме гаммирования так же, как функция
+    ak_bckey_ctr(), и вырабатывает тот же самый результат. Данные большой длины разбиваются
+    на фрагменты, для каждого из которых заранее вычисляется начальное значение счетчика,
+    после чего фрагменты обрабатываются одновременно в `threads` потоках. Каждый поток
+    обрабатывает не менее 4096 блоков; если библиотека собрана без поддержки pthreads,
+    то шифрование выполняется в вызывающем потоке. Ресурс ключа уменьшается один раз,
+    до начала обработки данных.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param in Указатель на область памяти, где хранятся входные данные.
+    @param out Указатель на область памяти, куда помещаются выходные данные
+    (этот указатель может совпадать с `in`).
+    @param size Размер обрабатываемых данных (в байтах).
+    @param iv Указатель на синхропосылку; может принимать значение NULL.
+    @param iv_size Длина синхропосылки в байтах.
+    @param threads Максимальное количество используемых потоков.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_ctr_threads( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                             ak_pointer iv, size_t iv_size, const size_t threads )
+{
+ return ak_bckey_ctr_common( bkey, in, out, size, iv, iv_size, threads );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  int ak_bckey_encrypt_cbc( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
                                                                     ak_pointer iv, size_t iv_size )
@@ -646,7 +1098,7 @@
    ak_int64 blocks = 0;
    ak_uint64 yaout[2], z = iv_size / bkey->bsize;
    ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out, *ivector = (ak_uint64 *)bkey->ivector;
-   int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+   int error = ak_error_ok, oc = bkey->options.openssl_compability;
 
    if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
                                                  "wrong value for \"openssl_compability\" option" );
@@ -714,13 +1166,16 @@
  }
 
 /* ----------------------------------------------------------------------------------------------- */
- int ak_bckey_decrypt_cbc( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
-                                                                    ak_pointer iv, size_t iv_size )
+/*! \brief Функция расшифрования в режиме простой замены с зацеплением, использующая
+    заданное количество потоков (см. ak_bckey_decrypt_cbc_threads()).                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_decrypt_cbc_common( ak_bckey bkey, ak_pointer in, ak_pointer out,
+                               size_t size, ak_pointer iv, size_t iv_size, const size_t threads )
  {
   ak_int64 blocks = 0;
   ak_uint64 yaout[2], z = iv_size / bkey->bsize;
   ak_uint64 *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out, *ivector = (ak_uint64 *)bkey->ivector;
-  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+  int error = ak_error_ok, oc = bkey->options.openssl_compability;
 
   if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
                                                 "wrong value for \"openssl_compability\" option" );
@@ -750,6 +1205,13 @@
    memcpy(bkey->ivector, iv, iv_size);
 
  /* теперь приступаем к расшифрованию данных */
+ /* при наличии многоблочной реализации все блоки шифртекста известны заранее,
+    поэтому они расшифровываются группами (и, возможно, в нескольких потоках) */
+  if( bkey->decrypt_blocks != NULL ) {
+    ak_bckey_feedback_blocks_threads( bkey, bkey->decrypt_blocks, ivector, iv_size >> 3,
+                                                          inptr, outptr, size >> 3, ak_true, threads );
+    blocks = 0;
+  }
   switch( bkey->bsize ) {
     case  8: /* шифр с длиной блока 64 бита */
       while( blocks > 0 ) {
@@ -788,6 +1250,39 @@
  return ak_error_ok;
  }
 
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_decrypt_cbc( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                                                    ak_pointer iv, size_t iv_size )
+{
+ return ak_bckey_decrypt_cbc_common( bkey, in, out, size, iv, iv_size, 1 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция расшифровывает данные в режиме простой замены с зацеплением так же, как
+    функция ak_bckey_decrypt_cbc(). Поскольку при расшифровании все блоки шифртекста известны
+    заранее, шифртекст большой длины разбивается на фрагменты, которые расшифровываются
+    одновременно в `threads` потоках. Каждый поток обрабатывает не менее 4096 блоков;
+    если библиотека собрана без поддержки pthreads, то расшифрование выполняется
+    в вызывающем потоке.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param in Указатель на область памяти, где хранятся расшифровываемые данные.
+    @param out Указатель на область памяти, куда помещаются расшифрованные данные
+    (этот указатель может совпадать с `in`).
+    @param size Размер расшифровываемых данных (в байтах), должен быть кратен длине блока.
+    @param iv Указатель на синхропосылку.
+    @param iv_size Длина синхропосылки в байтах (кратна длине блока).
+    @param threads Максимальное количество используемых потоков.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_decrypt_cbc_threads( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                             ak_pointer iv, size_t iv_size, const size_t threads )
+{
+ return ak_bckey_decrypt_cbc_common( bkey, in, out, size, iv, iv_size, threads );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
  int ak_bckey_ofb( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
                                                                      ak_pointer iv, size_t iv_size )
@@ -796,7 +1291,7 @@
   ak_int64 blocks = (ak_int64)( size/bkey->bsize ),
              tail = (ak_int64)( size%bkey->bsize );
   ak_uint64 yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
-  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+  int error = ak_error_ok, oc = bkey->options.openssl_compability;
   unsigned long counter = 0, z = iv_size / bkey->bsize; /* во сколько раз синхрпосылка длиннее блока */
 
   if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
@@ -894,7 +1389,7 @@
               tail = (ak_int64)( size%bkey->bsize );
    ak_uint8 *vecptr = NULL;
    ak_uint64 yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
-   int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+   int error = ak_error_ok, oc = bkey->options.openssl_compability;
    unsigned long i = 0, z = iv_size / bkey->bsize; // во сколько раз синхрпосылка длиннее блока
 
    if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
@@ -981,14 +1476,17 @@
 }
 
 /* ----------------------------------------------------------------------------------------------- */
- int ak_bckey_decrypt_cfb( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
-                                                                      ak_pointer iv, size_t iv_size )
+/*! \brief Функция расшифрования в режиме гаммирования с обратной связью по шифртексту,
+    использующая заданное количество потоков (см. ak_bckey_decrypt_cfb_threads()).                */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_decrypt_cfb_common( ak_bckey bkey, ak_pointer in, ak_pointer out,
+                               size_t size, ak_pointer iv, size_t iv_size, const size_t threads )
  {
    ak_int64 blocks = (ak_int64)( size/bkey->bsize ),
               tail = (ak_int64)( size%bkey->bsize );
    ak_uint8 *vecptr = NULL;
    ak_uint64 yaout[2], *inptr = (ak_uint64 *)in, *outptr = (ak_uint64 *)out;
-   int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+   int error = ak_error_ok, oc = bkey->options.openssl_compability;
    unsigned long i = 0, z = iv_size / bkey->bsize; // во сколько раз синхрпосылка длиннее блока
 
    if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
@@ -1025,6 +1523,24 @@
       bkey->key.flags = ( bkey->key.flags&( ~key_flag_not_ctr ))^key_flag_not_ctr;
      }
 
+  /* при наличии многоблочной реализации все значения, подлежащие зашифрованию, известны заранее
+     (это синхропосылка и блоки шифртекста), поэтому они зашифровываются группами */
+   if(( bkey->encrypt_blocks != NULL ) && ( z > 0 ) && ( blocks > 0 )) {
+     ak_uint64 chain[8];
+     size_t j, bw = bkey->bsize >> 3;
+
+     memcpy( chain, bkey->ivector, z*bkey->bsize );
+     ak_bckey_feedback_blocks_threads( bkey, bkey->encrypt_blocks, chain, z*bw,
+                                 inptr, outptr, (size_t)blocks*bw, ak_false, threads );
+    /* восстанавливаем состояние синхропосылки, которое получилось бы при поблочной обработке */
+     for( j = 0; j < z; j++ )
+        memcpy( bkey->ivector + (( (size_t)blocks +j )%z )*bkey->bsize,
+                                                                chain +j*bw, bkey->bsize );
+     i = (unsigned long)( blocks%(ak_int64)z );
+     inptr += blocks*(ak_int64)bw; outptr += blocks*(ak_int64)bw;
+     blocks = 0;
+   }
+
   /* обработка основного массива данных (кратного длине блока) */
    switch( bkey->bsize ) {
      case  8: /* шифр с длиной блока 64 бита */
@@ -1074,6 +1590,39 @@
    return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_decrypt_cfb( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                                                      ak_pointer iv, size_t iv_size )
+{
+ return ak_bckey_decrypt_cfb_common( bkey, in, out, size, iv, iv_size, 1 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция расшифровывает данные в режиме гаммирования с обратной связью по шифртексту так же,
+    как функция ak_bckey_decrypt_cfb(). Поскольку при расшифровании все блоки шифртекста известны
+    заранее, шифртекст большой длины разбивается на фрагменты, для которых гамма вырабатывается
+    одновременно в `threads` потоках. Каждый поток обрабатывает не менее 4096 блоков;
+    если библиотека собрана без поддержки pthreads, то расшифрование выполняется
+    в вызывающем потоке.
+
+    @param bkey Контекст ключа алгоритма блочного шифрования.
+    @param in Указатель на область памяти, где хранятся расшифровываемые данные.
+    @param out Указатель на область памяти, куда помещаются расшифрованные данные
+    (этот указатель может совпадать с `in`).
+    @param size Размер расшифровываемых данных (в байтах).
+    @param iv Указатель на синхропосылку; может принимать значение NULL.
+    @param iv_size Длина синхропосылки в байтах (кратна длине блока).
+    @param threads Максимальное количество используемых потоков.
+
+    @return В случае возникновения ошибки функция возвращает ее код, в противном случае
+    возвращается \ref ak_error_ok (ноль)                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_decrypt_cfb_threads( ak_bckey bkey, ak_pointer in, ak_pointer out, size_t size,
+                                             ak_pointer iv, size_t iv_size, const size_t threads )
+{
+ return ak_bckey_decrypt_cfb_common( bkey, in, out, size, iv, iv_size, threads );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция реализует последовательную комбинацию алгоритма выработки имитовставки HMAC и
     режима гаммирования данных, согласно ГОСТ Р 34.12-2015. В начале
@@ -33,7 +33,7 @@
  int ak_bckey_cmac( ak_bckey bkey, ak_pointer in,
                                           const size_t size, ak_pointer out, const size_t out_size )
 {
-  ak_int64 i = 0, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" ),
+  ak_int64 i = 0, oc = bkey->options.openssl_compability,
         #ifdef AK_LITTLE_ENDIAN
            one64[2] = { 0x02, 0x00 },
         #else
@@ -354,7 +354,7 @@
                                                            ak_pointer out, const size_t out_size )
 {
   int error = ak_error_ok;
-  ak_int64 oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" ),
+  ak_int64 oc = 0,
         #ifdef AK_LITTLE_ENDIAN
            one64[2] = { 0x02, 0x00 };
         #else
@@ -364,6 +364,7 @@
 
   if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                         "using null pointer to block cipher key" );
+  oc = bkey->options.openssl_compability;
   if( out == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                            "using null pointer to result buffer" );
   if( !out_size ) return ak_error_message( ak_error_zero_length, __func__,
@@ -446,6 +447,16 @@
  return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/* завершение вычисления имитовставки для файла: пустому файлу соответствует имитовставка
+   от вектора нулевой длины, см. замечания к реализации ak_bckey_cmac() */
+ static int ak_bckey_cmac_file_finalize( ak_bckey key, const ak_pointer in, const size_t size,
+                                                           ak_pointer out, const size_t out_size )
+{
+  if( size == 0 ) return ak_bckey_cmac( key, NULL, 0, out, out_size );
+ return ak_bckey_cmac_finalize( key, in, size, out, out_size );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \note Реализация данной функции не использует методы класса \ref mac, поскольку
     функция ak_bckey_cmac_finalize() не может принимать данные нелевой длины.
@@ -461,61 +472,7 @@
 /* ----------------------------------------------------------------------------------------------- */
  int ak_bckey_cmac_file( ak_bckey key, const char *filename, ak_pointer out, const size_t out_size )
 {
-  struct file file;
-  int error = ak_error_ok;
-  size_t block_size = 4096; /* оптимальная длина блока для Windows, по-прежнему, не ясна */
-  ak_int64 len = 0, readlen = 0;
-  ak_uint8 *localbuffer = NULL; /* место для локального считывания информации */
-
- /* выполняем необходимые проверки */
-  if( key == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
-                                                "use a null pointer to block cipher key context" );
-  if( filename == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
-                                                                "use a null pointer to filename" );
-  if(( error = ak_file_open_to_read( &file, filename )) != ak_error_ok )
-    return ak_error_message_fmt( error, __func__, "incorrect access to file %s (%s)",
-                                                                      filename, strerror( errno ));
- /* для файла нулевой длины результатом будет хеш от вектора нулевой длины,
-                                 см. замечания к реализации ak_bckey_cmac() */
-  if( !file.size ) {
-    ak_file_close( &file );
-    return ak_bckey_cmac( key, NULL, 0, out, out_size );
-  }
- /* готовим область для хранения данных */
-  block_size = ak_max( ( size_t )file.blksize, 512 );
- /* здесь мы выделяем локальный буффер для считывания/обработки данных */
-  if(( localbuffer = ( ak_uint8 * ) ak_aligned_malloc( block_size )) == NULL ) {
-    ak_file_close( &file );
-    return ak_error_message( ak_error_out_of_memory, __func__ ,
-                                                      "memory allocation error for local buffer" );
-  }
-
- /* теперь обрабатываем файл с данными */
-  ak_bckey_cmac_clean( key );
-  read_label:
-   readlen += ( len = ( size_t ) ak_file_read( &file, localbuffer, block_size ));
-   if( readlen == file.size ) { /* считан последний большой блок */
-     size_t qcnt = len / key->bsize,
-            tail = len - qcnt*key->bsize;
-     if( tail == 0 ) {
-       if( qcnt > 0 ) { qcnt--; tail = key->bsize; }
-         else {
-           error = ak_error_message( ak_error_read_data, __func__,
-                                                           "unexpected length of input data");
-           goto labex;
-         }
-     }
-     if( qcnt ) ak_bckey_cmac_update( key, localbuffer, qcnt*key->bsize );
-     error = ak_bckey_cmac_finalize(key, localbuffer + qcnt*key->bsize, tail, out, out_size );
-   }
-    else {
-           ak_bckey_cmac_update( key, localbuffer, len );
-           goto read_label;
-         }
-  labex:
-   if( localbuffer != NULL ) ak_aligned_free( localbuffer );
-   ak_file_close( &file );
- return error;
+  return ak_bckey_cmac_file_offset( key, filename, 0, -1, out, out_size );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -540,86 +497,16 @@
  int ak_bckey_cmac_file_offset( ak_bckey key, const char *filename,
                        ak_int64 offset, ak_int64 data_size, ak_pointer out, const size_t out_size )
 {
-  struct file file;
-  int error = ak_error_ok;
-  ssize_t result;
-  size_t len = 0, total_len = 0;
-  size_t block_size = 4096; /* оптимальная длина блока для Windows, по-прежнему, не ясна */
-  ak_uint8 *localbuffer = NULL; /* место для локального считывания информации */
-
  /* выполняем необходимые проверки */
   if( key == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                                 "use a null pointer to block cipher key context" );
   if( filename == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                                                 "use a null pointer to filename" );
-  if(( error = ak_file_open_to_read( &file, filename )) != ak_error_ok ) {
-    if( ak_log_get_level() > ak_log_none )
-      ak_error_message_fmt( error, __func__, "incorrect access to file %s (%s)",
-                                                                      filename, strerror( errno ));
-    return error;
-  }
-
- /* вычисляем сколько октетов нам надо обработать */
-  if( offset >= file.size ) total_len = 0;
-   else total_len = ( data_size == -1 ) ?
-                               ( file.size - offset ) : ( ak_min( data_size, file.size - offset ));
-
- /* для файла нулевой длины результатом будет хеш от вектора нулевой длины,
-                                 см. замечания к реализации ak_bckey_cmac() */
-  if(( !file.size ) || ( total_len == 0 )) {
-    ak_file_close( &file );
-    return ak_bckey_cmac( key, NULL, 0, out, out_size );
-  }
-
- /* сдвигаем указатель на заданое число байт */
-  if(( ak_file_lseek( &file, offset, SEEK_SET )) == -1 ) {
-    ak_file_close( &file );
-    return ak_error_message( ak_error_lseek_file, __func__, "incorrect seeking to offset" );
-  }
-
- /* готовим область для хранения данных */
-  block_size = ak_max( ( size_t )file.blksize, 512 );
- /* здесь мы выделяем локальный буффер для считывания/обработки данных */
-  if(( localbuffer = ( ak_uint8 * ) ak_aligned_malloc( block_size )) == NULL ) {
-    ak_file_close( &file );
-    return ak_error_message( ak_error_out_of_memory, __func__ ,
-                                                      "memory allocation error for local buffer" );
-  }
-
- /* теперь обрабатываем файл с данными */
+ /* функции ak_bckey_cmac_finalize() всегда передается непустой последний блок */
   ak_bckey_cmac_clean( key );
-  read_label:
-   result = ak_file_read( &file, localbuffer, ak_min( total_len, block_size ));
-   if( result < 0 ) {
-     error = ak_error_message( ak_error_read_data, __func__,
-                                                        "incorrect reading a block of input data");
-     goto labex;
-   }
-    else len = ( size_t ) result;
-
-   if( len == total_len ) { /* считан последний большой блок */
-     size_t qcnt = len / key->bsize,
-            tail = len - qcnt*key->bsize;
-     if( tail == 0 ) {
-       if( qcnt > 0 ) { qcnt--; tail = key->bsize; }
-         else {
-           error = ak_error_message( ak_error_read_data, __func__,
-                                                           "unexpected length of input data");
-           goto labex;
-         }
-     }
-     if( qcnt ) ak_bckey_cmac_update( key, localbuffer, qcnt*key->bsize );
-     error = ak_bckey_cmac_finalize(key, localbuffer + qcnt*key->bsize, tail, out, out_size );
-   }
-    else {
-           ak_bckey_cmac_update( key, localbuffer, len );
-           total_len -= len;
-           goto read_label;
-         }
-  labex:
-   if( localbuffer != NULL ) ak_aligned_free( localbuffer );
-   ak_file_close( &file );
- return error;
+ return ak_mac_file_process( filename, offset, data_size, key->bsize, ak_true,
+              ( ak_function_update * )ak_bckey_cmac_update,
+                         ( ak_function_finalize * )ak_bckey_cmac_file_finalize, key, out, out_size );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -4,9 +4,14 @@
 /*  Файл ak_curves.с                                                                               */
 /*  - содержит реализацию функций для работы с эллиптическими кривыми.                             */
 /* ----------------------------------------------------------------------------------------------- */
- #include <libakrypt.h>
+ #include <libakrypt-internal.h>
 
 /* ----------------------------------------------------------------------------------------------- */
+#ifdef AK_HAVE_STDLIB_H
+ #include <stdlib.h>
+#else
+ #error Library cannot be compiled without stdlib.h header
+#endif
 #ifdef AK_HAVE_STRING_H
  #include <string.h>
 #else
@@ -15,6 +20,28 @@
 #ifdef AK_HAVE_STRINGS_H
  #include <strings.h>
 #endif
+#ifdef AK_HAVE_PTHREAD_H
+ #include <pthread.h>
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычитание вычетов по модулю \f$ p \f$: \f$ z \equiv x - y \pmod{p} \f$.
+
+    Вычитание выполняется за фиксированное время, не зависящее от значений вычетов.
+    @param z Вычет, в который помещается результат.
+    @param x Уменьшаемое, удовлетворяющее неравенству \f$ 0 \leq x < p \f$.
+    @param y Вычитаемое, удовлетворяющее неравенству \f$ 0 \leq y < p \f$.
+    @param ec Эллиптическая кривая, модуль которой используется в вычислениях.                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mpzn_sub_montgomery( ak_uint64 *z, ak_uint64 *x, ak_uint64 *y, ak_wcurve ec )
+{
+  size_t i;
+  ak_mpznmax t;
+  ak_uint64 mask = ( ak_uint64 )0 - ak_mpzn_sub( z, x, y, ec->size );
+
+  for( i = 0; i < ec->size; i++ ) t[i] = ec->p[i]&mask;
+  ak_mpzn_add( z, z, t, ec->size );
+}
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция вычисляет величину \f$\Delta \equiv -16(4a^3 + 27b^2) \pmod{p} \f$, зависящую
@@ -82,7 +109,7 @@
 /* ----------------------------------------------------------------------------------------------- */
  int ak_wcurve_check_order_parameters( ak_wcurve ec )
 {
-  ak_mpzn512 r, s, t;
+  ak_mpzn512 s, t;
   struct random generator;
 
   ak_random_create_lcg( &generator );
@@ -90,9 +117,7 @@
   ak_mpzn_rem( t, t, ec->q, ec->size );
   ak_random_destroy( &generator );
 
-  ak_mpzn_set_ui( r, ec->size, 2 );
-  ak_mpzn_sub( r, ec->q, r, ec->size );
-  ak_mpzn_modpow_montgomery( s, t, r, ec->q, ec->nq, ec->size );
+  ak_mpzn_inverse_montgomery( s, t, ec->q, ec->nq, ec->size );
   ak_mpzn_mul_montgomery( t, s, t, ec->q, ec->nq, ec->size );
 
   ak_mpzn_mul_montgomery( t, t, ec->r2q, ec->q, ec->nq, ec->size );
@@ -102,6 +127,65 @@
    else return ak_error_curve_order_parameters;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Проверка параметров скрученной кривой Эдвардса, эквивалентной заданной кривой.
+
+    Проверяется, что величины \f$ s, t \f$ согласованы с коэффициентами \f$ e, d \f$
+    кривой Эдвардса и коэффициентами \f$ a, b \f$ кривой в форме Вейерштрасса, то есть
+    \f$ e - d \equiv 4s, \ e + d \equiv 6t, \ a \equiv s^2 - 3t^2, \ b \equiv 2t^3 - ts^2 \pmod{p}\f$.
+    Кроме того, проверяется, что \f$ e \f$ является квадратичным вычетом, а \f$ d \f$ -
+    квадратичным невычетом по модулю \f$ p \f$; в этом случае формулы сложения точек кривой
+    Эдвардса являются полными, то есть не имеют исключительных случаев.
+
+    @param ec Эллиптическая кривая.
+    @return Функция возвращает \ref ak_true если все проверки выполнены. В противном случае
+    возвращается \ref ak_false.                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_wcurve_edwards_is_ok( ak_wcurve ec )
+{
+  size_t i;
+  ak_mpznmax u, v, w, one = ak_mpznmax_one;
+  const struct wcurve_edwards *ed = ec->edwards;
+
+  if( ed == NULL ) return ak_false;
+ /* e - d = 4s, e + d = 6t */
+  ak_mpzn_sub_montgomery( u, ( ak_uint64 *)ed->e, ( ak_uint64 *)ed->d, ec );
+  ak_mpzn_lshift_montgomery( v, ( ak_uint64 *)ed->s, ec->p, ec->size );
+  ak_mpzn_lshift_montgomery( v, v, ec->p, ec->size );
+  if( ak_mpzn_cmp( u, v, ec->size ) != 0 ) return ak_false;
+  ak_mpzn_add_montgomery( u, ( ak_uint64 *)ed->e, ( ak_uint64 *)ed->d, ec->p, ec->size );
+  ak_mpzn_lshift_montgomery( v, ( ak_uint64 *)ed->t, ec->p, ec->size );
+  ak_mpzn_add_montgomery( v, v, ( ak_uint64 *)ed->t, ec->p, ec->size );
+  ak_mpzn_lshift_montgomery( v, v, ec->p, ec->size );
+  if( ak_mpzn_cmp( u, v, ec->size ) != 0 ) return ak_false;
+
+ /* a = s^2 - 3t^2, b = 2t^3 - ts^2 */
+  ak_mpzn_sqr_montgomery( u, ( ak_uint64 *)ed->s, ec->p, ec->n, ec->size );
+  ak_mpzn_sqr_montgomery( v, ( ak_uint64 *)ed->t, ec->p, ec->n, ec->size );
+  ak_mpzn_lshift_montgomery( w, v, ec->p, ec->size );
+  ak_mpzn_add_montgomery( w, w, v, ec->p, ec->size );
+  ak_mpzn_sub_montgomery( w, u, w, ec );
+  if( ak_mpzn_cmp( w, ec->a, ec->size ) != 0 ) return ak_false;
+  ak_mpzn_mul_montgomery( w, v, ( ak_uint64 *)ed->t, ec->p, ec->n, ec->size );
+  ak_mpzn_lshift_montgomery( w, w, ec->p, ec->size );
+  ak_mpzn_mul_montgomery( u, u, ( ak_uint64 *)ed->t, ec->p, ec->n, ec->size );
+  ak_mpzn_sub_montgomery( w, w, u, ec );
+  if( ak_mpzn_cmp( w, ec->b, ec->size ) != 0 ) return ak_false;
+
+ /* критерий Эйлера: e^{(p-1)/2} = 1, d^{(p-1)/2} = -1 */
+  ak_mpzn_sub( w, ec->p, one, ec->size );
+  for( i = 0; i < ec->size-1; i++ ) w[i] = ( w[i] >> 1 )^( w[i+1] << 63 );
+  w[ec->size-1] >>= 1;
+  ak_mpzn_mul_montgomery( v, ec->r2, one, ec->p, ec->n, ec->size ); /* единица в форме Монтгомери */
+  ak_mpzn_modpow_montgomery( u, ( ak_uint64 *)ed->e, w, ec->p, ec->n, ec->size );
+  if( ak_mpzn_cmp( u, v, ec->size ) != 0 ) return ak_false;
+  ak_mpzn_sub( v, ec->p, v, ec->size );
+  ak_mpzn_modpow_montgomery( u, ( ak_uint64 *)ed->d, w, ec->p, ec->n, ec->size );
+  if( ak_mpzn_cmp( u, v, ec->size ) != 0 ) return ak_false;
+
+ return ak_true;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция принимает на вход контекст эллиптической кривой, заданной в короткой форме Вейерштрасса,
     и выполняет следующие математические проверки
@@ -110,6 +194,10 @@
        \f$ 2^{n-32} < p < 2^n \f$, где \f$ n \f$ это либо 256, либо 512 в зависимости от
        параметров кривой,
      - проверяется, что дискриминант кривой отличен от нуля по модулю \f$ p \f$,
+     - проверяется, что система координат, используемая при вычислении кратных точек,
+       допустима для заданных параметров (координаты Якоби для кривых с \f$ a \equiv -3 \f$
+       могут использоваться только при выполнении этого сравнения, а для координат кривой
+       Эдвардса проверяются параметры эквивалентной кривой),
      - проверяется, что фиксированная точка кривой, содержащаяся в контексте эллиптической кривой,
        действительно принадлежит эллиптической кривой,
      - проверяется, что порядок этой точки кривой равен простому числу \f$ q \f$,
@@ -154,6 +242,24 @@
   if(( error = ak_wcurve_discriminant_is_ok( ec )) != ak_error_ok )
     return ak_error_message( ak_error_curve_discriminant, __func__ ,
                                        "using elliptic curve parameters with zero discriminant" );
+ /* проверяем, что система координат допустима для заданного коэффициента a */
+  if( ec->coordinates == wcurve_jacobian_a3_coordinates ) {
+    ak_mpzn_set_ui( temp, ec->size, 3 );
+    ak_mpzn_sub( temp, ec->p, temp, ec->size );
+    ak_mpzn_mul_montgomery( temp, temp, ec->r2, ec->p, ec->n, ec->size );
+    if( ak_mpzn_cmp( temp, ec->a, ec->size ) != 0 )
+      return ak_error_message( ak_error_curve_coordinates, __func__ ,
+                                    "using coordinates for a = -3 with another value of a" );
+  } else
+     if( ec->coordinates == wcurve_edwards_coordinates ) {
+       if( ak_wcurve_edwards_is_ok( ec ) != ak_true )
+         return ak_error_message( ak_error_curve_coordinates, __func__ ,
+                                      "using wrong parameters of equivalent twisted Edwards curve" );
+     } else
+        if(( ec->coordinates != wcurve_projective_coordinates ) &&
+           ( ec->coordinates != wcurve_jacobian_coordinates ))
+          return ak_error_message( ak_error_curve_coordinates, __func__ ,
+                                 "using unsupported coordinates for elliptic curve parameters" );
  /* теперь проверяем принадлежность точки кривой */
   if(( error = ak_wpoint_set( &wp, ec )) != ak_error_ok )
     return ak_error_message( error, __func__, "incorect asiigning a temporary point" );
@@ -306,6 +412,7 @@
           case ak_error_curve_point_order      : p = "base point order"; break;
           case ak_error_curve_prime_modulo     : p = "prime modulo p"; break;
           case ak_error_curve_order_parameters : p = "prime order parameters"; break;
+          case ak_error_curve_coordinates      : p = "coordinates"; break;
           case ak_error_wrong_endian           : p = "incorrect representation of prime modulo";
                                                  break;
           default : p = "unexpected parameter";
@@ -419,16 +526,16 @@
   ak_mpzn_add_montgomery( t, t, s, ec->p, ec->size ); // теперь в t величина (ax+bz)
 
   ak_mpzn_set( s, wp->z, ec->size );
-  ak_mpzn_mul_montgomery( s, s, s, ec->p, ec->n, ec->size );
+  ak_mpzn_sqr_montgomery( s, s, ec->p, ec->n, ec->size );
   ak_mpzn_mul_montgomery( t, t, s, ec->p, ec->n, ec->size ); // теперь в t величина (ax+bz)z^2
 
   ak_mpzn_set( s, wp->x, ec->size );
-  ak_mpzn_mul_montgomery( s, s, s, ec->p, ec->n, ec->size );
+  ak_mpzn_sqr_montgomery( s, s, ec->p, ec->n, ec->size );
   ak_mpzn_mul_montgomery( s, s, wp->x, ec->p, ec->n, ec->size );
   ak_mpzn_add_montgomery( t, t, s, ec->p, ec->size ); // теперь в t величина x^3 + (ax+bz)z^2
 
   ak_mpzn_set( s, wp->y, ec->size );
-  ak_mpzn_mul_montgomery( s, s, s, ec->p, ec->n, ec->size );
+  ak_mpzn_sqr_montgomery( s, s, ec->p, ec->n, ec->size );
   ak_mpzn_mul_montgomery( s, s, wp->z, ec->p, ec->n, ec->size ); // теперь в s величина x^3 + (ax+bz)z^2
 
   if( ak_mpzn_cmp( t, s, ec->size )) return ak_false;
@@ -471,8 +578,8 @@
    return;
  }
  // dbl-2007-bl
- ak_mpzn_mul_montgomery( u1, wp->x, wp->x, ec->p, ec->n, ec->size );
- ak_mpzn_mul_montgomery( u2, wp->z, wp->z, ec->p, ec->n, ec->size );
+ ak_mpzn_sqr_montgomery( u1, wp->x, ec->p, ec->n, ec->size );
+ ak_mpzn_sqr_montgomery( u2, wp->z, ec->p, ec->n, ec->size );
  ak_mpzn_lshift_montgomery( u4, u1, ec->p, ec->size );
  ak_mpzn_add_montgomery( u4, u4, u1, ec->p, ec->size );
  ak_mpzn_mul_montgomery( u3, u2, ec->a, ec->p, ec->n, ec->size );
@@ -484,7 +591,7 @@
  ak_mpzn_mul_montgomery( u7, u6, wp->x, ec->p, ec->n, ec->size ); // u7 = 8xy^2z
  ak_mpzn_lshift_montgomery( u1, u7, ec->p, ec->size );
  ak_mpzn_sub( u1, ec->p, u1, ec->size );
- ak_mpzn_mul_montgomery( u2, u3, u3, ec->p, ec->n, ec->size );
+ ak_mpzn_sqr_montgomery( u2, u3, ec->p, ec->n, ec->size );
  ak_mpzn_add_montgomery( u2, u2, u1, ec->p, ec->size );
  ak_mpzn_mul_montgomery( wp->x, u2, u4, ec->p, ec->n, ec->size );
  ak_mpzn_mul_montgomery( u6, u6, u5, ec->p, ec->n, ec->size );
@@ -493,7 +600,7 @@
  ak_mpzn_add_montgomery( u2, u2, u7, ec->p, ec->size );
  ak_mpzn_mul_montgomery( wp->y, u2, u3, ec->p, ec->n, ec->size );
  ak_mpzn_add_montgomery( wp->y, wp->y, u6, ec->p, ec->size );
- ak_mpzn_mul_montgomery( wp->z, u4, u4, ec->p, ec->n, ec->size );
+ ak_mpzn_sqr_montgomery( wp->z, u4, ec->p, ec->n, ec->size );
  ak_mpzn_mul_montgomery( wp->z, wp->z, u4, ec->p, ec->n, ec->size );
 }
 
@@ -560,11 +667,11 @@
   ak_mpzn_mul_montgomery( u3, wp1->z, wp2->z, ec->p, ec->n, ec->size );
   ak_mpzn_mul_montgomery( u4, wp2->y, wp1->z, ec->p, ec->n, ec->size );
   ak_mpzn_add_montgomery( u4, u4, u2, ec->p, ec->size );
-  ak_mpzn_mul_montgomery( u5, u4, u4, ec->p, ec->n, ec->size );
+  ak_mpzn_sqr_montgomery( u5, u4, ec->p, ec->n, ec->size );
   ak_mpzn_sub( u7, ec->p, u1, ec->size );
   ak_mpzn_mul_montgomery( wp1->x, wp2->x, wp1->z, ec->p, ec->n, ec->size );
   ak_mpzn_add_montgomery( wp1->x, wp1->x, u7, ec->p, ec->size );
-  ak_mpzn_mul_montgomery( u7, wp1->x, wp1->x, ec->p, ec->n, ec->size );
+  ak_mpzn_sqr_montgomery( u7, wp1->x, ec->p, ec->n, ec->size );
   ak_mpzn_mul_montgomery( u6, u7, wp1->x, ec->p, ec->n, ec->size);
   ak_mpzn_mul_montgomery( u1, u7, u1, ec->p, ec->n, ec->size );
   ak_mpzn_lshift_montgomery( u7, u1, ec->p, ec->size );
@@ -597,9 +704,7 @@
    return;
  }
 
- ak_mpzn_set_ui( u, ec->size, 2 );
- ak_mpzn_sub( u, ec->p, u, ec->size );
- ak_mpzn_modpow_montgomery( u, wp->z, u, ec->p, ec->n, ec->size ); // u <- z^{p-2} (mod p)
+ ak_mpzn_inverse_montgomery( u, wp->z, ec->p, ec->n, ec->size ); // u <- z^{-1} (mod p)
  ak_mpzn_mul_montgomery( u, u, one, ec->p, ec->n, ec->size );
 
  ak_mpzn_mul_montgomery( wp->x, wp->x, u, ec->p, ec->n, ec->size );
@@ -607,13 +712,679 @@
  ak_mpzn_set_ui( wp->z, ec->size, 1 );
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция приводит к аффинному виду (см. ak_wpoint_reduce()) массив точек, вычисляя
+    обратные значения всех z-координат с помощью одного возведения в степень
+    (функция ak_mpzn_modinv_montgomery_batch()). Бесконечно удаленные точки допускаются.
+
+    @param wp Массив точек кривой, которые приводятся к аффинной форме
+    @param count Количество точек в массиве
+    @param ec Эллиптическая кривая, которой принадлежат точки                                      */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_wpoint_reduce_batch( ak_wpoint wp, const size_t count, ak_wcurve ec )
+{
+  size_t i;
+  ak_uint64 *zs = NULL, *us = NULL;
+  ak_mpznmax u, one = ak_mpznmax_one;
+
+  if( count < 2 ) {
+    if( count ) ak_wpoint_reduce( wp, ec );
+    return;
+  }
+  if(( zs = malloc( 2*count*ec->size*sizeof( ak_uint64 ))) == NULL ) {
+    for( i = 0; i < count; i++ ) ak_wpoint_reduce( wp +i, ec );
+    return;
+  }
+  us = zs +count*ec->size;
+
+ /* для бесконечно удаленных точек обращается единица (в представлении Монтгомери) */
+  ak_mpzn_mul_montgomery( u, ec->r2, one, ec->p, ec->n, ec->size );
+  for( i = 0; i < count; i++ ) {
+     if( ak_mpzn_cmp_ui( wp[i].z, ec->size, 0 ) == ak_true )
+       memcpy( zs +i*ec->size, u, ec->size*sizeof( ak_uint64 ));
+      else memcpy( zs +i*ec->size, wp[i].z, ec->size*sizeof( ak_uint64 ));
+  }
+  ak_mpzn_modinv_montgomery_batch( us, zs, count, ec->p, ec->n, ec->size );
+
+  for( i = 0; i < count; i++ ) {
+     if( ak_mpzn_cmp_ui( wp[i].z, ec->size, 0 ) == ak_true ) {
+       ak_wpoint_set_as_unit( wp +i, ec );
+       continue;
+     }
+     ak_mpzn_mul_montgomery( u, us +i*ec->size, one, ec->p, ec->n, ec->size );
+     ak_mpzn_mul_montgomery( wp[i].x, wp[i].x, u, ec->p, ec->n, ec->size );
+     ak_mpzn_mul_montgomery( wp[i].y, wp[i].y, u, ec->p, ec->n, ec->size );
+     ak_mpzn_set_ui( wp[i].z, ec->size, 1 );
+  }
+  free( zs );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*                 вычисления в координатах Якоби (используются при вычислении кратных точек)      */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Переход от однородных проективных координат к координатам Якоби.
+
+    Точка \f$ (x:y:z) \f$ заменяется точкой \f$ (xz:yz^2:z) \f$, задающей в координатах Якоби
+    ту же самую точку эллиптической кривой.
+
+    @param wp Точка эллиптической кривой.
+    @param ec Эллиптическая кривая, которой принадлежит точка.                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_to_jacobian( ak_wpoint wp, ak_wcurve ec )
+{
+  ak_mpznmax t;
+
+  ak_mpzn_mul_montgomery( wp->x, wp->x, wp->z, ec->p, ec->n, ec->size );
+  ak_mpzn_sqr_montgomery( t, wp->z, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( wp->y, wp->y, t, ec->p, ec->n, ec->size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Переход от координат Якоби к однородным проективным координатам.
+
+    Точка \f$ (X:Y:Z) \f$, заданная в координатах Якоби,
+    заменяется точкой \f$ (XZ:Y:Z^3) \f$ в однородных проективных координатах.
+
+    @param wp Точка эллиптической кривой.
+    @param ec Эллиптическая кривая, которой принадлежит точка.                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_from_jacobian( ak_wpoint wp, ak_wcurve ec )
+{
+  ak_mpznmax t;
+
+  if( ak_mpzn_cmp_ui( wp->z, ec->size, 0 ) == ak_true ) {
+    ak_wpoint_set_as_unit( wp, ec );
+    return;
+  }
+  ak_mpzn_mul_montgomery( wp->x, wp->x, wp->z, ec->p, ec->n, ec->size );
+  ak_mpzn_sqr_montgomery( t, wp->z, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( wp->z, wp->z, t, ec->p, ec->n, ec->size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Удвоение точки, заданной в координатах Якоби.
+
+    Для кривых с коэффициентом \f$ a \equiv -3 \pmod{p} \f$ (система координат
+    \ref wcurve_jacobian_a3_coordinates) используются соотношения dbl-2001-b,
+    требующие 3 умножений и 5 возведений в квадрат
+
+    \code
+      delta = Z^2
+      gamma = Y^2
+      beta = X*gamma
+      alpha = 3*(X-delta)*(X+delta)
+      X3 = alpha^2-8*beta
+      Z3 = (Y+Z)^2-gamma-delta
+      Y3 = alpha*(4*beta-X3)-8*gamma^2
+    \endcode
+
+    для остальных кривых используются соотношения dbl-2007-bl
+
+    \code
+      XX = X^2
+      YY = Y^2
+      YYYY = YY^2
+      ZZ = Z^2
+      S = 2*((X+YY)^2-XX-YYYY)
+      M = 3*XX+a*ZZ^2
+      X3 = M^2-2*S
+      Y3 = M*(S-X3)-8*YYYY
+      Z3 = (Y+Z)^2-YY-ZZ
+    \endcode
+
+    @param wp удваиваемая точка \f$ P \f$ эллиптической кривой.
+    @param ec эллиптическая кривая, которой принадлежит точка \f$P\f$.                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_jacobian_double( ak_wpoint wp, ak_wcurve ec )
+{
+ ak_mpznmax u1, u2, u3, u4, u5;
+
+ if( ak_mpzn_cmp_ui( wp->z, ec->size, 0 ) == ak_true ) return;
+ if( ak_mpzn_cmp_ui( wp->y, ec->size, 0 ) == ak_true ) {
+   ak_wpoint_set_as_unit( wp, ec );
+   return;
+ }
+
+ if( ec->coordinates == wcurve_jacobian_a3_coordinates ) {
+  // dbl-2001-b
+   ak_mpzn_sqr_montgomery( u1, wp->z, ec->p, ec->n, ec->size ); // u1 = delta
+   ak_mpzn_sqr_montgomery( u2, wp->y, ec->p, ec->n, ec->size ); // u2 = gamma
+   ak_mpzn_add_montgomery( u3, wp->x, u1, ec->p, ec->size );
+   ak_mpzn_sub_montgomery( u4, wp->x, u1, ec );
+   ak_mpzn_mul_montgomery( u3, u3, u4, ec->p, ec->n, ec->size );
+   ak_mpzn_lshift_montgomery( u4, u3, ec->p, ec->size );
+   ak_mpzn_add_montgomery( u3, u3, u4, ec->p, ec->size );        // u3 = alpha
+   ak_mpzn_mul_montgomery( u4, wp->x, u2, ec->p, ec->n, ec->size );
+   ak_mpzn_lshift_montgomery( u4, u4, ec->p, ec->size );
+   ak_mpzn_lshift_montgomery( u4, u4, ec->p, ec->size );         // u4 = 4*beta
+
+   ak_mpzn_add_montgomery( wp->z, wp->y, wp->z, ec->p, ec->size );
+   ak_mpzn_sqr_montgomery( wp->z, wp->z, ec->p, ec->n, ec->size );
+   ak_mpzn_sub_montgomery( wp->z, wp->z, u2, ec );
+   ak_mpzn_sub_montgomery( wp->z, wp->z, u1, ec );
+
+   ak_mpzn_sqr_montgomery( wp->x, u3, ec->p, ec->n, ec->size );
+   ak_mpzn_lshift_montgomery( u5, u4, ec->p, ec->size );
+   ak_mpzn_sub_montgomery( wp->x, wp->x, u5, ec );
+
+   ak_mpzn_sub_montgomery( u4, u4, wp->x, ec );
+   ak_mpzn_mul_montgomery( u4, u4, u3, ec->p, ec->n, ec->size );
+   ak_mpzn_sqr_montgomery( u2, u2, ec->p, ec->n, ec->size );
+   ak_mpzn_lshift_montgomery( u2, u2, ec->p, ec->size );
+   ak_mpzn_lshift_montgomery( u2, u2, ec->p, ec->size );
+   ak_mpzn_lshift_montgomery( u2, u2, ec->p, ec->size );         // u2 = 8*gamma^2
+   ak_mpzn_sub_montgomery( wp->y, u4, u2, ec );
+   return;
+ }
+
+ // dbl-2007-bl
+ ak_mpzn_sqr_montgomery( u1, wp->x, ec->p, ec->n, ec->size );   // u1 = XX
+ ak_mpzn_sqr_montgomery( u2, wp->y, ec->p, ec->n, ec->size );   // u2 = YY
+ ak_mpzn_sqr_montgomery( u3, u2, ec->p, ec->n, ec->size );      // u3 = YYYY
+ ak_mpzn_sqr_montgomery( u4, wp->z, ec->p, ec->n, ec->size );   // u4 = ZZ
+ ak_mpzn_add_montgomery( u5, wp->x, u2, ec->p, ec->size );
+ ak_mpzn_sqr_montgomery( u5, u5, ec->p, ec->n, ec->size );
+ ak_mpzn_sub_montgomery( u5, u5, u1, ec );
+ ak_mpzn_sub_montgomery( u5, u5, u3, ec );
+ ak_mpzn_lshift_montgomery( u5, u5, ec->p, ec->size );          // u5 = S
+
+ ak_mpzn_add_montgomery( wp->z, wp->y, wp->z, ec->p, ec->size );
+ ak_mpzn_sqr_montgomery( wp->z, wp->z, ec->p, ec->n, ec->size );
+ ak_mpzn_sub_montgomery( wp->z, wp->z, u2, ec );
+ ak_mpzn_sub_montgomery( wp->z, wp->z, u4, ec );
+
+ ak_mpzn_sqr_montgomery( u4, u4, ec->p, ec->n, ec->size );
+ ak_mpzn_mul_montgomery( u4, u4, ec->a, ec->p, ec->n, ec->size );
+ ak_mpzn_lshift_montgomery( u2, u1, ec->p, ec->size );
+ ak_mpzn_add_montgomery( u1, u1, u2, ec->p, ec->size );
+ ak_mpzn_add_montgomery( u1, u1, u4, ec->p, ec->size );         // u1 = M
+
+ ak_mpzn_sqr_montgomery( wp->x, u1, ec->p, ec->n, ec->size );
+ ak_mpzn_lshift_montgomery( u2, u5, ec->p, ec->size );
+ ak_mpzn_sub_montgomery( wp->x, wp->x, u2, ec );
+
+ ak_mpzn_sub_montgomery( u5, u5, wp->x, ec );
+ ak_mpzn_mul_montgomery( u5, u5, u1, ec->p, ec->n, ec->size );
+ ak_mpzn_lshift_montgomery( u3, u3, ec->p, ec->size );
+ ak_mpzn_lshift_montgomery( u3, u3, ec->p, ec->size );
+ ak_mpzn_lshift_montgomery( u3, u3, ec->p, ec->size );          // u3 = 8*YYYY
+ ak_mpzn_sub_montgomery( wp->y, u5, u3, ec );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Сложение двух точек, заданных в координатах Якоби.
+
+    Для вычислений используются соотношения add-2007-bl (11 умножений и 5 возведений в квадрат)
+
+    \code
+      Z1Z1 = Z1^2
+      Z2Z2 = Z2^2
+      U1 = X1*Z2Z2
+      U2 = X2*Z1Z1
+      S1 = Y1*Z2*Z2Z2
+      S2 = Y2*Z1*Z1Z1
+      H = U2-U1
+      I = (2*H)^2
+      J = H*I
+      r = 2*(S2-S1)
+      V = U1*I
+      X3 = r^2-J-2*V
+      Y3 = r*(V-X3)-2*S1*J
+      Z3 = ((Z1+Z2)^2-Z1Z1-Z2Z2)*H
+    \endcode
+
+    @param wp1 Точка \f$ P \f$, в которую помещается результат операции сложения; первое слагаемое
+    @param wp2 Точка \f$ Q \f$, второе слагаемое
+    @param ec Эллиптическая кривая, которой принадллежат складываемые точки                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_jacobian_add( ak_wpoint wp1, ak_wpoint wp2, ak_wcurve ec )
+{
+  ak_mpznmax u1, u2, u3, u4, u5, u6;
+
+  if( ak_mpzn_cmp_ui( wp2->z, ec->size, 0 ) == ak_true ) return;
+  if( ak_mpzn_cmp_ui( wp1->z, ec->size, 0 ) == ak_true ) {
+    ak_wpoint_set_wpoint( wp1, wp2, ec );
+    return;
+  }
+
+  ak_mpzn_sqr_montgomery( u1, wp1->z, ec->p, ec->n, ec->size );       // u1 = Z1Z1
+  ak_mpzn_sqr_montgomery( u2, wp2->z, ec->p, ec->n, ec->size );       // u2 = Z2Z2
+  ak_mpzn_mul_montgomery( u3, wp1->x, u2, ec->p, ec->n, ec->size );   // u3 = U1
+  ak_mpzn_mul_montgomery( u4, wp2->x, u1, ec->p, ec->n, ec->size );   // u4 = U2
+  ak_mpzn_mul_montgomery( u5, wp1->y, wp2->z, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( u5, u5, u2, ec->p, ec->n, ec->size );       // u5 = S1
+  ak_mpzn_mul_montgomery( u6, wp2->y, wp1->z, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( u6, u6, u1, ec->p, ec->n, ec->size );       // u6 = S2
+  ak_mpzn_sub_montgomery( u4, u4, u3, ec );                           // u4 = H
+  ak_mpzn_sub_montgomery( u6, u6, u5, ec );
+ /* случай совпадения х-координат точек */
+  if( ak_mpzn_cmp_ui( u4, ec->size, 0 ) == ak_true ) {
+    if( ak_mpzn_cmp_ui( u6, ec->size, 0 ) == ak_true ) ak_wpoint_jacobian_double( wp1, ec );
+     else ak_wpoint_set_as_unit( wp1, ec );
+    return;
+  }
+
+  // add-2007-bl
+  ak_mpzn_add_montgomery( wp1->z, wp1->z, wp2->z, ec->p, ec->size );
+  ak_mpzn_sqr_montgomery( wp1->z, wp1->z, ec->p, ec->n, ec->size );
+  ak_mpzn_sub_montgomery( wp1->z, wp1->z, u1, ec );
+  ak_mpzn_sub_montgomery( wp1->z, wp1->z, u2, ec );
+  ak_mpzn_mul_montgomery( wp1->z, wp1->z, u4, ec->p, ec->n, ec->size );
+
+  ak_mpzn_lshift_montgomery( u1, u4, ec->p, ec->size );
+  ak_mpzn_sqr_montgomery( u1, u1, ec->p, ec->n, ec->size );           // u1 = I
+  ak_mpzn_mul_montgomery( u2, u4, u1, ec->p, ec->n, ec->size );       // u2 = J
+  ak_mpzn_lshift_montgomery( u6, u6, ec->p, ec->size );               // u6 = r
+  ak_mpzn_mul_montgomery( u3, u3, u1, ec->p, ec->n, ec->size );       // u3 = V
+
+  ak_mpzn_sqr_montgomery( wp1->x, u6, ec->p, ec->n, ec->size );
+  ak_mpzn_sub_montgomery( wp1->x, wp1->x, u2, ec );
+  ak_mpzn_lshift_montgomery( u4, u3, ec->p, ec->size );
+  ak_mpzn_sub_montgomery( wp1->x, wp1->x, u4, ec );
+
+  ak_mpzn_sub_montgomery( u3, u3, wp1->x, ec );
+  ak_mpzn_mul_montgomery( u3, u3, u6, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( u5, u5, u2, ec->p, ec->n, ec->size );
+  ak_mpzn_lshift_montgomery( u5, u5, ec->p, ec->size );
+  ak_mpzn_sub_montgomery( wp1->y, u3, u5, ec );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Сложение точки, заданной в координатах Якоби, и точки, заданной аффинными координатами.
+
+    Вторая точка \f$ Q = (x_2:y_2:1) \f$ должна иметь z-координату, равную единице
+    в представлении Монтгомери. Для вычислений используются соотношения madd-2007-bl
+    (7 умножений и 4 возведения в квадрат)
+
+    \code
+      Z1Z1 = Z1^2
+      U2 = X2*Z1Z1
+      S2 = Y2*Z1*Z1Z1
+      H = U2-X1
+      HH = H^2
+      I = 4*HH
+      J = H*I
+      r = 2*(S2-Y1)
+      V = X1*I
+      X3 = r^2-J-2*V
+      Y3 = r*(V-X3)-2*Y1*J
+      Z3 = (Z1+H)^2-Z1Z1-HH
+    \endcode
+
+    @param wp1 Точка \f$ P \f$, в которую помещается результат операции сложения; первое слагаемое
+    @param wp2 Точка \f$ Q \f$, второе слагаемое
+    @param ec Эллиптическая кривая, которой принадллежат складываемые точки                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_jacobian_add_affine( ak_wpoint wp1, ak_wpoint wp2, ak_wcurve ec )
+{
+  ak_mpznmax u1, u2, u3, u4, u5, u6;
+
+  if( ak_mpzn_cmp_ui( wp1->z, ec->size, 0 ) == ak_true ) {
+    ak_wpoint_set_wpoint( wp1, wp2, ec );
+    return;
+  }
+
+  ak_mpzn_sqr_montgomery( u1, wp1->z, ec->p, ec->n, ec->size );       // u1 = Z1Z1
+  ak_mpzn_mul_montgomery( u2, wp2->x, u1, ec->p, ec->n, ec->size );   // u2 = U2
+  ak_mpzn_mul_montgomery( u3, wp2->y, wp1->z, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( u3, u3, u1, ec->p, ec->n, ec->size );       // u3 = S2
+  ak_mpzn_sub_montgomery( u2, u2, wp1->x, ec );                       // u2 = H
+  ak_mpzn_sub_montgomery( u3, u3, wp1->y, ec );
+ /* случай совпадения х-координат точек */
+  if( ak_mpzn_cmp_ui( u2, ec->size, 0 ) == ak_true ) {
+    if( ak_mpzn_cmp_ui( u3, ec->size, 0 ) == ak_true ) ak_wpoint_jacobian_double( wp1, ec );
+     else ak_wpoint_set_as_unit( wp1, ec );
+    return;
+  }
+
+  // madd-2007-bl
+  ak_mpzn_sqr_montgomery( u4, u2, ec->p, ec->n, ec->size );           // u4 = HH
+  ak_mpzn_add_montgomery( wp1->z, wp1->z, u2, ec->p, ec->size );
+  ak_mpzn_sqr_montgomery( wp1->z, wp1->z, ec->p, ec->n, ec->size );
+  ak_mpzn_sub_montgomery( wp1->z, wp1->z, u1, ec );
+  ak_mpzn_sub_montgomery( wp1->z, wp1->z, u4, ec );
+
+  ak_mpzn_lshift_montgomery( u4, u4, ec->p, ec->size );
+  ak_mpzn_lshift_montgomery( u4, u4, ec->p, ec->size );               // u4 = I
+  ak_mpzn_mul_montgomery( u5, u2, u4, ec->p, ec->n, ec->size );       // u5 = J
+  ak_mpzn_lshift_montgomery( u3, u3, ec->p, ec->size );               // u3 = r
+  ak_mpzn_mul_montgomery( u4, wp1->x, u4, ec->p, ec->n, ec->size );   // u4 = V
+  ak_mpzn_mul_montgomery( u6, wp1->y, u5, ec->p, ec->n, ec->size );
+  ak_mpzn_lshift_montgomery( u6, u6, ec->p, ec->size );               // u6 = 2*Y1*J
+
+  ak_mpzn_sqr_montgomery( wp1->x, u3, ec->p, ec->n, ec->size );
+  ak_mpzn_sub_montgomery( wp1->x, wp1->x, u5, ec );
+  ak_mpzn_lshift_montgomery( u1, u4, ec->p, ec->size );
+  ak_mpzn_sub_montgomery( wp1->x, wp1->x, u1, ec );
+
+  ak_mpzn_sub_montgomery( u4, u4, wp1->x, ec );
+  ak_mpzn_mul_montgomery( u4, u4, u3, ec->p, ec->n, ec->size );
+  ak_mpzn_sub_montgomery( wp1->y, u4, u6, ec );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*              вычисления на эквивалентной скрученной кривой Эдвардса                             */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Переход от однородных проективных координат к проективным координатам кривой Эдвардса.
+
+    Точка \f$ (x:y:z) \f$ кривой в форме Вейерштрасса заменяется точкой \f$ (U:V:W) \f$
+    эквивалентной кривой Эдвардса, где
+    \f$ U = (x-tz)(x-(t-s)z), \ V = y(x-(t+s)z), \ W = y(x-(t-s)z) \f$.
+    Бесконечно удаленная точка переходит в нейтральный элемент \f$ (0:1:1) \f$,
+    точка второго порядка \f$ (t:0:1) \f$ - в точку \f$ (0:-1:1) \f$.
+
+    @param wp Точка эллиптической кривой.
+    @param ec Эллиптическая кривая, которой принадлежит точка.                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_to_edwards( ak_wpoint wp, ak_wcurve ec )
+{
+  ak_mpznmax u1, u2, u3;
+
+  if( ak_mpzn_cmp_ui( wp->z, ec->size, 0 ) == ak_true ) {
+    ak_mpzn_set_ui( wp->x, ec->size, 0 );
+    ak_mpzn_set( wp->y, ec->r2, ec->size );
+    ak_mpzn_set( wp->z, ec->r2, ec->size );
+    return;
+  }
+  if( ak_mpzn_cmp_ui( wp->y, ec->size, 0 ) == ak_true ) {
+    ak_mpzn_set_ui( wp->x, ec->size, 0 );
+    ak_mpzn_sub( wp->y, ec->p, wp->z, ec->size );
+    return;
+  }
+
+  ak_mpzn_mul_montgomery( u1, ( ak_uint64 *)ec->edwards->t, wp->z, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( u2, ( ak_uint64 *)ec->edwards->s, wp->z, ec->p, ec->n, ec->size );
+  ak_mpzn_sub_montgomery( u3, wp->x, u1, ec );                  // u3 = x - tz
+  ak_mpzn_sub_montgomery( u1, u3, u2, ec );                     // u1 = x - (t+s)z
+  ak_mpzn_add_montgomery( u2, u3, u2, ec->p, ec->size );        // u2 = x - (t-s)z
+  ak_mpzn_mul_montgomery( wp->x, u3, u2, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( wp->z, wp->y, u2, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( wp->y, wp->y, u1, ec->p, ec->n, ec->size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Переход от проективных координат кривой Эдвардса к однородным проективным координатам.
+
+    Точка \f$ (U:V:W) \f$ кривой Эдвардса заменяется точкой \f$ (x:y:z) \f$ кривой
+    в форме Вейерштрасса, где
+    \f$ x = (s(W+V) + t(W-V))U, \ y = s(W+V)W, \ z = (W-V)U \f$.
+
+    @param wp Точка эллиптической кривой.
+    @param ec Эллиптическая кривая, которой принадлежит точка.                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_from_edwards( ak_wpoint wp, ak_wcurve ec )
+{
+  ak_mpznmax u1, u2, u3;
+
+  ak_mpzn_sub_montgomery( u1, wp->z, wp->y, ec );               // u1 = W - V
+ /* нейтральный элемент */
+  if( ak_mpzn_cmp_ui( u1, ec->size, 0 ) == ak_true ) {
+    ak_wpoint_set_as_unit( wp, ec );
+    return;
+  }
+ /* точка второго порядка */
+  if( ak_mpzn_cmp_ui( wp->x, ec->size, 0 ) == ak_true ) {
+    ak_mpzn_mul_montgomery( wp->x, ( ak_uint64 *)ec->edwards->t, wp->z, ec->p, ec->n, ec->size );
+    ak_mpzn_set_ui( wp->y, ec->size, 0 );
+    return;
+  }
+
+  ak_mpzn_add_montgomery( u2, wp->z, wp->y, ec->p, ec->size );
+  ak_mpzn_mul_montgomery( u2, u2, ( ak_uint64 *)ec->edwards->s, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( u3, u1, ( ak_uint64 *)ec->edwards->t, ec->p, ec->n, ec->size );
+  ak_mpzn_add_montgomery( u3, u3, u2, ec->p, ec->size );
+  ak_mpzn_mul_montgomery( wp->y, u2, wp->z, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( wp->z, u1, wp->x, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( wp->x, u3, wp->x, ec->p, ec->n, ec->size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Удвоение точки, заданной в проективных координатах кривой Эдвардса.
+
+    Для вычислений используются соотношения dbl-2008-bbjlp (3 умножения и 4 возведения
+    в квадрат), не имеющие исключительных случаев
+
+    \code
+      B = (X+Y)^2
+      C = X^2
+      D = Y^2
+      E = e*C
+      F = E+D
+      J = F-2*Z^2
+      X3 = (B-C-D)*J
+      Y3 = F*(E-D)
+      Z3 = F*J
+    \endcode
+
+    @param wp удваиваемая точка \f$ P \f$ эллиптической кривой.
+    @param ec эллиптическая кривая, которой принадлежит точка \f$P\f$.                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_edwards_double( ak_wpoint wp, ak_wcurve ec )
+{
+  ak_mpznmax u1, u2, u3, u4, u5, u6;
+
+  ak_mpzn_add_montgomery( u1, wp->x, wp->y, ec->p, ec->size );
+  ak_mpzn_sqr_montgomery( u1, u1, ec->p, ec->n, ec->size );          // u1 = B
+  ak_mpzn_sqr_montgomery( u2, wp->x, ec->p, ec->n, ec->size );       // u2 = C
+  ak_mpzn_sqr_montgomery( u3, wp->y, ec->p, ec->n, ec->size );       // u3 = D
+  ak_mpzn_mul_montgomery( u4, u2, ( ak_uint64 *)ec->edwards->e, ec->p, ec->n, ec->size ); // u4 = E
+  ak_mpzn_add_montgomery( u5, u4, u3, ec->p, ec->size );             // u5 = F
+  ak_mpzn_sqr_montgomery( u6, wp->z, ec->p, ec->n, ec->size );
+  ak_mpzn_lshift_montgomery( u6, u6, ec->p, ec->size );
+  ak_mpzn_sub_montgomery( u6, u5, u6, ec );                          // u6 = J
+
+  ak_mpzn_sub_montgomery( u1, u1, u2, ec );
+  ak_mpzn_sub_montgomery( u1, u1, u3, ec );
+  ak_mpzn_mul_montgomery( wp->x, u1, u6, ec->p, ec->n, ec->size );
+  ak_mpzn_sub_montgomery( u4, u4, u3, ec );
+  ak_mpzn_mul_montgomery( wp->y, u5, u4, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( wp->z, u5, u6, ec->p, ec->n, ec->size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Сложение двух точек, заданных в проективных координатах кривой Эдвардса.
+
+    Для вычислений используются соотношения add-2008-bbjlp, в которых величина \f$ A = Z_1Z_2\f$
+    вычисляется заранее (для точки \f$ Q \f$, заданной аффинными координатами, \f$ A = Z_1 \f$)
+
+    \code
+      B = A^2
+      C = X1*X2
+      D = Y1*Y2
+      E = d*C*D
+      F = B-E
+      G = B+E
+      X3 = A*F*((X1+Y1)*(X2+Y2)-C-D)
+      Y3 = A*G*(D-e*C)
+      Z3 = F*G
+    \endcode
+
+    Поскольку коэффициент \f$ e \f$ является квадратичным вычетом, а коэффициент \f$ d \f$ -
+    невычетом, формулы являются полными: они верны для любых, в том числе совпадающих,
+    слагаемых, а также для нейтрального элемента.
+
+    @param wp1 Точка \f$ P \f$, в которую помещается результат операции сложения; первое слагаемое
+    @param wp2 Точка \f$ Q \f$, второе слагаемое
+    @param a Величина \f$ A \f$
+    @param ec Эллиптическая кривая, которой принадллежат складываемые точки                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_edwards_add_common( ak_wpoint wp1, ak_wpoint wp2, ak_uint64 *a,
+                                                                                   ak_wcurve ec )
+{
+  ak_mpznmax u1, u2, u3, u4, u5, u6;
+
+  ak_mpzn_sqr_montgomery( u1, a, ec->p, ec->n, ec->size );               // u1 = B
+  ak_mpzn_mul_montgomery( u2, wp1->x, wp2->x, ec->p, ec->n, ec->size );  // u2 = C
+  ak_mpzn_mul_montgomery( u3, wp1->y, wp2->y, ec->p, ec->n, ec->size );  // u3 = D
+  ak_mpzn_mul_montgomery( u4, u2, u3, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( u4, u4, ( ak_uint64 *)ec->edwards->d, ec->p, ec->n, ec->size ); // u4 = E
+  ak_mpzn_sub_montgomery( u5, u1, u4, ec );                              // u5 = F
+  ak_mpzn_add_montgomery( u1, u1, u4, ec->p, ec->size );                 // u1 = G
+
+  ak_mpzn_add_montgomery( u4, wp1->x, wp1->y, ec->p, ec->size );
+  ak_mpzn_add_montgomery( u6, wp2->x, wp2->y, ec->p, ec->size );
+  ak_mpzn_mul_montgomery( u4, u4, u6, ec->p, ec->n, ec->size );
+  ak_mpzn_sub_montgomery( u4, u4, u2, ec );
+  ak_mpzn_sub_montgomery( u4, u4, u3, ec );
+  ak_mpzn_mul_montgomery( u4, u4, u5, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( wp1->x, u4, a, ec->p, ec->n, ec->size );
+
+  ak_mpzn_mul_montgomery( u2, u2, ( ak_uint64 *)ec->edwards->e, ec->p, ec->n, ec->size );
+  ak_mpzn_sub_montgomery( u3, u3, u2, ec );
+  ak_mpzn_mul_montgomery( u3, u3, u1, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( wp1->y, u3, a, ec->p, ec->n, ec->size );
+  ak_mpzn_mul_montgomery( wp1->z, u5, u1, ec->p, ec->n, ec->size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Сложение двух точек, заданных в проективных координатах кривой Эдвардса. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_edwards_add( ak_wpoint wp1, ak_wpoint wp2, ak_wcurve ec )
+{
+  ak_mpznmax a;
+
+  ak_mpzn_mul_montgomery( a, wp1->z, wp2->z, ec->p, ec->n, ec->size );
+  ak_wpoint_edwards_add_common( wp1, wp2, a, ec );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Сложение точки кривой Эдвардса и точки, z-координата которой равна единице
+    в представлении Монтгомери. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_edwards_add_affine( ak_wpoint wp1, ak_wpoint wp2, ak_wcurve ec )
+{
+  ak_mpznmax a;
+
+  ak_mpzn_set( a, wp1->z, ec->size );
+  ak_wpoint_edwards_add_common( wp1, wp2, a, ec );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Условная смена знака точки кривой в форме Вейерштрасса (y-координаты).
+
+    Смена знака выполняется за фиксированное время, не зависящее от значения маски.
+    @param wp Точка эллиптической кривой.
+    @param mask Маска: все единицы, если знак меняется, и ноль в противном случае.
+    @param ec Эллиптическая кривая, которой принадлежит точка.                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_negate_y( ak_wpoint wp, ak_uint64 mask, ak_wcurve ec )
+{
+  size_t i;
+  ak_mpznmax t, zero = ak_mpznmax_zero;
+
+  ak_mpzn_sub_montgomery( t, zero, wp->y, ec );
+  for( i = 0; i < ec->size; i++ ) wp->y[i] = ( wp->y[i]&~mask )^( t[i]&mask );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Условная смена знака точки кривой Эдвардса (u-координаты). */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_wpoint_negate_x( ak_wpoint wp, ak_uint64 mask, ak_wcurve ec )
+{
+  size_t i;
+  ak_mpznmax t, zero = ak_mpznmax_zero;
+
+  ak_mpzn_sub_montgomery( t, zero, wp->x, ec );
+  for( i = 0; i < ec->size; i++ ) wp->x[i] = ( wp->x[i]&~mask )^( t[i]&mask );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Не изменяющее точку преобразование координат (для однородных проективных координат). */
+ static void ak_wpoint_projective_identity( ak_wpoint wp, ak_wcurve ec )
+{
+  (void)wp; (void)ec;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Набор операций с точками, используемый при вычислении кратных точек. */
+ typedef struct wpoint_engine {
+ /*! \brief Переход от однородных проективных координат к внутреннему представлению. */
+  void ( *import )( ak_wpoint, ak_wcurve );
+ /*! \brief Переход от внутреннего представления к однородным проективным координатам. */
+  void ( *export )( ak_wpoint, ak_wcurve );
+ /*! \brief Удвоение точки. */
+  void ( *dbl )( ak_wpoint, ak_wcurve );
+ /*! \brief Сложение двух точек. */
+  void ( *add )( ak_wpoint, ak_wpoint, ak_wcurve );
+ /*! \brief Сложение с точкой, z-координата которой равна единице в представлении Монтгомери. */
+  void ( *add_affine )( ak_wpoint, ak_wpoint, ak_wcurve );
+ /*! \brief Условная смена знака точки (выполняется за фиксированное время). */
+  void ( *neg )( ak_wpoint, ak_uint64, ak_wcurve );
+} const *ak_wpoint_engine;
+
+/* ----------------------------------------------------------------------------------------------- */
+ static const struct wpoint_engine wpoint_projective_engine = {
+   ak_wpoint_projective_identity,
+   ak_wpoint_projective_identity,
+   ak_wpoint_double,
+   ak_wpoint_add,
+   ak_wpoint_add,
+   ak_wpoint_negate_y
+ };
+
+ static const struct wpoint_engine wpoint_jacobian_engine = {
+   ak_wpoint_to_jacobian,
+   ak_wpoint_from_jacobian,
+   ak_wpoint_jacobian_double,
+   ak_wpoint_jacobian_add,
+   ak_wpoint_jacobian_add_affine,
+   ak_wpoint_negate_y
+ };
+
+ static const struct wpoint_engine wpoint_edwards_engine = {
+   ak_wpoint_to_edwards,
+   ak_wpoint_from_edwards,
+   ak_wpoint_edwards_double,
+   ak_wpoint_edwards_add,
+   ak_wpoint_edwards_add_affine,
+   ak_wpoint_negate_x
+ };
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Выбор набора операций с точками в соответствии с системой координат кривой.
+    @param ec Эллиптическая кривая.
+    @return Указатель на набор операций.                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline ak_wpoint_engine ak_wcurve_get_engine( ak_wcurve ec )
+{
+  switch( ec->coordinates ) {
+    case wcurve_projective_coordinates: return &wpoint_projective_engine;
+    case wcurve_edwards_coordinates: return &wpoint_edwards_engine;
+    default: return &wpoint_jacobian_engine;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Условная перестановка двух точек, выполняемая за фиксированное время.
+
+    @param wp Первая точка.
+    @param wq Вторая точка.
+    @param mask Маска: все единицы, если точки переставляются, и ноль в противном случае.
+    @param ec Эллиптическая кривая, которой принадлежат точки.                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_wpoint_cswap( ak_wpoint wp, ak_wpoint wq, ak_uint64 mask, ak_wcurve ec )
+{
+  size_t i;
+  ak_uint64 t;
+
+  for( i = 0; i < ec->size; i++ ) {
+     t = ( wp->x[i]^wq->x[i] )&mask; wp->x[i] ^= t; wq->x[i] ^= t;
+     t = ( wp->y[i]^wq->y[i] )&mask; wp->y[i] ^= t; wq->y[i] ^= t;
+     t = ( wp->z[i]^wq->z[i] )&mask; wp->z[i] ^= t; wq->z[i] ^= t;
+  }
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Для заданной точки \f$ P = (x:y:z) \f$ и заданного целого числа (вычета) \f$ k \f$
     функция вычисляет кратную точку \f$ Q \f$, удовлетворяющую
     равенству \f$  Q = [k]P = \underbrace{P+ \cdots + P}_{k}\f$.
 
     При вычислении используется метод `лесенки Монтгомери`, выравнивающий время работы алгоритма
-    вне зависимости от вида числа \f$ k \f$.
+    вне зависимости от вида числа \f$ k \f$; порядок слагаемых на каждом шаге определяется
+    условной перестановкой точек, выполняемой за фиксированное время. Промежуточные точки
+    представляются в системе координат, заданной в параметрах кривой
+    (см. \ref wcurve_coordinates_t). Для кривых, эквивалентных скрученным кривым Эдвардса,
+    используются полные формулы сложения, не содержащие ветвлений.
 
     \b Для \b информации:
      \li Функция не приводит результирующую точку \f$ Q \f$ к аффинной форме.
@@ -629,25 +1400,540 @@
 /* ----------------------------------------------------------------------------------------------- */
  void ak_wpoint_pow( ak_wpoint wq, ak_wpoint wp, ak_uint64 *k, size_t size, ak_wcurve ec )
 {
-  ak_uint64 uk = 0;
+  ak_uint64 uk = 0, mask;
   long long int i, j;
   struct wpoint Q, R; /* две точки из лесенки Монтгомери */
+  ak_wpoint_engine eng = ak_wcurve_get_engine( ec );
 
  /* начальные значения для переменных */
   ak_wpoint_set_as_unit( &Q, ec );
   ak_wpoint_set_wpoint( &R, wp, ec );
+  eng->import( &Q, ec );
+  eng->import( &R, ec );
 
- /* полный цикл по всем(!) битам числа k */
+ /* полный цикл по всем(!) битам числа k:
+    для единичного бита вычисляются Q <- Q+R, R <- 2R, для нулевого R <- R+Q, Q <- 2Q */
   for( i = size-1; i >= 0; i-- ) {
      uk = k[i];
      for( j = 0; j < 64; j++ ) {
-       if( uk&0x8000000000000000LL ) { ak_wpoint_add( &Q, &R, ec ); ak_wpoint_double( &R, ec ); }
-        else { ak_wpoint_add( &R, &Q, ec ); ak_wpoint_double( &Q, ec ); }
+       mask = ( ak_uint64 )0 - ( uk >> 63 );
+       ak_wpoint_cswap( &Q, &R, mask, ec );
+       eng->add( &R, &Q, ec );
+       eng->dbl( &Q, ec );
+       ak_wpoint_cswap( &Q, &R, mask, ec );
        uk <<= 1;
      }
   }
  /* копируем полученный результат */
+  eng->export( &Q, ec );
+  ak_wpoint_set_wpoint( wq, &Q, ec );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество нечетных кратных точки, используемых при вычислениях с фиксированным окном. */
+ #define ak_wpoint_window_points  (8)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Выбор точки из таблицы, выполняемый за фиксированное время.
+
+    Функция просматривает все точки таблицы и копирует точку с заданным индексом с помощью
+    масок, поэтому обращения к памяти не зависят от значения индекса.
+
+    @param wr Точка, в которую помещается результат.
+    @param table Таблица из \ref ak_wpoint_window_points точек.
+    @param index Индекс выбираемой точки.
+    @param ec Эллиптическая кривая, которой принадлежат точки.                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_wpoint_select( ak_wpoint wr, ak_wpoint table, ak_uint64 index, ak_wcurve ec )
+{
+  size_t i, j;
+  ak_uint64 t, mask;
+
+  for( i = 0; i < ec->size; i++ ) wr->x[i] = wr->y[i] = wr->z[i] = 0;
+  for( j = 0; j < ak_wpoint_window_points; j++ ) {
+     t = j^index;
+     mask = (( t|( (ak_uint64)0 - t )) >> 63 ) - 1;
+     for( i = 0; i < ec->size; i++ ) {
+        wr->x[i] |= table[j].x[i]&mask;
+        wr->y[i] |= table[j].y[i]&mask;
+        wr->z[i] |= table[j].z[i]&mask;
+     }
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Для заданной точки \f$ P \f$ порядка \f$ q \f$ и вычета \f$ k < q \f$ функция вычисляет
+    кратную точку \f$ Q = [k]P \f$ методом фиксированного окна ширины 4 бита.
+
+    Если число \f$ k \f$ четно, оно заменяется нечетным числом \f$ q - k \f$, а знак результата
+    меняется на противоположный. Нечетное число представляется в виде
+    \f$ k = \sum_{i=0}^{n-1} d_i16^i \f$ с нечетными цифрами \f$ d_i \in \{\pm 1, \pm 3, \ldots, \pm 15\}\f$,
+    где \f$ n = \lfloor b/4 \rfloor + 1 \f$, а \f$ b \f$ - битовая длина порядка \f$ q \f$.
+    Поскольку ни одна из цифр не равна нулю, на каждом шаге выполняются ровно четыре удвоения и
+    одно сложение; точка \f$ [|d_i|]P \f$ выбирается из таблицы нечетных кратных
+    \f$ P, [3]P, \ldots, [15]P \f$ с помощью масок, а ее знак меняется за фиксированное время.
+    Для 256-ти битного порядка функция выполняет около 330 операций сложения и удвоения
+    вместо 512 операций, выполняемых функцией ak_wpoint_pow().
+
+    \b Для \b информации:
+     \li Функция не приводит результирующую точку \f$ Q \f$ к аффинной форме.
+     \li Исходная точка \f$ P \f$ и результирующая точка \f$ Q \f$ могут совпадать.
+     \li Если \f$ k \geq q \f$, то вычисления выполняются функцией ak_wpoint_pow().
+
+    @param wq Точка \f$ Q \f$, в которую помещается результат.
+    @param wp Точка \f$ P \f$, порядок которой равен \f$ q \f$.
+    @param k Степень кратности.
+    @param size Размер степени \f$ k \f$ в машинных словах.
+    @param ec Эллиптическая кривая, на которой происходят вычисления                               */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_wpoint_pow_window( ak_wpoint wq, ak_wpoint wp, ak_uint64 *k, size_t size, ak_wcurve ec )
+{
+  size_t i, pos, bits;
+  ak_uint64 even, neg, u, d;
+  ak_mpznmax kk = ak_mpznmax_zero, t;
+  struct wpoint table[ak_wpoint_window_points], Q, T;
+  ak_wpoint_engine eng = ak_wcurve_get_engine( ec );
+
+ /* степень должна быть вычетом по модулю q */
+  for( i = ec->size; i < size; i++ )
+     if( k[i] ) { ak_wpoint_pow( wq, wp, k, size, ec ); return; }
+  for( i = 0; i < ak_min( size, ec->size ); i++ ) kk[i] = k[i];
+  if( ak_mpzn_cmp( kk, ec->q, ec->size ) >= 0 ) { ak_wpoint_pow( wq, wp, k, size, ec ); return; }
+
+ /* для четного k используем нечетное число q - k */
+  even = ( k[0]&1 ) - 1;
+  ak_mpzn_sub( t, ec->q, kk, ec->size );
+  for( i = 0; i < ec->size; i++ ) kk[i] = ( kk[i]&~even )^( t[i]&even );
+
+ /* вычисляем нечетные кратные P, [3]P, ..., [15]P */
+  ak_wpoint_set_wpoint( table, wp, ec );
+  eng->import( table, ec );
+  ak_wpoint_set_wpoint( &T, table, ec );
+  eng->dbl( &T, ec );
+  for( i = 1; i < ak_wpoint_window_points; i++ ) {
+     ak_wpoint_set_wpoint( table+i, table+i-1, ec );
+     eng->add( table+i, &T, ec );
+  }
+
+ /* битовая длина порядка q определяет количество окон */
+  for( bits = 64*ec->size; bits > 0; bits-- )
+     if(( ec->q[( bits-1 ) >> 6] >> (( bits-1 )&0x3f ))&1 ) break;
+  pos = ( bits >> 2 ) << 2;
+
+ /* старшая цифра всегда положительна */
+  u = ( kk[pos >> 6] >> ( pos&0x3f ))|1;
+  ak_wpoint_select( &Q, table, u >> 1, ec );
+
+  while( pos > 0 ) {
+     pos -= 4;
+     eng->dbl( &Q, ec );
+     eng->dbl( &Q, ec );
+     eng->dbl( &Q, ec );
+     eng->dbl( &Q, ec );
+
+    /* извлекаем пять бит, начиная с позиции pos, и формируем нечетную цифру d = u - 16 */
+     u = kk[pos >> 6] >> ( pos&0x3f );
+     if(( pos&0x3f ) > 59 ) u |= kk[( pos >> 6 )+1] << ( 64 - ( pos&0x3f ));
+     u = ( u&0x1f )|1;
+     neg = ( u >> 4 ) - 1;
+     d = (( u - 16 )^neg ) - neg;
+
+     ak_wpoint_select( &T, table, d >> 1, ec );
+     eng->neg( &T, neg, ec );
+     eng->add( &Q, &T, ec );
+  }
+
+ /* возвращаем знак результата */
+  eng->neg( &Q, even, ec );
+  eng->export( &Q, ec );
+  ak_wpoint_set_wpoint( wq, &Q, ec );
+}
+/* ----------------------------------------------------------------------------------------------- */
+/*                  таблицы кратных образующей точки эллиптической кривой                          */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество нечетных кратных точки, хранящихся в таблице для одного окна. */
+ #define ak_wcurve_generator_window_points  (8)
+/*! \brief Ширина окна wNAF представления, используемая для образующей точки. */
+ #define ak_wcurve_generator_wnaf_width  (7)
+/*! \brief Ширина окна wNAF представления, используемая для произвольной точки. */
+ #define ak_wpoint_wnaf_width  (5)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Таблица кратных образующей точки эллиптической кривой.
+
+    Для каждого окна \f$ i \f$ длины 4 бита таблица содержит аффинные координаты точек
+    \f$ [j16^i]P \f$, где \f$ j = 1, 3, \ldots, 15 \f$, а \f$ P \f$ образующая точка кривой.
+    Кроме того, таблица содержит аффинные координаты нечетных кратных \f$ P, [3]P, \ldots, [63]P \f$,
+    используемых для вычислений с помощью wNAF представления степени кратности.
+    Для каждой точки последовательно хранятся `x` и `y` координаты длины `wc->size` слов
+    в представлении Монтгомери, то есть z-координата каждой точки равна величине `one`.          */
+/* ----------------------------------------------------------------------------------------------- */
+ typedef struct wcurve_generator_table {
+ /*! \brief Эллиптическая кривая, для образующей точки которой выработана таблица. */
+  ak_wcurve wc;
+ /*! \brief Копия модуля кривой, используемая для контроля совпадения параметров. */
+  ak_uint64 p[ak_mpzn512_size];
+ /*! \brief Копия образующей точки, используемая для контроля совпадения параметров. */
+  struct wpoint point;
+ /*! \brief Количество окон (четырехбитных фрагментов степени кратности). */
+  size_t windows;
+ /*! \brief Координаты кратных точек. */
+  ak_uint64 *data;
+ /*! \brief Координаты нечетных кратных точек (указатель на область внутри data). */
+  ak_uint64 *odd;
+ /*! \brief Единица в представлении Монтгомери. */
+  ak_uint64 one[ak_mpzn512_size];
+ /*! \brief Следующая таблица в списке. */
+  struct wcurve_generator_table *next;
+} *ak_wcurve_generator_table;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Список таблиц, выработанных для используемых эллиптических кривых. */
+ static ak_wcurve_generator_table wcurve_generator_tables = NULL;
+#ifdef AK_HAVE_PTHREAD_H
+ static pthread_mutex_t wcurve_generator_tables_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Выработка таблицы кратных образующей точки заданной эллиптической кривой.
+
+    @param ec Эллиптическая кривая.
+    @return В случае успеха возвращается указатель на созданную таблицу. В случае ошибки
+    возвращается NULL.                                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_wcurve_generator_table ak_wcurve_generator_table_new( ak_wcurve ec )
+{
+  size_t i, j, count;
+  ak_uint64 *ptr = NULL;
+  ak_wpoint wp = NULL, tp = NULL;
+  struct wpoint base, dbl;
+  ak_mpznmax one = ak_mpznmax_one;
+  ak_wcurve_generator_table tb = NULL;
+
+  if(( tb = malloc( sizeof( struct wcurve_generator_table ))) == NULL ) {
+    ak_error_message( ak_error_out_of_memory, __func__, "incorrect memory allocation" );
+    return NULL;
+  }
+  tb->wc = ec;
+  tb->windows = 16*ec->size;
+  tb->next = NULL;
+  memcpy( tb->p, ec->p, sizeof( tb->p ));
+  memcpy( &tb->point, &ec->point, sizeof( struct wpoint ));
+  count = tb->windows*ak_wcurve_generator_window_points +
+                                           ( 1 << ( ak_wcurve_generator_wnaf_width -2 ));
+  tb->data = malloc( count*2*ec->size*sizeof( ak_uint64 ));
+ /* временный массив точек в проективных координатах */
+  wp = malloc( count*sizeof( struct wpoint ));
+  if(( tb->data == NULL ) || ( wp == NULL )) {
+    if( wp != NULL ) free( wp );
+    if( tb->data != NULL ) free( tb->data );
+    free( tb );
+    ak_error_message( ak_error_out_of_memory, __func__, "incorrect memory allocation" );
+    return NULL;
+  }
+
+ /* для каждого окна вычисляем точки [16^i]P, [3*16^i]P, ... , [15*16^i]P */
+  ak_wpoint_set( &base, ec );
+  for( i = 0, tp = wp; i < tb->windows; i++ ) {
+     ak_wpoint_set_wpoint( &dbl, &base, ec );
+     ak_wpoint_double( &dbl, ec );
+     ak_wpoint_set_wpoint( tp, &base, ec );
+     for( j = 1; j < ak_wcurve_generator_window_points; j++, tp++ ) {
+        ak_wpoint_set_wpoint( tp +1, tp, ec );
+        ak_wpoint_add( tp +1, &dbl, ec );
+     }
+     tp++;
+     for( j = 0; j < 4; j++ ) ak_wpoint_double( &base, ec );
+  }
+ /* нечетные кратные P, [3]P, ... , [63]P */
+  ak_wpoint_set( &dbl, ec );
+  ak_wpoint_double( &dbl, ec );
+  ak_wpoint_set( tp, ec );
+  for( ; tp < wp +count -1; tp++ ) {
+     ak_wpoint_set_wpoint( tp +1, tp, ec );
+     ak_wpoint_add( tp +1, &dbl, ec );
+  }
+ /* для кривых, эквивалентных кривым Эдвардса, в таблице хранятся точки кривой Эдвардса */
+  if( ec->coordinates == wcurve_edwards_coordinates )
+    for( i = 0; i < count; i++ ) ak_wpoint_to_edwards( wp +i, ec );
+
+ /* приводим все точки к аффинной форме и сохраняем их координаты в представлении Монтгомери */
+  ak_wpoint_reduce_batch( wp, count, ec );
+  for( i = 0, ptr = tb->data; i < count; i++, ptr += 2*ec->size ) {
+     ak_mpzn_mul_montgomery( ptr, wp[i].x, ec->r2, ec->p, ec->n, ec->size );
+     ak_mpzn_mul_montgomery( ptr +ec->size, wp[i].y, ec->r2, ec->p, ec->n, ec->size );
+  }
+  memset( tb->one, 0, sizeof( tb->one ));
+  ak_mpzn_mul_montgomery( tb->one, ec->r2, one, ec->p, ec->n, ec->size );
+  tb->odd = tb->data +2*tb->windows*ak_wcurve_generator_window_points*ec->size;
+
+  free( wp );
+ return tb;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Получение таблицы кратных образующей точки заданной эллиптической кривой.
+
+    При первом обращении таблица вырабатывается и сохраняется до завершения работы с библиотекой;
+    последующие обращения (в том числе из различных потоков) используют уже выработанную таблицу.
+
+    @param ec Эллиптическая кривая.
+    @return Указатель на таблицу. В случае ошибки возвращается NULL.                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_wcurve_generator_table ak_wcurve_get_generator_table( ak_wcurve ec )
+{
+  ak_wcurve_generator_table tb = NULL;
+
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &wcurve_generator_tables_mutex );
+#endif
+  for( tb = wcurve_generator_tables; tb != NULL; tb = tb->next ) {
+     if(( tb->wc == ec ) &&
+        ( memcmp( tb->p, ec->p, sizeof( tb->p )) == 0 ) &&
+        ( memcmp( &tb->point, &ec->point, sizeof( struct wpoint )) == 0 )) break;
+  }
+  if( tb == NULL ) {
+    if(( tb = ak_wcurve_generator_table_new( ec )) != NULL ) {
+      tb->next = wcurve_generator_tables;
+      wcurve_generator_tables = tb;
+    }
+  }
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &wcurve_generator_tables_mutex );
+#endif
+ return tb;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вызывается при завершении работы с библиотекой.                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_wcurve_destroy_generator_tables( void )
+{
+  ak_wcurve_generator_table tb = NULL;
+
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &wcurve_generator_tables_mutex );
+#endif
+  while(( tb = wcurve_generator_tables ) != NULL ) {
+    wcurve_generator_tables = tb->next;
+    free( tb->data );
+    free( tb );
+  }
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &wcurve_generator_tables_mutex );
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет точку \f$ Q = [k]P \f$, где \f$ P \f$ образующая точка эллиптической кривой,
+    используя заранее выработанную таблицу кратных точки \f$ P \f$. Таблица вырабатывается
+    при первом вызове функции для заданной кривой.
+
+    Степень кратности \f$ k \f$ (или \f$ q-k \f$, если \f$ k \f$ четно) представляется в виде
+    \f$ k = \sum_i d_i16^i \f$, где все \f$ d_i \f$ нечетны и \f$ |d_i| \leq 15 \f$.
+    Тогда вычисление кратной точки сводится к сложению `4*wc->size` точек,
+    выбираемых из таблицы; для кривых, использующих координаты Якоби, каждое сложение
+    выполняется по формулам сложения с аффинной точкой. Выбор точки выполняется за фиксированное время, не зависящее от
+    значения \f$ d_i \f$, поскольку каждый раз просматриваются все точки, хранящиеся для окна.
+
+    \b Для \b информации:
+     \li Функция не приводит результирующую точку \f$ Q \f$ к аффинной форме.
+     \li Степень кратности должна удовлетворять неравенству \f$ 0 \leq k < q \f$.
+     \li Если таблица не может быть выработана или длина `size` отлична от `wc->size`,
+         то вычисление выполняется функцией ak_wpoint_pow().
+
+    @param wq Точка \f$ Q \f$, в которую помещается результат.
+    @param k Степень кратности.
+    @param size Размер степени \f$ k \f$ в машинных словах.
+    @param ec Эллиптическая кривая, на которой происходят вычисления                               */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_wpoint_pow_generator( ak_wpoint wq, ak_uint64 *k, size_t size, ak_wcurve ec )
+{
+  size_t i, j, l;
+  struct wpoint Q, T;
+  ak_uint64 *ptr = NULL;
+  ak_mpznmax e, t;
+  ak_uint64 even, digit, sign, idx, mask;
+  ak_wcurve_generator_table tb = NULL;
+  ak_wpoint_engine eng = ak_wcurve_get_engine( ec );
+
+  if(( size != ec->size ) || (( tb = ak_wcurve_get_generator_table( ec )) == NULL )) {
+    ak_wpoint_pow( wq, &ec->point, k, size, ec );
+    return;
+  }
+
+ /* вместо четного k используем нечетное значение q-k, результат затем меняет знак */
+  ak_mpzn_sub( t, ec->q, k, size );
+  even = ( k[0]&1 ) - 1;
+  for( i = 0; i < size; i++ ) e[i] = ( k[i]&~even )^( t[i]&even );
+
+ /* вычисляем e <- (k-1)/2 + 2^{64size-1},
+    тогда четырехбитные фрагменты e_i задают нечетные цифры d_i = 2e_i - 15 */
+  for( i = 0; i < size-1; i++ ) e[i] = ( e[i] >> 1 )^( e[i+1] << 63 );
+  e[size-1] = ( e[size-1] >> 1 )^0x8000000000000000LL;
+
+  ak_wpoint_set_as_unit( &Q, ec );
+  ak_mpzn_set( T.z, tb->one, size );
+  for( i = 0, ptr = tb->data; i < tb->windows; i++ ) {
+     digit = ( e[i >> 4] >> ( 4*( i&0xf ))) & 0xf;
+     sign = (( digit >> 3 )&1 ) - 1; /* маска отрицательной цифры */
+     idx = ( digit^sign )&0x7;       /* индекс точки [|d_i|16^i]P в таблице */
+
+    /* выбираем точку, просматривая все точки окна */
+     memset( T.x, 0, size*sizeof( ak_uint64 ));
+     memset( T.y, 0, size*sizeof( ak_uint64 ));
+     for( j = 0; j < ak_wcurve_generator_window_points; j++ ) {
+        mask = ( ak_uint64 )0 - ((( j^idx ) - 1 ) >> 63 );
+        for( l = 0; l < size; l++ ) {
+           T.x[l] ^= ptr[l]&mask;
+           T.y[l] ^= ptr[size+l]&mask;
+        }
+        ptr += 2*size;
+     }
+    /* для отрицательной цифры меняем знак точки */
+     eng->neg( &T, sign, ec );
+
+     if( i == 0 ) ak_wpoint_set_wpoint( &Q, &T, ec );
+       else eng->add_affine( &Q, &T, ec );
+  }
+
+ /* для четного k меняем знак результата */
+  eng->neg( &Q, even, ec );
+  eng->export( &Q, ec );
   ak_wpoint_set_wpoint( wq, &Q, ec );
+
+  memset( &Q, 0, sizeof( struct wpoint ));
+  memset( &T, 0, sizeof( struct wpoint ));
+  memset( e, 0, sizeof( ak_mpznmax ));
+  memset( t, 0, sizeof( ak_mpznmax ));
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычисление wNAF представления неотрицательного целого числа.
+
+    Число \f$ k \f$ представляется в виде \f$ k = \sum_i d_i2^i \f$, где каждая ненулевая цифра
+    \f$ d_i \f$ нечетна, удовлетворяет неравенству \f$ |d_i| < 2^{w-1} \f$, а среди любых
+    \f$ w \f$ последовательных цифр не более одной отлично от нуля.
+
+    @param naf Массив, в который помещаются цифры (начиная с младшей); должен содержать
+    не менее `64*size+1` элементов.
+    @param k Число, для которого вычисляется представление.
+    @param size Размер числа \f$ k \f$ в машинных словах.
+    @param w Ширина окна.
+    @return Количество вычисленных цифр.                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static size_t ak_mpzn_wnaf( ak_int8 *naf, ak_uint64 *k, const size_t size, const unsigned int w )
+{
+  ak_int64 d;
+  size_t i, len = 0;
+  ak_uint64 c, v, t[ak_mpzn512_size+1];
+  const ak_uint64 mod = ( ak_uint64 )1 << w;
+
+  memcpy( t, k, size*sizeof( ak_uint64 ));
+  t[size] = 0;
+  while( ak_mpzn_cmp_ui( t, size+1, 0 ) != ak_true ) {
+     d = 0;
+     if( t[0]&1 ) {
+       d = ( ak_int64 )( t[0]&( mod-1 ));
+       if( d >= ( ak_int64 )( mod >> 1 )) d -= ( ak_int64 )mod;
+      /* t <- t - d */
+       if( d > 0 ) {
+         for( i = 0, c = ( ak_uint64 )d; c && ( i <= size ); i++ ) {
+            v = t[i]; t[i] = v - c; c = ( v < c );
+         }
+       } else {
+           for( i = 0, c = ( ak_uint64 )( -d ); c && ( i <= size ); i++ ) {
+              t[i] += c; c = ( t[i] < c );
+           }
+         }
+     }
+     naf[len++] = ( ak_int8 )d;
+    /* t <- t/2 */
+     for( i = 0; i < size; i++ ) t[i] = ( t[i] >> 1 )^( t[i+1] << 63 );
+     t[size] >>= 1;
+  }
+ return len;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Для образующей точки \f$ P \f$ эллиптической кривой, заданной точки \f$ Q \f$ и
+    целых чисел \f$ k_1, k_2 \f$ функция вычисляет точку \f$ R = [k_1]P + [k_2]Q \f$.
+
+    Для вычислений используется метод Штрауса (Шамира) совместного вычисления кратных точек:
+    степени кратности представляются в wNAF форме, после чего обе кратные точки
+    вычисляются за один общий проход с удвоениями. Для образующей точки используются
+    заранее выработанные нечетные кратные \f$ P, [3]P, \ldots, [63]P \f$ (см. описание функции
+    ak_wpoint_pow_generator()), для точки \f$ Q \f$ нечетные кратные \f$ Q, [3]Q, \ldots, [15]Q \f$
+    вычисляются при каждом вызове функции.
+
+    \warning Время работы функции зависит от значений \f$ k_1, k_2 \f$, поэтому функция должна
+    использоваться только с открытыми данными, например, при проверке электронной подписи.
+
+    \b Для \b информации:
+     \li Функция не приводит результирующую точку \f$ R \f$ к аффинной форме.
+
+    @param wr Точка \f$ R \f$, в которую помещается результат.
+    @param k1 Степень кратности образующей точки.
+    @param wq Точка \f$ Q \f$.
+    @param k2 Степень кратности точки \f$ Q \f$.
+    @param size Размер степеней кратности в машинных словах.
+    @param ec Эллиптическая кривая, на которой происходят вычисления                               */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_wpoint_pow_sum( ak_wpoint wr, ak_uint64 *k1, ak_wpoint wq, ak_uint64 *k2,
+                                                                     size_t size, ak_wcurve ec )
+{
+  long long int i;
+  ak_uint64 *ptr = NULL;
+  size_t j, len1, len2;
+  struct wpoint R, T, dq, tq[ 1 << ( ak_wpoint_wnaf_width -2 )];
+  ak_int8 naf1[ 64*ak_mpzn512_size +1 ], naf2[ 64*ak_mpzn512_size +1 ];
+  ak_wcurve_generator_table tb = NULL;
+  ak_wpoint_engine eng = ak_wcurve_get_engine( ec );
+
+  if(( size > ak_mpzn512_size ) || (( tb = ak_wcurve_get_generator_table( ec )) == NULL )) {
+    ak_wpoint_pow( &R, &ec->point, k1, size, ec );
+    ak_wpoint_pow( &T, wq, k2, size, ec );
+    ak_wpoint_add( &R, &T, ec );
+    ak_wpoint_set_wpoint( wr, &R, ec );
+    return;
+  }
+
+ /* нечетные кратные точки Q */
+  ak_wpoint_set_wpoint( tq, wq, ec );
+  eng->import( tq, ec );
+  ak_wpoint_set_wpoint( &dq, tq, ec );
+  eng->dbl( &dq, ec );
+  for( j = 1; j < ( 1 << ( ak_wpoint_wnaf_width -2 )); j++ ) {
+     ak_wpoint_set_wpoint( tq +j, tq +j -1, ec );
+     eng->add( tq +j, &dq, ec );
+  }
+
+  len1 = ak_mpzn_wnaf( naf1, k1, size, ak_wcurve_generator_wnaf_width );
+  len2 = ak_mpzn_wnaf( naf2, k2, size, ak_wpoint_wnaf_width );
+
+  ak_wpoint_set_as_unit( &R, ec );
+  eng->import( &R, ec );
+  for( i = ( long long int )ak_max( len1, len2 ) -1; i >= 0; i-- ) {
+     eng->dbl( &R, ec );
+     if(( i < ( long long int )len1 ) && naf1[i] ) {
+       ptr = tb->odd + (( naf1[i] > 0 ? naf1[i] : -naf1[i] ) >> 1 )*2*ec->size;
+       memcpy( T.x, ptr, ec->size*sizeof( ak_uint64 ));
+       memcpy( T.y, ptr +ec->size, ec->size*sizeof( ak_uint64 ));
+       ak_mpzn_set( T.z, tb->one, ec->size );
+       if( naf1[i] < 0 ) eng->neg( &T, ( ak_uint64 )-1, ec );
+       eng->add_affine( &R, &T, ec );
+     }
+     if(( i < ( long long int )len2 ) && naf2[i] ) {
+       if( naf2[i] > 0 ) eng->add( &R, tq +( naf2[i] >> 1 ), ec );
+        else {
+          ak_wpoint_set_wpoint( &T, tq +(( -naf2[i] ) >> 1 ), ec );
+          eng->neg( &T, ( ak_uint64 )-1, ec );
+          eng->add( &R, &T, ec );
+        }
+     }
+  }
+  eng->export( &R, ec );
+  ak_wpoint_set_wpoint( wr, &R, ec );
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -101,6 +101,28 @@
 #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет сумму попарных произведений \f$ z = z + \sum_{i=0}^{n-1} a_ib_i \f$
+    элементов конечного поля \f$ \mathbb F_{2^{128}}\f$ с помощью последовательных вызовов
+    функции ak_gf128_mul_uint64().
+
+    @param z Элемент поля, к которому прибавляется сумма произведений.
+    @param a Массив из `count` элементов поля (по 16 октетов каждый).
+    @param b Массив из `count` элементов поля (по 16 октетов каждый).
+    @param count Количество произведений.                                                          */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_gf128_mul_sum_uint64( ak_pointer z, ak_pointer a, ak_pointer b, const size_t count )
+{
+  size_t i;
+  ak_uint64 t[2];
+
+  for( i = 0; i < count; i++ ) {
+     ak_gf128_mul_uint64( t, ((ak_uint64 *)a) +2*i, ((ak_uint64 *)b) +2*i );
+     ((ak_uint64 *)z)[0] ^= t[0];
+     ((ak_uint64 *)z)[1] ^= t[1];
+  }
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция реализует операцию умножения двух элементов конечного поля \f$ \mathbb F_{2^{256}}\f$,
     порожденного неприводимым многочленом
@@ -374,6 +396,50 @@
 #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет сумму попарных произведений \f$ z = z + \sum_{i=0}^{n-1} a_ib_i \f$
+    элементов конечного поля \f$ \mathbb F_{2^{128}}\f$ с помощью команды PCLMULQDQ.
+
+    Произведения многочленов накапливаются без приведения в 256-ти битной сумме
+    (сложение в поле линейно), после чего выполняется одно приведение по модулю
+    многочлена \f$ f(x) = x^{128} + x^7 + x^2 + x + 1 \f$. Умножения различных пар не зависят
+    друг от друга, поэтому выполняются процессором параллельно.
+
+    @param z Элемент поля, к которому прибавляется сумма произведений.
+    @param a Массив из `count` элементов поля (по 16 октетов каждый).
+    @param b Массив из `count` элементов поля (по 16 октетов каждый).
+    @param count Количество произведений.                                                          */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_gf128_mul_sum_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b, const size_t count )
+{
+  size_t i;
+  ak_uint64 x0, x1, x2, x3, D;
+  ak_uint64 *ap = (ak_uint64 *)a, *bp = (ak_uint64 *)b;
+  __m128i am, bm, cm = _mm_setzero_si128(), dm = _mm_setzero_si128(), em = _mm_setzero_si128();
+
+ /* умножение и накопление: c = sum a0*b0, d = sum a1*b1, e = sum (a0*b1 + a1*b0) */
+  for( i = 0; i < count; i++, ap += 2, bp += 2 ) {
+     am = _mm_set_epi64x( (long long) ap[1], (long long) ap[0] );
+     bm = _mm_set_epi64x( (long long) bp[1], (long long) bp[0] );
+     cm = _mm_xor_si128( cm, _mm_clmulepi64_si128( am, bm, 0x00 ));
+     dm = _mm_xor_si128( dm, _mm_clmulepi64_si128( am, bm, 0x11 ));
+     em = _mm_xor_si128( em, _mm_clmulepi64_si128( am, bm, 0x10 ));
+     em = _mm_xor_si128( em, _mm_clmulepi64_si128( am, bm, 0x01 ));
+  }
+
+ /* приведение */
+#ifdef _MSC_VER
+  x0 = cm.m128i_u64[0] ; x1 = cm.m128i_u64[1] ^ em.m128i_u64[0];
+  x2 = dm.m128i_u64[0] ^ em.m128i_u64[1]; x3 = dm.m128i_u64[1];
+#else
+  x0 = (ak_uint64) cm[0]; x1 = (ak_uint64)( cm[1] ^ em[0] );
+  x2 = (ak_uint64)( dm[0] ^ em[1] ); x3 = (ak_uint64) dm[1];
+#endif
+  D = x2 ^ (x3 >> 63) ^ (x3 >> 62) ^ (x3 >> 57);
+  ((ak_uint64 *)z)[0] ^= x0 ^ D ^ (D << 1) ^ (D << 2) ^ (D << 7);
+  ((ak_uint64 *)z)[1] ^= x1 ^ x3 ^ (x3 << 1) ^ (D >> 63) ^ (x3 << 2) ^ (D >> 62) ^ (x3 << 7) ^ (D >> 57);
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция реализует операцию умножения двух элементов конечного поля \f$ \mathbb F_{2^{256}}\f$,
     порожденного неприводимым многочленом
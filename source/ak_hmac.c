@@ -17,9 +17,117 @@
 #else
  #error Library cannot be compiled without string.h header
 #endif
+#ifdef AK_HAVE_PTHREAD_H
+ #include <pthread.h>
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычисление промежуточных состояний функции хеширования для текущего значения ключа.
+    \details Функция сжимает блоки \f$ K \oplus ipad \f$ и \f$ K \oplus opad \f$ и сохраняет
+    полученные состояния функции хеширования, накладывая на векторы h и \f$ \Sigma \f$
+    случайные маски. Для алгоритма NMAC внешнее состояние вычисляется с помощью
+    второго алгоритма хеширования.
+    \param hctx Контекст алгоритма HMAC выработки имитовставки.
+    \return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hmac_midstate_create( ak_hmac hctx )
+{
+  int i = 0;
+  struct hash nctx;
+  ak_hash ctx = NULL;
+  int error = ak_error_ok;
+  size_t idx = 0, jdx = 0, len = 0;
+  ak_uint8 buffer[64]; /* буффер для хранения промежуточных значений */
+  const ak_uint8 pad[2] = { 0x36, 0x5C };
+
+  hctx->midstate_ready = ak_false;
+  if( !((hctx->key.flags)&key_flag_set_key )) return ak_error_message( ak_error_key_value,
+                                               __func__ , "using hmac key with unassigned value" );
+  if( hctx->mctx.bsize > sizeof( buffer )) return ak_error_message( ak_error_wrong_length,
+                                            __func__, "using hash function with huge block size" );
+  for( i = 0; i < 2; i++ ) {
+    /* фомируем маскированное значение ключа */
+     len = ak_min( hctx->mctx.bsize, jdx = hctx->key.key_size );
+     for( idx = 0; idx < len; idx++, jdx++ ) {
+        buffer[idx] = hctx->key.key[idx] ^ pad[i];
+        buffer[idx] ^= hctx->key.key[jdx];
+     }
+     for( ; idx < hctx->mctx.bsize; idx++ ) buffer[idx] = pad[i];
+
+    /* различие с nmac во внешней функции хеширования */
+     ctx = &hctx->ctx;
+     if(( i == 1 ) && ( hctx->nmac_second_hash_oid != NULL )) {
+       if(( error = (( ak_function_hash_create *)
+                       hctx->nmac_second_hash_oid->func.first.create )( &nctx )) != ak_error_ok ) {
+         ak_error_message( error, __func__, "wrong creation of second hash function context" );
+         break;
+       }
+       ctx = &nctx;
+     }
+
+    /* сжимаем блок и сохраняем маскированное состояние */
+     if(( error = ak_hash_clean( ctx )) == ak_error_ok )
+       error = ak_hash_update( ctx, buffer, hctx->mctx.bsize );
+     if( error == ak_error_ok ) {
+       ak_random_ptr( &hctx->key.generator, hctx->midmask[i], sizeof( hctx->midmask[i] ));
+       for( idx = 0; idx < 8; idx++ ) {
+          hctx->midstate[i].h[idx] = ctx->data.sctx.h[idx] ^ hctx->midmask[i][idx];
+          hctx->midstate[i].n[idx] = ctx->data.sctx.n[idx];
+          hctx->midstate[i].sigma[idx] = ctx->data.sctx.sigma[idx] ^ hctx->midmask[i][8+idx];
+       }
+       hctx->midstate[i].hsize = ctx->data.sctx.hsize;
+     }
+      else ak_error_message( error, __func__, "invalid compression of padded key block" );
+
+     if( ctx == &nctx ) ak_hash_destroy( &nctx );
+     if( error != ak_error_ok ) break;
+  }
+
+ /* очищаем буффер и контекст функции хеширования */
+  ak_ptr_wipe( buffer, sizeof( buffer ), &hctx->key.generator );
+  ak_hash_clean( &hctx->ctx );
+
+ /* перемаскируем ключ */
+  hctx->key.set_mask( &hctx->key );
+  if( error == ak_error_ok ) hctx->midstate_ready = ak_true;
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Перенос сохраненного промежуточного состояния в контекст функции хеширования.
+    \details После переноса на сохраненное состояние накладывается новая маска.
+    \param hctx Контекст алгоритма HMAC выработки имитовставки.
+    \param i Индекс состояния: 0 для внутреннего и 1 для внешнего хеширования.                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_hmac_midstate_load( ak_hmac hctx, const int i )
+{
+  size_t idx = 0;
+  ak_uint64 mask[16];
+  ak_streebog sx = &hctx->ctx.data.sctx;
+
+  for( idx = 0; idx < 8; idx++ ) {
+     sx->h[idx] = hctx->midstate[i].h[idx] ^ hctx->midmask[i][idx];
+     sx->n[idx] = hctx->midstate[i].n[idx];
+     sx->sigma[idx] = hctx->midstate[i].sigma[idx] ^ hctx->midmask[i][8+idx];
+  }
+  sx->hsize = hctx->midstate[i].hsize;
+
+ /* перемаскируем сохраненное состояние */
+  ak_random_ptr( &hctx->key.generator, mask, sizeof( mask ));
+  for( idx = 0; idx < 8; idx++ ) {
+     hctx->midstate[i].h[idx] ^= mask[idx];
+     hctx->midmask[i][idx] ^= mask[idx];
+     hctx->midstate[i].sigma[idx] ^= mask[8+idx];
+     hctx->midmask[i][8+idx] ^= mask[8+idx];
+  }
+}
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Очистка контекста алгоритма hmac.
+    \details Вместо сжатия блока \f$ K \oplus ipad \f$ в контекст функции хеширования
+    переносится заранее вычисленное промежуточное состояние.
     \param ctx Контекст алгоритма HMAC выработки имитовставки.
     \return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
     возвращается код ошибки.                                                                       */
@@ -28,8 +136,6 @@
 {
   int error = ak_error_ok;
   ak_hmac hctx = ( ak_hmac ) ctx;
-  size_t idx = 0, jdx = 0, len = 0;
-  ak_uint8 buffer[64]; /* буффер для хранения промежуточных значений */
 
   if( ctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                       "using a null pointer to hmac key context" );
@@ -40,30 +146,20 @@
   if( hctx->key.resource.value.counter <= 1 ) return ak_error_message( ak_error_low_key_resource,
                                             __func__, "using hmac key context with low resource" );
                       /* нам надо два раза использовать ключ => ресурс должен быть не менее двух */
-  if( hctx->mctx.bsize > sizeof( buffer )) return ak_error_message( ak_error_wrong_length,
-                                            __func__, "using hash function with huge block size" );
 
- /* фомируем маскированное значение ключа */
-  len = ak_min( hctx->mctx.bsize, jdx = hctx->key.key_size );
-  for( idx = 0; idx < len; idx++, jdx++ ) {
-     buffer[idx] = hctx->key.key[idx] ^ 0x36;
-     buffer[idx] ^= hctx->key.key[jdx];
+ /* промежуточные состояния могут быть не вычислены,
+    если значение ключа было присвоено в обход функций ak_hmac_set_key() */
+  if( !hctx->midstate_ready ) {
+    if(( error = ak_hmac_midstate_create( hctx )) != ak_error_ok )
+      return ak_error_message( error, __func__, "incorrect precomputation of hash function states" );
   }
-  for( ; idx < hctx->mctx.bsize; idx++ ) buffer[idx] = 0x36;
 
  /* инициализируем начальное состояние контекста хеширования */
   if(( error = ak_hash_clean( &hctx->ctx )) != ak_error_ok )
     return ak_error_message( error, __func__, "wrong cleaning of hash function context" );
 
- /* обновляем состояние контекста хеширования */
-  if(( error = ak_hash_update( &hctx->ctx, buffer, hctx->mctx.bsize )) != ak_error_ok )
-    ak_error_message( error, __func__, "invalid 1st step iteration for hmac key context" );
-
- /* очищаем буффер */
-  ak_ptr_wipe( buffer, sizeof( buffer ), &hctx->key.generator );
-
- /* перемаскируем ключ и меняем его ресурс */
-  hctx->key.set_mask( &hctx->key );
+ /* восстанавливаем состояние после обработки блока K^ipad */
+  ak_hmac_midstate_load( hctx, 0 );
   hctx->key.resource.value.counter--; /* мы использовали ключ один раз */
 
  return error;
@@ -112,9 +208,7 @@
 {
   int error = ak_error_ok;
   ak_hmac hctx = ( ak_hmac ) ctx;
-  size_t idx = 0, jdx = 0, len = 0;
-  ak_uint8 temporary[128]; /* первый буффер для хранения промежуточных значений */
-  ak_uint8 keybuffer[128]; /* второй буффер для хранения промежуточных значений */
+  ak_uint8 temporary[128]; /* буффер для хранения промежуточных значений */
 
  /* выполняем проверки */
   if( hctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
@@ -128,49 +222,24 @@
  /* проверяем наличие ключа (ресурс проверен при вызове clean) */
   if( !((hctx->key.flags)&key_flag_set_key )) return ak_error_message( ak_error_key_value,
                                                __func__ , "using hmac key with unassigned value" );
+  if( !hctx->midstate_ready ) return ak_error_message( ak_error_key_value,
+                                          __func__ , "using hmac key with undefined hash states" );
  /* обрабатываем хвост предыдущих данных */
   memset( temporary, 0, sizeof( temporary ));
   if(( error = ak_hash_finalize( &hctx->ctx, in, size, temporary,
                                                             sizeof( temporary ))) != ak_error_ok )
     return ak_error_message( error, __func__ , "wrong updating of finalized data" );
 
- /* фомируем маскированное значение ключа */
-  len = ak_min( hctx->mctx.bsize, jdx = hctx->key.key_size );
-  for( idx = 0; idx < len; idx++ , jdx++ ) {
-     keybuffer[idx] = hctx->key.key[idx] ^ 0x5C;
-     keybuffer[idx] ^= hctx->key.key[jdx];
-  }
-  for( ; idx < hctx->mctx.bsize; idx++ ) keybuffer[idx] = 0x5C;
-
-
- /* различие с nmac в последней функции хеширования */
-  if( hctx->nmac_second_hash_oid ) {
-    ak_hash_destroy( &hctx->ctx );
-    hctx->nmac_second_hash_oid->func.first.create( &hctx->ctx );
-  }
-
- /* возвращаем контекст хеширования в начальное состояние */
+ /* восстанавливаем состояние после обработки блока K^opad
+    (для nmac это состояние второй функции хеширования) */
   if(( error = ak_hash_clean( &hctx->ctx )) != ak_error_ok )
     return ak_error_message( error, __func__, "wrong cleaning of hash function context" );
-
- /* обновляем состояние контекста хеширования */
-  if(( error = ak_hash_update( &hctx->ctx, keybuffer, hctx->mctx.bsize )) != ak_error_ok )
-    return ak_error_message( error, __func__, "invalid 1st step iteration for hmac key context" );
-
- /* очищаем буффер */
-  ak_ptr_wipe( keybuffer, sizeof( keybuffer ), &hctx->key.generator );
-
- /* ресурс ключа */
-  hctx->key.set_mask( &hctx->key );
+  ak_hmac_midstate_load( hctx, 1 );
   hctx->key.resource.value.counter--; /* мы использовали ключ один раз */
 
  /* последний update/finalize и возврат результата */
   error = ak_hash_finalize( &hctx->ctx, temporary, hctx->ctx.data.sctx.hsize, out, out_size );
-
-  if( hctx->nmac_second_hash_oid ) {
-    ak_hash_destroy( &hctx->ctx );
-    ak_hash_create_streebog512( &hctx->ctx );
-  }
+  hctx->ctx.data.sctx.hsize = hctx->midstate[0].hsize;
 
  /* очищаем контекст функции хеширования, ключ не трогаем */
   ak_hash_clean( &hctx->ctx );
@@ -233,6 +302,10 @@
   hctx->key.oid = oid;
  /* устанавливаем указатель на второй алгоритм хеширования */
   hctx->nmac_second_hash_oid = NULL;
+ /* промежуточные состояния вычисляются после присвоения ключу значения */
+  memset( hctx->midstate, 0, sizeof( hctx->midstate ));
+  memset( hctx->midmask, 0, sizeof( hctx->midmask ));
+  hctx->midstate_ready = ak_false;
 
  return error;
 }
@@ -282,6 +355,9 @@
     ak_error_message( error, __func__, "incorrect destroying of secret key context" );
   if(( error = ak_mac_destroy( &hctx->mctx )) != ak_error_ok )
     ak_error_message( error, __func__, "incorrect destroying of mac context" );
+  memset( hctx->midstate, 0, sizeof( hctx->midstate ));
+  memset( hctx->midmask, 0, sizeof( hctx->midmask ));
+  hctx->midstate_ready = ak_false;
 
  return error;
 }
@@ -326,6 +402,10 @@
         return ak_error_message( error, __func__ , "incorrect assigning a secret key value" );
   }
 
+ /* вычисляем промежуточные состояния функции хеширования */
+  if(( error = ak_hmac_midstate_create( hctx )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect precomputation of hash function states" );
+
  /* устанавливаем ресурс ключа */
   if(( error = ak_skey_set_resource_values( &hctx->key,
                           key_using_resource, "hmac_key_count_resource", 0, 0 )) != ak_error_ok )
@@ -353,6 +433,10 @@
   if(( error = ak_skey_set_key_random( &hctx->key, generator )) != ak_error_ok )
     return ak_error_message( error, __func__ , "incorrect assigning a secret key value" );
 
+ /* вычисляем промежуточные состояния функции хеширования */
+  if(( error = ak_hmac_midstate_create( hctx )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect precomputation of hash function states" );
+
  /* устанавливаем ресурс ключа */
   if(( error = ak_skey_set_resource_values( &hctx->key,
                           key_using_resource, "hmac_key_count_resource", 0, 0 )) != ak_error_ok )
@@ -389,6 +473,10 @@
                                           pass, pass_size, salt, salt_size )) != ak_error_ok )
     return ak_error_message( error, __func__ , "incorrect assigning a secret key value" );
 
+ /* вычисляем промежуточные состояния функции хеширования */
+  if(( error = ak_hmac_midstate_create( hctx )) != ak_error_ok )
+    return ak_error_message( error, __func__, "incorrect precomputation of hash function states" );
+
  /* устанавливаем ресурс ключа */
   if(( error = ak_skey_set_resource_values( &hctx->key,
                           key_using_resource, "hmac_key_count_resource", 0, 0 )) != ak_error_ok )
@@ -540,10 +628,99 @@
  return hctx->mctx.bsize;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычисление одного 64-х октетного блока \f$ T_i \f$ алгоритма PBKDF2.
+    \details Функция вычисляет значение \f$ T_i = U_1 \oplus \ldots \oplus U_c \f$, где
+    \f$ U_1 = HMAC( P, S || INT(i)) \f$ и \f$ U_j = HMAC( P, U_{j-1}) \f$.
+    \param hctx Контекст алгоритма hmac-streebog512 с установленным значением пароля.
+    \param salt Указатель на инициализационный вектор.
+    \param salt_size Размер инициализационного вектора в байтах.
+    \param cnt Количество итераций.
+    \param idx Номер вычисляемого блока (начиная с единицы).
+    \param out Массив, куда помещается результат; длина массива должна быть не менее 64-х байт.
+    \return В случае успеха функция возвращает \ref ak_error_ok. В противном случае
+    возвращается код ошибки; функция не формирует сообщений об ошибках, поскольку может
+    вызываться из рабочих потоков.                                                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hmac_pbkdf2_streebog512_block( ak_hmac hctx, const ak_pointer salt,
+                 const size_t salt_size, const size_t cnt, const ak_uint32 idx, ak_uint8 *out )
+{
+  size_t i = 0, jdx = 0;
+  ak_uint8 result[64];
+  int error = ak_error_ok;
+
+ /* начальная инициализация промежуточного вектора */
+  memset( result, 0, 64 );
+  result[0] = ( ak_uint8 )( idx >> 24 );
+  result[1] = ( ak_uint8 )( idx >> 16 );
+  result[2] = ( ak_uint8 )( idx >> 8 );
+  result[3] = ( ak_uint8 )idx;
+
+ /* вычисляем значение первой строки U1  */
+  if(( error = ak_hmac_clean( hctx )) != ak_error_ok ) return error;
+  if(( error = ak_hmac_update( hctx, salt, salt_size )) != ak_error_ok ) return error;
+  if(( error = ak_hmac_finalize( hctx, result, 4, result, sizeof( result ))) != ak_error_ok )
+    return error;
+  memcpy( out, result, 64 );
+
+ /* теперь основной цикл по значению аргумента c */
+  for( i = 1; i < cnt; i++ ) {
+     ak_hmac_ptr( hctx, result, 64, result, sizeof( result ));
+     for( jdx = 0; jdx < 64; jdx++ ) out[jdx] ^= result[jdx];
+  }
+  memset( result, 0, 64 );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Выработка ключевого вектора произвольной длины с использованием созданного контекста.
+    \details При длине ключевого вектора, не превосходящей 64-х октетов, результатом являются
+    младшие `dklen` октетов блока \f$ T_1 \f$ (так же, как это делалось в предыдущих версиях
+    библиотеки). При большей длине результатом являются первые `dklen` октетов
+    последовательности \f$ T_1 || T_2 || \ldots \f$ (см. Р 50.1.111-2016, раздел 4).
+    Таким образом, 64-х октетный вектор \f$ T_1 \f$ является началом любого более длинного
+    вектора и окончанием любого более короткого.
+
+    Функция не формирует сообщений об ошибках и возвращает только их код.                         */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_hmac_pbkdf2_streebog512_context( ak_hmac hctx, const ak_pointer salt,
+                   const size_t salt_size, const size_t cnt, const size_t dklen, ak_uint8 *out )
+{
+  ak_uint8 block[64];
+  int error = ak_error_ok;
+  size_t offset = 0, len = 0;
+  ak_uint32 idx = 1;
+
+  if( dklen <= 64 ) {
+    if(( error = ak_hmac_pbkdf2_streebog512_block( hctx,
+                                               salt, salt_size, cnt, 1, block )) == ak_error_ok )
+      memcpy( out, block+64-dklen, dklen );
+  }
+   else {
+     for( offset = 0; offset < dklen; offset += len, idx++ ) {
+        if(( error = ak_hmac_pbkdf2_streebog512_block( hctx,
+                                            salt, salt_size, cnt, idx, block )) != ak_error_ok )
+          break;
+        memcpy( out+offset, block, len = ak_min( 64, dklen - offset ));
+     }
+   }
+  ak_ptr_wipe( block, sizeof( block ), &hctx->key.generator );
+
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Пароль должен представлять собой ненулевую строку символов в utf8
-    кодировке. Размер вырабатываемого ключевого вектора может колебаться от 32-х до 64-х байт.
-    При выработке используется алгоритм hmac-streebog512.
+    кодировке. При выработке используется алгоритм hmac-streebog512.
+
+    Размер вырабатываемого ключевого вектора должен быть не менее 32-х байт. При длине, не
+    превосходящей 64-х байт, результатом являются младшие `dklen` байт первого блока
+    \f$ T_1 \f$ (это соглашение сохранено для совместимости с ключами, выработанными
+    предыдущими версиями библиотеки); при большей длине вычисляются блоки
+    \f$ T_1, T_2, \ldots \f$ и результатом являются первые `dklen` байт их конкатенации,
+    как в Р 50.1.111-2016. Длине 64 байта соответствуют оба правила: результат равен \f$ T_1 \f$,
+    является началом любого более длинного результата и заканчивается любым более коротким.
 
     @param pass Пароль, строка символов в utf8 кодировке.
     @param pass_size Размер пароля в байтах, должен быть отличен от нуля.
@@ -553,8 +730,8 @@
     @param cnt Параметр, определяющий количество однотипных итераций для выработки ключа; данный
     параметр определяет время работы алгоритма; параметр не является секретным и может храниться или
     передаваться в открытом виде.
-    @param dklen Длина вырабатываемого ключевого вектора в байтах, величина должна принимать
-    значение от 32-х до 64-х.
+    @param dklen Длина вырабатываемого ключевого вектора в байтах, величина должна быть
+    не менее 32-х.
     @param out Указатель на массив, куда будет помещен результат; под данный массив должна быть
     заранее выделена память не менее, чем dklen байт.
 
@@ -566,9 +743,7 @@
                                                                const size_t dklen, ak_pointer out )
 {
   struct hmac hctx;
-  ak_uint8 result[64];
   int error = ak_error_ok;
-  size_t idx = 0, jdx = 0;
 
  /* в начале, многочисленные проверки входных параметров */
   if( pass == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
@@ -577,45 +752,143 @@
                                                                    "using a zero length password" );
   if( salt == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                                                      "using null pointer to salt" );
-  if(( dklen < 32 ) || ( dklen > 64 )) return ak_error_message( ak_error_wrong_length,
+  if( dklen < 32 ) return ak_error_message( ak_error_wrong_length,
                                        __func__ , "using a wrong length for resulting key vector" );
   if( out == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                                      "using null pointer to resulting key vector" );
  /* создаем контекст алгоритма hmac и определяем его ключ */
   if(( error = ak_hmac_create_streebog512( &hctx )) != ak_error_ok )
     return ak_error_message( error, __func__, "wrong creation of hmac-streebog512 key context" );
-  if(( error = ak_hmac_set_key( &hctx, pass, pass_size )) != ak_error_ok ) {
+  if(( error = ak_hmac_set_key( &hctx, pass, pass_size )) != ak_error_ok )
     ak_error_message( error, __func__, "wrong initialization of hmac-streebog512 secret key" );
-    goto lab_exit;
-  }
+   else
+    if(( error = ak_hmac_pbkdf2_streebog512_context( &hctx,
+                                           salt, salt_size, cnt, dklen, out )) != ak_error_ok )
+      ak_error_message( error, __func__, "incorrect evaluation of pbkdf2 key vector" );
 
- /* начальная инициализация промежуточного вектора */
-  memset( result, 0, 64 );
-  result[3] = 1;
+  ak_hmac_destroy( &hctx );
+ return error;
+}
 
- /* вычисляем значение первой строки U1  */
-  if(( error = ak_hmac_clean( &hctx )) != ak_error_ok ) {
-    ak_error_message( error, __func__, "incorrect cleaning of internal hmac context");
-    goto lab_exit;
-  }
-  if(( error = ak_hmac_update( &hctx, salt, salt_size )) != ak_error_ok ) {
-    ak_error_message( error, __func__, "incorrect updating of internal hmac context");
-    goto lab_exit;
-  }
-  if(( error = ak_hmac_finalize( &hctx, result, 4, result, sizeof( result ))) != ak_error_ok ) {
-    ak_error_message( error, __func__, "incorrect finalizing of internal mac context");
-    goto lab_exit;
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Выполнение одного задания пакетной выработки ключевых векторов.
+    \details Функция может выполняться в рабочем потоке, поэтому она не формирует сообщений
+    об ошибках (и не изменяет общую переменную `ak_errno`), а только сохраняет код ошибки
+    в поле `error` задания. Сообщение об ошибке формируется в вызывающем потоке функцией
+    ak_hmac_pbkdf2_streebog512_tasks().
+    \param task Указатель на задание; результат выполнения помещается в поле `error`.              */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_hmac_pbkdf2_streebog512_task( ak_pbkdf2_task task )
+{
+  struct hmac hctx;
+
+  if(( task->pass == NULL ) || ( !task->pass_size ) || ( task->salt == NULL ) ||
+                                                  ( task->dklen < 32 ) || ( task->out == NULL )) {
+    task->error = ak_error_invalid_value;
+    return;
   }
-  memcpy( out, result+64-dklen, dklen );
+  if(( task->error = ak_hmac_create_streebog512( &hctx )) != ak_error_ok ) return;
+  if(( task->error = ak_hmac_set_key( &hctx, task->pass, task->pass_size )) == ak_error_ok )
+    task->error = ak_hmac_pbkdf2_streebog512_context( &hctx,
+                               task->salt, task->salt_size, task->cnt, task->dklen, task->out );
+  ak_hmac_destroy( &hctx );
+}
 
- /* теперь основной цикл по значению аргумента c */
-  for( idx = 1; idx < cnt; idx++ ) {
-     ak_hmac_ptr( &hctx, result, 64, result, sizeof( result ));
-     for( jdx = 0; jdx < dklen; jdx++ ) ((ak_uint8 *)out)[jdx] ^= result[64-dklen+jdx];
+#ifdef AK_HAVE_PTHREAD_H
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Общие данные потоков, выполняющих пакетную выработку ключевых векторов. */
+ typedef struct pbkdf2_queue {
+  /*! \brief Массив заданий. */
+   ak_pbkdf2_task tasks;
+  /*! \brief Общее количество заданий. */
+   size_t count;
+  /*! \brief Индекс следующего необработанного задания. */
+   size_t next;
+  /*! \brief Мьютекс, защищающий индекс следующего задания. */
+   pthread_mutex_t mutex;
+ } *ak_pbkdf2_queue;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция потока: последовательно извлекает задания из общей очереди и выполняет их. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void *ak_hmac_pbkdf2_streebog512_thread( void *ptr )
+{
+  size_t idx = 0;
+  ak_pbkdf2_queue queue = ( ak_pbkdf2_queue ) ptr;
+
+  for( ;; ) {
+     pthread_mutex_lock( &queue->mutex );
+     idx = queue->next++;
+     pthread_mutex_unlock( &queue->mutex );
+     if( idx >= queue->count ) break;
+     ak_hmac_pbkdf2_streebog512_task( queue->tasks + idx );
   }
-  memset( result, 0, 64 );
+ return NULL;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция предназначена для одновременной выработки большого количества ключевых векторов,
+    например, при разблокировке множества ключевых контейнеров, защищенных паролями.
+    Каждое задание описывается структурой \ref pbkdf2_task и обрабатывается так же,
+    как и при вызове функции ak_hmac_pbkdf2_streebog512(); результат обработки задания
+    помещается в поле `error` соответствующей структуры.
+
+    Если библиотека собрана с поддержкой pthreads, то задания распределяются между
+    `threads` потоками; в противном случае, а также при `threads` не превосходящем единицы,
+    задания выполняются последовательно в вызывающем потоке.
+
+    @param tasks Массив заданий.
+    @param count Количество заданий в массиве.
+    @param threads Максимальное количество используемых потоков.
 
-  lab_exit: ak_hmac_destroy( &hctx );
+    @return Функция возвращает \ref ak_error_ok, если все задания выполнены успешно. В противном
+    случае возвращается код ошибки первого из неуспешно выполненных заданий.                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_hmac_pbkdf2_streebog512_tasks( ak_pbkdf2_task tasks, const size_t count,
+                                                                            const size_t threads )
+{
+  size_t idx = 0;
+  int error = ak_error_ok;
+
+  if( tasks == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                         "using null pointer to array of tasks" );
+  if( !count ) return ak_error_message( ak_error_zero_length, __func__ ,
+                                                                 "using empty array of tasks" );
+#ifndef AK_HAVE_PTHREAD_H
+  (void)threads;
+#else
+  if(( threads > 1 ) && ( count > 1 )) {
+    pthread_t *handles = NULL;
+    struct pbkdf2_queue queue;
+    size_t created = 0, tcount = ak_min( threads, count );
+
+    if(( handles = malloc( tcount*sizeof( pthread_t ))) == NULL )
+      return ak_error_message( ak_error_out_of_memory, __func__ ,
+                                                          "incorrect memory allocation for threads" );
+    queue.tasks = tasks;
+    queue.count = count;
+    queue.next = 0;
+    pthread_mutex_init( &queue.mutex, NULL );
+    for( created = 0; created < tcount; created++ )
+       if( pthread_create( handles + created, NULL,
+                                      ak_hmac_pbkdf2_streebog512_thread, &queue ) != 0 ) break;
+   /* если не удалось создать ни одного потока, задания выполняются в вызывающем потоке */
+    if( created == 0 ) ak_hmac_pbkdf2_streebog512_thread( &queue );
+    for( idx = 0; idx < created; idx++ ) pthread_join( handles[idx], NULL );
+    pthread_mutex_destroy( &queue.mutex );
+    free( handles );
+  }
+   else
+#endif
+  for( idx = 0; idx < count; idx++ ) ak_hmac_pbkdf2_streebog512_task( tasks + idx );
+
+  for( idx = 0; idx < count; idx++ )
+     if( tasks[idx].error != ak_error_ok ) {
+       error = ak_error_message_fmt( tasks[idx].error, __func__,
+                                "incorrect execution of pbkdf2 task %u", (unsigned int) idx );
+       break;
+     }
  return error;
 }
 
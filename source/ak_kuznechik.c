@@ -6,6 +6,9 @@
 /*    регламентированного ГОСТ Р 34.12-2015                                                        */
 /* ----------------------------------------------------------------------------------------------- */
  #include <libakrypt-internal.h>
+#ifdef AK_HAVE_BUILTIN_XOR_SI128
+ #include <emmintrin.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Нелинейное биективное преобразование байт, используемое в алгоритмах
@@ -227,7 +230,7 @@
  int ak_bckey_kuznechik_init_tables( const linear_register reg,
                                                           const sbox pi, ak_kuznechik_params par )
 {
-  int i, j, l, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+  int i, j, l, oc = (int) ak_libakrypt_get_option_by_index( ak_option_openssl_compability );
 
   if(( oc < 0 ) || ( oc > 1 )) return ak_error_message( ak_error_wrong_option, __func__,
                                                 "wrong value for \"openssl_compability\" option" );
@@ -313,7 +316,7 @@
   ak_uint8 reverse[64];
   int i = 0, j = 0, l = 0, kdx = 2;
   ak_uint64 a0[2], a1[2], c[2], t[2], idx = 0;
-  ak_int64 oc = ak_libakrypt_get_option_by_name( "openssl_compability" );
+  ak_int64 oc = ak_libakrypt_get_option_by_index( ak_option_openssl_compability );
   ak_uint64 *ekey = NULL, *mkey = NULL, *dkey = NULL, *xkey = NULL, *rkey = NULL, *lkey = NULL;
 
  /* выполняем стандартные проверки */
@@ -670,6 +673,281 @@
   (( ak_uint64 *) out)[1] = x[1] ^ xkey[1];
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*             многоблочная реализация алгоритмов зашифрования и расшифрования                     */
+/* ----------------------------------------------------------------------------------------------- */
+#ifdef AK_HAVE_BUILTIN_XOR_SI128
+/*! \brief Количество блоков, одновременно находящихся в обработке. */
+ #define ak_kuznechik_blocks_in_flight  (8)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует линейно-нелинейное преобразование LS одного блока с помощью
+    развернутых таблиц, каждая строка которых рассматривается как 128-ми битный вектор.
+
+    Параметр `oc` должен быть константой: после подстановки функции компилятор исключает
+    лишнее ветвление.                                                                              */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline __m128i ak_kuznechik_ls_sse2( const __m128i *table, const ak_uint8 *b,
+                                                                                    const int oc )
+{
+  int k = 1;
+  __m128i t = _mm_loadu_si128( table + b[ oc ? 15 : 0 ] );
+
+  for( ; k < 16; k++ )
+     t = _mm_xor_si128( t, _mm_loadu_si128( table + ( k << 8 ) + b[ oc ? 15 - k : k ] ));
+ return t;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует алгоритм зашифрования последовательности независимых блоков
+    шифром Кузнечик (согласно ГОСТ Р 34.12-2015).
+
+    Блоки обрабатываются группами по \ref ak_kuznechik_blocks_in_flight штук: на каждом раунде
+    табличные преобразования выполняются сразу для всех блоков группы. Поскольку обработка
+    различных блоков не зависит друг от друга, задержки обращений к таблицам перекрываются.         */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_kuznechik_encrypt_blocks_sse2( ak_skey skey, ak_pointer in,
+                                                ak_pointer out, size_t count, const int oc )
+{
+  size_t i, j, n;
+  __m128i x[ ak_kuznechik_blocks_in_flight ];
+  const __m128i *ekey = ( const __m128i *)skey->data,
+                *mkey = ( const __m128i *)skey->data + 20,
+                *table = ( const __m128i *)kuznechik_parameters.enc,
+                *inptr = ( const __m128i *)in;
+  __m128i *outptr = ( __m128i *)out;
+
+  while( count > 0 ) {
+    n = ak_min( count, ak_kuznechik_blocks_in_flight );
+    for( j = 0; j < n; j++ ) x[j] = _mm_loadu_si128( inptr + j );
+
+    for( i = 0; i < 9; i++ ) {
+       for( j = 0; j < n; j++ ) {
+          x[j] = _mm_xor_si128( x[j], _mm_loadu_si128( ekey + i ));
+          x[j] = _mm_xor_si128( x[j], _mm_loadu_si128( mkey + i ));
+       }
+       for( j = 0; j < n; j++ )
+          x[j] = ak_kuznechik_ls_sse2( table, ( const ak_uint8 *)( x + j ), oc );
+    }
+
+    for( j = 0; j < n; j++ ) {
+       x[j] = _mm_xor_si128( x[j], _mm_loadu_si128( ekey + 9 ));
+       _mm_storeu_si128( outptr + j, _mm_xor_si128( x[j], _mm_loadu_si128( mkey + 9 )));
+    }
+    inptr += n; outptr += n; count -= n;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует алгоритм расшифрования последовательности независимых блоков
+    шифром Кузнечик (согласно ГОСТ Р 34.12-2015).
+
+    Блоки обрабатываются группами по \ref ak_kuznechik_blocks_in_flight штук аналогично
+    функции ak_kuznechik_encrypt_blocks_sse2().                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_kuznechik_decrypt_blocks_sse2( ak_skey skey, ak_pointer in,
+                                                ak_pointer out, size_t count, const int oc )
+{
+  size_t i, j, k, n;
+  ak_uint8 *b = NULL;
+  __m128i x[ ak_kuznechik_blocks_in_flight ];
+  const __m128i *dkey = ( const __m128i *)skey->data + 10,
+                *xkey = ( const __m128i *)skey->data + 30,
+                *table = ( const __m128i *)kuznechik_parameters.dec,
+                *inptr = ( const __m128i *)in;
+  __m128i *outptr = ( __m128i *)out;
+
+  while( count > 0 ) {
+    n = ak_min( count, ak_kuznechik_blocks_in_flight );
+    for( j = 0; j < n; j++ ) {
+       x[j] = _mm_loadu_si128( inptr + j );
+       b = ( ak_uint8 *)( x + j );
+       for( k = 0; k < 16; k++ ) b[k] = kuznechik_parameters.pi[b[k]];
+    }
+
+    for( i = 9; i > 0; i-- ) {
+       for( j = 0; j < n; j++ )
+          x[j] = ak_kuznechik_ls_sse2( table, ( const ak_uint8 *)( x + j ), oc );
+       for( j = 0; j < n; j++ ) {
+          x[j] = _mm_xor_si128( x[j], _mm_loadu_si128( dkey + i ));
+          x[j] = _mm_xor_si128( x[j], _mm_loadu_si128( xkey + i ));
+       }
+    }
+
+    for( j = 0; j < n; j++ ) {
+       b = ( ak_uint8 *)( x + j );
+       for( k = 0; k < 16; k++ ) b[k] = kuznechik_parameters.pinv[b[k]];
+       x[j] = _mm_xor_si128( x[j], _mm_loadu_si128( dkey ));
+       _mm_storeu_si128( outptr + j, _mm_xor_si128( x[j], _mm_loadu_si128( xkey )));
+    }
+    inptr += n; outptr += n; count -= n;
+  }
+}
+
+#else
+/*! \brief Количество блоков, одновременно находящихся в обработке. */
+ #define ak_kuznechik_blocks_in_flight  (4)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует алгоритм зашифрования последовательности независимых блоков
+    шифром Кузнечик (согласно ГОСТ Р 34.12-2015), переносимая реализация для 64-х битных слов.
+
+    Блоки обрабатываются группами по \ref ak_kuznechik_blocks_in_flight штук: на каждом раунде
+    табличные преобразования выполняются сразу для всех блоков группы.                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_kuznechik_encrypt_blocks_uint64( ak_skey skey, ak_pointer in,
+                                                ak_pointer out, size_t count, const int oc )
+{
+  int k;
+  size_t i, j, n;
+  ak_uint8 *b = NULL;
+  ak_uint64 s, t, x[ ak_kuznechik_blocks_in_flight ][2];
+  ak_uint64 *ekey = ( ak_uint64 *)skey->data, *mkey = ( ak_uint64 *)skey->data + 40,
+            *inptr = ( ak_uint64 *)in, *outptr = ( ak_uint64 *)out;
+
+  while( count > 0 ) {
+    n = ak_min( count, ak_kuznechik_blocks_in_flight );
+    for( j = 0; j < n; j++ ) { x[j][0] = inptr[2*j]; x[j][1] = inptr[2*j+1]; }
+
+    for( i = 0; i < 18; i += 2 ) {
+       for( j = 0; j < n; j++ ) {
+          x[j][0] ^= ekey[i];   x[j][0] ^= mkey[i];
+          x[j][1] ^= ekey[i+1]; x[j][1] ^= mkey[i+1];
+       }
+       for( j = 0; j < n; j++ ) {
+          b = ( ak_uint8 *)x[j];
+          t = kuznechik_parameters.enc[0][b[ oc ? 15 : 0 ]][0];
+          s = kuznechik_parameters.enc[0][b[ oc ? 15 : 0 ]][1];
+          for( k = 1; k < 16; k++ ) {
+             t ^= kuznechik_parameters.enc[k][b[ oc ? 15 - k : k ]][0];
+             s ^= kuznechik_parameters.enc[k][b[ oc ? 15 - k : k ]][1];
+          }
+          x[j][0] = t; x[j][1] = s;
+       }
+    }
+
+    for( j = 0; j < n; j++ ) {
+       x[j][0] ^= ekey[18]; x[j][1] ^= ekey[19];
+       outptr[2*j] = x[j][0] ^ mkey[18];
+       outptr[2*j+1] = x[j][1] ^ mkey[19];
+    }
+    inptr += 2*n; outptr += 2*n; count -= n;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует алгоритм расшифрования последовательности независимых блоков
+    шифром Кузнечик (согласно ГОСТ Р 34.12-2015), переносимая реализация для 64-х битных слов.    */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_kuznechik_decrypt_blocks_uint64( ak_skey skey, ak_pointer in,
+                                                ak_pointer out, size_t count, const int oc )
+{
+  int k;
+  size_t i, j, n;
+  ak_uint8 *b = NULL;
+  ak_uint64 s, t, x[ ak_kuznechik_blocks_in_flight ][2];
+  ak_uint64 *dkey = ( ak_uint64 *)skey->data + 20, *xkey = ( ak_uint64 *)skey->data + 60,
+            *inptr = ( ak_uint64 *)in, *outptr = ( ak_uint64 *)out;
+
+  while( count > 0 ) {
+    n = ak_min( count, ak_kuznechik_blocks_in_flight );
+    for( j = 0; j < n; j++ ) {
+       x[j][0] = inptr[2*j]; x[j][1] = inptr[2*j+1];
+       b = ( ak_uint8 *)x[j];
+       for( k = 0; k < 16; k++ ) b[k] = kuznechik_parameters.pi[b[k]];
+    }
+
+    for( i = 19; i > 1; i -= 2 ) {
+       for( j = 0; j < n; j++ ) {
+          b = ( ak_uint8 *)x[j];
+          t = kuznechik_parameters.dec[0][b[ oc ? 15 : 0 ]][0];
+          s = kuznechik_parameters.dec[0][b[ oc ? 15 : 0 ]][1];
+          for( k = 1; k < 16; k++ ) {
+             t ^= kuznechik_parameters.dec[k][b[ oc ? 15 - k : k ]][0];
+             s ^= kuznechik_parameters.dec[k][b[ oc ? 15 - k : k ]][1];
+          }
+          x[j][0] = t; x[j][1] = s;
+       }
+       for( j = 0; j < n; j++ ) {
+          x[j][1] ^= dkey[i];   x[j][1] ^= xkey[i];
+          x[j][0] ^= dkey[i-1]; x[j][0] ^= xkey[i-1];
+       }
+    }
+
+    for( j = 0; j < n; j++ ) {
+       b = ( ak_uint8 *)x[j];
+       for( k = 0; k < 16; k++ ) b[k] = kuznechik_parameters.pinv[b[k]];
+       x[j][0] ^= dkey[0]; x[j][1] ^= dkey[1];
+       outptr[2*j] = x[j][0] ^ xkey[0];
+       outptr[2*j+1] = x[j][1] ^ xkey[1];
+    }
+    inptr += 2*n; outptr += 2*n; count -= n;
+  }
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует алгоритм зашифрования последовательности из `count` независимых
+    блоков информации шифром Кузнечик (согласно ГОСТ Р 34.12-2015).                                */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_encrypt_blocks_with_mask( ak_skey skey,
+                                                      ak_pointer in, ak_pointer out, size_t count )
+{
+#ifdef AK_HAVE_BUILTIN_XOR_SI128
+  ak_kuznechik_encrypt_blocks_sse2( skey, in, out, count, 0 );
+#else
+  ak_kuznechik_encrypt_blocks_uint64( skey, in, out, count, 0 );
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует алгоритм зашифрования последовательности из `count` независимых
+    блоков информации шифром Кузнечик (согласно ГОСТ Р 34.12-2015).
+
+    Реализуется симметричное преобразование, введенное для совместимости с библиотекой openssl
+    и другими реализациями.                                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_encrypt_blocks_with_mask_oc( ak_skey skey,
+                                                      ak_pointer in, ak_pointer out, size_t count )
+{
+#ifdef AK_HAVE_BUILTIN_XOR_SI128
+  ak_kuznechik_encrypt_blocks_sse2( skey, in, out, count, 1 );
+#else
+  ak_kuznechik_encrypt_blocks_uint64( skey, in, out, count, 1 );
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует алгоритм расшифрования последовательности из `count` независимых
+    блоков информации шифром Кузнечик (согласно ГОСТ Р 34.12-2015).                                */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_decrypt_blocks_with_mask( ak_skey skey,
+                                                      ak_pointer in, ak_pointer out, size_t count )
+{
+#ifdef AK_HAVE_BUILTIN_XOR_SI128
+  ak_kuznechik_decrypt_blocks_sse2( skey, in, out, count, 0 );
+#else
+  ak_kuznechik_decrypt_blocks_uint64( skey, in, out, count, 0 );
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует алгоритм расшифрования последовательности из `count` независимых
+    блоков информации шифром Кузнечик (согласно ГОСТ Р 34.12-2015).
+
+    Реализуется симметричное преобразование, введенное для совместимости с библиотекой openssl
+    и другими реализациями.                                                                        */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_kuznechik_decrypt_blocks_with_mask_oc( ak_skey skey,
+                                                      ak_pointer in, ak_pointer out, size_t count )
+{
+#ifdef AK_HAVE_BUILTIN_XOR_SI128
+  ak_kuznechik_decrypt_blocks_sse2( skey, in, out, count, 1 );
+#else
+  ak_kuznechik_decrypt_blocks_uint64( skey, in, out, count, 1 );
+#endif
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! После инициализации устанавливаются обработчики (функции класса). Однако само значение
     ключу не присваивается - поле `bkey->key` остается неопределенным.
@@ -679,7 +957,8 @@
 /* ----------------------------------------------------------------------------------------------- */
  int ak_bckey_create_kuznechik( ak_bckey bkey )
 {
-  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+  int error = ak_error_ok,
+      oc = (int) ak_libakrypt_get_option_by_index( ak_option_openssl_compability );
 
   if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                "using null pointer to block cipher key context" );
@@ -706,10 +985,14 @@
   if( oc ) {
     bkey->encrypt = ak_kuznechik_encrypt_with_mask_oc;
     bkey->decrypt = ak_kuznechik_decrypt_with_mask_oc;
+    bkey->encrypt_blocks = ak_kuznechik_encrypt_blocks_with_mask_oc;
+    bkey->decrypt_blocks = ak_kuznechik_decrypt_blocks_with_mask_oc;
   }
    else {
     bkey->encrypt = ak_kuznechik_encrypt_with_mask;
     bkey->decrypt = ak_kuznechik_decrypt_with_mask;
+    bkey->encrypt_blocks = ak_kuznechik_encrypt_blocks_with_mask;
+    bkey->decrypt_blocks = ak_kuznechik_decrypt_blocks_with_mask;
   }
  return error;
 }
@@ -723,7 +1006,7 @@
   ak_uint8 out[16];
   struct kuznechik_params parameters;
   int error = ak_error_ok, audit = ak_log_get_level(),
-      oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+      oc = (int) ak_libakrypt_get_option_by_index( ak_option_openssl_compability );
 
   ak_uint8 esum[16] = {
                  0x5b,0x80,0x54,0xb3,0x4e,0x81,0x09,0x94,0xcc,0x83,0x8b,0x8e,0x53,0xba,0x9d,0x18 };
@@ -834,7 +1117,7 @@
   ak_uint8 myout[256];
   bool_t result = ak_true;
   int error = ak_error_ok, audit = ak_log_get_level(),
-      oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+      oc = (int) ak_libakrypt_get_option_by_index( ak_option_openssl_compability );
 
  /* тестовый ключ из ГОСТ Р 34.13-2015, приложение А.1 */
   ak_uint8 key[32] = {
@@ -1191,7 +1474,7 @@
  bool_t ak_libakrypt_test_kuznechik( void )
 {
   int audit = ak_log_get_level();
-  int oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+  int oc = (int) ak_libakrypt_get_option_by_index( ak_option_openssl_compability );
 
  /* мы тестируем алгоритм Магма в двух режимах совместимисти,
     вызывая для этого функцию тестирования дважды
@@ -390,6 +390,11 @@
     ak_error_message( error, __func__, "initialization of context manager is wrong" );
      return ak_false;
    }
+ /* инициализируем развернутые таблицы замен для алгоритма Магма */
+   if(( error = ak_bckey_magma_init_tables()) != ak_error_ok ) {
+     ak_error_message( error, __func__, "initialization of magma tables is wrong" );
+     return ak_false;
+   }
 
  /* в случае, когда компилируются сетевые функции, инициализируем работу с сокетами */
 #ifdef AK_HAVE_WINDOWS_H
@@ -442,6 +447,9 @@
   #endif
 #endif
 
+ /* удаляем таблицы, выработанные для эллиптических кривых */
+  ak_wcurve_destroy_generator_tables();
+
   if( ak_log_get_level() != ak_log_none )
     ak_error_message( ak_error_ok, __func__ , "all crypto mechanisms successfully destroyed" );
 
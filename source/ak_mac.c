@@ -5,6 +5,12 @@
 /*  - содержит реализацию алгоритмов итерационного сжатия                                          */
 /* ----------------------------------------------------------------------------------------------- */
  #include <libakrypt-internal.h>
+#ifdef AK_HAVE_ERRNO_H
+ #include <errno.h>
+#endif
+#ifdef AK_HAVE_UNISTD_H
+ #include <unistd.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
  int ak_mac_create( ak_mac mctx, const size_t size, ak_pointer ictx,
@@ -186,74 +192,188 @@
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! Функция вычисляет результат сжимающего отображения для заданного файла и помещает
-    его в область памяти, на которую указывает out.
+/* считывание из файла заданного количества октетов (с учетом возможного неполного чтения) */
+ static ssize_t ak_mac_file_read( ak_file file, ak_uint8 *buffer, size_t size )
+{
+  ssize_t len = 0, total = 0;
 
-    @param mctx Указатель на контекст итерационного сжатия.
-    @param filename имя сжимаемого файла
-    @param out Область памяти, куда будет помещен результат. Память должна быть заранее выделена.
-    Размер выделяемой памяти должен быть не менее значения поля hsize для класса-родителя и может
-    быть определен с помощью вызова соответствующей функции, например, ak_hash_context_get_tag_size().
-    @param out_size Размер области памяти (в октетах), в которую будет помещен результат.
+  while( size > 0 ) {
+    if(( len = ak_file_read( file, buffer, size )) <= 0 ) break;
+    total += len; buffer += len; size -= ( size_t )len;
+  }
+  if(( len < 0 ) && ( total == 0 )) return -1;
+ return total;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/* передача последнего фрагмента данных функции finalize: при установленном флаге keep_last
+   функции finalize всегда передается непустой фрагмент (при ненулевой длине данных) */
+ static int ak_mac_file_finalize( ak_uint8 *data, const size_t len, const size_t bsize,
+                            const bool_t keep_last, ak_function_update *update,
+           ak_function_finalize *finalize, ak_pointer ctx, ak_pointer out, const size_t out_size )
+{
+  int error = ak_error_ok;
+  size_t qcnt = len / bsize, tail = len - qcnt*bsize;
+
+  if(( keep_last ) && ( tail == 0 ) && ( qcnt > 0 )) { qcnt--; tail = bsize; }
+  if( qcnt ) {
+    if(( error = update( ctx, data, qcnt*bsize )) != ak_error_ok ) return error;
+  }
+ return finalize( ctx, data +qcnt*bsize, tail, out, out_size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция последовательно передает функциям update и finalize содержимое фрагмента файла,
+    начинающегося со смещения offset и имеющего длину не более data_size октетов
+    (значение data_size = -1 означает обработку всех данных до конца файла). Функция используется
+    при вычислении кодов целостности файлов функциями ak_mac_file(), ak_mac_file_offset(),
+    а также ak_bckey_cmac_file() и ak_bckey_cmac_file_offset().
+
+    По-умолчанию данные считываются в буффер, длина которого определяется
+    опцией `file_read_buffer_size`. Если опция `file_mmap_threshold` отлична от нуля и длина
+    фрагмента не меньше ее значения, файл отображается в память и обрабатывается без
+    промежуточного копирования; в случае ошибки отображения используется чтение в буффер.
+
+    \warning Отображение файла в память допустимо только для файлов, которые не изменяются
+    во время вычислений: если файл будет уменьшен другим процессом, то обращение к отображенной
+    памяти приведет к сигналу SIGBUS, а не к возврату кода ошибки. Поэтому по-умолчанию
+    опция `file_mmap_threshold` равна нулю и отображение не используется.
+
+    Функции update всегда передаются данные, длина которых кратна bsize. Если установлен флаг
+    keep_last, то функции finalize передается непустой фрагмент длины от 1 до bsize октетов;
+    в противном случае длина фрагмента меньше bsize. Для пустого фрагмента функция finalize
+    вызывается с нулевой длиной данных.
+
+    @param filename имя обрабатываемого файла
+    @param offset смещение от начала файла (в октетах)
+    @param data_size размер фрагмента (в октетах) или -1
+    @param bsize длина блока данных, обрабатываемых функцией update
+    @param keep_last флаг передачи функции finalize непустого фрагмента данных
+    @param update функция обновления внутреннего состояния
+    @param finalize функция завершения вычислений
+    @param ctx контекст, передаваемый функциям update и finalize
+    @param out область памяти, куда будет помещен результат
+    @param out_size размер области памяти (в октетах), в которую будет помещен результат
 
     @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
     возвращается код ошибки.                                                                       */
 /* ----------------------------------------------------------------------------------------------- */
- int ak_mac_file( ak_mac mctx, const char* filename, ak_pointer out, const size_t out_size )
+ int ak_mac_file_process( const char *filename, ak_int64 offset, ak_int64 data_size,
+                            const size_t bsize, const bool_t keep_last, ak_function_update *update,
+           ak_function_finalize *finalize, ak_pointer ctx, ak_pointer out, const size_t out_size )
 {
-  size_t len = 0;
   struct file file;
+  ssize_t len = 0;
   int error = ak_error_ok;
-  size_t block_size = 4096; /* оптимальная длина блока для Windows пока не ясна */
-  ak_uint8 *localbuffer = NULL; /* место для локального считывания информации */
+  ak_uint8 *localbuffer = NULL, zero[1] = { 0x00 };
+  size_t block_size = 0, total_len = 0;
+ #ifdef AK_HAVE_SYSMMAN_H
+  ak_int64 threshold = ak_libakrypt_get_option_by_index( ak_option_file_mmap_threshold );
+ #endif
 
- /* выполняем необходимые проверки */
-  if( mctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
-                                                             "use a null pointer to mac context" );
   if( filename == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                                                 "use a null pointer to filename" );
-  if(( error = ak_mac_clean( mctx )) != ak_error_ok )
-    return ak_error_message( error, __func__, "incorrect cleaning a mac context");
-
   if(( error = ak_file_open_to_read( &file, filename )) != ak_error_ok ) {
     if( ak_log_get_level() > ak_log_none )
       ak_error_message_fmt( error, __func__, "incorrect access to file %s", filename );
     return error;
   }
+  if( offset < 0 ) {
+    ak_file_close( &file );
+    return ak_error_message( ak_error_lseek_file, __func__, "incorrect seeking to offset" );
+  }
+
+ /* вычисляем сколько октетов нам надо обработать */
+  if( offset >= file.size ) total_len = 0;
+   else total_len = ( size_t )(( data_size < 0 ) ?
+                               ( file.size - offset ) : ( ak_min( data_size, file.size - offset )));
+ /* для пустого фрагмента результатом будет код целостности от вектора нулевой длины */
+  if( total_len == 0 ) {
+    ak_file_close( &file );
+    return finalize( ctx, zero, 0, out, out_size );
+  }
 
- /* для файла нулевой длины результатом будет хеш от нулевого вектора */
-  if( !file.size ) {
+ /* для больших фрагментов используем отображение файла в память */
+ #ifdef AK_HAVE_SYSMMAN_H
+  if(( threshold > 0 ) && ( total_len >= ( size_t )threshold )) {
+    long page = sysconf( _SC_PAGESIZE );
+    size_t shift = ( size_t )offset % ( size_t )( page > 0 ? page : 4096 );
+    ak_uint8 *addr = mmap( NULL, total_len +shift, PROT_READ, MAP_PRIVATE, file.fd, offset -shift );
+
+    if( addr != MAP_FAILED ) {
+     #ifdef MADV_SEQUENTIAL
+      madvise( addr, total_len +shift, MADV_SEQUENTIAL );
+     #endif
+      error = ak_mac_file_finalize( addr +shift, total_len,
+                                         bsize, keep_last, update, finalize, ctx, out, out_size );
+      munmap( addr, total_len +shift );
+      ak_file_close( &file );
+      return error;
+    }
+    if( ak_log_get_level() >= ak_log_maximum )
+      ak_error_message_fmt( ak_error_mmap_file, __func__,
+                        "mmap error (%s) for file %s, using read instead", strerror( errno ), filename );
+  }
+ #endif
+
+ /* сдвигаем указатель на заданое число байт */
+  if(( offset > 0 ) && (( ak_file_lseek( &file, offset, SEEK_SET )) == -1 )) {
     ak_file_close( &file );
-    return ak_mac_finalize( mctx, "", 0, out, out_size );
+    return ak_error_message( ak_error_lseek_file, __func__, "incorrect seeking to offset" );
   }
 
- /* готовим область для хранения данных */
-  block_size = ak_max( ( size_t )file.blksize, mctx->bsize );
- /* здесь мы выделяем локальный буффер для считывания/обработки данных */
+ /* готовим область для хранения данных: длина буффера кратна bsize
+    (или совпадает с длиной фрагмента, если фрагмент короче буффера) */
+  block_size = ak_max( ( size_t )file.blksize,
+           ( size_t )ak_libakrypt_get_option_by_index( ak_option_file_read_buffer_size ));
+  block_size = ak_min( ak_max( bsize, block_size - block_size%bsize ), total_len );
   if(( localbuffer = ( ak_uint8 * ) ak_aligned_malloc( block_size )) == NULL ) {
     ak_file_close( &file );
     return ak_error_message( ak_error_out_of_memory, __func__ ,
                                                       "memory allocation error for local buffer" );
   }
- /* теперь обрабатываем файл с данными */
-  read_label: len = ( size_t ) ak_file_read( &file, localbuffer, block_size );
-  if( len == block_size ) {
-    ak_mac_update( mctx, localbuffer, block_size ); /* добавляем считанные данные */
-    goto read_label;
-  } else {
-           size_t qcnt = len / mctx->bsize,
-                  tail = len - qcnt*mctx->bsize;
-           if( qcnt ) ak_mac_update( mctx, localbuffer, qcnt*mctx->bsize );
-           error = ak_mac_finalize( mctx, localbuffer + qcnt*mctx->bsize, tail, out, out_size );
-         }
- /* очищаем за собой данные, содержащиеся в контексте */
-  ak_mac_clean( mctx );
- /* закрываем данные */
-  ak_file_close( &file );
+
+ /* теперь цикл последовательной обработки */
+  for( ;; ) {
+    size_t size = ak_min( total_len, block_size );
+    if(( len = ak_mac_file_read( &file, localbuffer, size )) != ( ssize_t )size ) {
+      error = ak_error_message_fmt( ak_error_read_data, __func__,
+                                           "incorrect reading a block of file %s", filename );
+      break;
+    }
+    if( size == total_len ) { /* считан последний фрагмент */
+      error = ak_mac_file_finalize( localbuffer, size,
+                                         bsize, keep_last, update, finalize, ctx, out, out_size );
+      break;
+    }
+    if(( error = update( ctx, localbuffer, size )) != ak_error_ok ) break;
+    total_len -= size;
+  }
+
   ak_aligned_free( localbuffer );
+  ak_file_close( &file );
  return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет результат сжимающего отображения для заданного файла и помещает
+    его в область памяти, на которую указывает out.
+
+    @param mctx Указатель на контекст итерационного сжатия.
+    @param filename имя сжимаемого файла
+    @param out Область памяти, куда будет помещен результат. Память должна быть заранее выделена.
+    Размер выделяемой памяти должен быть не менее значения поля hsize для класса-родителя и может
+    быть определен с помощью вызова соответствующей функции, например, ak_hash_context_get_tag_size().
+    @param out_size Размер области памяти (в октетах), в которую будет помещен результат.
+
+    @return В случае успеха функция возвращает ноль (\ref ak_error_ok). В противном случае
+    возвращается код ошибки.                                                                       */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_mac_file( ak_mac mctx, const char* filename, ak_pointer out, const size_t out_size )
+{
+ return ak_mac_file_offset( mctx, filename, 0, -1, out, out_size );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция вычисляет результат сжимающего отображения для фрагмента файла,
     начинающегося со смещения offset и имеющего длину не более data_size октетов, и помещает
@@ -278,17 +398,8 @@
  int ak_mac_file_offset( ak_mac mctx, const char* filename,
                        ak_int64 offset, ak_int64 data_size, ak_pointer out, const size_t out_size )
 {
-    struct file file;
     int error = ak_error_ok;
-    size_t block_size = 4096; /* оптимальная длина блока для Windows пока не ясна */
-    size_t len = 0, total_len = 0;
-    ak_uint8 *localbuffer = NULL; /* место для локального считывания информации */
 
-   /* в начале проверяем, нельзя ли свалить свою работу на чужие плечи? */
-    if(( offset == 0 ) && ( data_size == -1 ))
-      return ak_mac_file( mctx, filename, out, out_size );
-
-   /* дальше - делать нечего, принимаемся за работу */
     if( mctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                                                               "use a null pointer to mac context" );
     if( filename == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
@@ -296,55 +407,11 @@
     if(( error = ak_mac_clean( mctx )) != ak_error_ok )
       return ak_error_message( error, __func__, "incorrect cleaning a mac context");
 
-    if(( error = ak_file_open_to_read( &file, filename )) != ak_error_ok ) {
-      if( ak_log_get_level() > ak_log_none )
-        ak_error_message_fmt( error, __func__, "incorrect access to file %s", filename );
-      return error;
-    }
-
-   /* для файла нулевой длины результатом будет хеш от нулевого вектора */
-    if(( !file.size ) || ( offset >= file.size )) {
-      ak_file_close( &file );
-      return ak_mac_finalize( mctx, "", 0, out, out_size );
-    }
-
-   /* сдвигаем указатель на заданое число байт */
-    if(( ak_file_lseek( &file, offset, SEEK_SET )) == -1 ) {
-      ak_file_close( &file );
-      return ak_error_message( ak_error_lseek_file, __func__, "incorrect seeking to offset" );
-    }
-
-   /* готовим область для хранения данных */
-    block_size = ak_max( ( size_t )file.blksize, mctx->bsize );
-   /* здесь мы выделяем локальный буффер для считывания/обработки данных */
-    if(( localbuffer = ( ak_uint8 * ) ak_aligned_malloc( block_size )) == NULL ) {
-      ak_file_close( &file );
-      return ak_error_message( ak_error_out_of_memory, __func__ ,
-                                                       "memory allocation error for local buffer" );
-    }
-
-   /* вычисляем сколько октетов нам надо обработать */
-    total_len = ( data_size == -1 ) ?
-                                ( file.size - offset ) : ( ak_min( data_size, file.size - offset ));
-
-   /* теперь цикл последовательной обработки */
-    read_label: len = ( size_t ) ak_file_read( &file, localbuffer, ak_min( block_size, total_len ));
-    if( len == block_size ) {
-      ak_mac_update( mctx, localbuffer, block_size ); /* добавляем считанные данные */
-      total_len -= len;
-      goto read_label;
-    } else {
-             size_t qcnt = len / mctx->bsize,
-                    tail = len - qcnt*mctx->bsize;
-             if( qcnt ) ak_mac_update( mctx, localbuffer, qcnt*mctx->bsize );
-             error = ak_mac_finalize( mctx, localbuffer + qcnt*mctx->bsize, tail, out, out_size );
-         }
-
+    error = ak_mac_file_process( filename, offset, data_size, mctx->bsize, ak_false,
+                  ( ak_function_update * )ak_mac_update, ( ak_function_finalize * )ak_mac_finalize,
+                                                                         mctx, out, out_size );
    /* очищаем за собой данные, содержащиеся в контексте */
     ak_mac_clean( mctx );
-   /* закрываем данные */
-    ak_file_close( &file );
-    ak_aligned_free( localbuffer );
 
   return error;
 }
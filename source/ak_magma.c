@@ -641,6 +641,227 @@
 #endif
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*             многоблочная реализация алгоритмов зашифрования и расшифрования                     */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество блоков, одновременно находящихся в обработке. */
+ #define ak_magma_blocks_in_flight  (8)
+
+/*! \brief Номера раундовых ключей, используемых на последовательных тактах зашифрования. */
+ static const ak_uint8 magma_encrypt_key_order[32] = {
+   7, 6, 5, 4, 3, 2, 1, 0, 7, 6, 5, 4, 3, 2, 1, 0, 7, 6, 5, 4, 3, 2, 1, 0, 0, 1, 2, 3, 4, 5, 6, 7
+ };
+
+/*! \brief Номера раундовых ключей, используемых на последовательных тактах расшифрования. */
+ static const ak_uint8 magma_decrypt_key_order[32] = {
+   7, 6, 5, 4, 3, 2, 1, 0, 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7
+ };
+
+/*! \brief Развернутые таблицы замен: результат замены байта сразу сдвинут на свою позицию
+    в 32-х битном слове и циклически повернут на 11 разрядов. */
+ static ak_uint32 magma_expanded_boxes[2][2][4][256];
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция вычисляет развернутые таблицы замен, используемые многоблочной реализацией
+    алгоритма Магма. Функция вызывается один раз, при инициализации библиотеки.
+
+    @return Функция возвращает \ref ak_error_ok.                                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_magma_init_tables( void )
+{
+  ak_uint32 i, j, k, x, v;
+
+  for( j = 0; j < 2; j++ )
+    for( i = 0; i < 2; i++ )
+      for( k = 0; k < 4; k++ )
+        for( x = 0; x < 256; x++ ) {
+           v = (( ak_uint32 ) magma_boxes[j][i][k][x] ) << ( 8*k );
+           magma_expanded_boxes[j][i][k][x] = ( v<<11 | v>>21 );
+        }
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция реализует один такт шифрующего преобразования ГОСТ 34.12-2015 (Mагма)
+    с использованием развернутых таблиц; результат совпадает с ak_magma_gostf_boxes().             */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline ak_uint32 ak_magma_gostf_expanded( ak_uint32 x, const ak_uint32 i, const ak_uint32 j )
+{
+  return magma_expanded_boxes[j][i][3][x>>24 & 255] ^ magma_expanded_boxes[j][i][2][x>>16 & 255] ^
+         magma_expanded_boxes[j][i][1][x>> 8 & 255] ^ magma_expanded_boxes[j][i][0][x & 255];
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифрования (расшифрования) последовательности независимых блоков информации
+    алгоритмом ГОСТ 34.12-2015 (Магма).
+
+    Зашифрование и расшифрование отличаются только порядком использования раундовых ключей,
+    который задается параметром `order`. Блоки обрабатываются группами по \ref ak_magma_blocks_in_flight штук. Для каждого блока
+    группы вырабатывается собственная случайная траектория (все траектории группы вырабатываются
+    за одно обращение к генератору), после чего каждый такт сети Фейстеля выполняется сразу для
+    всех блоков группы. Поскольку обработка различных блоков не зависит друг от друга,
+    задержки обращений к таблицам замен перекрываются.
+
+    Траектория хранится в виде 64-х битного слова `w`, в котором разряд с номером `r`
+    совпадает со значением `m[r]` однократной реализации алгоритма.
+
+    Параметр `oc` должен быть константой: после подстановки функции компилятор исключает
+    лишнее ветвление.
+
+    @param skey Контекст секретного ключа.
+    @param in Последовательность блоков входной информации (открытый текст).
+    @param out Последовательность блоков выходной информации (шифртекст).
+    @param count Количество обрабатываемых блоков.
+    @param order Номера раундовых ключей, используемых на последовательных тактах.
+    @param oc Флаг режима совместимости с библиотекой openssl.                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_magma_encrypt_blocks_with_random_walk_common( ak_skey skey,
+          ak_pointer in, ak_pointer out, size_t count, const ak_uint8 *order, const int oc )
+{
+  size_t i, j, n;
+  ak_uint32 mv[ ak_magma_blocks_in_flight ], n3[ ak_magma_blocks_in_flight ],
+            n4[ ak_magma_blocks_in_flight ], p = 0, k = 0, b = 0;
+  ak_uint64 w[ ak_magma_blocks_in_flight ];
+  ak_uint32 (*kp)[8] = ((struct magma_encrypted_keys *)skey->data)->inkey;
+  ak_uint32 (*mp)[8] = ((struct magma_encrypted_keys *)skey->data)->inmask;
+  ak_uint32 *inptr = ( ak_uint32 *)in, *outptr = ( ak_uint32 *)out;
+
+  while( count > 0 ) {
+    n = ak_min( count, ak_magma_blocks_in_flight );
+
+   /* вырабатываем случайные траектории */
+    skey->generator.random( &skey->generator, mv, ( ssize_t )( n*sizeof( ak_uint32 )));
+    for( j = 0; j < n; j++ ) {
+       w[j] = (( ak_uint64 )mv[j] ) << 1;
+       if( oc ) w[j] &= 0xfffffffc; /* в режиме совместимости m[1] = m[32] = 0 */
+       b = ( ak_uint32 )( w[j] >> 1 )&0x01;
+      #ifdef AK_LITTLE_ENDIAN
+       if( oc ) {
+         n4[j] = bswap_32( inptr[2*j] )^( b * 0xffffffff );
+         n3[j] = bswap_32( inptr[2*j+1] );
+       } else {
+           n3[j] = inptr[2*j]^( b * 0xffffffff );
+           n4[j] = inptr[2*j+1];
+         }
+      #else
+       if( oc ) {
+         n4[j] = inptr[2*j]^( b * 0xffffffff );
+         n3[j] = inptr[2*j+1];
+       } else {
+           n3[j] = bswap_32( inptr[2*j] )^( b * 0xffffffff );
+           n4[j] = bswap_32( inptr[2*j+1] );
+         }
+      #endif
+    }
+
+   /* выполняем такты сети Фейстеля, по два такта за одну итерацию */
+    for( i = 1; i < 33; i += 2 ) {
+       k = order[i-1];
+       for( j = 0; j < n; j++ ) {
+          b = ( ak_uint32 )( w[j] >> i )&0x01;
+          p = n3[j]; p -= mp[b][k]; p += kp[b][k] + b;
+          n4[j] ^= ak_magma_gostf_expanded( p,
+                                 ( ak_uint32 )(( w[j] >> ( i+1 )) ^ ( w[j] >> ( i-1 )))&0x01, b );
+       }
+       k = order[i];
+       for( j = 0; j < n; j++ ) {
+          b = ( ak_uint32 )( w[j] >> ( i+1 ))&0x01;
+          p = n4[j]; p -= mp[b][k]; p += kp[b][k] + b;
+          n3[j] ^= ak_magma_gostf_expanded( p,
+                                     ( ak_uint32 )(( w[j] >> ( i+2 )) ^ ( w[j] >> i ))&0x01, b );
+       }
+    }
+
+    for( j = 0; j < n; j++ ) {
+       b = ( ak_uint32 )( w[j] >> 32 )&0x01;
+      #ifdef AK_LITTLE_ENDIAN
+       if( oc ) {
+         outptr[2*j+1] = bswap_32( n4[j] )^( b * 0xffffffff );
+         outptr[2*j] = bswap_32( n3[j] );
+       } else {
+           outptr[2*j] = n4[j]^( b * 0xffffffff );
+           outptr[2*j+1] = n3[j];
+         }
+      #else
+       if( oc ) {
+         outptr[2*j+1] = n4[j]^( b * 0xffffffff );
+         outptr[2*j] = n3[j];
+       } else {
+           outptr[2*j] = bswap_32( n4[j] )^( b * 0xffffffff );
+           outptr[2*j+1] = bswap_32( n3[j] );
+         }
+      #endif
+    }
+    inptr += 2*n; outptr += 2*n; count -= n;
+  }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифрования последовательности из `count` независимых блоков информации
+    алгоритмом ГОСТ 34.12-2015 (Магма).
+
+    @param skey Контекст секретного ключа.
+    @param in Последовательность блоков входной информации (открытый текст).
+    @param out Последовательность блоков выходной информации (шифртекст).
+    @param count Количество обрабатываемых блоков.                                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_encrypt_blocks_with_random_walk( ak_skey skey,
+                                                     ak_pointer in, ak_pointer out, size_t count )
+{
+  ak_magma_encrypt_blocks_with_random_walk_common( skey, in, out, count,
+                                                                  magma_encrypt_key_order, 0 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифрования последовательности из `count` независимых блоков информации
+    алгоритмом ГОСТ 34.12-2015 (Магма).
+    Функция реализует режим совместимости с псевдопреобразованием, реализуемым библиотекой openssl.
+
+    @param skey Контекст секретного ключа.
+    @param in Последовательность блоков входной информации (открытый текст).
+    @param out Последовательность блоков выходной информации (шифртекст).
+    @param count Количество обрабатываемых блоков.                                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_encrypt_blocks_with_random_walk_oc( ak_skey skey,
+                                                     ak_pointer in, ak_pointer out, size_t count )
+{
+  ak_magma_encrypt_blocks_with_random_walk_common( skey, in, out, count,
+                                                                  magma_encrypt_key_order, 1 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция расшифрования последовательности из `count` независимых блоков информации
+    алгоритмом ГОСТ 34.12-2015 (Магма).
+
+    @param skey Контекст секретного ключа.
+    @param in Последовательность блоков входной информации (шифртекст).
+    @param out Последовательность блоков выходной информации (открытый текст).
+    @param count Количество обрабатываемых блоков.                                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_decrypt_blocks_with_random_walk( ak_skey skey,
+                                                     ak_pointer in, ak_pointer out, size_t count )
+{
+  ak_magma_encrypt_blocks_with_random_walk_common( skey, in, out, count,
+                                                                  magma_decrypt_key_order, 0 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция расшифрования последовательности из `count` независимых блоков информации
+    алгоритмом ГОСТ 34.12-2015 (Магма).
+    Функция реализует режим совместимости с псевдопреобразованием, реализуемым библиотекой openssl.
+
+    @param skey Контекст секретного ключа.
+    @param in Последовательность блоков входной информации (шифртекст).
+    @param out Последовательность блоков выходной информации (открытый текст).
+    @param count Количество обрабатываемых блоков.                                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_magma_decrypt_blocks_with_random_walk_oc( ak_skey skey,
+                                                     ak_pointer in, ak_pointer out, size_t count )
+{
+  ak_magma_encrypt_blocks_with_random_walk_common( skey, in, out, count,
+                                                                  magma_decrypt_key_order, 1 );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция уничтожения развернутых ключей для маскированной магмы
 
@@ -916,7 +1137,8 @@
 /* ----------------------------------------------------------------------------------------------- */
  int ak_bckey_create_magma( ak_bckey bkey )
 {
-  int error = ak_error_ok, oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+  int error = ak_error_ok,
+      oc = (int) ak_libakrypt_get_option_by_index( ak_option_openssl_compability );
 
   if( bkey == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
                                                "using null pointer to block cipher key context" );
@@ -948,10 +1170,14 @@
   if( oc ) {
     bkey->encrypt = ak_magma_encrypt_with_random_walk_oc;
     bkey->decrypt = ak_magma_decrypt_with_random_walk_oc;
+    bkey->encrypt_blocks = ak_magma_encrypt_blocks_with_random_walk_oc;
+    bkey->decrypt_blocks = ak_magma_decrypt_blocks_with_random_walk_oc;
   }
    else {
     bkey->encrypt = ak_magma_encrypt_with_random_walk;
     bkey->decrypt = ak_magma_decrypt_with_random_walk;
+    bkey->encrypt_blocks = ak_magma_encrypt_blocks_with_random_walk;
+    bkey->decrypt_blocks = ak_magma_decrypt_blocks_with_random_walk;
   }
   return error;
 }
@@ -1107,7 +1333,7 @@
   ak_uint8 myout[256];
   bool_t result = ak_true;
   int error = ak_error_ok, audit = ak_log_get_level(),
-      oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+      oc = (int) ak_libakrypt_get_option_by_index( ak_option_openssl_compability );
 
  /* Проверка используемого режима совместимости */
   if(( oc < 0 ) || ( oc > 1 )) {
@@ -1449,7 +1675,7 @@
 /* ----------------------------------------------------------------------------------------------- */
  bool_t ak_libakrypt_test_magma( void )
 {
- int oc = (int) ak_libakrypt_get_option_by_name( "openssl_compability" );
+ int oc = (int) ak_libakrypt_get_option_by_index( ak_option_openssl_compability );
 
  /* мы тестируем алгоритм Магма в двух режимах совместимисти,
     вызывая для этого функцию тестирования дважды
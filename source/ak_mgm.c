@@ -129,6 +129,96 @@
 
 #endif
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество блоков, обрабатываемых за один вызов многоблочной функции зашифрования
+    в режиме `mgm` для 128-битного шифра. */
+ #define ak_mgm_blocks  (8)
+
+/*! \brief Увеличение на единицу 64-битной половины счетчика, хранящейся в формате big endian
+    (для little endian платформ увеличение выполняется без разворота). */
+#ifdef AK_LITTLE_ENDIAN
+ #define ak_mgm_increment(Q) (Q)++;
+#else
+ #define ak_mgm_increment(Q) (Q) = bswap_64( bswap_64( Q ) + 1 );
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Конвейерная обработка группы полных блоков данных для 128-битного шифра.
+
+    Функция вырабатывает за один проход до \ref ak_mgm_blocks последовательных значений
+    счетчиков \f$ Y_i \f$ и \f$ Z_i \f$, зашифровывает их с помощью многоблочной функции
+    `encrypt_blocks` (если ключи шифрования и имитозащиты совпадают, то одним вызовом),
+    после чего вычисляет сумму произведений \f$ H_i \otimes C_i \f$ с одним приведением
+    по модулю на всю группу (функция ak_gf128_mul_sum()). Поскольку блоки группы не зависят
+    друг от друга, процессор совмещает во времени шифрование, умножение и приведение.
+
+    Ключ шифрования может принимать значение `NULL` (обрабатываются только дополнительные данные,
+    указатель `out` не используется), ключ имитозащиты также может принимать значение `NULL`
+    (выполняется только шифрование). Ресурсы ключей функцией не проверяются и не изменяются.
+
+    @param ctx Контекст внутреннего состояния алгоритма.
+    @param encryptionKey Ключ шифрования; метод `encrypt_blocks` должен быть определен.
+    @param authenticationKey Ключ имитозащиты; метод `encrypt_blocks` должен быть определен.
+    @param in Входные данные.
+    @param out Выходные данные.
+    @param blocks Количество обрабатываемых блоков.
+    @param authin Если значение истинно, то имитовставка вычисляется от входных данных
+    (расшифрование и дополнительные данные), в противном случае -- от выходных данных
+    (зашифрование).                                                                                */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_mgm_update_blocks128( ak_mgm_ctx ctx, ak_bckey encryptionKey,
+                                ak_bckey authenticationKey, ak_uint64 *in, ak_uint64 *out,
+                                                                size_t blocks, const bool_t authin )
+{
+  size_t j, n;
+  ak_uint64 ctr[ 4*ak_mgm_blocks ], gamma[ 4*ak_mgm_blocks ];
+  ak_uint64 *yc = ctr, *zc = ctr +2*ak_mgm_blocks, *e = gamma, *h = gamma +2*ak_mgm_blocks;
+
+  while( blocks > 0 ) {
+    n = ak_min( blocks, ak_mgm_blocks );
+
+   /* вырабатываем значения счетчиков */
+    if( encryptionKey != NULL ) {
+      for( j = 0; j < n; j++ ) {
+         yc[2*j] = ctx->ycount.q[0];
+         yc[2*j+1] = ctx->ycount.q[1];
+         ak_mgm_increment( ctx->ycount.q[0] );
+      }
+    }
+    if( authenticationKey != NULL ) {
+      for( j = 0; j < n; j++ ) {
+         zc[2*j] = ctx->zcount.q[0];
+         zc[2*j+1] = ctx->zcount.q[1];
+         ak_mgm_increment( ctx->zcount.q[1] );
+      }
+    }
+
+   /* зашифровываем счетчики */
+    if( encryptionKey == authenticationKey ) {
+      if( n == ak_mgm_blocks )
+        encryptionKey->encrypt_blocks( &encryptionKey->key, ctr, gamma, 2*ak_mgm_blocks );
+       else {
+        encryptionKey->encrypt_blocks( &encryptionKey->key, yc, e, n );
+        encryptionKey->encrypt_blocks( &encryptionKey->key, zc, h, n );
+       }
+    } else {
+       if( encryptionKey != NULL ) encryptionKey->encrypt_blocks( &encryptionKey->key, yc, e, n );
+       if( authenticationKey != NULL )
+         authenticationKey->encrypt_blocks( &authenticationKey->key, zc, h, n );
+      }
+
+   /* шифруем данные и вычисляем имитовставку */
+    if(( authenticationKey != NULL ) && authin ) ak_gf128_mul_sum( &ctx->sum, h, in, n );
+    if( encryptionKey != NULL ) {
+      for( j = 0; j < 2*n; j++ ) out[j] = in[j] ^ e[j];
+      if(( authenticationKey != NULL ) && !authin ) ak_gf128_mul_sum( &ctx->sum, h, out, n );
+      out += 2*n;
+    }
+    in += 2*n;
+    blocks -= n;
+  }
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция обрабатывает очередной блок дополнительных данных и
     обновляет внутреннее состояние переменных алгоритма MGM, участвующих в алгоритме
@@ -176,6 +266,11 @@
  if( absize == 16 ) { /* обработка 128-битным шифром */
 
    ctx->abitlen += ( blocks  << 7 );
+   if( authenticationKey->encrypt_blocks != NULL ) {
+     ak_mgm_update_blocks128( ctx, NULL, authenticationKey,
+                                            (ak_uint64 *)aptr, NULL, ( size_t )blocks, ak_true );
+     aptr += 16*blocks; blocks = 0;
+   }
    for( ; blocks > 0; blocks--, aptr += 16 ) { astep128( aptr ); }
    if( tail ) {
     memset( temp, 0, 16 );
@@ -442,6 +537,10 @@
 
     if( absize&0x10 ) { /* режим работы для 128-битного шифра */
      /* основная часть */
+      if( encryptionKey->encrypt_blocks != NULL ) {
+        ak_mgm_update_blocks128( ctx, encryptionKey, NULL, inp, outp, blocks, ak_false );
+        inp += 2*blocks; outp += 2*blocks; blocks = 0;
+      }
       for( ; blocks > 0; blocks--, inp += 2, outp += 2 ) {
          estep128;
       }
@@ -479,6 +578,10 @@
 
   if( absize&0x10 ) { /* режим работы для 128-битного шифра */
    /* основная часть */
+    if(( encryptionKey->encrypt_blocks != NULL ) && ( authenticationKey->encrypt_blocks != NULL )) {
+      ak_mgm_update_blocks128( ctx, encryptionKey, authenticationKey, inp, outp, blocks, ak_false );
+      inp += 2*blocks; outp += 2*blocks; blocks = 0;
+    }
     for( ; blocks > 0; blocks--, inp += 2, outp += 2 ) {
       estep128;
       astep128( outp );
@@ -584,6 +687,10 @@
                                     /* это полная копия кода, содержащегося в функции .. _encryption_ ... */
     if( absize&0x10 ) { /* режим работы для 128-битного шифра */
      /* основная часть */
+      if( encryptionKey->encrypt_blocks != NULL ) {
+        ak_mgm_update_blocks128( ctx, encryptionKey, NULL, inp, outp, blocks, ak_false );
+        inp += 2*blocks; outp += 2*blocks; blocks = 0;
+      }
       for( ; blocks > 0; blocks--, inp += 2, outp += 2 ) {
          estep128;
       }
@@ -617,6 +724,10 @@
 
      if( absize&0x10 ) { /* режим работы для 128-битного шифра */
       /* основная часть */
+      if(( encryptionKey->encrypt_blocks != NULL ) && ( authenticationKey->encrypt_blocks != NULL )) {
+        ak_mgm_update_blocks128( ctx, encryptionKey, authenticationKey, inp, outp, blocks, ak_true );
+        inp += 2*blocks; outp += 2*blocks; blocks = 0;
+      }
       for( ; blocks > 0; blocks--, inp += 2, outp += 2 ) {
          astep128( inp );
          estep128;
@@ -73,6 +73,27 @@
  } while (0)
 #endif
 
+/* ----------------------------------------------------------------------------------------------- */
+/* вычисление двухсловного значения (h,l) = a*b + c + d, используемое в арифметике Монтгомери      */
+#ifdef AK_HAVE_BUILTIN_UINT128
+ __extension__ typedef unsigned __int128 ak_mpzn_dword;
+ #define ak_mpzn_mac( h, l, a, b, c, d )                                        \
+ do {                                                                           \
+    ak_mpzn_dword __t = ( ak_mpzn_dword )(a)*(b) + (c) + (d);                   \
+    (l) = ( ak_uint64 )__t;                                                     \
+    (h) = ( ak_uint64 )( __t >> 64 );                                           \
+ } while (0)
+#else
+ #define ak_mpzn_mac( h, l, a, b, c, d )                                        \
+ do {                                                                           \
+    ak_uint64 __h, __l, __c = (c), __d = (d);                                   \
+    umul_ppmm( __h, __l, (a), (b) );                                            \
+    __l += __c; __h += ( __l < __c );                                           \
+    __l += __d; __h += ( __l < __d );                                           \
+    (l) = __l; (h) = __h;                                                       \
+ } while (0)
+#endif
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция присваивает значение вычета x вычету z. Для оптимизации вычислений проверка
     корректности входных данных не производится.
@@ -719,6 +740,105 @@
    if( t[size] != cy ) memcpy( z, t, size*sizeof( ak_uint64 ));
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Завершающее вычитание модуля в арифметике Монтгомери.
+
+    Функция помещает в `z` значение \f$ t - p\f$, если \f$ t \geq p \f$, и значение \f$ t \f$
+    в противном случае. Величина \f$ t \f$ занимает `size+1` слово, выбор результата
+    выполняется без условных переходов.                                                            */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mpzn_montgomery_final_sub( ak_uint64 *z, const ak_uint64 *t,
+                                                         const ak_uint64 *p, const size_t size )
+{
+  size_t j;
+  ak_uint64 u[ak_mpzn512_size], av, bv, cy = 0, mask;
+
+  for( j = 0; j < size; j++ ) {
+     av = t[j];
+     bv = av - cy;
+     cy = bv > av;
+     av = bv - p[j];
+     cy += av > bv;
+     u[j] = av;
+  }
+ /* значение t сохраняется, только если t < p, т.е. старшее слово равно нулю и был заем */
+  mask = ( ak_uint64 )0 - (( t[size]^1 )&cy );
+  for( j = 0; j < size; j++ ) z[j] = ( t[j]&mask )^( u[j]&~mask );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Умножение вычетов в представлении Монтгомери для модулей фиксированной длины.
+
+    Реализация метода CIOS (Coarsely Integrated Operand Scanning), в котором умножение и
+    приведение по модулю выполняются в одном цикле. Функция вызывается с константным значением
+    `size`, что позволяет компилятору полностью развернуть все циклы.                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mpzn_mul_montgomery_cios( ak_uint64 *z, const ak_uint64 *x,
+                    const ak_uint64 *y, const ak_uint64 *p, const ak_uint64 n0, const size_t size )
+{
+  size_t i, j;
+  ak_uint64 t[ak_mpzn512_size+2], c, m, h;
+
+  for( j = 0; j < size+2; j++ ) t[j] = 0;
+  for( i = 0; i < size; i++ ) {
+    /* t <- t + x*y[i] */
+     c = 0;
+     for( j = 0; j < size; j++ ) ak_mpzn_mac( c, t[j], x[j], y[i], t[j], c );
+     t[size] += c;
+     t[size+1] = ( t[size] < c );
+
+    /* t <- (t + m*p)/2^64 */
+     m = t[0]*n0;
+     ak_mpzn_mac( c, h, m, p[0], t[0], 0 );
+     for( j = 1; j < size; j++ ) ak_mpzn_mac( c, t[j-1], m, p[j], t[j], c );
+     t[size-1] = t[size] + c;
+     c = ( t[size-1] < c );
+     t[size] = t[size+1] + c;
+  }
+  (void)h;
+  ak_mpzn_montgomery_final_sub( z, t, p, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Возведение в квадрат вычета в представлении Монтгомери для модулей фиксированной длины.
+
+    Сначала вычисляется квадрат вычета (каждое попарное произведение различных слов
+    вычисляется один раз и удваивается), после чего выполняется приведение Монтгомери.
+    Функция вызывается с константным значением `size`.                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mpzn_sqr_montgomery_sos( ak_uint64 *z, const ak_uint64 *x,
+                                      const ak_uint64 *p, const ak_uint64 n0, const size_t size )
+{
+  size_t i, j;
+  ak_uint64 t[2*ak_mpzn512_size+1], c, cc, h, l, m;
+
+ /* попарные произведения x[i]*x[j], i < j */
+  for( j = 0; j < 2*size+1; j++ ) t[j] = 0;
+  for( i = 0; i < size-1; i++ ) {
+     c = 0;
+     for( j = i+1; j < size; j++ ) ak_mpzn_mac( c, t[i+j], x[i], x[j], t[i+j], c );
+     t[i+size] = c;
+  }
+ /* удваиваем и добавляем квадраты слов */
+  for( i = 0, c = 0; i < size; i++ ) {
+     ak_mpzn_mac( h, l, x[i], x[i], 0, 0 );
+     ak_mpzn_mac( c, t[2*i], t[2*i], 2, l, c );
+     ak_mpzn_mac( c, t[2*i+1], t[2*i+1], 2, h, c );
+  }
+
+ /* приведение Монтгомери; перенос из старшего разряда накапливается в cc */
+  for( i = 0, cc = 0; i < size; i++ ) {
+     m = t[i]*n0;
+     c = 0;
+     for( j = 0; j < size; j++ ) ak_mpzn_mac( c, t[i+j], m, p[j], t[i+j], c );
+     t[i+size] += c; l = ( t[i+size] < c );
+     t[i+size] += cc; l += ( t[i+size] < cc );
+     cc = l;
+  }
+  t[2*size] = cc;
+  ak_mpzn_montgomery_final_sub( z, t +size, p, size );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция умножает два вычета x и y в представлении Монтгомери, после чего приводит полученное
     произведение по модулю p, то есть для \f$ x \equiv x_0r \pmod{p} \f$ и
@@ -743,6 +863,19 @@
   ak_uint64 av = 0, bv = 0, cy = 0;
   ak_mpznmax t = ak_mpznmax_zero;
 
+ /* для длин, используемых в эллиптических кривых, применяются специализированные реализации */
+  switch( size ) {
+    case ak_mpzn256_size:
+      if( x == y ) ak_mpzn_sqr_montgomery_sos( z, x, p, n0, ak_mpzn256_size );
+        else ak_mpzn_mul_montgomery_cios( z, x, y, p, n0, ak_mpzn256_size );
+      return;
+    case ak_mpzn512_size:
+      if( x == y ) ak_mpzn_sqr_montgomery_sos( z, x, p, n0, ak_mpzn512_size );
+        else ak_mpzn_mul_montgomery_cios( z, x, y, p, n0, ak_mpzn512_size );
+      return;
+    default: break;
+  }
+
   // ak_mpzn_mul( t, x, y, size );
   for( i = 0; i < size; i++ ) {
      ak_uint64 c = 0, m = x[i];
@@ -795,6 +928,30 @@
   if( cy != t[2*size] ) memcpy( z, t+size, size*sizeof( ak_uint64 ));
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция возводит в квадрат вычет x в представлении Монтгомери, то есть для
+    \f$ x \equiv x_0r \pmod{p} \f$ вычисляет значение, удовлетворяющее сравнению
+    \f$ z \equiv x_0^2r \pmod{p}\f$. Результат совпадает с результатом вызова
+    `ak_mpzn_mul_montgomery( z, x, x, p, n0, size )`, однако для модулей длины 256 и 512 бит
+    вычисляется быстрее, поскольку каждое попарное произведение различных слов вычета
+    вычисляется только один раз.
+
+    @param z Указатель на вычет, в который помещается результат; может совпадать с x
+    @param x Вычет, возводимый в квадрат
+    @param p Модуль, по которому производятся вычисления
+    @param n0 Константа, используемая в вычислениях (см. ak_mpzn_mul_montgomery())
+    @param size Размер модуля в словах                                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_mpzn_sqr_montgomery( ak_uint64 *z, ak_uint64 *x, ak_uint64 *p,
+                                                            ak_uint64 n0, const size_t size )
+{
+  switch( size ) {
+    case ak_mpzn256_size: ak_mpzn_sqr_montgomery_sos( z, x, p, n0, ak_mpzn256_size ); break;
+    case ak_mpzn512_size: ak_mpzn_sqr_montgomery_sos( z, x, p, n0, ak_mpzn512_size ); break;
+    default: ak_mpzn_mul_montgomery( z, x, x, p, n0, size );
+  }
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Для вычета \f$ x \f$, заданного в представлении Монтгомери в виде \f$ xr \f$, где \f$ r \f$
     заданная степень двойки, вычисляется вычет \f$ z \f$,
@@ -841,6 +998,290 @@
   memcpy( z, res, size*sizeof( ak_uint64 ));
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                 обращение вычетов методом Бернштейна-Янга (safegcd) за фиксированное время      */
+/* ----------------------------------------------------------------------------------------------- */
+/*! Значения в алгоритме представляются в виде знаковых 62-х битных слов, последнее слово содержит
+    знак; число слов достаточно для представления вычетов длины 512 бит.                          */
+#ifdef AK_HAVE_BUILTIN_UINT128
+ __extension__ typedef __int128 ak_mpzn_sdword;
+ #define ak_mpzn62_mask     ( 0x3fffffffffffffffLL )
+ #define ak_mpzn62_max_size ( 9 )
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычисление матрицы перехода для 62-х последовательных шагов (divsteps) алгоритма.
+
+    Шаг алгоритма: если \f$ \delta > 0 \f$ и \f$ g \f$ нечетно, то
+    \f$ (\delta, f, g) \leftarrow (1-\delta, g, (g-f)/2) \f$, иначе
+    \f$ (\delta, f, g) \leftarrow (1+\delta, f, (g + (g \bmod 2)f)/2) \f$.
+    Вычисления выполняются без ветвлений только для младших слов \f$ f \f$ и \f$ g \f$;
+    в массив `t` помещается матрица \f$ (u, v, q, r) \f$, умноженная на \f$ 2^{62} \f$.
+
+    @param delta Текущее значение параметра \f$ \delta \f$
+    @param f Младшее слово значения \f$ f \f$ (нечетно)
+    @param g Младшее слово значения \f$ g \f$
+    @param t Массив из четырех элементов, в который помещается матрица перехода
+    @return Новое значение параметра \f$ \delta \f$.                                               */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline ak_int64 ak_mpzn_divsteps_62( ak_int64 delta, ak_uint64 f, ak_uint64 g, ak_int64 *t )
+{
+  int i;
+  ak_uint64 u = 1, v = 0, q = 0, r = 1, c, c2, x;
+
+  for( i = 0; i < 62; i++ ) {
+     c = ( ak_uint64 )(( -delta ) >> 63 );  /* все единицы, если delta > 0 */
+     c2 = ( ak_uint64 )0 - ( g&1 );          /* все единицы, если g нечетно */
+     c &= c2;
+    /* при c: (f, g) <- (g, -f), (u, v, q, r) <- (q, r, -u, -v), delta <- -delta */
+     x = ( f^g )&c; f ^= x; g ^= x; g = ( g^c ) - c;
+     x = ( u^q )&c; u ^= x; q ^= x; q = ( q^c ) - c;
+     x = ( v^r )&c; v ^= x; r ^= x; r = ( r^c ) - c;
+     delta = ( ak_int64 )((( ak_uint64 )delta^c ) - c );
+    /* при нечетном g: g <- g + f */
+     g += f&c2; q += u&c2; r += v&c2;
+     g >>= 1; u <<= 1; v <<= 1; delta++;
+  }
+  t[0] = ( ak_int64 )u; t[1] = ( ak_int64 )v; t[2] = ( ak_int64 )q; t[3] = ( ak_int64 )r;
+ return delta;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Умножение пары \f$ (f, g) \f$ на матрицу перехода с делением на \f$ 2^{62} \f$.       */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mpzn_update_fg_62( ak_int64 *f, ak_int64 *g,
+                                                            const ak_int64 *t, const size_t n )
+{
+  size_t i;
+  ak_mpzn_sdword cf, cg;
+  const ak_int64 u = t[0], v = t[1], q = t[2], r = t[3];
+
+  cf = ( ak_mpzn_sdword )u*f[0] + ( ak_mpzn_sdword )v*g[0];
+  cg = ( ak_mpzn_sdword )q*f[0] + ( ak_mpzn_sdword )r*g[0];
+  cf >>= 62; cg >>= 62; /* младшие 62 бита равны нулю */
+  for( i = 1; i < n; i++ ) {
+     cf += ( ak_mpzn_sdword )u*f[i] + ( ak_mpzn_sdword )v*g[i];
+     cg += ( ak_mpzn_sdword )q*f[i] + ( ak_mpzn_sdword )r*g[i];
+     f[i-1] = ( ak_int64 )(( ak_uint64 )cf&ak_mpzn62_mask ); cf >>= 62;
+     g[i-1] = ( ak_int64 )(( ak_uint64 )cg&ak_mpzn62_mask ); cg >>= 62;
+  }
+  f[n-1] = ( ak_int64 )cf;
+  g[n-1] = ( ak_int64 )cg;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Умножение пары \f$ (d, e) \f$ на матрицу перехода с делением на \f$ 2^{62} \f$
+    по модулю \f$ m \f$.
+
+    Значения \f$ d \f$ и \f$ e \f$ остаются в интервале \f$ (-2m, m) \f$: к отрицательным
+    значениям добавляется модуль, после чего добавляется кратное модуля, обращающее в ноль
+    младшие 62 бита результата.                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mpzn_update_de_62( ak_int64 *d, ak_int64 *e, const ak_int64 *t,
+                                        const ak_int64 *m, const ak_uint64 minv, const size_t n )
+{
+  size_t i;
+  ak_mpzn_sdword cd, ce;
+  const ak_int64 u = t[0], v = t[1], q = t[2], r = t[3];
+  const ak_int64 sd = d[n-1] >> 63, se = e[n-1] >> 63;
+  ak_int64 md = ( u&sd ) + ( v&se ), me = ( q&sd ) + ( r&se );
+
+  cd = ( ak_mpzn_sdword )u*d[0] + ( ak_mpzn_sdword )v*e[0];
+  ce = ( ak_mpzn_sdword )q*d[0] + ( ak_mpzn_sdword )r*e[0];
+  md -= ( ak_int64 )(( minv*( ak_uint64 )cd + ( ak_uint64 )md )&ak_mpzn62_mask );
+  me -= ( ak_int64 )(( minv*( ak_uint64 )ce + ( ak_uint64 )me )&ak_mpzn62_mask );
+  cd += ( ak_mpzn_sdword )m[0]*md;
+  ce += ( ak_mpzn_sdword )m[0]*me;
+  cd >>= 62; ce >>= 62; /* младшие 62 бита равны нулю */
+  for( i = 1; i < n; i++ ) {
+     cd += ( ak_mpzn_sdword )u*d[i] + ( ak_mpzn_sdword )v*e[i] + ( ak_mpzn_sdword )m[i]*md;
+     ce += ( ak_mpzn_sdword )q*d[i] + ( ak_mpzn_sdword )r*e[i] + ( ak_mpzn_sdword )m[i]*me;
+     d[i-1] = ( ak_int64 )(( ak_uint64 )cd&ak_mpzn62_mask ); cd >>= 62;
+     e[i-1] = ( ak_int64 )(( ak_uint64 )ce&ak_mpzn62_mask ); ce >>= 62;
+  }
+  d[n-1] = ( ak_int64 )cd;
+  e[n-1] = ( ak_int64 )ce;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Условное прибавление модуля к значению \f$ d \f$ с последующим
+    приведением слов к 62-х битному виду.                                                          */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mpzn_cond_add_62( ak_int64 *d, const ak_int64 *m,
+                                                             const ak_int64 mask, const size_t n )
+{
+  size_t i;
+
+  for( i = 0; i < n; i++ ) d[i] += m[i]&mask;
+  for( i = 0; i < n-1; i++ ) { d[i+1] += d[i] >> 62; d[i] &= ak_mpzn62_mask; }
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Обращение вычета по нечетному модулю методом Бернштейна-Янга.
+
+    Выполняется фиксированное число шагов, равное \f$ \lfloor (49d+57)/17 \rfloor \f$, где
+    \f$ d = 64\cdot\text{size} \f$ (оценка из работы D.J. Bernstein, B.-Y. Yang,
+    "Fast constant-time gcd computation and modular inversion", 2019), округленное вверх
+    до числа, кратного 62. После их выполнения \f$ g = 0 \f$, \f$ f = \pm 1 \f$, а значение
+    \f$ \pm d \f$ является обратным к вычету \f$ x \f$.                                              */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_mpzn_inverse_safegcd( ak_uint64 *z, ak_uint64 *x,
+                                                               ak_uint64 *p, const size_t size )
+{
+  const size_t n = ( 64*size )/62 +1, count = (( 49*64*size +57 )/17 +61 )/62;
+  ak_int64 d[ak_mpzn62_max_size], e[ak_mpzn62_max_size], f[ak_mpzn62_max_size],
+                                  g[ak_mpzn62_max_size], m[ak_mpzn62_max_size], t[4], delta = 1;
+  ak_uint64 minv = p[0], w;
+  size_t i, j, s;
+
+ /* величина p^{-1} (mod 2^{62}) вычисляется методом Ньютона */
+  for( i = 0; i < 5; i++ ) minv *= 2 - p[0]*minv;
+  minv &= ak_mpzn62_mask;
+
+ /* переводим модуль и вычет в 62-х битное представление */
+  for( i = 0; i < n; i++ ) {
+     j = ( 62*i ) >> 6; s = ( 62*i )&0x3f;
+     w = ( j < size ) ? p[j] >> s : 0;
+     if(( s > 2 ) && ( j+1 < size )) w |= p[j+1] << ( 64 - s );
+     m[i] = f[i] = ( ak_int64 )( w&ak_mpzn62_mask );
+     w = ( j < size ) ? x[j] >> s : 0;
+     if(( s > 2 ) && ( j+1 < size )) w |= x[j+1] << ( 64 - s );
+     g[i] = ( ak_int64 )( w&ak_mpzn62_mask );
+     d[i] = e[i] = 0;
+  }
+  e[0] = 1;
+
+ /* основной цикл: инварианты d*x = f и e*x = g (mod p) */
+  for( i = 0; i < count; i++ ) {
+     delta = ak_mpzn_divsteps_62( delta, ( ak_uint64 )f[0], ( ak_uint64 )g[0], t );
+     ak_mpzn_update_de_62( d, e, t, m, minv, n );
+     ak_mpzn_update_fg_62( f, g, t, n );
+  }
+
+ /* приводим d к интервалу [0, p) с учетом знака f */
+  ak_mpzn_cond_add_62( d, m, d[n-1] >> 63, n );
+  for( i = 0; i < n; i++ ) d[i] = ( d[i]^( f[n-1] >> 63 )) - ( f[n-1] >> 63 );
+  ak_mpzn_cond_add_62( d, m, 0, n ); /* только нормализация слов после смены знака */
+  ak_mpzn_cond_add_62( d, m, d[n-1] >> 63, n );
+
+ /* возвращаемся к 64-х битным словам */
+  for( j = 0; j < size; j++ ) {
+     i = ( 64*j )/62; s = ( 64*j )%62;
+     w = ( ak_uint64 )d[i] >> s;
+     if( i+1 < n ) w |= ( ak_uint64 )d[i+1] << ( 62 - s );
+     z[j] = w;
+  }
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Для заданного вычета \f$ x \f$ вычисляется вычет \f$ z \f$, удовлетворяющий сравнению
+    \f$ xz \equiv 1 \pmod{p} \f$. Для нулевого вычета результат равен нулю.
+
+    Для вычетов длины не более 512 бит используется алгоритм Бернштейна-Янга (safegcd),
+    время работы которого не зависит от обращаемого вычета; в остальных случаях, а также при
+    отсутствии 128-ми битного целого типа, обратный вычет вычисляется возведением
+    в степень \f$ p-2 \f$.
+
+    @param z Вычет, в который помещается результат
+    @param x Обращаемый вычет
+    @param p Модуль, по которому производятся вычисления; должен быть простым числом
+    @param size Размер модуля в словах (значение константы \ref ak_mpzn256_size
+    или \ref ak_mpzn512_size )                                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_mpzn_inverse( ak_uint64 *z, ak_uint64 *x, ak_uint64 *p, const size_t size )
+{
+  size_t i;
+  ak_uint64 n0 = p[0];
+  ak_mpznmax t, one = ak_mpznmax_one;
+
+#ifdef AK_HAVE_BUILTIN_UINT128
+  if( 64*size < 62*ak_mpzn62_max_size ) {
+    ak_mpzn_inverse_safegcd( z, x, p, size );
+    return;
+  }
+#endif
+ /* вычет x рассматривается как представление Монтгомери значения xr^{-1},
+    обратное к которому, xr^{-2}, выводится из представления Монтгомери двумя умножениями */
+  for( i = 0; i < 5; i++ ) n0 *= 2 - p[0]*n0;
+  n0 = ( ak_uint64 )0 - n0;
+  ak_mpzn_set_ui( t, size, 2 );
+  ak_mpzn_sub( t, p, t, size );
+  ak_mpzn_modpow_montgomery( z, x, t, p, n0, size );
+  ak_mpzn_mul_montgomery( z, z, one, p, n0, size );
+  ak_mpzn_mul_montgomery( z, z, one, p, n0, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Для вычета \f$ x \f$, заданного в представлении Монтгомери, вычисляется обратный вычет
+    \f$ z \equiv x^{-1} \pmod{p} \f$, также в представлении Монтгомери. Функция является
+    заменой вызова ak_mpzn_modpow_montgomery() с показателем \f$ p-2 \f$:
+    представление Монтгомери \f$ xr \f$ дважды умножается на единицу, после чего значение
+    \f$ xr^{-1} \f$ обращается функцией ak_mpzn_inverse(), давая \f$ x^{-1}r \f$.
+
+    @param z Вычет, в который помещается результат
+    @param x Обращаемый вычет
+    @param p Простой модуль, по которому производятся вычисления
+    @param n0 Константа, используемая в вычислениях (см. ak_mpzn_modpow_montgomery())
+    @param size Размер модуля в словах (значение константы \ref ak_mpzn256_size
+    или \ref ak_mpzn512_size )                                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_mpzn_inverse_montgomery( ak_uint64 *z, ak_uint64 *x,
+                                                   ak_uint64 *p, ak_uint64 n0, const size_t size )
+{
+  ak_mpznmax t, one = ak_mpznmax_one;
+
+#ifdef AK_HAVE_BUILTIN_UINT128
+  if( 64*size < 62*ak_mpzn62_max_size ) {
+    ak_mpzn_mul_montgomery( t, x, one, p, n0, size );
+    ak_mpzn_mul_montgomery( t, t, one, p, n0, size );
+    ak_mpzn_inverse_safegcd( z, t, p, size );
+    return;
+  }
+#endif
+  ak_mpzn_set_ui( t, size, 2 );
+  ak_mpzn_sub( t, p, t, size );
+  ak_mpzn_modpow_montgomery( z, x, t, p, n0, size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Для набора ненулевых вычетов \f$ x_1, \ldots, x_n \f$, заданных в представлении Монтгомери,
+    вычисляются обратные вычеты \f$ z_i \equiv x_i^{-1} \pmod{p}\f$ (также в представлении Монтгомери).
+    Используется метод Монтгомери одновременного обращения: вычисляется произведение всех вычетов,
+    которое обращается однократным вызовом функции ak_mpzn_inverse_montgomery(), после чего обратные значения
+    восстанавливаются с помощью \f$ 3(n-1) \f$ умножений.
+
+    @param z Массив из `count` вычетов, в который помещается результат; массив не должен
+    пересекаться с массивом `x`
+    @param x Массив из `count` обращаемых вычетов, каждый из которых занимает `size` слов
+    @param count Количество вычетов
+    @param p Простой модуль, по которому производятся вычисления
+    @param n0 Константа, используемая в вычислениях (см. ak_mpzn_modpow_montgomery())
+    @param size Размер модуля в словах (значение константы \ref ak_mpzn256_size
+    или \ref ak_mpzn512_size )                                                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ void ak_mpzn_modinv_montgomery_batch( ak_uint64 *z, ak_uint64 *x, const size_t count,
+                                                   ak_uint64 *p, ak_uint64 n0, const size_t size )
+{
+  size_t i;
+  ak_mpznmax u;
+
+  if( !count ) return;
+ /* последовательные произведения x_1*...*x_i */
+  memcpy( z, x, size*sizeof( ak_uint64 ));
+  for( i = 1; i < count; i++ )
+     ak_mpzn_mul_montgomery( z +i*size, z +(i-1)*size, x +i*size, p, n0, size );
+
+ /* обращаем произведение всех вычетов */
+  ak_mpzn_inverse_montgomery( u, z +(count-1)*size, p, n0, size );
+
+ /* восстанавливаем обратные значения, начиная с последнего */
+  for( i = count-1; i > 0; i-- ) {
+     ak_mpzn_mul_montgomery( z +i*size, u, z +(i-1)*size, p, n0, size );
+     ak_mpzn_mul_montgomery( u, u, x +i*size, p, n0, size );
+  }
+  memcpy( z, u, size*sizeof( ak_uint64 ));
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 #ifdef AK_HAVE_GMP_H
 /* преобразование "туда и обратно" */
@@ -28,31 +28,43 @@
  } *ak_option;
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! Константные значения опций (значения по-умолчанию) */
+/*! Константные значения опций (значения по-умолчанию).
+    Положение каждой опции в массиве задается значением перечисления \ref option_index_t.        */
  static struct option options[] = {
-     { "log_level", ak_log_standard, 0, 2 },
-     { "pbkdf2_iteration_count", 2000, 1000, 65536 },
-     { "hmac_key_count_resource", 1048576, 1024, 2147483648 },
-     { "digital_signature_count_resource", 65536, 1024, 2147483648 },
+     [ak_option_log_level] = { "log_level", ak_log_standard, 0, 2 },
+     [ak_option_pbkdf2_iteration_count] = { "pbkdf2_iteration_count", 2000, 1000, 65536 },
+     [ak_option_hmac_key_count_resource] = { "hmac_key_count_resource", 1048576, 1024, 2147483648 },
+     [ak_option_digital_signature_count_resource] =
+                                     { "digital_signature_count_resource", 65536, 1024, 2147483648 },
 
   /* значение константы задает максимальный объем зашифрованной информации на одном ключе в 256 MБ:
                                        33554432 блока x 8 байт на блок = 268.435.456 байт = 256 MБ */
-     { "magma_cipher_resource", 33554432, 1024, 2147483648 },
+     [ak_option_magma_cipher_resource] = { "magma_cipher_resource", 33554432, 1024, 2147483648 },
 
   /* значение константы задает максимальный объем зашифрованной информации на одном ключе в 4ГБ:
                                268435456 блоков x 16 байт на блок = 4.294.967.296 байт = 4096 MБ  */
-     { "kuznechik_cipher_resource", 268435456, 8196, 2147483648 },
-     { "acpkm_message_count", 4096, 128, 65536 },
-     { "acpkm_section_magma_block_count", 128, 128, 16777216 },
-     { "acpkm_section_kuznechik_block_count", 512, 512, 16777216 },
+     [ak_option_kuznechik_cipher_resource] =
+                                { "kuznechik_cipher_resource", 268435456, 8196, 2147483648 },
+     [ak_option_acpkm_message_count] = { "acpkm_message_count", 4096, 128, 65536 },
+     [ak_option_acpkm_section_magma_block_count] =
+                                      { "acpkm_section_magma_block_count", 128, 128, 16777216 },
+     [ak_option_acpkm_section_kuznechik_block_count] =
+                                  { "acpkm_section_kuznechik_block_count", 512, 512, 16777216 },
 
   /* при значении равным единицы, формат шифрования данных соответствует варианту OpenSSL */
-     { "openssl_compability", 0, 0, 1 },
+     [ak_option_openssl_compability] = { "openssl_compability", 0, 0, 1 },
   /* флаг использования цвета при выводе сообщений библиотеки */
-     { "use_color_output", 1, 0, 1 },
+     [ak_option_use_color_output] = { "use_color_output", 1, 0, 1 },
   /* флаг выполнения дополнительных проверок корректной работы алгоритма при создании контекстов */
-     { "use_additional_algorithm_check_context", 0, 0, 1 },
-     { NULL, 0, 0, 0 } /* завершающая константа, должна всегда принимать нулевые значения */
+     [ak_option_use_additional_algorithm_check_context] =
+                            { "use_additional_algorithm_check_context", 0, 0, 1 },
+  /* длина буффера для чтения файлов при вычислении кодов целостности (от 4 КБ до 8 МБ) */
+     [ak_option_file_read_buffer_size] = { "file_read_buffer_size", 1048576, 4096, 8388608 },
+  /* файлы, длина которых не меньше заданной, отображаются в память
+     (0 - запрет отображения, используется по-умолчанию) */
+     [ak_option_file_mmap_threshold] = { "file_mmap_threshold", 0, 0, 2147483648 },
+  /* завершающая константа, должна всегда принимать нулевые значения */
+     [ak_option_count] = { NULL, 0, 0, 0 }
  };
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -102,7 +114,14 @@
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! \param index Индекс опции, должен быть от нуля до значения,
+/*! Функция получает значение опции за константное время и предназначена для использования
+    в тех местах, где значение опции требуется часто. В качестве индекса рекомендуется
+    использовать значения перечисления \ref option_index_t, например,
+    \code
+      oc = ak_libakrypt_get_option_by_index( ak_option_openssl_compability );
+    \endcode
+
+    \param index Индекс опции, должен быть от нуля до значения,
     возвращаемого функцией ak_libakrypt_options_count().
 
     \return Значение опции с заданным именем. Если имя указано неверно, то возвращается
@@ -193,7 +193,12 @@
   clk = ( ak_uint64 ) clock();
 #endif
 
-  value = ( shift_value += 11 )*125643267795740073ULL + pval;
+#ifdef AK_HAVE_BUILTIN_ATOMIC
+ /* функция вызывается при создании ключей, в том числе, из рабочих потоков */
+  value = __atomic_add_fetch( &shift_value, 11, __ATOMIC_RELAXED )*125643267795740073ULL + pval;
+#else
+  value = ( shift_value += 11 )*125643267795740073ULL + pval;
+#endif
   value = ( value * 506098983240188723ULL ) + 71331*uval + vtme;
  return value ^ clk;
 }
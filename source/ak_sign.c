@@ -9,6 +9,12 @@
 #ifdef AK_HAVE_TIME_H
  #include <time.h>
 #endif
+#ifdef AK_HAVE_STDLIB_H
+ #include <stdlib.h>
+#endif
+#ifdef AK_HAVE_PTHREAD_H
+ #include <pthread.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Установление или изменение маски секретного ключа ассиметричного криптографического
@@ -37,7 +43,7 @@
 #ifndef AK_LITTLE_ENDIAN
   int i = 0;
 #endif
-  ak_mpznmax u, zeta;
+  ak_mpznmax zeta;
   ak_wcurve wc = NULL;
   int error = ak_error_ok;
   ak_uint64 *key = NULL, *mask = NULL;
@@ -80,10 +86,7 @@
      ak_mpzn_mul_montgomery( key, key, mask, wc->q, wc->nq, wc->size);
 
     /* вычисляем обратное значение для маски */
-     ak_mpzn_set_ui( u, wc->size, 2 );
-     ak_mpzn_sub( u, wc->q, u, wc->size );
-     ak_mpzn_modpow_montgomery( mask, // m <- m^{q-2} (mod q)
-                                    mask, u, wc->q, wc->nq, wc->size );
+     ak_mpzn_inverse_montgomery( mask, mask, wc->q, wc->nq, wc->size ); // m <- m^{-1} (mod q)
     /* меняем значение флага */
      skey->flags |= key_flag_set_mask;
 
@@ -100,9 +103,7 @@
     /* домножаем ключ на случайное число */
      ak_mpzn_mul_montgomery( key, key, zeta, wc->q, wc->nq, wc->size );
     /* вычисляем обратное значение zeta */
-     ak_mpzn_set_ui( u, wc->size, 2 );
-     ak_mpzn_sub( u, wc->q, u, wc->size );
-     ak_mpzn_modpow_montgomery( zeta, zeta, u, wc->q, wc->nq, wc->size ); // z <- z^{q-2} (mod q)
+     ak_mpzn_inverse_montgomery( zeta, zeta, wc->q, wc->nq, wc->size ); // z <- z^{-1} (mod q)
 
     /* домножаем маску на обратное значение zeta */
      ak_mpzn_mul_montgomery( mask, mask, zeta, wc->q, wc->nq, wc->size );
@@ -175,6 +176,367 @@
 }
 
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                        предварительно вычисленные пары (k, r) для выработки подписи             */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Набор предварительно вычисленных пар \f$ (k, r) \f$, где \f$ r \equiv x([k]P) \pmod{q} \f$.
+
+    Значения \f$ k \f$ хранятся в маскированном виде: вместе с величиной \f$ k \oplus m \f$
+    хранится случайная маска \f$ m \f$, которая вырабатывается собственным генератором набора.    */
+/* ----------------------------------------------------------------------------------------------- */
+ typedef struct signkey_nonces {
+  /*! \brief Массив из `count` троек \f$ (k \oplus m, m, r) \f$, каждый элемент занимает `size` слов. */
+   ak_uint64 *values;
+  /*! \brief Максимальное количество пар. */
+   size_t count;
+  /*! \brief Количество вычисленных и еще не использованных пар. */
+   size_t available;
+  /*! \brief Эллиптическая кривая, на которой вычисляются значения \f$ r \f$. */
+   ak_wcurve wc;
+  /*! \brief Генератор масок. */
+   struct random generator;
+#ifdef AK_HAVE_PTHREAD_H
+  /*! \brief Мьютекс, защищающий массив пар. */
+   pthread_mutex_t mutex;
+  /*! \brief Условная переменная, сигнализирующая фоновому потоку о расходовании пар. */
+   pthread_cond_t cond;
+  /*! \brief Фоновый поток, пополняющий набор. */
+   pthread_t thread;
+  /*! \brief Генератор случайных чисел фонового потока. */
+   ak_random thread_generator;
+  /*! \brief Флаг работы фонового потока; сбрасывается потоком при его завершении. */
+   bool_t running;
+  /*! \brief Флаг, указывающий, что фоновый поток был создан и еще не присоединен. */
+   bool_t joinable;
+  /*! \brief Флаг завершения фонового потока. */
+   bool_t stop;
+  /*! \brief Код ошибки, из-за которой фоновый поток прекратил работу. */
+   int error;
+#endif
+} *ak_signkey_nonces;
+
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_signkey_nonces_lock( ak_signkey_nonces ns )
+{
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &ns->mutex );
+#else
+  (void)ns;
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_signkey_nonces_unlock( ak_signkey_nonces ns )
+{
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &ns->mutex );
+#else
+  (void)ns;
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычисление одной пары \f$ (k, r) \f$ и помещение ее в набор.
+
+    Кратная точка вычисляется вне критической секции, поэтому пополнение набора
+    не задерживает выработку подписей другими потоками. Если во время вычислений набор был
+    очищен в связи со сменой эллиптической кривой, то вычисленная пара отбрасывается.
+    Функция может вызываться из фонового потока, поэтому она не выводит сообщений об ошибках.
+
+    @return Функция возвращает \ref ak_error_ok, если пара была добавлена или отброшена,
+    \ref ak_error_overflow, если набор уже заполнен, и код ошибки в остальных случаях.           */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_signkey_nonces_add( ak_signkey_nonces ns, ak_random generator )
+{
+  size_t i;
+  ak_mpzn512 k;
+  struct wpoint wr;
+  ak_wcurve wc = NULL;
+  ak_uint64 *ptr = NULL;
+  int error = ak_error_ok;
+
+  ak_signkey_nonces_lock( ns );
+  wc = ns->wc;
+  ak_signkey_nonces_unlock( ns );
+
+  memset( k, 0, sizeof( k ));
+  if(( error = ak_mpzn_set_random_modulo( k, wc->q, wc->size, generator )) != ak_error_ok )
+    return error;
+  ak_wpoint_pow_generator( &wr, k, wc->size, wc );
+  ak_wpoint_reduce( &wr, wc );
+
+  ak_signkey_nonces_lock( ns );
+  if( ns->wc != wc ) error = ak_error_ok;
+   else if( ns->available < ns->count ) {
+    ptr = ns->values +3*ns->available*wc->size;
+    ak_random_ptr( &ns->generator, ptr +wc->size, sizeof( ak_uint64 )*wc->size );
+    for( i = 0; i < wc->size; i++ ) ptr[i] = k[i]^ptr[wc->size +i];
+    ak_mpzn_rem( ptr +2*wc->size, wr.x, wc->q, wc->size );
+    ns->available++;
+  } else error = ak_error_overflow;
+  ak_signkey_nonces_unlock( ns );
+
+ /* генератор ns->generator используется только внутри критической секции,
+    поэтому значение k очищается с помощью генератора вызывающей стороны */
+  ak_ptr_wipe( k, sizeof( k ), generator );
+  memset( &wr, 0, sizeof( struct wpoint ));
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Извлечение пары \f$ (k, r) \f$ из набора.
+    @return Функция возвращает истину, если набор содержал хотя бы одну пару, вычисленную
+    на эллиптической кривой wc.                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ static bool_t ak_signkey_nonces_get( ak_signkey_nonces ns, ak_wcurve wc,
+                                                                       ak_uint64 *k, ak_uint64 *r )
+{
+  size_t i, size = wc->size;
+  ak_uint64 *ptr = NULL;
+  bool_t result = ak_false;
+
+  ak_signkey_nonces_lock( ns );
+  if(( ns->wc == wc ) && ( ns->available > 0 )) {
+    ptr = ns->values +3*( --ns->available )*size;
+    for( i = 0; i < size; i++ ) k[i] = ptr[i]^ptr[size +i];
+    memcpy( r, ptr +2*size, sizeof( ak_uint64 )*size );
+    ak_ptr_wipe( ptr, 3*sizeof( ak_uint64 )*size, &ns->generator );
+    result = ak_true;
+#ifdef AK_HAVE_PTHREAD_H
+    if( ns->running ) pthread_cond_signal( &ns->cond );
+#endif
+  }
+  ak_signkey_nonces_unlock( ns );
+ return result;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Удаление из набора всех пар и смена эллиптической кривой, на которой
+    вычисляются новые пары. Фоновый поток, если он запущен, продолжает пополнять набор.           */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_signkey_nonces_flush( ak_signkey_nonces ns, ak_wcurve wc )
+{
+  ak_signkey_nonces_lock( ns );
+  ak_ptr_wipe( ns->values, 3*sizeof( ak_uint64 )*ns->count*ns->wc->size, &ns->generator );
+  ns->available = 0;
+  ns->wc = wc;
+#ifdef AK_HAVE_PTHREAD_H
+  if( ns->running ) pthread_cond_signal( &ns->cond );
+#endif
+  ak_signkey_nonces_unlock( ns );
+}
+
+#ifdef AK_HAVE_PTHREAD_H
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция фонового потока: пополняет набор пар и ожидает их расходования.
+
+    При возникновении ошибки поток сохраняет ее код в наборе и завершается, сбрасывая флаг
+    `running`; сообщение об ошибке выводится функцией ak_signkey_start_nonces_thread()
+    в вызывающем потоке.                                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static void *ak_signkey_nonces_thread( void *ptr )
+{
+  int error = ak_error_ok;
+  ak_signkey_nonces ns = ( ak_signkey_nonces ) ptr;
+
+  for( ;; ) {
+     pthread_mutex_lock( &ns->mutex );
+     while( !ns->stop && ( ns->available == ns->count )) pthread_cond_wait( &ns->cond, &ns->mutex );
+     if( ns->stop ) break;
+     pthread_mutex_unlock( &ns->mutex );
+     error = ak_signkey_nonces_add( ns, ns->thread_generator );
+     if(( error != ak_error_ok ) && ( error != ak_error_overflow )) {
+       pthread_mutex_lock( &ns->mutex );
+       ns->error = error;
+       break;
+     }
+  }
+  ns->running = ak_false;
+  pthread_mutex_unlock( &ns->mutex );
+ return NULL;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Остановка фонового потока и уничтожение набора пар.                                   */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_signkey_nonces_destroy( ak_signkey_nonces ns )
+{
+  if( ns == NULL ) return;
+#ifdef AK_HAVE_PTHREAD_H
+  if( ns->joinable ) {
+    pthread_mutex_lock( &ns->mutex );
+    ns->stop = ak_true;
+    pthread_cond_signal( &ns->cond );
+    pthread_mutex_unlock( &ns->mutex );
+    pthread_join( ns->thread, NULL );
+  }
+  pthread_cond_destroy( &ns->cond );
+  pthread_mutex_destroy( &ns->mutex );
+#endif
+  ak_ptr_wipe( ns->values, 3*sizeof( ak_uint64 )*ns->count*ns->wc->size, &ns->generator );
+  ak_random_destroy( &ns->generator );
+  free( ns->values );
+  free( ns );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция создает для секретного ключа набор из `count` предварительно вычисляемых пар
+    \f$ (k, r) \f$. Вычисление пары требует нахождения кратной точки \f$ [k]P \f$, то есть
+    основных затрат времени при выработке подписи, и не зависит от подписываемого сообщения.
+    Если набор содержит пары, то функция ak_signkey_sign_hash() использует их, выполняя лишь
+    несколько модульных умножений; в противном случае подпись вырабатывается обычным образом.
+
+    Набор пополняется функцией ak_signkey_refill_nonces() или фоновым потоком,
+    запускаемым функцией ak_signkey_start_nonces_thread(). Ранее созданный набор уничтожается;
+    при `count = 0` набор только уничтожается.
+
+    @param sctx Контекст секретного ключа электронной подписи.
+    @param count Максимальное количество пар.
+
+    @return В случае успеха возвращается ноль (\ref ak_error_ok). В противном случае возвращается
+    код ошибки.                                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_signkey_set_nonces( ak_signkey sctx, const size_t count )
+{
+  int error = ak_error_ok;
+  ak_signkey_nonces ns = NULL;
+
+  if( sctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                      "using null pointer to secret key context" );
+  if( sctx->key.data == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                 "using internal null pointer to elliptic curve" );
+  ak_signkey_nonces_destroy( sctx->nonces );
+  sctx->nonces = NULL;
+  if( !count ) return ak_error_ok;
+
+  if(( ns = calloc( 1, sizeof( struct signkey_nonces ))) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__ ,
+                                                 "incorrect memory allocation for nonces context" );
+  ns->wc = ( ak_wcurve ) sctx->key.data;
+  if(( ns->values = calloc( 3*count*ns->wc->size, sizeof( ak_uint64 ))) == NULL ) {
+    free( ns );
+    return ak_error_message( ak_error_out_of_memory, __func__ ,
+                                                  "incorrect memory allocation for nonce values" );
+  }
+  if(( error = ak_random_create_lcg( &ns->generator )) != ak_error_ok ) {
+    free( ns->values );
+    free( ns );
+    return ak_error_message( error, __func__ , "wrong creation of mask generator" );
+  }
+  ns->count = count;
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_init( &ns->mutex, NULL );
+  pthread_cond_init( &ns->cond, NULL );
+#endif
+  sctx->nonces = ns;
+
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция дополняет набор пар \f$ (k, r) \f$ до максимального количества. Функция может
+    вызываться одновременно с выработкой подписей в других потоках.
+
+    @param sctx Контекст секретного ключа электронной подписи.
+    @param generator Генератор случайных чисел, используемый для выработки значений \f$ k \f$.
+
+    @return В случае успеха возвращается ноль (\ref ak_error_ok). В противном случае возвращается
+    код ошибки.                                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_signkey_refill_nonces( ak_signkey sctx, ak_random generator )
+{
+  int error = ak_error_ok;
+
+  if( sctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                      "using null pointer to secret key context" );
+  if( generator == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                 "using null pointer to random number generator" );
+  if( sctx->nonces == NULL ) return ak_error_message( ak_error_not_ready, __func__ ,
+                                                  "using secret key without set of nonces" );
+  while(( error = ak_signkey_nonces_add( sctx->nonces, generator )) == ak_error_ok );
+  if( error == ak_error_overflow ) return ak_error_ok;
+
+ return ak_error_message( error, __func__ , "incorrect calculation of nonce" );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция запускает поток, который пополняет набор пар \f$ (k, r) \f$ по мере их расходования.
+    Поток завершается при уничтожении набора или секретного ключа, а также при возникновении
+    ошибки. В последнем случае повторный вызов функции выводит сообщение о возникшей ошибке
+    и запускает поток заново.
+
+    @param sctx Контекст секретного ключа электронной подписи.
+    @param generator Генератор случайных чисел, используемый для выработки значений \f$ k \f$;
+    до завершения потока генератор не должен использоваться другими потоками.
+
+    @return В случае успеха возвращается ноль (\ref ak_error_ok). В противном случае возвращается
+    код ошибки.                                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_signkey_start_nonces_thread( ak_signkey sctx, ak_random generator )
+{
+#ifdef AK_HAVE_PTHREAD_H
+  bool_t running = ak_false;
+#endif
+
+  if( sctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                      "using null pointer to secret key context" );
+  if( generator == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                 "using null pointer to random number generator" );
+  if( sctx->nonces == NULL ) return ak_error_message( ak_error_not_ready, __func__ ,
+                                                  "using secret key without set of nonces" );
+#ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &sctx->nonces->mutex );
+  running = sctx->nonces->running;
+  pthread_mutex_unlock( &sctx->nonces->mutex );
+  if( running ) return ak_error_message( ak_error_duplicate, __func__ ,
+                                                   "background thread is already running" );
+ /* поток, завершившийся из-за ошибки, присоединяется, а ошибка выводится в вызывающем потоке */
+  if( sctx->nonces->joinable ) {
+    pthread_join( sctx->nonces->thread, NULL );
+    sctx->nonces->joinable = ak_false;
+    if( sctx->nonces->error != ak_error_ok )
+      ak_error_message( sctx->nonces->error, __func__ ,
+                                               "background thread was stopped by an error" );
+  }
+  pthread_mutex_lock( &sctx->nonces->mutex );
+  sctx->nonces->thread_generator = generator;
+  sctx->nonces->stop = ak_false;
+  sctx->nonces->error = ak_error_ok;
+  sctx->nonces->running = ak_true;
+  pthread_mutex_unlock( &sctx->nonces->mutex );
+  if( pthread_create( &sctx->nonces->thread, NULL,
+                                             ak_signkey_nonces_thread, sctx->nonces ) != 0 ) {
+    pthread_mutex_lock( &sctx->nonces->mutex );
+    sctx->nonces->running = ak_false;
+    pthread_mutex_unlock( &sctx->nonces->mutex );
+    return ak_error_message( ak_error_undefined_function, __func__ ,
+                                                     "incorrect creation of background thread" );
+  }
+  sctx->nonces->joinable = ak_true;
+ return ak_error_ok;
+#else
+ return ak_error_message( ak_error_undefined_function, __func__ ,
+                                                 "library is compiled without pthreads support" );
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param sctx Контекст секретного ключа электронной подписи.
+    @return Функция возвращает количество вычисленных и еще не использованных пар
+    \f$ (k, r) \f$.                                                                                */
+/* ----------------------------------------------------------------------------------------------- */
+ size_t ak_signkey_get_nonces_count( ak_signkey sctx )
+{
+  size_t count = 0;
+
+  if(( sctx == NULL ) || ( sctx->nonces == NULL )) return 0;
+  ak_signkey_nonces_lock( sctx->nonces );
+  count = sctx->nonces->available;
+  ak_signkey_nonces_unlock( sctx->nonces );
+ return count;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                    функции для работы с секретными ключами электронной подписи                  */
 /* ----------------------------------------------------------------------------------------------- */
@@ -343,7 +705,10 @@
     return ak_error_message_fmt( ak_error_curve_not_supported, __func__ ,
                               "%u bits elliptic curve is not applicable for algorithm %s",
                                                            wc->size << 6, sctx->key.oid->name[0] );
-    else sctx->key.data = wc;
+  /* пары (k, r), вычисленные на прежней кривой, более не могут использоваться */
+   if(( sctx->nonces != NULL ) && ( sctx->key.data != wc ))
+     ak_signkey_nonces_flush( sctx->nonces, wc );
+   sctx->key.data = wc;
  return ak_error_ok;
 }
 
@@ -368,7 +733,10 @@
     return ak_error_message_fmt( ak_error_curve_not_supported, __func__ ,
                               "%u bits elliptic curve is not applicable for algorithm %s",
                                                            wc->size << 6, sctx->key.oid->name[0] );
-   else sctx->key.data = wc;
+  /* пары (k, r), вычисленные на прежней кривой, более не могут использоваться */
+  if(( sctx->nonces != NULL ) && ( sctx->key.data != wc ))
+    ak_signkey_nonces_flush( sctx->nonces, wc );
+  sctx->key.data = wc;
  return ak_error_ok;
 }
 
@@ -407,6 +775,8 @@
   int error = ak_error_ok;
   if( sctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
                            "destroying a null pointer to digital signature secret key context" );
+  ak_signkey_nonces_destroy( sctx->nonces );
+  sctx->nonces = NULL;
   if(( error = ak_skey_destroy( &sctx->key )) != ak_error_ok )
     ak_error_message( error, __func__ , "incorrect destroying of digital signature secret key" );
   if(( error = ak_hash_destroy( &sctx->ctx )) != ak_error_ok )
@@ -552,6 +922,53 @@
  return ak_error_ok;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Выработка электронной подписи по известным значениям \f$ k \f$ и
+    \f$ r \equiv x([k]P) \pmod{q} \f$.
+
+    Функция вычисляет \f$ s \equiv rd + ke \pmod{q}\f$, помещает пару \f$ (s, r) \f$ в
+    буффер `out` (см. ak_signkey_sign_const_values()) и сменяет маску секретного ключа.           */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_signkey_sign_values( ak_signkey sctx, ak_uint64 *k, ak_uint64 *r,
+                                                                  ak_uint64 *e, ak_pointer out )
+{
+  ak_mpzn512 s, t, u;
+  ak_wcurve wc = ( ak_wcurve ) sctx->key.data;
+
+ /* приводим r к виду Монтгомери и помещаем во временную переменную t <- r */
+  ak_mpzn_mul_montgomery( t, r, wc->r2q, wc->q, wc->nq, wc->size );
+
+ /* вычисляем значение s <- r*d (mod q) (сначала домножаем на ключ, потом на его маску) */
+  ak_mpzn_mul_montgomery( s, t, (ak_uint64 *)sctx->key.key, wc->q, wc->nq, wc->size );
+  ak_mpzn_mul_montgomery( s, s,
+              (ak_uint64 *)(sctx->key.key+sctx->key.key_size), wc->q, wc->nq, wc->size );
+
+ /* приводим k к виду Монтгомери и помещаем во временную переменную t <- k */
+  ak_mpzn_mul_montgomery( t, k, wc->r2q, wc->q, wc->nq, wc->size );
+
+ /* приводим e к виду Монтгомери и помещаем во временную переменную u <- e */
+  ak_mpzn_rem( u, e, wc->q, wc->size );
+  if( ak_mpzn_cmp_ui( u, wc->size, 0 )) ak_mpzn_set_ui( u, wc->size, 1 );
+  ak_mpzn_mul_montgomery( u, u, wc->r2q, wc->q, wc->nq, wc->size );
+
+ /* вычисляем k*e (mod q) и вычисляем s = r*d + k*e (mod q) (в форме Монтгомери) */
+  ak_mpzn_mul_montgomery( t, t, u, wc->q, wc->nq, wc->size ); /* t <- k*e */
+  ak_mpzn_add_montgomery( s, s, t, wc->q, wc->size );
+
+ /* приводим s к обычной форме */
+  ak_mpzn_mul_montgomery( s, s,  wc->point.z, /* для экономии памяти пользуемся равенством z = 1 */
+                                 wc->q, wc->nq, wc->size );
+ /* экспортируем результат */
+  ak_mpzn_to_little_endian( s, wc->size, out, sizeof(ak_uint64)*wc->size, ak_true );
+  ak_mpzn_to_little_endian( r, wc->size, (ak_uint64 *)out + wc->size,
+                                                             sizeof(ak_uint64)*wc->size, ak_true );
+ /* завершаемся */
+  sctx->key.set_mask( &sctx->key );
+  memset( s, 0, sizeof( ak_mpzn512 ));
+  memset( t, 0, sizeof( ak_mpzn512 ));
+  memset( u, 0, sizeof( ak_mpzn512 ));
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция вырабатывает электронную подпись для \f$ e \f$ - вычисленного хеш-кода подписываемого
     сообщения и заданного случайного числа \f$ k \f$. Для этого
@@ -588,48 +1005,20 @@
 /* ----------------------------------------------------------------------------------------------- */
  void ak_signkey_sign_const_values( ak_signkey sctx, ak_uint64 *k, ak_uint64 *e, ak_pointer out )
 {
-  ak_mpzn512 r, s;
+  ak_mpzn512 r;
   struct wpoint wr;
   ak_wcurve wc = ( ak_wcurve ) sctx->key.data;
 
  /* поскольку функция не экспортируется, мы оставляем все проверки функциям верхнего уровня */
  /* вычисляем r */
-  ak_wpoint_pow( &wr, &wc->point, k, wc->size, wc );
+  ak_wpoint_pow_generator( &wr, k, wc->size, wc );
   ak_wpoint_reduce( &wr, wc );
   ak_mpzn_rem( r, wr.x, wc->q, wc->size );
-
- /* приводим r к виду Монтгомери и помещаем во временную переменную wr.x <- r */
-  ak_mpzn_mul_montgomery( wr.x, r, wc->r2q, wc->q, wc->nq, wc->size );
-
- /* вычисляем значение s <- r*d (mod q) (сначала домножаем на ключ, потом на его маску) */
-  ak_mpzn_mul_montgomery( s, wr.x, (ak_uint64 *)sctx->key.key, wc->q, wc->nq, wc->size );
-  ak_mpzn_mul_montgomery( s, s,
-              (ak_uint64 *)(sctx->key.key+sctx->key.key_size), wc->q, wc->nq, wc->size );
-
- /* приводим k к виду Монтгомери и помещаем во временную переменную wr.y <- k */
-  ak_mpzn_mul_montgomery( wr.y, k, wc->r2q, wc->q, wc->nq, wc->size );
-
- /* приводим e к виду Монтгомери и помещаем во временную переменную wr.z <- e */
-  ak_mpzn_rem( wr.z, e, wc->q, wc->size );
-  if( ak_mpzn_cmp_ui( wr.z, wc->size, 0 )) ak_mpzn_set_ui( wr.z, wc->size, 1 );
-  ak_mpzn_mul_montgomery( wr.z, wr.z, wc->r2q, wc->q, wc->nq, wc->size );
-
- /* вычисляем k*e (mod q) и вычисляем s = r*d + k*e (mod q) (в форме Монтгомери) */
-  ak_mpzn_mul_montgomery( wr.y, wr.y, wr.z, wc->q, wc->nq, wc->size ); /* wr.y <- k*e */
-  ak_mpzn_add_montgomery( s, s, wr.y, wc->q, wc->size );
-
- /* приводим s к обычной форме */
-  ak_mpzn_mul_montgomery( s, s,  wc->point.z, /* для экономии памяти пользуемся равенством z = 1 */
-                                 wc->q, wc->nq, wc->size );
- /* экспортируем результат */
-  ak_mpzn_to_little_endian( s, wc->size, out, sizeof(ak_uint64)*wc->size, ak_true );
-  ak_mpzn_to_little_endian( r, wc->size, (ak_uint64 *)out + wc->size,
-                                                             sizeof(ak_uint64)*wc->size, ak_true );
- /* завершаемся */
   memset( &wr, 0, sizeof( struct wpoint ));
-  sctx->key.set_mask( &sctx->key );
+
+ /* вычисляем s и формируем подпись */
+  ak_signkey_sign_values( sctx, k, r, e, out );
   memset( r, 0, sizeof( ak_mpzn512 ));
-  memset( s, 0, sizeof( ak_mpzn512 ));
 }
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -654,7 +1043,7 @@
   int i = 0;
 #endif
   size_t lb = 0;
-  ak_mpzn512 k, h;
+  ak_mpzn512 k, h, r;
   int error = ak_error_ok;
 
   if( sctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
@@ -669,18 +1058,26 @@
   if( out_size < 2*lb ) return ak_error_message( ak_error_wrong_length, __func__,
                                                        "using small buffer for digital sigature" );
 
- /* вырабатываем случайное число */
-  memset( k, 0, sizeof( ak_uint64 )*ak_mpzn512_size );
-  if(( error = ak_mpzn_set_random_modulo( k, (( ak_wcurve )sctx->key.data)->q,
-                                (( ak_wcurve )sctx->key.data)->size, generator )) != ak_error_ok )
-    return ak_error_message( error, __func__ , "invalid generation of random value");
-
  /* превращаем хеш от сообщения в последовательность 64х битных слов  */
   memcpy( h, hash, sctx->ctx.data.sctx.hsize );
 #ifndef AK_LITTLE_ENDIAN
   for( i = 0; i < (( ak_wcurve )sctx->key.data)->size; i++ ) h[i] = bswap_64( h[i] );
 #endif
 
+ /* если есть предварительно вычисленная пара (k, r), то используем ее */
+  memset( k, 0, sizeof( ak_uint64 )*ak_mpzn512_size );
+  if(( sctx->nonces != NULL ) &&
+                    ak_signkey_nonces_get( sctx->nonces, ( ak_wcurve )sctx->key.data, k, r )) {
+    ak_signkey_sign_values( sctx, k, r, h, out );
+    ak_ptr_wipe( k, sizeof( ak_uint64 )*ak_mpzn512_size, &sctx->key.generator );
+    return ak_error_ok;
+  }
+
+ /* вырабатываем случайное число */
+  if(( error = ak_mpzn_set_random_modulo( k, (( ak_wcurve )sctx->key.data)->q,
+                                (( ak_wcurve )sctx->key.data)->size, generator )) != ak_error_ok )
+    return ak_error_message( error, __func__ , "invalid generation of random value");
+
  /* и только теперь вычисляем электронную подпись */
   ak_signkey_sign_const_values( sctx, k, h, out );
   ak_ptr_wipe( k, sizeof( ak_uint64 )*ak_mpzn512_size, &sctx->key.generator );
@@ -811,6 +1208,281 @@
  return ak_signkey_sign_hash( sctx, generator, hash, sctx->ctx.data.sctx.hsize, out, out_size );
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                  пул реплик секретного ключа для многопоточной выработки подписей               */
+/* ----------------------------------------------------------------------------------------------- */
+#ifndef AK_HAVE_BUILTIN_ATOMIC
+ #ifdef AK_HAVE_PTHREAD_H
+/*! \brief Мьютекс, используемый пулами реплик при отсутствии атомарных операций. */
+  static pthread_mutex_t signkey_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+ #endif
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Атомарная попытка захвата свободной реплики пула.
+    @return Функция возвращает истину, если реплика была свободна и захвачена.                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline bool_t ak_signkey_pool_try_lock( ak_uint32 *busy )
+{
+#ifdef AK_HAVE_BUILTIN_ATOMIC
+  ak_uint32 expected = 0;
+ return __atomic_compare_exchange_n( busy, &expected, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED );
+#else
+  bool_t result = ak_false;
+ #ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &signkey_pool_mutex );
+ #endif
+  if( *busy == 0 ) { *busy = 1; result = ak_true; }
+ #ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &signkey_pool_mutex );
+ #endif
+ return result;
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Освобождение захваченной реплики пула.                                                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_signkey_pool_unlock( ak_uint32 *busy )
+{
+#ifdef AK_HAVE_BUILTIN_ATOMIC
+  __atomic_store_n( busy, 0, __ATOMIC_RELEASE );
+#else
+ #ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &signkey_pool_mutex );
+ #endif
+  *busy = 0;
+ #ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &signkey_pool_mutex );
+ #endif
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Атомарное изменение счетчика пула на величину `delta`.
+    @return Функция возвращает значение счетчика после изменения.                                  */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline ssize_t ak_signkey_pool_add( ssize_t *counter, const ssize_t delta )
+{
+#ifdef AK_HAVE_BUILTIN_ATOMIC
+ return __atomic_add_fetch( counter, delta, __ATOMIC_RELAXED );
+#else
+  ssize_t result;
+ #ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_lock( &signkey_pool_mutex );
+ #endif
+  result = ( *counter += delta );
+ #ifdef AK_HAVE_PTHREAD_H
+  pthread_mutex_unlock( &signkey_pool_mutex );
+ #endif
+ return result;
+#endif
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция создает `count` реплик секретного ключа `sk`. Каждая реплика содержит то же значение
+    ключа, что и `sk`, но маскируется независимо, с использованием собственного генератора масок,
+    и имеет собственный контекст функции хеширования. Поэтому реплики могут одновременно
+    использоваться различными потоками, в то время как смена маски после выработки каждой подписи
+    не позволяет разделять между потоками один контекст секретного ключа.
+
+    Ресурс ключа `sk` (количество подписей, которые могут быть выработаны) переносится в пул и
+    расходуется всеми репликами совместно; при уничтожении пула оставшийся ресурс возвращается
+    ключу `sk`. Поэтому ключ `sk` не должен использоваться и уничтожаться до уничтожения пула.
+
+    @param pool Контекст пула реплик.
+    @param sk Контекст секретного ключа, значение которого должно быть установлено.
+    @param count Количество реплик; как правило, равно количеству потоков, вырабатывающих подписи.
+
+    @return В случае успеха возвращается ноль (\ref ak_error_ok). В противном случае возвращается
+    код ошибки.                                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_signkey_pool_create( ak_signkey_pool pool, ak_signkey sk, const size_t count )
+{
+  size_t i;
+  int error = ak_error_ok;
+  ak_wcurve wc = NULL;
+
+  if( pool == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                    "using null pointer to signing pool context" );
+  if( sk == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                      "using null pointer to secret key context" );
+  if( !count ) return ak_error_message( ak_error_zero_length, __func__ ,
+                                                         "using zero number of secret key replicas" );
+  if( !(( sk->key.flags )&key_flag_set_key ))
+    return ak_error_message( ak_error_key_value, __func__ , "using secret key with undefined value" );
+  if(( wc = ( ak_wcurve ) sk->key.data ) == NULL )
+    return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                 "using internal null pointer to elliptic curve" );
+
+  memset( pool, 0, sizeof( struct signkey_pool ));
+  if(( pool->keys = calloc( count, sizeof( struct signkey ))) == NULL )
+    return ak_error_message( ak_error_out_of_memory, __func__ ,
+                                               "incorrect memory allocation for key replicas" );
+  if(( pool->busy = calloc( count, sizeof( ak_uint32 ))) == NULL ) {
+    free( pool->keys );
+    return ak_error_message( ak_error_out_of_memory, __func__ ,
+                                                 "incorrect memory allocation for replica flags" );
+  }
+
+ /* снимаем маску с исходного ключа на время копирования его значения */
+  if(( error = sk->key.unmask( &sk->key )) != ak_error_ok ) {
+    ak_error_message( error, __func__ , "wrong unmasking of secret key" );
+    goto labex;
+  }
+  for( pool->count = 0; pool->count < count; pool->count++ ) {
+     ak_signkey rk = pool->keys + pool->count;
+     if(( error = ak_signkey_create( rk, wc )) != ak_error_ok ) break;
+     if(( error = ak_signkey_set_key( rk, sk->key.key, sk->key.key_size )) != ak_error_ok ) {
+       ak_signkey_destroy( rk );
+       break;
+     }
+     ak_skey_set_number( &rk->key, sk->key.number, sizeof( sk->key.number ));
+     memcpy( rk->verifykey_number, sk->verifykey_number, sizeof( sk->verifykey_number ));
+     rk->key.resource = sk->key.resource;
+  }
+  sk->key.set_mask( &sk->key );
+  if( error != ak_error_ok ) {
+    ak_error_message( error, __func__ , "incorrect creation of secret key replica" );
+    goto labex;
+  }
+
+ /* переносим ресурс ключа в пул */
+  pool->resource = sk->key.resource.value.counter;
+  sk->key.resource.value.counter = 0;
+  pool->source = sk;
+ return ak_error_ok;
+
+  labex:
+   for( i = 0; i < pool->count; i++ ) ak_signkey_destroy( pool->keys +i );
+   free( pool->busy );
+   free( pool->keys );
+   memset( pool, 0, sizeof( struct signkey_pool ));
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция уничтожает реплики секретного ключа и возвращает неизрасходованный ресурс
+    исходному ключу. Перед вызовом функции все потоки должны завершить выработку подписей.
+
+    @param pool Контекст пула реплик.
+    @return В случае успеха возвращается ноль (\ref ak_error_ok). В противном случае возвращается
+    код ошибки.                                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_signkey_pool_destroy( ak_signkey_pool pool )
+{
+  size_t i;
+  int error = ak_error_ok;
+
+  if( pool == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                         "destroying a null pointer to signing pool context" );
+  if( pool->source != NULL ) pool->source->key.resource.value.counter = ak_max( pool->resource, 0 );
+  for( i = 0; i < pool->count; i++ )
+     if(( error = ak_signkey_destroy( pool->keys +i )) != ak_error_ok )
+       ak_error_message( error, __func__ , "incorrect destroying of secret key replica" );
+  if( pool->busy ) free( pool->busy );
+  if( pool->keys ) free( pool->keys );
+  memset( pool, 0, sizeof( struct signkey_pool ));
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Резервирование ресурса для одной подписи и захват свободной реплики пула.
+
+    Поиск свободной реплики начинается с номера, который определяется атомарно увеличиваемым
+    счетчиком, и не использует блокировок. Если все реплики заняты, поиск повторяется.
+
+    @return Функция возвращает указатель на захваченную реплику или NULL, если ресурс исчерпан.   */
+/* ----------------------------------------------------------------------------------------------- */
+ static ak_signkey ak_signkey_pool_acquire( ak_signkey_pool pool )
+{
+  size_t idx = 0;
+
+  if( ak_signkey_pool_add( &pool->resource, -1 ) < 0 ) {
+    ak_signkey_pool_add( &pool->resource, 1 );
+    ak_error_message( ak_error_low_key_resource, __func__ , "low resource of digital signature" );
+    return NULL;
+  }
+  idx = ( size_t )ak_signkey_pool_add( &pool->next, 1 )%pool->count;
+  while( !ak_signkey_pool_try_lock( pool->busy +idx )) if( ++idx == pool->count ) idx = 0;
+ return pool->keys +idx;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Освобождение реплики пула; если подпись не была выработана, ресурс возвращается.      */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_signkey_pool_release( ak_signkey_pool pool, ak_signkey rk, const int error )
+{
+  ak_signkey_pool_unlock( pool->busy +( rk - pool->keys ));
+  if( error != ak_error_ok ) ak_signkey_pool_add( &pool->resource, 1 );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция может вызываться одновременно из нескольких потоков. Сначала атомарно уменьшается
+    общий ресурс пула, после чего захватывается свободная реплика ключа, которая вырабатывает
+    подпись и освобождается. Количество реплик целесообразно выбирать не меньшим количества
+    потоков, иначе потоки будут ожидать освобождения реплик.
+
+    @param pool Контекст пула реплик.
+    @param generator Генератор случайных чисел; генераторы не являются потокобезопасными,
+    поэтому каждый поток должен использовать собственный генератор.
+    @param hash Хеш-код подписываемого сообщения.
+    @param size Размер хеш-кода, в байтах.
+    @param out Область памяти, куда будет помещен результат.
+    @param out_size Размер области памяти `out`.
+
+    @return В случае успеха возвращается ноль (\ref ak_error_ok). Если ресурс ключа исчерпан,
+    возвращается \ref ak_error_low_key_resource. В остальных случаях возвращается код ошибки.      */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_signkey_pool_sign_hash( ak_signkey_pool pool, ak_random generator, ak_pointer hash,
+                                                    size_t size, ak_pointer out, size_t out_size )
+{
+  ak_signkey rk = NULL;
+  int error = ak_error_ok;
+
+  if( pool == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                    "using null pointer to signing pool context" );
+  if( pool->count == 0 ) return ak_error_message( ak_error_zero_length, __func__ ,
+                                                       "using signing pool without key replicas" );
+  if(( rk = ak_signkey_pool_acquire( pool )) == NULL ) return ak_error_low_key_resource;
+  error = ak_signkey_sign_hash( rk, generator, hash, size, out, out_size );
+  ak_signkey_pool_release( pool, rk, error );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция аналогична функции ak_signkey_pool_sign_hash(); хеш-код данных вычисляется
+    с помощью контекста функции хеширования захваченной реплики.
+
+    @param pool Контекст пула реплик.
+    @param generator Генератор случайных чисел, используемый вызывающим потоком.
+    @param in Указатель на подписываемые данные.
+    @param size Размер данных, в байтах.
+    @param out Область памяти, куда будет помещен результат.
+    @param out_size Размер области памяти `out`.
+
+    @return В случае успеха возвращается ноль (\ref ak_error_ok). В противном случае возвращается
+    код ошибки.                                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_signkey_pool_sign_ptr( ak_signkey_pool pool, ak_random generator,
+                          const ak_pointer in, const size_t size, ak_pointer out, size_t out_size )
+{
+  ak_signkey rk = NULL;
+  int error = ak_error_ok;
+
+  if( pool == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                    "using null pointer to signing pool context" );
+  if( pool->count == 0 ) return ak_error_message( ak_error_zero_length, __func__ ,
+                                                       "using signing pool without key replicas" );
+  if(( rk = ak_signkey_pool_acquire( pool )) == NULL ) return ak_error_low_key_resource;
+  error = ak_signkey_sign_ptr( rk, generator, in, size, out, out_size );
+  ak_signkey_pool_release( pool, rk, error );
+
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                     функции для работы с открытыми ключами электронной подписи                  */
 /* ----------------------------------------------------------------------------------------------- */
@@ -917,11 +1589,11 @@
  /* теперь определяем открытый ключ */
   ak_mpzn_mul_montgomery( k, ( ak_uint64 *)sctx->key.key, one,
                                                       pctx->wc->q, pctx->wc->nq, pctx->wc->size );
-  ak_wpoint_pow( &pctx->qpoint, &pctx->wc->point, k, pctx->wc->size, pctx->wc );
+  ak_wpoint_pow_generator( &pctx->qpoint, k, pctx->wc->size, pctx->wc );
 
   ak_mpzn_mul_montgomery( k, ( ak_uint64 *)( sctx->key.key + sctx->key.key_size ),
                                                   one, pctx->wc->q, pctx->wc->nq, pctx->wc->size);
-  ak_wpoint_pow( &pctx->qpoint, &pctx->qpoint, k, pctx->wc->size, pctx->wc );
+  ak_wpoint_pow_window( &pctx->qpoint, &pctx->qpoint, k, pctx->wc->size, pctx->wc );
   ak_wpoint_reduce( &pctx->qpoint, pctx->wc );
 
  /* устанавливаем флаг  */
@@ -957,76 +1629,96 @@
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! @param pctx контекст открытого ключа.
-    @param hash хеш-код сообщения (последовательность байт), для которого проверяется электронная подпись.
-    @param hsize размер хеш-кода, в байтах.
-    @param sign электронная подпись, для которой выполняется проверка.
-    @return Функция возыращает истину, если подпись верна. Если функция не верна или если
-    возникла ошибка, то возвращается ложь. Код Ошибки может получен с помощью
-    вызова функции ak_error_get_value().                                                           */
+/*! \brief Проверка параметров, передаваемых функциям проверки электронной подписи.
+    @return В случае корректных параметров возвращается \ref ak_error_ok. В противном случае
+    возвращается код ошибки.                                                                       */
 /* ----------------------------------------------------------------------------------------------- */
- bool_t ak_verifykey_verify_hash( ak_verifykey pctx,
+ static int ak_verifykey_verify_hash_check( ak_verifykey pctx,
                                         const ak_pointer hash, const size_t hsize, ak_pointer sign )
+{
+  if( pctx == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                               "using a null pointer to secret key context" );
+  if( hash == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                          "using a null pointer to hash value" );
+  if( hsize != sizeof( ak_uint64 )*(pctx->wc->size )) return ak_error_message(
+                               ak_error_wrong_length, __func__, "using hash value with wrong length" );
+  if( sign == NULL ) return ak_error_message( ak_error_null_pointer, __func__,
+                                                          "using a null pointer to sign value" );
+ return ak_error_ok;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Импорт электронной подписи и хеш-кода сообщения.
+
+    Функция помещает в `r` и `s` половинки электронной подписи,
+    а в `e` вычет \f$ e \equiv h \pmod{q} \f$ (в представлении Монтгомери),
+    соответствующий хеш-коду \f$ h \f$ подписанного сообщения.                                     */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_verifykey_verify_hash_import( ak_wcurve wc, const ak_pointer hash,
+                                     ak_pointer sign, ak_uint64 *r, ak_uint64 *s, ak_uint64 *e )
 {
 #ifndef AK_LITTLE_ENDIAN
   int i = 0;
 #endif
-  ak_mpzn512 v, z1, z2, u, r, s, h;
-  struct wpoint cpoint, tpoint;
-
-  if( pctx == NULL ) {
-    ak_error_message( ak_error_null_pointer, __func__,
-                                               "using a null pointer to secret key context" );
-    return ak_false;
-  }
-  if( hash == NULL ) {
-    ak_error_message( ak_error_null_pointer, __func__, "using a null pointer to hash value" );
-    return ak_false;
-  }
-  if( hsize != sizeof( ak_uint64 )*(pctx->wc->size )) {
-    ak_error_message( ak_error_wrong_length, __func__, "using hash value with wrong length" );
-    return ak_false;
-  }
-  if( sign == NULL ) {
-    ak_error_message( ak_error_null_pointer, __func__, "using a null pointer to sign value" );
-    return ak_false;
-  }
+  ak_mpzn512 h;
 
  /* импортируем подпись */
-  ak_mpzn_set_little_endian( s, pctx->wc->size, sign, sizeof(ak_uint64)*pctx->wc->size, ak_true );
-  ak_mpzn_set_little_endian( r, pctx->wc->size, ( ak_uint64* )sign + pctx->wc->size,
-                                                      sizeof(ak_uint64)*pctx->wc->size, ak_true );
-
-  memcpy( h, hash, sizeof( ak_uint64 )*pctx->wc->size );
+  ak_mpzn_set_little_endian( s, wc->size, sign, sizeof(ak_uint64)*wc->size, ak_true );
+  ak_mpzn_set_little_endian( r, wc->size, ( ak_uint64* )sign + wc->size,
+                                                              sizeof(ak_uint64)*wc->size, ak_true );
+  memcpy( h, hash, sizeof( ak_uint64 )*wc->size );
 #ifndef AK_LITTLE_ENDIAN
-  for( i = 0; i < pctx->wc->size; i++ ) h[i] = bswap_64( h[i] );
+  for( i = 0; i < wc->size; i++ ) h[i] = bswap_64( h[i] );
 #endif
 
-  ak_mpzn_set( v, h, pctx->wc->size );
-  ak_mpzn_rem( v, v, pctx->wc->q, pctx->wc->size );
-  if( ak_mpzn_cmp_ui( v, pctx->wc->size, 0 )) ak_mpzn_set_ui( v, pctx->wc->size, 1 );
-  ak_mpzn_mul_montgomery( v, v, pctx->wc->r2q, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
-
-  /* вычисляем v (в представлении Монтгомери) */
-  ak_mpzn_set_ui( u, pctx->wc->size, 2 );
-  ak_mpzn_sub( u, pctx->wc->q, u, pctx->wc->size );
-  ak_mpzn_modpow_montgomery( v, v, u, pctx->wc->q, pctx->wc->nq, pctx->wc->size ); // v <- v^{q-2} (mod q)
+  ak_mpzn_rem( h, h, wc->q, wc->size );
+  if( ak_mpzn_cmp_ui( h, wc->size, 0 )) ak_mpzn_set_ui( h, wc->size, 1 );
+  ak_mpzn_mul_montgomery( e, h, wc->r2q, wc->q, wc->nq, wc->size );
+}
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Вычисление кратностей \f$ z_1 \equiv sv \pmod{q} \f$ и \f$ z_2 \equiv -rv \pmod{q} \f$,
+    где \f$ v \equiv e^{-1} \pmod{q} \f$ (задается в представлении Монтгомери).                   */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_verifykey_verify_hash_multipliers( ak_wcurve wc, ak_uint64 *r, ak_uint64 *s,
+                                                   ak_uint64 *v, ak_uint64 *z1, ak_uint64 *z2 )
+{
   /* вычисляем z1 */
-  ak_mpzn_mul_montgomery( z1, s, pctx->wc->r2q, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
-  ak_mpzn_mul_montgomery( z1, z1, v, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
-  ak_mpzn_mul_montgomery( z1, z1, pctx->wc->point.z, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
+  ak_mpzn_mul_montgomery( z1, s, wc->r2q, wc->q, wc->nq, wc->size );
+  ak_mpzn_mul_montgomery( z1, z1, v, wc->q, wc->nq, wc->size );
+  ak_mpzn_mul_montgomery( z1, z1, wc->point.z, wc->q, wc->nq, wc->size );
 
   /* вычисляем z2 */
-  ak_mpzn_mul_montgomery( z2, r, pctx->wc->r2q, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
-  ak_mpzn_sub( z2, pctx->wc->q, z2, pctx->wc->size );
-  ak_mpzn_mul_montgomery( z2, z2, v, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
-  ak_mpzn_mul_montgomery( z2, z2, pctx->wc->point.z, pctx->wc->q, pctx->wc->nq, pctx->wc->size );
+  ak_mpzn_mul_montgomery( z2, r, wc->r2q, wc->q, wc->nq, wc->size );
+  ak_mpzn_sub( z2, wc->q, z2, wc->size );
+  ak_mpzn_mul_montgomery( z2, z2, v, wc->q, wc->nq, wc->size );
+  ak_mpzn_mul_montgomery( z2, z2, wc->point.z, wc->q, wc->nq, wc->size );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! @param pctx контекст открытого ключа.
+    @param hash хеш-код сообщения (последовательность байт), для которого проверяется электронная подпись.
+    @param hsize размер хеш-кода, в байтах.
+    @param sign электронная подпись, для которой выполняется проверка.
+    @return Функция возыращает истину, если подпись верна. Если функция не верна или если
+    возникла ошибка, то возвращается ложь. Код Ошибки может получен с помощью
+    вызова функции ak_error_get_value().                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ bool_t ak_verifykey_verify_hash( ak_verifykey pctx,
+                                        const ak_pointer hash, const size_t hsize, ak_pointer sign )
+{
+  ak_mpzn512 v, z1, z2, r, s, e;
+  struct wpoint cpoint;
+
+  if( ak_verifykey_verify_hash_check( pctx, hash, hsize, sign ) != ak_error_ok ) return ak_false;
+  ak_verifykey_verify_hash_import( pctx->wc, hash, sign, r, s, e );
+
+  /* вычисляем v (в представлении Монтгомери) */
+  ak_mpzn_inverse_montgomery( v, e, pctx->wc->q, pctx->wc->nq, pctx->wc->size ); // v <- e^{-1} (mod q)
+  ak_verifykey_verify_hash_multipliers( pctx->wc, r, s, v, z1, z2 );
 
  /* сложение точек и проверка */
-  ak_wpoint_pow( &cpoint, &pctx->wc->point, z1, pctx->wc->size, pctx->wc );
-  ak_wpoint_pow( &tpoint, &pctx->qpoint, z2, pctx->wc->size, pctx->wc );
-  ak_wpoint_add( &cpoint, &tpoint, pctx->wc );
+  ak_wpoint_pow_sum( &cpoint, z1, &pctx->qpoint, z2, pctx->wc->size, pctx->wc );
   ak_wpoint_reduce( &cpoint, pctx->wc );
   ak_mpzn_rem( cpoint.x, cpoint.x, pctx->wc->q, pctx->wc->size );
 
@@ -1037,6 +1729,180 @@
  return ak_true;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Максимальное количество заданий, обрабатываемых совместно. */
+ #define ak_verify_tasks_chunk  (64)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Совместная проверка группы электронных подписей.
+
+    Задания группируются по эллиптическим кривым; для каждой группы обращение хеш-кодов по
+    модулю \f$ q \f$ и приведение вычисленных точек к аффинной форме выполняются одновременно
+    для всех заданий группы.
+
+    Параметры заданий должны быть проверены заранее, в вызывающем потоке (задания с ненулевым
+    значением поля `error` пропускаются); функция не обращается к журналу и к коду ошибки
+    библиотеки, поэтому может безопасно выполняться одновременно в нескольких потоках.
+
+    @param tasks Массив заданий.
+    @param count Количество заданий, не превосходящее \ref ak_verify_tasks_chunk.                 */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_verifykey_verify_hash_chunk( ak_verify_task tasks, const size_t count )
+{
+  size_t i, j, m;
+  ak_wcurve wc = NULL;
+  ak_mpzn512 z1, z2;
+  bool_t done[ ak_verify_tasks_chunk ];
+  ak_verify_task group[ ak_verify_tasks_chunk ];
+  ak_mpzn512 rs[ ak_verify_tasks_chunk ], ss[ ak_verify_tasks_chunk ];
+  ak_uint64 es[ ak_verify_tasks_chunk*ak_mpzn512_size ], vs[ ak_verify_tasks_chunk*ak_mpzn512_size ];
+  struct wpoint cpoints[ ak_verify_tasks_chunk ];
+
+  for( i = 0; i < count; i++ ) done[i] = ( tasks[i].error != ak_error_ok );
+
+  for( i = 0; i < count; i++ ) {
+     if( done[i] ) continue;
+    /* собираем группу заданий, использующих одну и ту же кривую */
+     wc = tasks[i].key->wc;
+     for( j = i, m = 0; j < count; j++ ) {
+        if( done[j] || ( tasks[j].key->wc != wc )) continue;
+        done[j] = ak_true;
+        group[m] = tasks +j;
+        ak_verifykey_verify_hash_import( wc, group[m]->hash, group[m]->sign,
+                                                                rs[m], ss[m], es +m*wc->size );
+        m++;
+     }
+
+    /* вычисляем все значения v одновременно */
+     ak_mpzn_modinv_montgomery_batch( vs, es, m, wc->q, wc->nq, wc->size );
+     for( j = 0; j < m; j++ ) {
+        ak_verifykey_verify_hash_multipliers( wc, rs[j], ss[j], vs +j*wc->size, z1, z2 );
+        ak_wpoint_pow_sum( cpoints +j, z1, &group[j]->key->qpoint, z2, wc->size, wc );
+     }
+
+    /* приводим все точки к аффинной форме одновременно */
+     ak_wpoint_reduce_batch( cpoints, m, wc );
+     for( j = 0; j < m; j++ ) {
+        ak_mpzn_rem( cpoints[j].x, cpoints[j].x, wc->q, wc->size );
+        group[j]->result = ( ak_mpzn_cmp( cpoints[j].x, rs[j], wc->size ) == 0 );
+     }
+  }
+}
+
+#ifdef AK_HAVE_PTHREAD_H
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Общие данные потоков, выполняющих пакетную проверку электронных подписей. */
+ typedef struct verify_queue {
+  /*! \brief Массив заданий. */
+   ak_verify_task tasks;
+  /*! \brief Общее количество заданий. */
+   size_t count;
+  /*! \brief Индекс первого задания из следующей необработанной группы. */
+   size_t next;
+  /*! \brief Мьютекс, защищающий индекс следующей группы заданий. */
+   pthread_mutex_t mutex;
+ } *ak_verify_queue;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция потока: последовательно извлекает группы заданий из общей очереди
+    и выполняет их. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void *ak_verifykey_verify_hash_thread( void *ptr )
+{
+  size_t idx = 0;
+  ak_verify_queue queue = ( ak_verify_queue ) ptr;
+
+  for( ;; ) {
+     pthread_mutex_lock( &queue->mutex );
+     idx = queue->next;
+     queue->next += ak_verify_tasks_chunk;
+     pthread_mutex_unlock( &queue->mutex );
+     if( idx >= queue->count ) break;
+     ak_verifykey_verify_hash_chunk( queue->tasks + idx,
+                                               ak_min( ak_verify_tasks_chunk, queue->count - idx ));
+  }
+ return NULL;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция предназначена для проверки большого количества электронных подписей, выработанных,
+    в общем случае, различными отправителями. Каждое задание описывается структурой
+    \ref verify_task и проверяется так же, как и при вызове функции ak_verifykey_verify_hash();
+    результат проверки помещается в поле `result`, а код ошибки, связанной с некорректными
+    параметрами задания, в поле `error` соответствующей структуры.
+
+    Задания обрабатываются группами по \ref ak_verify_tasks_chunk заданий.
+    Внутри группы обращения по модулю \f$ q \f$ хеш-кодов и обращения по модулю \f$ p \f$,
+    необходимые для приведения точек к аффинной форме, выполняются одновременно
+    (методом Монтгомери), то есть требуют лишь по одному обращению на группу.
+
+    Если библиотека собрана с поддержкой pthreads, то группы заданий распределяются между
+    `threads` потоками; в противном случае, а также при `threads` не превосходящем единицы,
+    задания выполняются последовательно в вызывающем потоке.
+
+    @param tasks Массив заданий.
+    @param count Количество заданий в массиве.
+    @param threads Максимальное количество используемых потоков.
+
+    @return Функция возвращает \ref ak_error_ok, если все задания имели корректные параметры
+    (при этом результаты проверки подписей помещаются в поля `result`). В противном
+    случае возвращается код ошибки первого из некорректных заданий.                               */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_verifykey_verify_hash_tasks( ak_verify_task tasks, const size_t count,
+                                                                            const size_t threads )
+{
+  size_t idx = 0;
+  int error = ak_error_ok;
+
+  if( tasks == NULL ) return ak_error_message( ak_error_null_pointer, __func__ ,
+                                                         "using null pointer to array of tasks" );
+  if( !count ) return ak_error_message( ak_error_zero_length, __func__ ,
+                                                                 "using empty array of tasks" );
+
+ /* проверяем параметры всех заданий в вызывающем потоке, до их распределения между потоками;
+    потоки получают только корректные задания и не обращаются к журналу и коду ошибки */
+  for( idx = 0; idx < count; idx++ ) {
+     tasks[idx].result = ak_false;
+     tasks[idx].error = ak_verifykey_verify_hash_check( tasks[idx].key,
+                                        tasks[idx].hash, tasks[idx].hash_size, tasks[idx].sign );
+  }
+
+#ifndef AK_HAVE_PTHREAD_H
+  (void)threads;
+#else
+  if(( threads > 1 ) && ( count > ak_verify_tasks_chunk )) {
+    pthread_t *handles = NULL;
+    struct verify_queue queue;
+    size_t created = 0,
+           tcount = ak_min( threads, ( count + ak_verify_tasks_chunk -1 )/ak_verify_tasks_chunk );
+
+    if(( handles = malloc( tcount*sizeof( pthread_t ))) == NULL )
+      return ak_error_message( ak_error_out_of_memory, __func__ ,
+                                                          "incorrect memory allocation for threads" );
+    queue.tasks = tasks;
+    queue.count = count;
+    queue.next = 0;
+    pthread_mutex_init( &queue.mutex, NULL );
+    for( created = 0; created < tcount; created++ )
+       if( pthread_create( handles + created, NULL,
+                                         ak_verifykey_verify_hash_thread, &queue ) != 0 ) break;
+   /* если не удалось создать ни одного потока, задания выполняются в вызывающем потоке */
+    if( created == 0 ) ak_verifykey_verify_hash_thread( &queue );
+    for( idx = 0; idx < created; idx++ ) pthread_join( handles[idx], NULL );
+    pthread_mutex_destroy( &queue.mutex );
+    free( handles );
+  }
+   else
+#endif
+  for( idx = 0; idx < count; idx += ak_verify_tasks_chunk )
+     ak_verifykey_verify_hash_chunk( tasks + idx, ak_min( ak_verify_tasks_chunk, count - idx ));
+
+  for( idx = 0; idx < count; idx++ )
+     if( tasks[idx].error != ak_error_ok ) { error = tasks[idx].error; break; }
+ return error;
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! @param pctx контекст открытого ключа.
     @param in область памяти для которой проверяется электронная подпись.
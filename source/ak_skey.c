@@ -68,6 +68,7 @@
   struct hash ctx;
   ak_uint8 out[64], hm[32];
   ak_uint64 rvalue = 0;
+  ak_uint32 number = 0;
   int error = ak_error_ok;
   const char *version =  ak_libakrypt_version();
 
@@ -91,11 +92,11 @@
 #ifdef AK_HAVE_PTHREAD_H
   pthread_mutex_lock( &session_unique_number_mutex );
 #endif
-  session_unique_number++;
+  number = ++session_unique_number; /* значение копируется, пока мьютекс захвачен */
 #ifdef AK_HAVE_PTHREAD_H
   pthread_mutex_unlock( &session_unique_number_mutex );
 #endif
-  memcpy( out+len, &session_unique_number, sizeof( ak_uint32 )); /* потом время генерации номера ключа */
+  memcpy( out+len, &number, sizeof( ak_uint32 )); /* потом время генерации номера ключа */
   len += sizeof( ak_uint32 );
 
  /* заполняем стандартное начало вектора: текущее время */
@@ -20,8 +20,13 @@
 #endif
 
 /* ----------------------------------------------------------------------------------------------- */
-/*!  Переменная, содержащая в себе код последней ошибки                                            */
+/*!  Переменная, содержащая в себе код последней ошибки; при наличии поддержки компилятором
+     каждый поток выполнения программы имеет собственную копию данной переменной                   */
+#ifdef AK_HAVE_THREAD_LOCAL
+ static _Thread_local int ak_errno = ak_error_ok;
+#else
  static int ak_errno = ak_error_ok;
+#endif
  static int ak_log_level = ak_log_standard;
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -132,8 +137,10 @@
 }
 
 /* ----------------------------------------------------------------------------------------------- */
-/*! \return Функция возвращает текущее значение кода ошибки. Данное значение не является
-    защищенным от возможности изменения различными потоками выполнения программы.                  */
+/*! \return Функция возвращает текущее значение кода ошибки. Если библиотека собрана компилятором,
+    поддерживающим локальную память потоков (`AK_HAVE_THREAD_LOCAL`), то возвращается код последней
+    ошибки, возникшей в вызывающем потоке; в противном случае значение не является защищенным
+    от возможности изменения различными потоками выполнения программы.                             */
 /* ----------------------------------------------------------------------------------------------- */
  int ak_error_get_value( void )
 {
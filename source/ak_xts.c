@@ -11,6 +11,9 @@
 #ifdef AK_HAVE_STDALIGN_H
  #include <stdalign.h>
 #endif
+#ifdef AK_HAVE_PTHREAD_H
+ #include <pthread.h>
+#endif
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! Функция реализует алгоритм двухключевого шифрования, описываемый в стандарте IEEE P 1619.
@@ -275,6 +278,329 @@
   return error;
 }
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество секторов, для которых начальные значения tweak вырабатываются
+    за один вызов многоблочной функции. */
+ #define ak_xts_sectors_batch  (16)
+/*! \brief Количество 64-х битных слов, обрабатываемых за один вызов многоблочной функции. */
+ #define ak_xts_batch_words    (32)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция вычисляет следующее значение tweak (умножение на примитивный элемент
+    поля \f$ \mathbb F_{2^{128}}\f$). */
+ #define ak_xts_tweak_next( tw ) {\
+              ak_uint64 c0 = (tw)[0] >> 63, c1 = (tw)[1] >> 63;\
+              (tw)[0] <<= 1; (tw)[1] <<= 1;\
+              (tw)[1] ^= c0;\
+              if( c1 ) (tw)[0] ^= 0x87;\
+           }
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция применяет алгоритм блочного шифрования к `count` блокам, используя
+    многоблочную функцию `blocks`, а при ее отсутствии - функцию `single` для каждого блока. */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_xts_apply( ak_bckey bkey, ak_function_bckey_blocks *blocks,
+                     ak_function_bckey *single, ak_uint64 *in, ak_uint64 *out, const size_t count )
+{
+  size_t i, bw = bkey->bsize >> 3;
+  if( blocks != NULL ) blocks( &bkey->key, in, out, count );
+   else for( i = 0; i < count; i++ ) single( &bkey->key, in +i*bw, out +i*bw );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция зашифровывает (расшифровывает) последовательность секторов
+    в режиме `XTS` без проверки параметров и изменения ресурса ключей.
+
+    Для группы из нескольких секторов начальные значения tweak вырабатываются за один вызов
+    многоблочной функции ключа `authenticationKey`. Затем для каждого сектора последовательность
+    значений tweak вычисляется заранее для группы из нескольких блоков, и эти блоки
+    обрабатываются за один вызов многоблочной функции ключа `encryptionKey`. Поскольку
+    в каждый момент времени обрабатываемые блоки копируются во внутренний буффер,
+    указатели `in` и `out` могут совпадать.
+
+    @param encryptionKey Ключ шифрования данных.
+    @param authenticationKey Ключ выработки начального значения tweak.
+    @param decrypt Флаг расшифрования данных.
+    @param in Указатель на входные данные.
+    @param out Указатель на выходные данные.
+    @param sector_size Размер одного сектора в октетах (кратен длине блока).
+    @param sectors Количество секторов.
+    @param sector Номер первого сектора.                                                           */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_xts_sectors( ak_bckey encryptionKey, ak_bckey authenticationKey,
+                     const bool_t decrypt, ak_uint64 *in, ak_uint64 *out, const size_t sector_size,
+                                                            size_t sectors, ak_uint64 sector )
+{
+  size_t i, j, k, n, words;
+  ak_uint64 lo[ ak_xts_sectors_batch ], hi[ ak_xts_sectors_batch ],
+            tweak[2], tw[ ak_xts_batch_words ], buf[ ak_xts_batch_words ];
+  ak_function_bckey *single = decrypt ? encryptionKey->decrypt : encryptionKey->encrypt;
+  ak_function_bckey_blocks *blocks = decrypt ? encryptionKey->decrypt_blocks :
+                                                                    encryptionKey->encrypt_blocks;
+  const size_t bw = encryptionKey->bsize >> 3;
+
+  while( sectors > 0 ) {
+    n = ak_min( sectors, ak_xts_sectors_batch );
+
+   /* начальные значения tweak: номер сектора в виде 64-х битного числа
+                                                    (младшие октеты вперед), зашифрованный на ключе */
+    for( k = 0; k < n; k++ ) {
+      #ifdef AK_LITTLE_ENDIAN
+       lo[k] = sector +k;
+      #else
+       lo[k] = bswap_64( sector +k );
+      #endif
+       hi[k] = 0;
+    }
+    if( authenticationKey->bsize == 8 ) {
+      ak_xts_apply( authenticationKey, authenticationKey->encrypt_blocks,
+                                                     authenticationKey->encrypt, lo, lo, n );
+      for( k = 0; k < n; k++ ) hi[k] ^= lo[k];
+      ak_xts_apply( authenticationKey, authenticationKey->encrypt_blocks,
+                                                     authenticationKey->encrypt, hi, hi, n );
+    } else {
+        for( k = 0; k < n; k++ ) { buf[2*k] = lo[k]; buf[2*k+1] = hi[k]; }
+        ak_xts_apply( authenticationKey, authenticationKey->encrypt_blocks,
+                                                   authenticationKey->encrypt, buf, buf, n );
+        for( k = 0; k < n; k++ ) { lo[k] = buf[2*k]; hi[k] = buf[2*k+1]; }
+      }
+
+   /* обрабатываем секторы группы; слово с номером w каждого сектора складывается со словом
+      с тем же номером в последовательности tweak, tweak*a, tweak*a^2, ... */
+    for( k = 0; k < n; k++ ) {
+       tweak[0] = lo[k]; tweak[1] = hi[k];
+       words = sector_size >> 3;
+       while( words > 0 ) {
+          j = ak_min( words, ak_xts_batch_words );
+          for( i = 0; i < j; i += 2 ) {
+             tw[i] = tweak[0]; tw[i+1] = tweak[1];
+             ak_xts_tweak_next( tweak );
+          }
+          for( i = 0; i < j; i++ ) buf[i] = in[i] ^ tw[i];
+          ak_xts_apply( encryptionKey, blocks, single, buf, buf, j/bw );
+          for( i = 0; i < j; i++ ) out[i] = buf[i] ^ tw[i];
+          in += j; out += j; words -= j;
+       }
+    }
+    sector += n; sectors -= n;
+  }
+  ak_ptr_wipe( lo, sizeof( lo ), &encryptionKey->key.generator );
+  ak_ptr_wipe( hi, sizeof( hi ), &encryptionKey->key.generator );
+  ak_ptr_wipe( tweak, sizeof( tweak ), &encryptionKey->key.generator );
+  ak_ptr_wipe( tw, sizeof( tw ), &encryptionKey->key.generator );
+  ak_ptr_wipe( buf, sizeof( buf ), &encryptionKey->key.generator );
+}
+
+#ifdef AK_HAVE_PTHREAD_H
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Последовательность секторов, обрабатываемая отдельным потоком. */
+ typedef struct xts_sectors_segment {
+  /*! \brief Копия ключа шифрования данных, используемая потоком (многоблочные функции
+      алгоритма Магма изменяют состояние генератора масок ключа). */
+   struct bckey encryptionKey;
+  /*! \brief Копия ключа выработки начального значения tweak, используемая потоком. */
+   struct bckey authenticationKey;
+  /*! \brief Флаг расшифрования данных. */
+   bool_t decrypt;
+  /*! \brief Указатель на входные данные. */
+   ak_uint64 *in;
+  /*! \brief Указатель на выходные данные. */
+   ak_uint64 *out;
+  /*! \brief Размер одного сектора в октетах. */
+   size_t sector_size;
+  /*! \brief Количество секторов. */
+   size_t sectors;
+  /*! \brief Номер первого сектора. */
+   ak_uint64 sector;
+  /*! \brief Флаг успешного создания потока. */
+   bool_t started;
+  /*! \brief Дескриптор потока. */
+   pthread_t handle;
+ } *ak_xts_sectors_segment;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция потока: обрабатывает одну последовательность секторов. */
+/* ----------------------------------------------------------------------------------------------- */
+ static void *ak_xts_sectors_thread( void *ptr )
+{
+  ak_xts_sectors_segment seg = ( ak_xts_sectors_segment ) ptr;
+  ak_xts_sectors( &seg->encryptionKey, &seg->authenticationKey, seg->decrypt,
+                                    seg->in, seg->out, seg->sector_size, seg->sectors, seg->sector );
+ return NULL;
+}
+#endif
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Общая часть функций ak_bckey_encrypt_xts_sectors() и ak_bckey_decrypt_xts_sectors(). */
+/* ----------------------------------------------------------------------------------------------- */
+ static int ak_bckey_xts_sectors_common( ak_bckey encryptionKey, ak_bckey authenticationKey,
+                      const bool_t decrypt, ak_pointer in, ak_pointer out, const size_t sector_size,
+                                const size_t sectors, const ak_uint64 sector, const size_t threads )
+{
+  int error = ak_error_ok;
+  ssize_t ablocks = 0, eblocks = 0;
+
+  if(( encryptionKey == NULL ) || ( authenticationKey == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__, "using null pointer to cipher key" );
+  if(( in == NULL ) || ( out == NULL ))
+    return ak_error_message( ak_error_null_pointer, __func__, "using null pointer to data" );
+  if( !sectors ) return ak_error_ok;
+  if(( sector_size == 0 ) || ( sector_size%encryptionKey->bsize != 0 ))
+    return ak_error_message( ak_error_wrong_block_cipher_length,
+                          __func__ , "the length of sector is not divided by block length" );
+
+ /* проверяем целостность ключей */
+  if( encryptionKey->key.check_icode( &encryptionKey->key ) != ak_true )
+    return ak_error_message( ak_error_wrong_key_icode, __func__,
+                                               "incorrect integrity code of encryption key value" );
+  if( authenticationKey->key.check_icode( &authenticationKey->key ) != ak_true )
+    return ak_error_message( ak_error_wrong_key_icode, __func__,
+                                           "incorrect integrity code of authentication key value" );
+
+ /* ресурс ключей изменяется один раз для всех секторов */
+  ablocks = ( ssize_t )( sectors*( authenticationKey->bsize >> 3 ));
+  eblocks = ( ssize_t )( sectors*( sector_size/encryptionKey->bsize ));
+  if( authenticationKey->key.resource.value.counter < ablocks )
+    return ak_error_message( ak_error_low_key_resource,
+                                           __func__ , "low resource of authentication cipher key" );
+  if( encryptionKey->key.resource.value.counter < eblocks )
+    return ak_error_message( ak_error_low_key_resource,
+                                              __func__ , "low resource of encryption cipher key" );
+  authenticationKey->key.resource.value.counter -= ablocks;
+  encryptionKey->key.resource.value.counter -= eblocks;
+
+#ifndef AK_HAVE_PTHREAD_H
+  (void)threads;
+#else
+ /* секторы распределяются между потоками поровну */
+  if( ak_min( threads, ( size_t )eblocks/ak_bckey_thread_blocks ) > 1 ) {
+    ak_xts_sectors_segment segs = NULL;
+    size_t idx = 0, spw = 0, created = 0,
+           tcount = ak_min( ak_min( threads, ( size_t )eblocks/ak_bckey_thread_blocks ), sectors );
+
+    if(( segs = malloc( tcount*sizeof( struct xts_sectors_segment ))) != NULL ) {
+     /* каждая последовательность секторов обрабатывается с собственными копиями ключей */
+      for( created = 0; created < tcount; created++ ) {
+         if( ak_bckey_create_copy( &segs[created].encryptionKey, encryptionKey ) != ak_error_ok )
+           break;
+         if( ak_bckey_create_copy( &segs[created].authenticationKey,
+                                                           authenticationKey ) != ak_error_ok ) {
+           ak_bckey_destroy( &segs[created].encryptionKey );
+           break;
+         }
+      }
+      if( created < tcount ) {
+        for( idx = 0; idx < created; idx++ ) {
+           ak_bckey_destroy( &segs[idx].authenticationKey );
+           ak_bckey_destroy( &segs[idx].encryptionKey );
+        }
+        free( segs );
+        goto labser;
+      }
+      spw = sectors/tcount;
+      for( idx = 0; idx < tcount; idx++ ) {
+         segs[idx].decrypt = decrypt;
+         segs[idx].in = ( ak_uint64 *)in + idx*spw*( sector_size >> 3 );
+         segs[idx].out = ( ak_uint64 *)out + idx*spw*( sector_size >> 3 );
+         segs[idx].sector_size = sector_size;
+         segs[idx].sectors = ( idx == tcount-1 ) ? sectors - idx*spw : spw;
+         segs[idx].sector = sector + idx*spw;
+      }
+     /* первая последовательность секторов обрабатывается в вызывающем потоке, как и те,
+        для которых не удалось создать поток */
+      for( idx = 1; idx < tcount; idx++ )
+         segs[idx].started = ( pthread_create( &segs[idx].handle, NULL,
+                                       ak_xts_sectors_thread, segs +idx ) == 0 ) ? ak_true : ak_false;
+      ak_xts_sectors_thread( segs );
+      for( idx = 1; idx < tcount; idx++ ) {
+         if( segs[idx].started ) pthread_join( segs[idx].handle, NULL );
+          else ak_xts_sectors_thread( segs +idx );
+      }
+      for( idx = 0; idx < tcount; idx++ ) {
+         ak_bckey_destroy( &segs[idx].authenticationKey );
+         ak_bckey_destroy( &segs[idx].encryptionKey );
+      }
+      free( segs );
+      goto labex;
+    }
+  }
+  labser:
+#endif
+  ak_xts_sectors( encryptionKey, authenticationKey, decrypt,
+                                        ( ak_uint64 *)in, ( ak_uint64 *)out, sector_size, sectors, sector );
+#ifdef AK_HAVE_PTHREAD_H
+  labex:
+#endif
+ /* перемаскируем ключи */
+  if(( error = encryptionKey->key.set_mask( &encryptionKey->key )) != ak_error_ok )
+    ak_error_message( error, __func__ , "wrong remasking of encryption key" );
+  if(( error = authenticationKey->key.set_mask( &authenticationKey->key )) != ak_error_ok )
+    ak_error_message( error, __func__ , "wrong remasking of authentication key" );
+
+ return error;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция зашифровывает последовательность из `sectors` секторов одинакового размера,
+    имеющих последовательные номера `sector`, `sector+1`, ... Каждый сектор зашифровывается так же,
+    как при вызове функции ak_bckey_encrypt_xts() с синхропосылкой, равной номеру сектора,
+    представленному восемью октетами (младшие октеты вперед), что соответствует использованию
+    номера сектора в качестве tweak в стандарте IEEE P 1619.
+
+    В отличие от последовательных вызовов функции ak_bckey_encrypt_xts() начальные значения tweak
+    вырабатываются сразу для группы секторов, последовательность значений tweak
+    для каждого сектора вычисляется заранее, а блоки данных обрабатываются многоблочной функцией
+    алгоритма блочного шифрования. Ресурс ключей уменьшается один раз для всех секторов.
+    Если библиотека собрана с поддержкой pthreads, то секторы распределяются
+    между `threads` потоками (каждый поток обрабатывает не менее 4096 блоков и использует
+    собственные копии ключей).
+
+    @param encryptionKey Ключ, используемый для шифрования информации
+    @param authenticationKey Ключ, используемый для выработки начальных значений tweak
+    @param in Указатель на область памяти, где хранятся входные (открытые) данные
+    @param out Указатель на область памяти, куда будут помещены зашифрованные данные
+    (этот указатель может совпадать с `in`)
+    @param sector_size Размер одного сектора в октетах, должен быть кратен длине блока
+    @param sectors Количество секторов
+    @param sector Номер первого сектора
+    @param threads Максимальное количество используемых потоков
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В случае возникновения
+    ошибки возвращается ее код.                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_encrypt_xts_sectors( ak_bckey encryptionKey, ak_bckey authenticationKey,
+                             ak_pointer in, ak_pointer out, const size_t sector_size,
+                                const size_t sectors, const ak_uint64 sector, const size_t threads )
+{
+ return ak_bckey_xts_sectors_common( encryptionKey, authenticationKey, ak_false,
+                                                    in, out, sector_size, sectors, sector, threads );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! Функция реализует обратное преобразование к алгоритму, реализуемому с помощью
+    функции ak_bckey_encrypt_xts_sectors().
+
+    @param encryptionKey Ключ, используемый для шифрования информации
+    @param authenticationKey Ключ, используемый для выработки начальных значений tweak
+    @param in Указатель на область памяти, где хранятся входные (зашифрованные) данные
+    @param out Указатель на область памяти, куда будут помещены расшифрованные данные
+    (этот указатель может совпадать с `in`)
+    @param sector_size Размер одного сектора в октетах, должен быть кратен длине блока
+    @param sectors Количество секторов
+    @param sector Номер первого сектора
+    @param threads Максимальное количество используемых потоков
+
+    @return В случае успеха функция возвращает \ref ak_error_ok (ноль). В случае возникновения
+    ошибки возвращается ее код.                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ int ak_bckey_decrypt_xts_sectors( ak_bckey encryptionKey, ak_bckey authenticationKey,
+                             ak_pointer in, ak_pointer out, const size_t sector_size,
+                                const size_t sectors, const ak_uint64 sector, const size_t threads )
+{
+ return ak_bckey_xts_sectors_common( encryptionKey, authenticationKey, ak_true,
+                                                    in, out, sector_size, sectors, sector, threads );
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                                                                                       ak_xts.c  */
 /* ----------------------------------------------------------------------------------------------- */
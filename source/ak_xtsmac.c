@@ -152,6 +152,120 @@
      ak_xtsmac_next_gamma64; \
    } while(0);
 
+/* ----------------------------------------------------------------------------------------------- */
+/*                 конвейерная обработка последовательности пар 64-х битных блоков                 */
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Количество пар блоков, обрабатываемых за один вызов многоблочной функции ключа. */
+ #define ak_xtsmac_batch_pairs  (16)
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Преобразование 64-х битного слова, используемое в одном раунде сети Фейстеля
+    (подстановка, перестановка и линейное преобразование функции хеширования Стрибог).             */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline ak_uint64 ak_xtsmac_lps64( ak_uint64 x )
+{
+  const ak_uint8 *b = (const ak_uint8 *)&x;
+  return streebog_Areverse_expand_with_pi[0][b[0]] ^ streebog_Areverse_expand_with_pi[1][b[1]] ^
+         streebog_Areverse_expand_with_pi[2][b[2]] ^ streebog_Areverse_expand_with_pi[3][b[3]] ^
+         streebog_Areverse_expand_with_pi[4][b[4]] ^ streebog_Areverse_expand_with_pi[5][b[5]] ^
+         streebog_Areverse_expand_with_pi[6][b[6]] ^ streebog_Areverse_expand_with_pi[7][b[7]];
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция изменяет значение имитовставки для группы пар блоков.
+
+    Результат совпадает с последовательным применением \ref ak_xtsmac_update_sum64 к каждой паре.
+    Поскольку преобразования различных пар не зависят друг от друга, каждый раунд сети Фейстеля
+    выполняется сразу для всех пар группы, и задержки обращений к таблицам перекрываются.
+
+    @param ctx Контекст алгоритма xtsmac.
+    @param t Указатель на пары зашифрованных блоков.
+    @param pairs Количество пар (не более \ref ak_xtsmac_batch_pairs).                            */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_xtsmac_update_sum64_blocks( ak_xtsmac_ctx ctx,
+                                                         const ak_uint64 *t, const size_t pairs )
+{
+  size_t i;
+  ak_uint64 x[ ak_xtsmac_batch_pairs ], y[ ak_xtsmac_batch_pairs ], s0 = 0, s1 = 0;
+
+  for( i = 0; i < pairs; i++ ) { x[i] = t[2*i] ^ ctx->gamma.u64[2]; y[i] = t[2*i+1]; }
+  for( i = 0; i < pairs; i++ ) y[i] ^= ak_xtsmac_lps64( x[i] ) ^ ctx->gamma.u64[3];
+  for( i = 0; i < pairs; i++ ) x[i] ^= ak_xtsmac_lps64( y[i] ) ^ ctx->gamma.u64[4];
+  for( i = 0; i < pairs; i++ ) y[i] ^= ak_xtsmac_lps64( x[i] ) ^ ctx->gamma.u64[5];
+  for( i = 0; i < pairs; i++ ) {
+     s0 ^= x[i] ^ ak_xtsmac_lps64( y[i] );
+     s1 ^= y[i];
+  }
+  ctx->sum[0] ^= s0;
+  ctx->sum[1] ^= s1;
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Зашифрование (расшифрование) блоков с использованием многоблочной функции ключа,
+    если она определена, и поблочной функции в противном случае.                                   */
+/* ----------------------------------------------------------------------------------------------- */
+ static inline void ak_xtsmac_apply64( ak_bckey bkey, const bool_t decrypt,
+                                                            ak_uint64 *buf, const size_t count )
+{
+  size_t i;
+  ak_function_bckey *single = decrypt ? bkey->decrypt : bkey->encrypt;
+  ak_function_bckey_blocks *blocks = decrypt ? bkey->decrypt_blocks : bkey->encrypt_blocks;
+
+  if( blocks != NULL ) blocks( &bkey->key, buf, buf, count );
+   else for( i = 0; i < count; i++ ) single( &bkey->key, buf +i, buf +i );
+}
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Функция обрабатывает последовательность пар 64-х битных блоков.
+
+    Результат совпадает с последовательным применением к каждой паре блоков одного из макросов
+    \ref ak_xtsmac_authenticate_step64 (если `out` равен `NULL`), \ref ak_xtsmac_encrypt_step64
+    или \ref ak_xtsmac_decrypt_step64 (если `decrypt` истинно). Для группы пар значения
+    маскирующей гаммы вычисляются заранее, после чего все блоки группы зашифровываются
+    (расшифровываются) за один вызов многоблочной функции ключа, а имитовставка изменяется
+    функцией ak_xtsmac_update_sum64_blocks(). Поскольку обрабатываемые блоки копируются
+    во внутренний буффер, указатели `in` и `out` могут совпадать.
+
+    @param ctx Контекст алгоритма xtsmac.
+    @param bkey Ключ шифрования (или ключ имитозащиты при обработке ассоциированных данных).
+    @param decrypt Флаг расшифрования данных.
+    @param in Указатель на входные данные.
+    @param out Указатель на выходные данные.
+    @param pairs Количество обрабатываемых пар блоков.                                             */
+/* ----------------------------------------------------------------------------------------------- */
+ static void ak_xtsmac_blocks64( ak_xtsmac_ctx ctx, ak_bckey bkey, const bool_t decrypt,
+                                            const ak_uint8 *in, ak_uint8 *out, size_t pairs )
+{
+  size_t i, n;
+  ak_uint64 t[2], g[ 2*ak_xtsmac_batch_pairs ], buf[ 2*ak_xtsmac_batch_pairs ];
+
+  while( pairs > 0 ) {
+     n = ak_min( pairs, ak_xtsmac_batch_pairs );
+    /* вычисляем значения маскирующей гаммы для всей группы */
+     for( i = 0; i < n; i++ ) {
+        g[2*i] = ctx->gamma.u64[0]; g[2*i+1] = ctx->gamma.u64[1];
+        ak_xtsmac_next_gamma64;
+     }
+     memcpy( buf, in, n << 4 );
+     for( i = 0; i < 2*n; i++ ) buf[i] ^= g[i];
+
+     if( decrypt ) {
+       ak_xtsmac_update_sum64_blocks( ctx, buf, n );
+       ak_xtsmac_apply64( bkey, ak_true, buf, 2*n );
+     } else {
+         ak_xtsmac_apply64( bkey, ak_false, buf, 2*n );
+         ak_xtsmac_update_sum64_blocks( ctx, buf, n );
+       }
+     if( out != NULL ) {
+       for( i = 0; i < 2*n; i++ ) buf[i] ^= g[i];
+       memcpy( out, buf, n << 4 );
+       out += ( n << 4 );
+     }
+     in += ( n << 4 );
+     pairs -= n;
+  }
+}
+
 /* ----------------------------------------------------------------------------------------------- */
 /*                             реализация пошаговой стратегии вычислений                           */
 /* ----------------------------------------------------------------------------------------------- */
@@ -281,10 +395,9 @@
 
   }
    else { /* обработка 64-битным шифром */
-      while( blocks-- > 0 ) {
-        ak_xtsmac_authenticate_step64( inptr );
-        ctx->abitlen += 128;
-      }
+      ak_xtsmac_blocks64( ctx, authenticationKey, ak_false, inptr, NULL, ( size_t ) blocks );
+      inptr += ( blocks << 4 );
+      ctx->abitlen += ( blocks << 7 );
       if( tail ) {
         memcpy( tptr, inptr, tail ); /* копируем входные данные (здесь меньше одного 16-ти байтного блока) */
         memset( tptr +tail, 0, 16 -tail ); /* зануляем остаток */
@@ -441,12 +554,10 @@
  /* теперь blocks отлично от нуля и можно выполнить общий цикл обработки данных */
   switch( encryptionKey->bsize ) {
     case  8:
-      while( blocks-- > 0 ) {
-         //printf("in:  %s\n", ak_ptr_to_hexstr( inptr, 16, ak_false ));
-         ak_xtsmac_encrypt_step64( inptr, outptr );
-         ctx->pbitlen += 128;
-         //printf("out: %s\n\n", ak_ptr_to_hexstr( outptr -16, 16, ak_false ));
-      }
+      ak_xtsmac_blocks64( ctx, encryptionKey, ak_false, inptr, outptr, ( size_t ) blocks );
+      inptr += ( blocks << 4 );
+      outptr += ( blocks << 4 );
+      ctx->pbitlen += ( blocks << 7 );
       if( tail ) {
        /* копируем ту часть шифртекста, что не будет изменена */
          outptr -= 16;
@@ -553,10 +664,11 @@
  /* теперь blocks отлично от нуля и можно выполнить общий цикл обработки данных */
   switch( encryptionKey->bsize ) {
     case  8:
-      while( blocks-- > 1 ) {
-         ak_xtsmac_decrypt_step64( inptr, outptr );
-         ctx->pbitlen += 128;
-      }
+     /* последняя пара блоков обрабатывается отдельно */
+      ak_xtsmac_blocks64( ctx, encryptionKey, ak_true, inptr, outptr, ( size_t ) --blocks );
+      inptr += ( blocks << 4 );
+      outptr += ( blocks << 4 );
+      ctx->pbitlen += ( blocks << 7 );
       if( tail ) {
         ak_uint8 *loptr = NULL;
         ak_uint64 tgamma[2] = { ctx->gamma.u64[0], ctx->gamma.u64[1] };
@@ -25,11 +25,18 @@
                                                          char * , const size_t , export_format_t );
 /*! \brief Инициализация секретного ключа алгоритма блочного шифрования. */
  int ak_bckey_create( ak_bckey , size_t , size_t );
+/*! \brief Сохранение в контексте ключа текущих значений опций библиотеки. */
+ void ak_bckey_load_options( ak_bckey );
 /*! \brief Инициализация ключа алгоритма блочного шифрования значением другого ключа */
  int ak_bckey_create_and_set_bckey( ak_bckey , ak_bckey );
+/*! \brief Создание копии ключа алгоритма блочного шифрования с собственным генератором масок. */
+ int ak_bckey_create_copy( ak_bckey , ak_bckey );
 /*! \brief Процедура вычисления производного ключа в соответствии с алгоритмом ACPKM
     из рекомендаций Р 1323565.1.012-2018. */
  int ak_bckey_next_acpkm_key( ak_bckey );
+/*! \brief Минимальное количество блоков, обрабатываемых одним потоком при многопоточном
+    шифровании; более короткие данные обрабатываются в вызывающем потоке. */
+ #define ak_bckey_thread_blocks  (4096)
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Выработка матрицы, соответствующей 16 тактам работы линейного региста сдвига. */
@@ -44,6 +51,9 @@
                                                                 const sbox , ak_kuznechik_params );
 /*! \brief Инициализация внутренних переменных значениями, регламентируемыми ГОСТ Р 34.12-2015. */
  int ak_bckey_kuznechik_init_gost_tables( void );
+/*! \brief Инициализация развернутых таблиц замен, используемых многоблочной реализацией
+    алгоритма блочного шифрования Магма (ГОСТ Р 34.12-2015). */
+ int ak_bckey_magma_init_tables( void );
 /** @} */
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -69,6 +79,16 @@
  int ak_mac_file( ak_mac , const char* , ak_pointer , const size_t );
 /*! \brief Применение сжимающего отображения к фрагменту заданного файла. */
  int ak_mac_file_offset( ak_mac , const char* , ak_int64 , ak_int64 , ak_pointer , const size_t );
+/*! \brief Последовательная обработка фрагмента файла функциями update и finalize. */
+ int ak_mac_file_process( const char * , ak_int64 , ak_int64 , const size_t , const bool_t ,
+         ak_function_update * , ak_function_finalize * , ak_pointer , ak_pointer , const size_t );
+/** @} */
+
+/* ----------------------------------------------------------------------------------------------- */
+/** \addtogroup curves-doc Эллиптические кривые
+ @{ */
+/*! \brief Удаление таблиц кратных образующей точки, выработанных для эллиптических кривых. */
+ void ak_wcurve_destroy_generator_tables( void );
 /** @} */
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -67,6 +67,8 @@ extern "C" {
  #define ak_error_curve_prime_modulo          (-125)
 /*! \brief Ошибка, возникающая при сравнении двух эллиптических кривых */
  #define ak_error_curve_not_equal             (-126)
+/*! \brief Ошибка, возникающая когда система координат не соответствует параметрам кривой. */
+ #define ak_error_curve_coordinates           (-127)
 
 /*! \brief Ошибка, возникающая при использовании ключа, значение которого не определено. */
  #define ak_error_key_value                   (-130)
@@ -144,6 +146,46 @@ extern "C" {
 /*! \brief Функция завершает работу с библиотекой. */
  dll_export int ak_libakrypt_destroy( void );
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Индексы опций библиотеки.
+    \details Значения перечисления совпадают с положением опций во внутренней таблице библиотеки
+    и могут передаваться в функцию ak_libakrypt_get_option_by_index(). Это позволяет получать
+    значения опций за константное время, без поиска по имени опции. */
+ typedef enum {
+  /*! \brief Уровень аудита библиотеки. */
+   ak_option_log_level = 0,
+  /*! \brief Количество итераций алгоритма PBKDF2. */
+   ak_option_pbkdf2_iteration_count,
+  /*! \brief Ресурс ключа алгоритма HMAC. */
+   ak_option_hmac_key_count_resource,
+  /*! \brief Ресурс ключа электронной подписи. */
+   ak_option_digital_signature_count_resource,
+  /*! \brief Ресурс ключа алгоритма Магма (в блоках). */
+   ak_option_magma_cipher_resource,
+  /*! \brief Ресурс ключа алгоритма Кузнечик (в блоках). */
+   ak_option_kuznechik_cipher_resource,
+  /*! \brief Количество сообщений, обрабатываемых на одном ключе в режиме ACPKM. */
+   ak_option_acpkm_message_count,
+  /*! \brief Максимальная длина секции (в блоках) режима ACPKM для алгоритма Магма. */
+   ak_option_acpkm_section_magma_block_count,
+  /*! \brief Максимальная длина секции (в блоках) режима ACPKM для алгоритма Кузнечик. */
+   ak_option_acpkm_section_kuznechik_block_count,
+  /*! \brief Режим совместимости с библиотекой openssl. */
+   ak_option_openssl_compability,
+  /*! \brief Флаг использования цвета при выводе сообщений. */
+   ak_option_use_color_output,
+  /*! \brief Флаг выполнения дополнительных проверок при создании контекстов. */
+   ak_option_use_additional_algorithm_check_context,
+  /*! \brief Длина буффера (в октетах) для чтения файлов при вычислении кодов целостности. */
+   ak_option_file_read_buffer_size,
+  /*! \brief Минимальная длина файла (в октетах), отображаемого в память при вычислении
+      кодов целостности (нулевое значение, используемое по-умолчанию, запрещает отображение;
+      уменьшение отображенного файла другим процессом приводит к сигналу SIGBUS). */
+   ak_option_file_mmap_threshold,
+  /*! \brief Общее количество опций библиотеки (не является индексом опции). */
+   ak_option_count
+ } option_index_t;
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Функция возвращает номер версии бибилиотеки libakrypt. */
  dll_export const char *ak_libakrypt_version( void );
@@ -695,6 +737,9 @@ extern "C" {
  typedef int ( ak_function_bckey_create ) ( ak_bckey );
 /*! \brief Функция зашифрования/расширования одного блока информации. */
  typedef void ( ak_function_bckey )( ak_skey, ak_pointer, ak_pointer );
+/*! \brief Функция зашифрования/расшифрования последовательности из заданного количества
+    независимых блоков. */
+ typedef void ( ak_function_bckey_blocks )( ak_skey, ak_pointer, ak_pointer, size_t );
 /*! \brief Функция, предназначенная для зашифрования/расшифрования области памяти заданного размера */
  typedef int ( ak_function_bckey_encrypt )( ak_bckey, ak_pointer, ak_pointer, size_t,
                                                                                 ak_pointer, size_t );
@@ -715,10 +760,30 @@ extern "C" {
    ak_function_bckey *encrypt;
   /*! \brief Функция расширования одного блока информации. */
    ak_function_bckey *decrypt;
+  /*! \brief Функция зашифрования нескольких независимых блоков информации.
+      \details Может принимать значение NULL; в этом случае режимы шифрования
+      последовательно вызывают функцию encrypt для каждого блока. */
+   ak_function_bckey_blocks *encrypt_blocks;
+  /*! \brief Функция расшифрования нескольких независимых блоков информации.
+      \details Может принимать значение NULL; в этом случае режимы шифрования
+      последовательно вызывают функцию decrypt для каждого блока. */
+   ak_function_bckey_blocks *decrypt_blocks;
   /*! \brief Функция развертки ключа. */
    ak_function_skey *schedule_keys;
   /*! \brief Функция уничтожения развернутых ключей. */
    ak_function_skey *delete_keys;
+  /*! \brief Значения опций библиотеки, зафиксированные в момент присвоения ключу значения.
+      \details Режимы шифрования используют эти значения вместо обращения к опциям библиотеки
+      при каждом вызове. Значения обновляются при создании ключа, каждом присвоении ключу
+      значения и при импорте ключа из ASN.1 контейнера. */
+   struct {
+    /*! \brief Режим совместимости с библиотекой openssl. */
+     int openssl_compability;
+    /*! \brief Максимальная длина секции (в блоках) для режима ACPKM. */
+     ak_int64 acpkm_section_block_count;
+    /*! \brief Ресурс ключа (в блоках), устанавливаемый при присвоении ключу значения. */
+     ak_int64 cipher_resource;
+   } options;
 };
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -789,9 +854,15 @@ extern "C" {
     (cipher block chaining, cbc). */
  dll_export int ak_bckey_decrypt_cbc( ak_bckey , ak_pointer , ak_pointer , size_t ,
                                                                             ak_pointer , size_t );
+/*! \brief Многопоточное расшифрование данных в режиме простой замены с зацеплением. */
+ dll_export int ak_bckey_decrypt_cbc_threads( ak_bckey , ak_pointer , ak_pointer , size_t ,
+                                                            ak_pointer , size_t , const size_t );
 /*! \brief Шифрование данных в режиме гаммирования из ГОСТ Р 34.13-2015
    (counter mode, ctr). */
  dll_export int ak_bckey_ctr( ak_bckey , ak_pointer , ak_pointer , size_t , ak_pointer , size_t );
+/*! \brief Многопоточное шифрование данных в режиме гаммирования из ГОСТ Р 34.13-2015. */
+ dll_export int ak_bckey_ctr_threads( ak_bckey , ak_pointer , ak_pointer , size_t ,
+                                                            ak_pointer , size_t , const size_t );
 /*! \brief Шифрование данных в режиме гаммирования с обратной связью по выходу
    (output feedback, ofb). */
  dll_export int ak_bckey_ofb( ak_bckey , ak_pointer , ak_pointer , size_t , ak_pointer , size_t );
@@ -803,15 +874,28 @@ extern "C" {
    из ГОСТ Р 34.13-2015 (cipher feedback, cfb). */
  dll_export int ak_bckey_decrypt_cfb( ak_bckey , ak_pointer , ak_pointer , size_t ,
                                                                              ak_pointer , size_t );
+/*! \brief Многопоточное расшифрование данных в режиме гаммирования с обратной связью
+   по шифртексту. */
+ dll_export int ak_bckey_decrypt_cfb_threads( ak_bckey , ak_pointer , ak_pointer , size_t ,
+                                                            ak_pointer , size_t , const size_t );
 /*! \brief Шифрование данных в режиме `CTR-ACPKM` из Р 1323565.1.017—2018. */
  dll_export int ak_bckey_ctr_acpkm( ak_bckey , ak_pointer , ak_pointer , size_t , size_t ,
                                                                              ak_pointer , size_t );
+/*! \brief Многопоточное шифрование данных в режиме `CTR-ACPKM` из Р 1323565.1.017—2018. */
+ dll_export int ak_bckey_ctr_acpkm_threads( ak_bckey , ak_pointer , ak_pointer , size_t , size_t ,
+                                                            ak_pointer , size_t , const size_t );
 /*! \brief Зашифрование данных в режиме `XTS`. */
  dll_export int ak_bckey_encrypt_xts( ak_bckey ,  ak_bckey , ak_pointer , ak_pointer , size_t ,
                                                                              ak_pointer , size_t );
 /*! \brief Расшифрование данных в режиме `XTS`. */
  dll_export int ak_bckey_decrypt_xts( ak_bckey ,  ak_bckey , ak_pointer , ak_pointer , size_t ,
                                                                              ak_pointer , size_t );
+/*! \brief Зашифрование последовательности секторов в режиме `XTS`. */
+ dll_export int ak_bckey_encrypt_xts_sectors( ak_bckey , ak_bckey , ak_pointer , ak_pointer ,
+                                     const size_t , const size_t , const ak_uint64 , const size_t );
+/*! \brief Расшифрование последовательности секторов в режиме `XTS`. */
+ dll_export int ak_bckey_decrypt_xts_sectors( ak_bckey , ak_bckey , ak_pointer , ak_pointer ,
+                                     const size_t , const size_t , const ak_uint64 , const size_t );
 /** @}*/
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -973,6 +1057,15 @@ extern "C" {
   /*! \brief Идентификатор второго алгоритма хеширования,
       применяется только в алгоритмах семейства NMAC (см. Р 1323565.1.022-2018) */
    ak_oid nmac_second_hash_oid;
+  /*! \brief Маскированные состояния функции хеширования после обработки блоков
+      \f$ K \oplus ipad \f$ (нулевой элемент) и \f$ K \oplus opad \f$ (первый элемент).
+      \details Состояния вычисляются один раз для каждого значения ключа и позволяют
+      не выполнять два дополнительных сжатия при каждом вычислении имитовставки. */
+   struct streebog midstate[2];
+  /*! \brief Маски, наложенные на векторы h и \f$ \Sigma \f$ промежуточных состояний. */
+   ak_uint64 midmask[2][16];
+  /*! \brief Флаг того, что промежуточные состояния соответствуют текущему значению ключа. */
+   bool_t midstate_ready;
 } *ak_hmac;
 
 /*! \brief Создание секретного ключа алгоритма выработки имитовставки HMAC на основе функции Стрибог256. */
@@ -1185,6 +1278,30 @@ extern "C" {
 /*! \brief Развертка ключевого вектора из пароля (согласно Р 50.1.111-2016, раздел 4) */
  dll_export int ak_hmac_pbkdf2_streebog512( const ak_pointer , const size_t ,
                    const ak_pointer , const size_t, const size_t , const size_t , ak_pointer );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Задание для пакетной выработки ключевого вектора из пароля. */
+ typedef struct pbkdf2_task {
+  /*! \brief Пароль, строка символов в utf8 кодировке. */
+   ak_pointer pass;
+  /*! \brief Размер пароля в байтах. */
+   size_t pass_size;
+  /*! \brief Инициализационный вектор. */
+   ak_pointer salt;
+  /*! \brief Размер инициализационного вектора в байтах. */
+   size_t salt_size;
+  /*! \brief Количество итераций алгоритма. */
+   size_t cnt;
+  /*! \brief Длина вырабатываемого ключевого вектора в байтах. */
+   size_t dklen;
+  /*! \brief Указатель на массив, куда помещается результат. */
+   ak_pointer out;
+  /*! \brief Код ошибки, возникшей при выполнении задания. */
+   int error;
+ } *ak_pbkdf2_task;
+
+/*! \brief Пакетная развертка ключевых векторов из паролей, в том числе в нескольких потоках. */
+ dll_export int ak_hmac_pbkdf2_streebog512_tasks( ak_pbkdf2_task , const size_t , const size_t );
 /** @}*/
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -1438,9 +1555,20 @@ extern "C" {
 /*! \brief Умножение двух вычетов в представлении Монтгомери. */
  dll_export void ak_mpzn_mul_montgomery( ak_uint64 *, ak_uint64 *, ak_uint64 *,
                                                            ak_uint64 *, ak_uint64, const size_t );
+/*! \brief Возведение в квадрат вычета в представлении Монтгомери. */
+ dll_export void ak_mpzn_sqr_montgomery( ak_uint64 *, ak_uint64 *,
+                                                           ak_uint64 *, ak_uint64, const size_t );
 /*! \brief Модульное возведение в степень в представлении Монтгомери. */
  dll_export void ak_mpzn_modpow_montgomery( ak_uint64 *, ak_uint64 *, ak_uint64 *,
                                                            ak_uint64 *, ak_uint64, const size_t );
+/*! \brief Обращение вычета по простому модулю за фиксированное время. */
+ dll_export void ak_mpzn_inverse( ak_uint64 *, ak_uint64 *, ak_uint64 *, const size_t );
+/*! \brief Обращение вычета в представлении Монтгомери за фиксированное время. */
+ dll_export void ak_mpzn_inverse_montgomery( ak_uint64 *, ak_uint64 *,
+                                                           ak_uint64 *, ak_uint64, const size_t );
+/*! \brief Одновременное обращение набора вычетов в представлении Монтгомери. */
+ dll_export void ak_mpzn_modinv_montgomery_batch( ak_uint64 *, ak_uint64 *, const size_t ,
+                                                           ak_uint64 *, ak_uint64, const size_t );
 /* ----------------------------------------------------------------------------------------------- */
 #ifdef AK_HAVE_GMP_H
 /*! \brief Преобразование ak_mpznxxx в mpz_t. */
@@ -1497,8 +1625,57 @@ extern "C" {
  dll_export void ak_wpoint_add( ak_wpoint , ak_wpoint , ak_wcurve );
 /*! \brief Приведение проективной точки к аффинному виду. */
  dll_export void ak_wpoint_reduce( ak_wpoint , ak_wcurve );
+/*! \brief Одновременное приведение набора проективных точек к аффинному виду. */
+ dll_export void ak_wpoint_reduce_batch( ak_wpoint , const size_t , ak_wcurve );
 /*! \brief Вычисление кратной точки эллиптической кривой. */
  dll_export void ak_wpoint_pow( ak_wpoint , ak_wpoint , ak_uint64 *, size_t , ak_wcurve );
+/*! \brief Вычисление кратной точки эллиптической кривой методом фиксированного окна. */
+ dll_export void ak_wpoint_pow_window( ak_wpoint , ak_wpoint , ak_uint64 *, size_t , ak_wcurve );
+/*! \brief Вычисление кратной образующей точки эллиптической кривой с использованием таблиц. */
+ dll_export void ak_wpoint_pow_generator( ak_wpoint , ak_uint64 *, size_t , ak_wcurve );
+/*! \brief Совместное вычисление суммы кратных образующей и заданной точек эллиптической кривой. */
+ dll_export void ak_wpoint_pow_sum( ak_wpoint , ak_uint64 *, ak_wpoint , ak_uint64 *,
+                                                                           size_t , ak_wcurve );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Система координат, используемая при вычислении кратных точек эллиптической кривой.
+
+    Выбор системы координат определяется параметрами кривой и влияет только на внутреннее
+    представление точек при вычислении кратных точек; результат вычислений всегда возвращается
+    в однородных проективных координатах.                                                          */
+ typedef enum {
+  /*! \brief Однородные проективные координаты \f$ (x:y:z) \f$, где \f$ x = X/Z, y = Y/Z \f$. */
+   wcurve_projective_coordinates = 0x00,
+  /*! \brief Координаты Якоби \f$ (X:Y:Z) \f$, где \f$ x = X/Z^2, y = Y/Z^3 \f$. */
+   wcurve_jacobian_coordinates = 0x01,
+  /*! \brief Координаты Якоби для кривых с коэффициентом \f$ a \equiv -3 \pmod{p} \f$. */
+   wcurve_jacobian_a3_coordinates = 0x02,
+  /*! \brief Проективные координаты \f$ (U:V:W) \f$ бирационально эквивалентной
+      скрученной кривой Эдвардса, где \f$ u = U/W, v = V/W \f$. */
+   wcurve_edwards_coordinates = 0x03
+ } wcurve_coordinates_t;
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Параметры скрученной кривой Эдвардса, бирационально эквивалентной кривой,
+    заданной в короткой форме Вейерштрасса.
+
+    Кривая Эдвардса задается уравнением \f$ eu^2 + v^2 = 1 + du^2v^2 \f$.
+    Переход к короткой форме Вейерштрасса задается соотношениями
+    \f$ x = s\frac{1+v}{1-v} + t, \ y = s\frac{1+v}{(1-v)u} \f$, где
+    \f$ s = \frac{e-d}{4}, \ t = \frac{e+d}{6} \f$. Все величины хранятся
+    в представлении Монтгомери.                                                                    */
+/* ----------------------------------------------------------------------------------------------- */
+ struct wcurve_edwards
+{
+ /*! \brief Коэффициент \f$ e \f$ кривой Эдвардса (в представлении Монтгомери). */
+  ak_uint64 e[ak_mpzn512_size];
+ /*! \brief Коэффициент \f$ d \f$ кривой Эдвардса (в представлении Монтгомери). */
+  ak_uint64 d[ak_mpzn512_size];
+ /*! \brief Величина \f$ s = (e-d)/4 \f$ (в представлении Монтгомери). */
+  ak_uint64 s[ak_mpzn512_size];
+ /*! \brief Величина \f$ t = (e+d)/6 \f$ (в представлении Монтгомери). */
+  ak_uint64 t[ak_mpzn512_size];
+};
 
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Перечисление числовых идентификаторов поддерживаемых эллиптических кривых */
@@ -1560,6 +1737,11 @@ extern "C" {
   const char *pchar;
  /*! \brief Идентификатор эллиптической кривой, используемый в криптографических протоколах. */
   wcurve_id_t id;
+ /*! \brief Система координат, используемая при вычислении кратных точек. */
+  wcurve_coordinates_t coordinates;
+ /*! \brief Параметры эквивалентной кривой Эдвардса (для системы координат
+     \ref wcurve_edwards_coordinates), для остальных кривых NULL. */
+  const struct wcurve_edwards *edwards;
 };
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -1627,6 +1809,8 @@ extern "C" {
  dll_export void ak_gf64_mul_uint64( ak_pointer z, ak_pointer x, ak_pointer y );
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{128}}\f$. */
  dll_export void ak_gf128_mul_uint64( ak_pointer z, ak_pointer x, ak_pointer y );
+/*! \brief Сумма попарных произведений элементов поля \f$ \mathbb F_{2^{128}}\f$. */
+ dll_export void ak_gf128_mul_sum_uint64( ak_pointer z, ak_pointer a, ak_pointer b, const size_t count );
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{256}}\f$. */
  dll_export void ak_gf256_mul_uint64( ak_pointer z, ak_pointer x, ak_pointer y );
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{512}}\f$. */
@@ -1637,6 +1821,8 @@ extern "C" {
  dll_export void ak_gf64_mul_pcmulqdq( ak_pointer z, ak_pointer x, ak_pointer y );
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{128}}\f$. */
  dll_export void ak_gf128_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b );
+/*! \brief Сумма попарных произведений элементов поля \f$ \mathbb F_{2^{128}}\f$. */
+ dll_export void ak_gf128_mul_sum_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b, const size_t count );
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{256}}\f$. */
  dll_export void ak_gf256_mul_pcmulqdq( ak_pointer z, ak_pointer a, ak_pointer b );
 /*! \brief Умножение двух элементов поля \f$ \mathbb F_{2^{512}}\f$. */
@@ -1644,12 +1830,14 @@ extern "C" {
 
  #define ak_gf64_mul ak_gf64_mul_pcmulqdq
  #define ak_gf128_mul ak_gf128_mul_pcmulqdq
+ #define ak_gf128_mul_sum ak_gf128_mul_sum_pcmulqdq
  #define ak_gf256_mul ak_gf256_mul_pcmulqdq
  #define ak_gf512_mul ak_gf512_mul_pcmulqdq
 #else
 
  #define ak_gf64_mul ak_gf64_mul_uint64
  #define ak_gf128_mul ak_gf128_mul_uint64
+ #define ak_gf128_mul_sum ak_gf128_mul_sum_uint64
  #define ak_gf256_mul ak_gf256_mul_uint64
  #define ak_gf512_mul ak_gf512_mul_uint64
 #endif
@@ -2034,6 +2222,8 @@ extern "C" {
   struct hash ctx;
  /*! \brief номер открытого ключа, выработанного из данного секретного ключа. */
   ak_uint8 verifykey_number[32];
+ /*! \brief набор предварительно вычисленных пар (k, r), может быть не определен */
+  struct signkey_nonces *nonces;
 } *ak_signkey;
 
 /* ----------------------------------------------------------------------------------------------- */
@@ -2145,6 +2335,14 @@ extern "C" {
     заранее значения хеш-функции. */
  dll_export void ak_signkey_sign_const_values( ak_signkey , ak_uint64 * ,
                                                                         ak_uint64 * , ak_pointer );
+/*! \brief Создание набора предварительно вычисляемых пар (k, r) для секретного ключа. */
+ dll_export int ak_signkey_set_nonces( ak_signkey , const size_t );
+/*! \brief Пополнение набора предварительно вычисляемых пар (k, r). */
+ dll_export int ak_signkey_refill_nonces( ak_signkey , ak_random );
+/*! \brief Запуск фонового потока, пополняющего набор пар (k, r). */
+ dll_export int ak_signkey_start_nonces_thread( ak_signkey , ak_random );
+/*! \brief Количество вычисленных и еще не использованных пар (k, r). */
+ dll_export size_t ak_signkey_get_nonces_count( ak_signkey );
 /*! \brief Выработка электронной подписи для вычисленного заранее значения хеш-функции. */
  dll_export int ak_signkey_sign_hash( ak_signkey , ak_random , ak_pointer , size_t ,
                                                                              ak_pointer , size_t );
@@ -2169,6 +2367,59 @@ extern "C" {
  dll_export bool_t ak_verifykey_verify_file_offset( ak_verifykey , const char * ,
                                                                 ak_int64 , ak_int64 , ak_pointer );
 
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Пул реплик секретного ключа электронной подписи.
+
+    Реплики содержат одно и то же значение секретного ключа, маскируемое независимо,
+    и могут одновременно использоваться различными потоками для выработки подписей.
+    Ресурс ключа расходуется всеми репликами совместно.                                            */
+/* ----------------------------------------------------------------------------------------------- */
+ typedef struct signkey_pool {
+  /*! \brief Массив реплик секретного ключа. */
+   ak_signkey keys;
+  /*! \brief Флаги занятости реплик. */
+   ak_uint32 *busy;
+  /*! \brief Количество реплик. */
+   size_t count;
+  /*! \brief Общий ресурс: количество подписей, которые еще могут быть выработаны. */
+   ssize_t resource;
+  /*! \brief Счетчик, определяющий реплику, с которой начинается поиск свободной реплики. */
+   ssize_t next;
+  /*! \brief Исходный ключ, которому при уничтожении пула возвращается оставшийся ресурс. */
+   ak_signkey source;
+} *ak_signkey_pool;
+
+/*! \brief Создание пула реплик секретного ключа электронной подписи. */
+ dll_export int ak_signkey_pool_create( ak_signkey_pool , ak_signkey , const size_t );
+/*! \brief Уничтожение пула реплик секретного ключа электронной подписи. */
+ dll_export int ak_signkey_pool_destroy( ak_signkey_pool );
+/*! \brief Выработка электронной подписи для хеш-кода с помощью пула реплик ключа. */
+ dll_export int ak_signkey_pool_sign_hash( ak_signkey_pool , ak_random , ak_pointer , size_t ,
+                                                                             ak_pointer , size_t );
+/*! \brief Выработка электронной подписи для области памяти с помощью пула реплик ключа. */
+ dll_export int ak_signkey_pool_sign_ptr( ak_signkey_pool , ak_random , const ak_pointer ,
+                                                              const size_t , ak_pointer , size_t );
+
+/* ----------------------------------------------------------------------------------------------- */
+/*! \brief Задание для пакетной проверки электронной подписи. */
+ typedef struct verify_task {
+  /*! \brief Открытый ключ, с помощью которого проверяется подпись. */
+   ak_verifykey key;
+  /*! \brief Хеш-код подписанного сообщения. */
+   ak_pointer hash;
+  /*! \brief Размер хеш-кода в байтах. */
+   size_t hash_size;
+  /*! \brief Проверяемая электронная подпись. */
+   ak_pointer sign;
+  /*! \brief Результат проверки: истина, если подпись верна. */
+   bool_t result;
+  /*! \brief Код ошибки, возникшей при выполнении задания. */
+   int error;
+} *ak_verify_task;
+
+/*! \brief Пакетная проверка электронных подписей, в том числе в нескольких потоках. */
+ dll_export int ak_verifykey_verify_hash_tasks( ak_verify_task , const size_t , const size_t );
+
 /* ----------------------------------------------------------------------------------------------- */
 /*! \brief Параметры запроса на сертификат открытого ключа */
  typedef struct request_opts {
@@ -2430,6 +2681,10 @@ extern "C" {
 /*! \brief Функция инициализирует контекст секретного ключа, импортирует параметры ключа
     из указанного файла, а также присваивает значение секретного ключа. */
  dll_export int ak_skey_import_from_file( ak_pointer , oid_engines_t , const char * );
+/*! \brief Функция инициализирует контексты секретных ключей и импортирует их значения
+    из указанных файлов, вырабатывая ключи доступа к контейнерам в нескольких потоках. */
+ dll_export int ak_skey_import_from_files( ak_pointer * , oid_engines_t ,
+                                                   const char ** , const size_t , const size_t );
 /*! \brief Функция создает и инициализирует контекст секретного ключа,
     после чего импортирует параметры ключа из указанного файла. */
  dll_export ak_pointer ak_skey_new_from_file( const char * );